@@ -0,0 +1,213 @@
+# Copyright (C) 2012 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# This script is used by ndk-build to convert the log of build commands
+# recorded with NDK_BUILD_TRACE=<file> into a Chrome trace-event file,
+# which can be loaded in chrome://tracing, and to print a summary of the
+# slowest translation units and modules.
+#
+# Its input must be the log sorted by start time, where each line
+# looks like:
+#
+#   <start> <end> <status> <category> <abi> <module> <name>
+#
+# Where <start> and <end> are the output of NDK_BUILD_TRACE_TIME, i.e. a
+# number of nanoseconds (see ndk-build).
+#
+# Usage:
+#
+#   sort -n <log> | awk -f <this-script> -v OUTPUT=<trace-file>
+#
+# The make jobs that ran each command are not known, so these are
+# reconstructed by assigning each command to the first job slot that
+# is free when it starts. With -j<N>, there are at most N slots.
+#
+# Set TOP to the number of translation units and modules to list in
+# the summary (default is 10).
+#
+
+BEGIN {
+    if (TOP == "") {
+        TOP = 10
+    }
+    NUM_EVENTS = 0
+    NUM_SLOTS = 0
+    NUM_MODULES = 0
+    NUM_FAILED = 0
+    FIRST = -1
+    LAST = 0
+}
+
+# $1: a time in nanoseconds
+# Out: the corresponding time in microseconds
+function to_us (time)
+{
+    # Avoid floating point rounding issues with large values.
+    if (length(time) > 3) {
+        return substr(time, 1, length(time)-3) + 0
+    }
+    return 0
+}
+
+# $1: a string
+# Out: the same as a JSON string literal
+function json_string (str)
+{
+    gsub(/\\/, "\\\\", str)
+    gsub(/"/, "\\\"", str)
+    return "\"" str "\""
+}
+
+# $1: a duration in microseconds
+# Out: the same in seconds, for display
+function seconds (us)
+{
+    return sprintf("%.3fs", us / 1000000)
+}
+
+NF >= 7 {
+    start = to_us($1)
+    end = to_us($2)
+    if (end < start) {
+        end = start
+    }
+    # Find the first free job slot.
+    for (slot = 0; slot < NUM_SLOTS; slot++) {
+        if (SLOT_END[slot] <= start) {
+            break
+        }
+    }
+    if (slot == NUM_SLOTS) {
+        NUM_SLOTS++
+    }
+    SLOT_END[slot] = end
+
+    n = NUM_EVENTS++
+    EVENT_START[n] = start
+    EVENT_DUR[n] = end - start
+    EVENT_SLOT[n] = slot
+    EVENT_STATUS[n] = $3
+    EVENT_CAT[n] = $4
+    EVENT_ABI[n] = $5
+    EVENT_MODULE[n] = $6
+    EVENT_NAME[n] = $7
+    if ($3 != 0) {
+        NUM_FAILED++
+    }
+    if (FIRST < 0 || start < FIRST) {
+        FIRST = start
+    }
+    if (end > LAST) {
+        LAST = end
+    }
+
+    module = $5 " " $6
+    if (!(module in MODULE_TIME)) {
+        MODULES[NUM_MODULES++] = module
+        MODULE_TIME[module] = 0
+        MODULE_COUNT[module] = 0
+        MODULE_START[module] = start
+    }
+    MODULE_TIME[module] += end - start
+    MODULE_COUNT[module]++
+    if (end > MODULE_END[module]) {
+        MODULE_END[module] = end
+    }
+}
+
+END {
+    printf "{\"traceEvents\":[\n" > OUTPUT
+    printf "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"ndk-build\"}}" > OUTPUT
+    printf ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"tid\":0,\"args\":{\"name\":\"modules\"}}" > OUTPUT
+    for (slot = 0; slot < NUM_SLOTS; slot++) {
+        printf ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"job %d\"}}", slot, slot + 1 > OUTPUT
+    }
+    # One complete event per command, in the job slot that ran it.
+    for (n = 0; n < NUM_EVENTS; n++) {
+        printf ",\n{\"name\":%s,\"cat\":%s,\"ph\":\"X\",\"ts\":%d,\"dur\":%d,\"pid\":1,\"tid\":%d,\"args\":{\"abi\":%s,\"module\":%s,\"status\":%d}}", \
+            json_string(EVENT_NAME[n]), json_string(EVENT_CAT[n]), \
+            EVENT_START[n] - FIRST, EVENT_DUR[n], EVENT_SLOT[n], \
+            json_string(EVENT_ABI[n]), json_string(EVENT_MODULE[n]), \
+            EVENT_STATUS[n] > OUTPUT
+    }
+    # One event per module, from its first to its last command.
+    for (n = 0; n < NUM_MODULES; n++) {
+        module = MODULES[n]
+        split(module, items, " ")
+        printf ",\n{\"name\":%s,\"cat\":\"module\",\"ph\":\"X\",\"ts\":%d,\"dur\":%d,\"pid\":2,\"tid\":%d,\"args\":{\"abi\":%s,\"commands\":%d,\"time_us\":%d}}", \
+            json_string(items[2]), MODULE_START[module] - FIRST, \
+            MODULE_END[module] - MODULE_START[module], n, \
+            json_string(items[1]), MODULE_COUNT[module], \
+            MODULE_TIME[module] > OUTPUT
+        printf ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":2,\"tid\":%d,\"args\":{\"name\":%s}}", \
+            n, json_string(module) > OUTPUT
+    }
+    printf "\n],\n\"displayTimeUnit\":\"ms\"}\n" > OUTPUT
+    close(OUTPUT)
+
+    if (NUM_EVENTS == 0) {
+        printf "Build trace    : %s (no commands)\n", OUTPUT
+        exit 0
+    }
+    printf "Build trace    : %s (%d commands, %d job slots, %s)\n", \
+        OUTPUT, NUM_EVENTS, NUM_SLOTS, seconds(LAST - FIRST)
+    if (NUM_FAILED > 0) {
+        printf "  %d command(s) failed\n", NUM_FAILED
+    }
+
+    # Slowest translation units, by selecting the largest remaining
+    # duration TOP times.
+    printf "  Slowest translation units:\n"
+    for (rank = 0; rank < TOP; rank++) {
+        best = -1
+        for (n = 0; n < NUM_EVENTS; n++) {
+            if (EVENT_CAT[n] != "compile" || (n in LISTED)) {
+                continue
+            }
+            if (best < 0 || EVENT_DUR[n] > EVENT_DUR[best]) {
+                best = n
+            }
+        }
+        if (best < 0) {
+            break
+        }
+        LISTED[best] = 1
+        printf "    %10s  %-12s %s <= %s\n", seconds(EVENT_DUR[best]), \
+            EVENT_ABI[best], EVENT_MODULE[best], EVENT_NAME[best]
+    }
+
+    # Slowest modules, by total time of their commands.
+    printf "  Slowest modules:\n"
+    for (rank = 0; rank < TOP; rank++) {
+        best = ""
+        for (n = 0; n < NUM_MODULES; n++) {
+            module = MODULES[n]
+            if (module in LISTED_MODULE) {
+                continue
+            }
+            if (best == "" || MODULE_TIME[module] > MODULE_TIME[best]) {
+                best = module
+            }
+        }
+        if (best == "") {
+            break
+        }
+        LISTED_MODULE[best] = 1
+        split(best, items, " ")
+        printf "    %10s  %-12s %s (%d commands, %s elapsed)\n", \
+            seconds(MODULE_TIME[best]), items[1], items[2], \
+            MODULE_COUNT[best], seconds(MODULE_END[best] - MODULE_START[best])
+    }
+}
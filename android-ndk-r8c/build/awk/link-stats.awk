@@ -0,0 +1,71 @@
+# Copyright (C) 2012 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# This script is used by the NDK build system to report the size and the
+# number of dynamic relocations of the binaries of the modules that use
+# LOCAL_LINK_OPTIMIZE or APP_LINK_OPTIMIZE (see docs/APPLICATION-MK.html).
+#
+# Its input is the output of 'readelf -r <binary>', as in:
+#
+#   readelf -r <binary> | awk -f <this-script> -v NAME=<name> \
+#       -v SIZE=<size-in-bytes> -v STATS=<stats-file>
+#
+# Each relocation is a line that contains its R_<arch>_<type> type. The
+# previous values are read from the stats file, which only contains
+# "<size> <relocations>", and the change is reported next to each new
+# value. Nothing is printed if both values are unchanged, e.g. when the
+# binary is only reinstalled.
+#
+
+BEGIN {
+    RELOCS = 0
+}
+
+/ R_[0-9A-Z_]+/ {
+    RELOCS++
+}
+
+# $1: new value
+# $2: previous value, or empty
+# Out: the change between both values, for display
+function delta (value, previous)
+{
+    if (previous == "") {
+        return ""
+    }
+    if (value >= previous) {
+        return sprintf(" (+%d)", value - previous)
+    }
+    return sprintf(" (-%d)", previous - value)
+}
+
+END {
+    SIZE += 0
+    OLD_SIZE = ""
+    OLD_RELOCS = ""
+    if ((getline LINE < STATS) > 0) {
+        split(LINE, items, " ")
+        OLD_SIZE = items[1] + 0
+        OLD_RELOCS = items[2] + 0
+    }
+    close(STATS)
+    if (OLD_SIZE != "" && SIZE == OLD_SIZE && RELOCS == OLD_RELOCS) {
+        exit 0
+    }
+    printf "LinkStats      : %s: %d bytes%s, %d relocations%s\n", NAME, \
+        SIZE, delta(SIZE, OLD_SIZE), RELOCS, delta(RELOCS, OLD_RELOCS)
+    printf "%d %d\n", SIZE, RELOCS > STATS
+    close(STATS)
+}
@@ -0,0 +1,101 @@
+# Copyright (C) 2012 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# This script is used by the NDK build system to merge the dependency
+# files generated by GCC with -MMD -MP into a single dependency database
+# for each module (see APP_DEPS_DATABASE in docs/APPLICATION-MK.html).
+#
+# It takes as input the current database, followed by the dependency
+# files of the objects that were recompiled since it was written, as in:
+#
+#   awk -f <this-script> <database> foo.o.d bar.o.d > <new-database>
+#
+# A dependency file looks like:
+#
+#    obj/local/armeabi/objs/foo/foo.o: jni/foo.c \
+#      jni/foo.h jni/bar.h
+#
+#    jni/foo.h:
+#
+#    jni/bar.h:
+#
+# The database contains a single line per object, where each object's
+# rule comes from the last input file that defines it, followed by a
+# single empty rule for all headers. The latter plays the same role as
+# the ones generated by -MP, i.e. it prevents errors when a header is
+# removed.
+#
+
+BEGIN {
+    LINE = ""
+    NUM_TARGETS = 0
+
+    # Skip missing input files, i.e. the database on the first run, and
+    # the dependency files that are not generated for some objects.
+    for (n = 1; n < ARGC; n++) {
+        if ((getline dummy < ARGV[n]) < 0) {
+            delete ARGV[n]
+        } else {
+            close(ARGV[n])
+        }
+    }
+}
+
+# Join continued lines.
+/\\$/ {
+    LINE = LINE substr($0, 1, length($0)-1) " "
+    next
+}
+
+{
+    LINE = LINE $0
+    # Look for the rule separator. Don't match the colon of a Windows
+    # drive letter, as in C:/foo.h
+    if (match(LINE, /:([ \t]|$)/)) {
+        deps = substr(LINE, RSTART+1)
+        target = substr(LINE, 1, RSTART-1)
+        gsub(/^[ \t]+|[ \t]+$/, "", target)
+        gsub(/^[ \t]+|[ \t]+$/, "", deps)
+        gsub(/[ \t]+/, " ", deps)
+        # Ignore empty rules, they will be regenerated.
+        if (deps != "" && target != "") {
+            if (!(target in DEPS)) {
+                TARGETS[NUM_TARGETS++] = target
+            }
+            DEPS[target] = deps
+        }
+    }
+    LINE = ""
+}
+
+END {
+    print "# Auto-generated by the Android NDK build system, do not edit."
+    HEADERS = ""
+    for (n = 0; n < NUM_TARGETS; n++) {
+        target = TARGETS[n]
+        print target ": " DEPS[target]
+        # The first dependency is the source file.
+        count = split(DEPS[target], items, " ")
+        for (i = 2; i <= count; i++) {
+            if (!(items[i] in SEEN)) {
+                SEEN[items[i]] = 1
+                HEADERS = HEADERS " " items[i]
+            }
+        }
+    }
+    if (HEADERS != "") {
+        print substr(HEADERS, 2) ":"
+    }
+}
@@ -145,11 +145,11 @@ ifndef APP_ABI
     APP_ABI := armeabi
 endif
 ifneq ($(APP_ABI),all)
-    _bad_abis := $(strip $(filter-out $(NDK_ALL_ABIS),$(APP_ABIS)))
+    _bad_abis := $(strip $(filter-out $(NDK_ALL_ABIS) $(NDK_HOST_ABIS),$(APP_ABIS)))
     ifdef _bad_abis
         $(call __ndk_info,Application $(_app) targets unknown ABI '$(_bad_abis)')
         $(call __ndk_info,Please fix the APP_ABI definition in $(_application_mk))
-        $(call __ndk_info,to use a set of the following values: $(NDK_ALL_ABIS))
+        $(call __ndk_info,to use a set of the following values: $(NDK_ALL_ABIS) $(NDK_HOST_ABIS))
         $(call __ndk_error,Aborting)
     endif
 endif
@@ -241,6 +241,90 @@ else
   APP_CFLAGS := -O2 -DNDEBUG -g $(APP_CFLAGS)
 endif
 
+# Check APP_LTO, it must be empty, 'true' or 'false'. Modules can override
+# it with LOCAL_LTO.
+#
+APP_LTO := $(strip $(APP_LTO))
+ifdef APP_LTO
+  ifneq (,$(filter-out true false,$(APP_LTO)))
+    $(call __ndk_info,APP_LTO defined in $(_application_mk) must be either 'true' or 'false' not '$(APP_LTO)')
+    $(call __ndk_error,Aborting)
+  endif
+endif
+
+# APP_LTO_JOBS is the number of parallel link-time optimization jobs
+# (i.e. partitions compiled at the same time) for each LTO link. It
+# defaults to the -j<N> value given to ndk-build, if any.
+#
+APP_LTO_JOBS := $(strip $(APP_LTO_JOBS))
+ifndef APP_LTO_JOBS
+  APP_LTO_JOBS := $(strip $(NDK_MAKE_JOBS))
+endif
+ifdef APP_LTO_JOBS
+  __lto_jobs := $(APP_LTO_JOBS)
+  $(foreach __digit,0 1 2 3 4 5 6 7 8 9,$(eval __lto_jobs := $$(subst $(__digit),,$$(__lto_jobs))))
+  ifneq (,$(__lto_jobs))
+    $(call __ndk_info,APP_LTO_JOBS must be a number not '$(APP_LTO_JOBS)')
+    $(call __ndk_error,Aborting)
+  endif
+  $(call ndk_log,  Using $(APP_LTO_JOBS) parallel LTO jobs)
+endif
+
+# Check APP_PGO, it must be empty, 'instrument' or 'use'.
+#
+# Instrumented binaries write their .gcda profiles under NDK_PGO_RUNTIME_DIR
+# on the device. The optimized build reads them from NDK_PGO_PROFILE_DIR on
+# the host, which must have the same layout (e.g. the result of 'adb pull').
+#
+APP_PGO := $(strip $(APP_PGO))
+ifdef APP_PGO
+  ifneq (,$(filter-out instrument use,$(APP_PGO)))
+    $(call __ndk_info,APP_PGO defined in $(_application_mk) must be either 'instrument' or 'use' not '$(APP_PGO)')
+    $(call __ndk_error,Aborting)
+  endif
+  NDK_PGO_RUNTIME_DIR := $(strip $(NDK_PGO_RUNTIME_DIR))
+  ifndef NDK_PGO_RUNTIME_DIR
+    NDK_PGO_RUNTIME_DIR := /sdcard/ndk-pgo
+  endif
+  NDK_PGO_PROFILE_DIR := $(strip $(NDK_PGO_PROFILE_DIR))
+  ifndef NDK_PGO_PROFILE_DIR
+    NDK_PGO_PROFILE_DIR := $(APP_PROJECT_PATH)/pgo
+  endif
+  ifeq ($(APP_PGO),use)
+    ifeq (,$(wildcard $(NDK_PGO_PROFILE_DIR)))
+      $(call __ndk_info,WARNING: APP_PGO is 'use' but there is no profile directory: $(NDK_PGO_PROFILE_DIR))
+    endif
+  endif
+  $(call ndk_log,  Profile-guided optimization mode: $(APP_PGO))
+endif
+
+# Check APP_DEPS_DATABASE, it must be empty, 'true' or 'false'. The
+# database is updated with shell commands that are not available on
+# Windows, unless Cygwin is used.
+#
+APP_DEPS_DATABASE := $(strip $(APP_DEPS_DATABASE))
+ifdef APP_DEPS_DATABASE
+  ifneq (,$(filter-out true false,$(APP_DEPS_DATABASE)))
+    $(call __ndk_info,APP_DEPS_DATABASE defined in $(_application_mk) must be either 'true' or 'false' not '$(APP_DEPS_DATABASE)')
+    $(call __ndk_error,Aborting)
+  endif
+  ifeq ($(APP_DEPS_DATABASE)-$(HOST_OS),true-windows)
+    $(call __ndk_info,WARNING: Ignoring APP_DEPS_DATABASE: Not supported on this host system)
+    APP_DEPS_DATABASE := false
+  endif
+endif
+
+# Check APP_LINK_OPTIMIZE, it must be empty, 'true' or 'false'. Modules can
+# override it with LOCAL_LINK_OPTIMIZE.
+#
+APP_LINK_OPTIMIZE := $(strip $(APP_LINK_OPTIMIZE))
+ifdef APP_LINK_OPTIMIZE
+  ifneq (,$(filter-out true false,$(APP_LINK_OPTIMIZE)))
+    $(call __ndk_info,APP_LINK_OPTIMIZE defined in $(_application_mk) must be either 'true' or 'false' not '$(APP_LINK_OPTIMIZE)')
+    $(call __ndk_error,Aborting)
+  endif
+endif
+
 # Check that APP_STL is defined. If not, use the default value (system)
 # otherwise, check that the name is correct.
 APP_STL := $(strip $(APP_STL))
@@ -73,7 +73,9 @@ $(foreach _abi,$(_abis),\
     $(eval NDK_ABI.$(_abi).arch := $(sort $(NDK_ABI.$(_abi).arch) $(_arch)))\
 )
 
-NDK_ARCH.$(_arch).toolchains += $(_name)
+# Use $(eval ...) to record the toolchain name itself. Otherwise, the first
+# += would define a recursive variable that references $(_name).
+$(eval NDK_ARCH.$(_arch).toolchains += $(_name))
 NDK_ARCH.$(_arch).abis := $(sort $(NDK_ARCH.$(_arch).abis) $(_abis))
 
 # done
@@ -65,6 +65,10 @@ ANDROID_MK_INCLUDED := \
 #
 ALL_DEPENDENCY_DIRS :=
 
+# this is the list of module dependency databases used instead, when
+# APP_DEPS_DATABASE is 'true'.
+ALL_DEPS_DATABASES :=
+
 # this is the list of all generated files that we would need to clean
 ALL_HOST_EXECUTABLES      :=
 ALL_HOST_STATIC_LIBRARIES :=
@@ -139,6 +143,7 @@ ifeq ($(HOST_OS),cygwin)
 clean: clean-dependency-converter
 endif
 	
-# include dependency information
+# include dependency information, either from the individual dependency
+# files of each object, or from the module databases (see build-binary.mk)
 ALL_DEPENDENCY_DIRS := $(patsubst %/,%,$(sort $(ALL_DEPENDENCY_DIRS)))
--include $(wildcard $(ALL_DEPENDENCY_DIRS:%=%/*.d))
+-include $(wildcard $(ALL_DEPENDENCY_DIRS:%=%/*.d) $(ALL_DEPS_DATABASES))
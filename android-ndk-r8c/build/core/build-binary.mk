@@ -120,6 +120,100 @@ else
   LOCAL_LDFLAGS += $($(my)RELRO_LDFLAGS)
 endif
 
+#
+# Profile-guided optimization is enabled for all the modules of the
+# application with APP_PGO. This is done before LTO since the link-time
+# code generation needs the same flags.
+#
+pgo_mode := $(NDK_APP_PGO)
+ifeq ($(call module-is-prebuilt,$(LOCAL_MODULE)),$(true))
+  pgo_mode :=
+endif
+ifdef pgo_mode
+  ifeq (,$(strip $($(my)PGO_$(pgo_mode)_CFLAGS)))
+    $(call __ndk_info,WARNING: Ignoring APP_PGO for module $(LOCAL_MODULE): The $(TARGET_TOOLCHAIN) toolchain doesn't support profile-guided optimization)
+    pgo_mode :=
+  else
+    LOCAL_CFLAGS  += $($(my)PGO_$(pgo_mode)_CFLAGS)
+    LOCAL_LDFLAGS += $($(my)PGO_$(pgo_mode)_LDFLAGS)
+  endif
+endif
+
+#
+# Link-time optimization is enabled with LOCAL_LTO, or APP_LTO for all the
+# modules of the application. The -flto objects are archived with the
+# toolchain's LTO plugin and the final link is performed with it.
+#
+LOCAL_LTO := $(strip $(LOCAL_LTO))
+ifdef LOCAL_LTO
+  $(if $(filter-out true false,$(LOCAL_LTO)),\
+    $(call __ndk_info,LOCAL_LTO must be defined either to 'true' or 'false' in $(LOCAL_MAKEFILE) not '$(LOCAL_LTO)')\
+    $(call __ndk_error,Aborting) \
+  )
+else
+  LOCAL_LTO := $(NDK_APP_LTO)
+endif
+ifeq ($(call module-is-prebuilt,$(LOCAL_MODULE)),$(true))
+  LOCAL_LTO := false
+endif
+ifeq ($(LOCAL_LTO),true)
+  ifeq (,$(strip $($(my)LTO_PLUGIN)))
+    $(call __ndk_info,WARNING: Ignoring LOCAL_LTO/APP_LTO for module $(LOCAL_MODULE): The $(TARGET_TOOLCHAIN) toolchain doesn't support link-time optimization)
+    LOCAL_LTO := false
+  endif
+  ifdef LOCAL_FILTER_ASM
+    $(call __ndk_info,WARNING: Ignoring LOCAL_LTO for module $(LOCAL_MODULE): It can't be used with LOCAL_FILTER_ASM)
+    LOCAL_LTO := false
+  endif
+endif
+ifeq ($(LOCAL_LTO),true)
+  LOCAL_CFLAGS += $($(my)LTO_CFLAGS)
+endif
+
+#
+# Linker-level optimizations are enabled with LOCAL_LINK_OPTIMIZE, or
+# APP_LINK_OPTIMIZE for all the modules of the application. Shared
+# libraries then only export the JNI entry points and LOCAL_EXPORT_SYMBOLS,
+# through a generated version script.
+#
+# When either variable is defined, the size and number of relocations of
+# the installed binaries are recorded and their changes reported.
+#
+LOCAL_LINK_OPTIMIZE := $(strip $(LOCAL_LINK_OPTIMIZE))
+ifdef LOCAL_LINK_OPTIMIZE
+  $(if $(filter-out true false,$(LOCAL_LINK_OPTIMIZE)),\
+    $(call __ndk_info,LOCAL_LINK_OPTIMIZE must be defined either to 'true' or 'false' in $(LOCAL_MAKEFILE) not '$(LOCAL_LINK_OPTIMIZE)')\
+    $(call __ndk_error,Aborting) \
+  )
+else
+  LOCAL_LINK_OPTIMIZE := $(NDK_APP_LINK_OPTIMIZE)
+endif
+ifeq ($(call module-is-prebuilt,$(LOCAL_MODULE)),$(true))
+  LOCAL_LINK_OPTIMIZE :=
+endif
+link_stats_file :=
+ifdef LOCAL_LINK_OPTIMIZE
+  ifneq ($(HOST_OS),windows)
+    link_stats_file := $(LOCAL_OBJS_DIR)/link-stats
+  endif
+endif
+LOCAL_EXPORT_SYMBOLS := $(strip $(LOCAL_EXPORT_SYMBOLS))
+ifeq ($(LOCAL_LINK_OPTIMIZE),true)
+  ifneq (,$(filter SHARED_LIBRARY EXECUTABLE,$(call module-get-class,$(LOCAL_MODULE))))
+    LOCAL_LDFLAGS += $($(my)LINK_OPTIMIZE_LDFLAGS)
+  endif
+  # Put these first, so that LOCAL_CFLAGS can override them.
+  LOCAL_CFLAGS := $($(my)LINK_OPTIMIZE_CFLAGS) $(LOCAL_CFLAGS)
+
+  ifeq ($(call module-get-class,$(LOCAL_MODULE)),SHARED_LIBRARY)
+    version_script := $(LOCAL_OBJS_DIR)/exports.map
+    $(call generate-version-script,$(version_script),$($(my)LINK_OPTIMIZE_EXPORTS) $(LOCAL_EXPORT_SYMBOLS))
+    LOCAL_LDFLAGS += -Wl,--version-script=$(call host-path,$(version_script))
+
+    $(LOCAL_BUILT_MODULE): $(version_script)
+  endif
+endif
+
 #
 # The original Android build system allows you to use the .arm prefix
 # to a source file name to indicate that it should be defined in either
@@ -211,6 +305,19 @@ $(call TARGET-process-src-files-tags)
 # only call dump-src-file-tags during debugging
 #$(dump-src-file-tags)
 
+# With LTO, code is generated at link time, so the linker must be given the
+# code generation and optimization flags too. Use the ones of the first
+# source file. -flto=<jobs> comes last to run that many LTRANS jobs in parallel.
+#
+ifeq ($(LOCAL_LTO),true)
+  LOCAL_LDFLAGS += $($(my)LTO_LDFLAGS) \
+                   $($(my)CFLAGS) \
+                   $(call get-src-file-target-cflags,$(firstword $(LOCAL_SRC_FILES))) \
+                   $(LOCAL_CFLAGS) \
+                   $(NDK_APP_CFLAGS) \
+                   -flto$(if $(NDK_APP_LTO_JOBS),=$(NDK_APP_LTO_JOBS))
+endif
+
 LOCAL_DEPENDENCY_DIRS :=
 
 # all_source_patterns contains the list of filename patterns that correspond
@@ -225,6 +332,73 @@ ifdef unknown_sources
     $(call __ndk_info,  $(unknown_sources))
 endif
 
+#
+# With LOCAL_UNITY_BUILD := true, the C and C++ sources are compiled in
+# batches of LOCAL_UNITY_BATCH_SIZE files, through generated unity sources
+# that #include them. Only sources with the same language and the same
+# target-specific flags (e.g. arm vs. thumb) are batched together, and those
+# listed in LOCAL_UNITY_EXCLUDE are compiled on their own.
+#
+# The unity sources are named unity-<n>.<ext> and replace the batched files
+# in LOCAL_SRC_FILES. Since they are only rewritten when their content
+# changes, modifying a source only rebuilds its batch. They are generated
+# in LOCAL_UNITY_DIR, outside of LOCAL_OBJS_DIR, since objects depend on
+# the latter and would be rebuilt each time a file is created in it.
+#
+LOCAL_UNITY_SOURCES :=
+LOCAL_UNITY_DIR     := $(LOCAL_OBJS_DIR).unity
+LOCAL_UNITY_BUILD := $(strip $(LOCAL_UNITY_BUILD))
+ifdef LOCAL_UNITY_BUILD
+  $(if $(filter-out true false,$(LOCAL_UNITY_BUILD)),\
+    $(call __ndk_info,LOCAL_UNITY_BUILD must be defined either to 'true' or 'false' in $(LOCAL_MAKEFILE) not '$(LOCAL_UNITY_BUILD)')\
+    $(call __ndk_error,Aborting) \
+  )
+endif
+ifeq ($(LOCAL_UNITY_BUILD),true)
+  LOCAL_UNITY_BATCH_SIZE := $(strip $(LOCAL_UNITY_BATCH_SIZE))
+  ifndef LOCAL_UNITY_BATCH_SIZE
+    LOCAL_UNITY_BATCH_SIZE := 8
+  endif
+  __unity_size := $(LOCAL_UNITY_BATCH_SIZE)
+  $(foreach __digit,0 1 2 3 4 5 6 7 8 9,$(eval __unity_size := $$(subst $(__digit),,$$(__unity_size))))
+  ifneq (,$(__unity_size)$(call index-is-zero,$(LOCAL_UNITY_BATCH_SIZE)))
+    $(call __ndk_info,LOCAL_UNITY_BATCH_SIZE must be a positive number in $(LOCAL_MAKEFILE) not '$(LOCAL_UNITY_BATCH_SIZE)')
+    $(call __ndk_error,Aborting)
+  endif
+
+  unity_candidates := $(filter-out $(LOCAL_UNITY_EXCLUDE),$(filter %.c $(all_cpp_patterns),$(LOCAL_SRC_FILES)))
+  unity_cpp_ext    := $(firstword $(filter .cpp,$(LOCAL_CPP_EXTENSION)) $(LOCAL_CPP_EXTENSION))
+
+  # The batching key of a source: its language and target-specific flags.
+  unity-src-key = $(if $(filter $(all_cpp_patterns),$1),cpp,c)|$(subst $(space),|,$(strip $(call get-src-file-target-cflags,$1)))
+
+  unity_keys :=
+  $(foreach _src,$(unity_candidates),\
+      $(eval _key := $(call unity-src-key,$(_src)))\
+      $(if $(filter $(_key),$(unity_keys)),,$(eval unity_keys += $(_key)))\
+  )
+
+  unity_batched :=
+  unity_count   :=
+  $(foreach _key,$(unity_keys),\
+      $(eval _group := $(foreach _src,$(unity_candidates),$(if $(filter $(_key),$(call unity-src-key,$(_src))),$(_src))))\
+      $(foreach _slice,$(call split-words,$(_group),$(LOCAL_UNITY_BATCH_SIZE)),\
+          $(eval _batch := $(subst |,$(space),$(_slice)))\
+          $(if $(word 2,$(_batch)),\
+              $(eval unity_count += x)\
+              $(eval _unity := unity-$(words $(unity_count))$(if $(filter cpp|%,$(_key)),$(unity_cpp_ext),.c))\
+              $(eval LOCAL_UNITY_SOURCES += $(_unity))\
+              $(eval unity_batched += $(_batch))\
+              $(call set-src-files-target-cflags,$(_unity),$(call get-src-file-target-cflags,$(firstword $(_batch))))\
+              $(call set-src-files-text,$(_unity),$(call get-src-file-text,$(firstword $(_batch))))\
+              $(call generate-unity-source,$(LOCAL_UNITY_DIR)/$(_unity),$(_batch))\
+              $(call ndk_log,Unity source $(_unity) of module $(LOCAL_MODULE): $(_batch))\
+          )\
+      )\
+  )
+  LOCAL_SRC_FILES := $(filter-out $(unity_batched),$(LOCAL_SRC_FILES)) $(LOCAL_UNITY_SOURCES)
+endif
+
 # LOCAL_OBJECTS will list all object files corresponding to the sources
 # listed in LOCAL_SRC_FILES, in the *same* order.
 #
@@ -236,6 +410,44 @@ LOCAL_OBJECTS := $(filter %.o,$(LOCAL_OBJECTS))
 LOCAL_OBJECTS := $(subst ../,__/,$(LOCAL_OBJECTS))
 LOCAL_OBJECTS := $(foreach _obj,$(LOCAL_OBJECTS),$(LOCAL_OBJS_DIR)/$(_obj))
 
+# When using profiles, the one of each object is found under
+# NDK_PGO_PROFILE_DIR at the object's path, which includes the ABI and the
+# module name. Objects depend on their profile so that they are rebuilt when
+# new profiles are collected.
+#
+# Warn about the sources without a profile, and about the ones modified
+# after their profile was collected. GCC only complains about the latter
+# when the change affects the control flow of the function.
+#
+ifeq ($(pgo_mode),use)
+  pgo_missing  :=
+  pgo_profiled :=
+  $(foreach _src,$(filter $(all_source_patterns),$(LOCAL_SRC_FILES)),\
+      $(eval _obj  := $(LOCAL_OBJS_DIR)/$(call get-object-name,$(_src)))\
+      $(eval _gcda := $(NDK_PGO_PROFILE_DIR)/$(patsubst ./%,%,$(_obj:%.o=%.gcda)))\
+      $(if $(wildcard $(_gcda)),\
+          $(eval $(_obj): $(_gcda))\
+          $(eval pgo_profiled += $(call get-src-file-path,$(_src)) $(_gcda)),\
+          $(eval pgo_missing += $(_src))\
+      )\
+  )
+  ifdef pgo_missing
+    $(call __ndk_info,WARNING: No profile in $(NDK_PGO_PROFILE_DIR) for these sources of module $(LOCAL_MODULE):)
+    $(call __ndk_info,  $(pgo_missing))
+  endif
+  ifdef pgo_profiled
+    pgo_stale := $(strip $(shell set -- $(pgo_profiled); \
+        while [ $$# -gt 1 ]; do \
+            if [ "$$1" -nt "$$2" ]; then echo "$$1"; fi; \
+            shift 2; \
+        done))
+    ifdef pgo_stale
+      $(call __ndk_info,WARNING: Stale profiles for these sources of module $(LOCAL_MODULE) modified after profiling:)
+      $(call __ndk_info,  $(pgo_stale))
+    endif
+  endif
+endif
+
 # If the module has any kind of C++ features, enable them in LOCAL_CPPFLAGS
 #
 ifneq (,$(call module-has-c++-features,$(LOCAL_MODULE),rtti))
@@ -246,12 +458,60 @@ ifneq (,$(call module-has-c++-features,$(LOCAL_MODULE),exceptions))
 endif
 
 # If we're using the 'system' STL and use rtti or exceptions, then
-# automatically link against the GNU libsupc++ for now.
+# automatically link against the GNU libsupc++ for now. The host's
+# libstdc++ already provides it for host ABIs.
 #
 ifneq (,$(call module-has-c++-features,$(LOCAL_MODULE),rtti exceptions))
     ifeq (system,$(NDK_APP_STL))
+    ifneq (host,$(TARGET_ARCH))
       LOCAL_LDLIBS := $(LOCAL_LDLIBS) $(call host-path,$(NDK_ROOT)/sources/cxx-stl/gnu-libstdc++/$(TOOLCHAIN_VERSION)/libs/$(TARGET_ARCH_ABI)/libsupc++.a)
     endif
+    endif
+endif
+
+#
+# LOCAL_PCH is a header (relative to LOCAL_PATH) that is precompiled and
+# included before anything else by all the C++ sources of the module.
+# Sources with different target-specific flags (e.g. arm vs. thumb) can't
+# share a precompiled header, so one is built for each set of flags, in
+# LOCAL_OBJS_DIR/pch-<n>, and LOCAL_PCH_HEADER.<source> is the one used by
+# each source. See build-pch in definitions.mk for details.
+#
+LOCAL_PCH := $(strip $(LOCAL_PCH))
+LOCAL_PCH_OBJECTS :=
+ifdef LOCAL_PCH
+  ifneq (1,$(words $(LOCAL_PCH)))
+    $(call __ndk_info,LOCAL_PCH must be a single header file in $(LOCAL_MAKEFILE) not '$(LOCAL_PCH)')
+    $(call __ndk_error,Aborting)
+  endif
+  ifeq (,$(wildcard $(LOCAL_PATH)/$(LOCAL_PCH)))
+    $(call __ndk_info,LOCAL_PCH file not found for module $(LOCAL_MODULE): $(LOCAL_PATH)/$(LOCAL_PCH))
+    $(call __ndk_error,Aborting)
+  endif
+
+  pch_sources := $(filter $(all_cpp_patterns),$(LOCAL_SRC_FILES))
+  ifndef pch_sources
+    $(call __ndk_info,WARNING: Ignoring LOCAL_PCH for module $(LOCAL_MODULE): It is only used by C++ sources)
+  endif
+
+  pch-src-key = cpp|$(subst $(space),|,$(strip $(call get-src-file-target-cflags,$1)))
+
+  pch_keys :=
+  $(foreach _src,$(pch_sources),\
+      $(eval _key := $(call pch-src-key,$(_src)))\
+      $(if $(filter $(_key),$(pch_keys)),,$(eval pch_keys += $(_key)))\
+  )
+
+  pch_count :=
+  $(foreach _key,$(pch_keys),\
+      $(eval pch_count += x)\
+      $(eval _group := $(foreach _src,$(pch_sources),$(if $(filter $(_key),$(call pch-src-key,$(_src))),$(_src))))\
+      $(eval _header := $(LOCAL_OBJS_DIR)/pch-$(words $(pch_count))/$(notdir $(LOCAL_PCH)))\
+      $(eval LOCAL_PCH_OBJECTS += $(_header).gch)\
+      $(foreach _src,$(_group),$(eval LOCAL_PCH_HEADER.$(_src) := $(_header)))\
+      $(call build-pch,$(_header),$(firstword $(_group)))\
+      $(call ndk_log,Precompiled header $(_header) of module $(LOCAL_MODULE): $(_group))\
+  )
 endif
 
 # Build the sources to object files
@@ -267,9 +527,40 @@ $(foreach src,$(filter $(all_cpp_patterns),$(LOCAL_SRC_FILES)),\
 #
 # The compile-xxx-source calls updated LOCAL_OBJECTS and LOCAL_DEPENDENCY_DIRS
 #
-ALL_DEPENDENCY_DIRS += $(sort $(LOCAL_DEPENDENCY_DIRS))
 CLEAN_OBJS_DIRS     += $(LOCAL_OBJS_DIR)
 
+#
+# With APP_DEPS_DATABASE, the dependency files of the objects are merged
+# into a single database for the module, which is loaded by build-all.mk
+# instead of the individual files. The database is updated incrementally
+# by a rule that only processes the objects that were rebuilt since its
+# last update, i.e. those that are newer than its timestamp file.
+#
+# Don't use the database as a target here, or GNU Make would try to remake
+# it (and thus all objects) before loading it.
+#
+ifneq (,$(and $(filter true,$(NDK_APP_DEPS_DATABASE)),$(LOCAL_OBJECTS)))
+LOCAL_DEPS_DATABASE := $(LOCAL_OBJS_DIR)/deps.mk
+ALL_DEPS_DATABASES  += $(LOCAL_DEPS_DATABASE)
+
+# Process all objects again if the database was removed.
+ifeq (,$(wildcard $(LOCAL_DEPS_DATABASE)))
+.PHONY: $(LOCAL_DEPS_DATABASE).timestamp
+endif
+
+$(LOCAL_DEPS_DATABASE).timestamp: PRIVATE_DATABASE := $(LOCAL_DEPS_DATABASE)
+$(LOCAL_DEPS_DATABASE).timestamp: $(LOCAL_OBJECTS) $(LOCAL_PCH_OBJECTS)
+	$(hide) $(HOST_AWK) -f $(BUILD_AWK)/merge-deps.awk $(PRIVATE_DATABASE) $(?:%=%.d) > $(PRIVATE_DATABASE).tmp
+	$(hide) mv -f $(PRIVATE_DATABASE).tmp $(PRIVATE_DATABASE)
+	$(hide) touch $@
+
+# Update the database before the module, but don't relink it when only
+# the database changes.
+$(LOCAL_BUILT_MODULE): | $(LOCAL_DEPS_DATABASE).timestamp
+else
+ALL_DEPENDENCY_DIRS += $(sort $(LOCAL_DEPENDENCY_DIRS))
+endif
+
 #
 # Handle the static and shared libraries this module depends on
 #
@@ -291,9 +582,9 @@ $(LOCAL_BUILT_MODULE): $(static_libraries) $(whole_static_libraries) $(shared_li
 
 # If LOCAL_LDLIBS contains anything like -l<library> then
 # prepend a -L$(SYSROOT)/usr/lib to it to ensure that the linker
-# looks in the right location
+# looks in the right location (there is no sysroot for the host ABIs)
 #
-ifneq ($(filter -l%,$(LOCAL_LDLIBS)),)
+ifneq ($(and $(SYSROOT),$(filter -l%,$(LOCAL_LDLIBS))),)
     LOCAL_LDLIBS := -L$(call host-path,$(SYSROOT)/usr/lib) $(LOCAL_LDLIBS)
 endif
 
@@ -361,9 +652,11 @@ $(LOCAL_BUILT_MODULE): PRIVATE_LDFLAGS := $(TARGET_LDFLAGS) $(LOCAL_LDFLAGS)
 $(LOCAL_BUILT_MODULE): PRIVATE_LDLIBS  := $(LOCAL_LDLIBS) $(TARGET_LDLIBS)
 
 $(LOCAL_BUILT_MODULE): PRIVATE_NAME := $(notdir $(LOCAL_BUILT_MODULE))
+$(LOCAL_BUILT_MODULE): PRIVATE_MODULE := $(LOCAL_MODULE)
+$(LOCAL_BUILT_MODULE): PRIVATE_ABI := $(TARGET_ARCH_ABI)
 $(LOCAL_BUILT_MODULE): PRIVATE_CXX := $(TARGET_CXX)
 $(LOCAL_BUILT_MODULE): PRIVATE_CC := $(TARGET_CC)
-$(LOCAL_BUILT_MODULE): PRIVATE_AR := $(TARGET_AR) $(TARGET_ARFLAGS)
+$(LOCAL_BUILT_MODULE): PRIVATE_AR := $(TARGET_AR) $(if $(filter true,$(LOCAL_LTO)),$(TARGET_LTO_ARFLAGS)) $(TARGET_ARFLAGS)
 $(LOCAL_BUILT_MODULE): PRIVATE_AR_OBJECTS := $(ar_objects)
 $(LOCAL_BUILT_MODULE): PRIVATE_SYSROOT := $(SYSROOT)
 $(LOCAL_BUILT_MODULE): PRIVATE_BUILD_SHARED_LIB := $(cmd-build-shared-library)
@@ -377,7 +670,7 @@ ifeq ($(call module-get-class,$(LOCAL_MODULE)),STATIC_LIBRARY)
 $(LOCAL_BUILT_MODULE): $(LOCAL_OBJECTS)
 	@ $(HOST_ECHO) "StaticLibrary  : $(PRIVATE_NAME)"
 	$(hide) $(call host-rm,$@)
-	$(hide) $(PRIVATE_BUILD_STATIC_LIB)
+	$(hide) $(cmd-trace-start)$(PRIVATE_BUILD_STATIC_LIB)$(call cmd-trace-end,archive,$(PRIVATE_NAME))
 
 ALL_STATIC_LIBRARIES += $(LOCAL_BUILT_MODULE)
 endif
@@ -388,7 +681,7 @@ endif
 ifeq ($(call module-get-class,$(LOCAL_MODULE)),SHARED_LIBRARY)
 $(LOCAL_BUILT_MODULE): $(LOCAL_OBJECTS)
 	@ $(HOST_ECHO) "SharedLibrary  : $(PRIVATE_NAME)"
-	$(hide) $(PRIVATE_BUILD_SHARED_LIB)
+	$(hide) $(cmd-trace-start)$(PRIVATE_BUILD_SHARED_LIB)$(call cmd-trace-end,link,$(PRIVATE_NAME))
 
 ALL_SHARED_LIBRARIES += $(LOCAL_BUILT_MODULE)
 endif
@@ -399,7 +692,7 @@ endif
 ifeq ($(call module-get-class,$(LOCAL_MODULE)),EXECUTABLE)
 $(LOCAL_BUILT_MODULE): $(LOCAL_OBJECTS)
 	@ $(HOST_ECHO) "Executable     : $(PRIVATE_NAME)"
-	$(hide) $(PRIVATE_BUILD_EXECUTABLE)
+	$(hide) $(cmd-trace-start)$(PRIVATE_BUILD_EXECUTABLE)$(call cmd-trace-end,link,$(PRIVATE_NAME))
 
 ALL_EXECUTABLES += $(LOCAL_BUILT_MODULE)
 endif
@@ -418,16 +711,21 @@ endif
 #
 ifeq ($(call module-is-installable,$(LOCAL_MODULE)),$(true))
 $(LOCAL_INSTALLED): PRIVATE_NAME      := $(notdir $(LOCAL_BUILT_MODULE))
+$(LOCAL_INSTALLED): PRIVATE_MODULE    := $(LOCAL_MODULE)
+$(LOCAL_INSTALLED): PRIVATE_ABI       := $(TARGET_ARCH_ABI)
 $(LOCAL_INSTALLED): PRIVATE_SRC       := $(LOCAL_BUILT_MODULE)
 $(LOCAL_INSTALLED): PRIVATE_DST_DIR   := $(NDK_APP_DST_DIR)
 $(LOCAL_INSTALLED): PRIVATE_DST       := $(LOCAL_INSTALLED)
 $(LOCAL_INSTALLED): PRIVATE_STRIP     := $(TARGET_STRIP)
 $(LOCAL_INSTALLED): PRIVATE_STRIP_CMD := $(call cmd-strip, $(PRIVATE_DST))
+$(LOCAL_INSTALLED): PRIVATE_READELF   := $(TARGET_READELF)
+$(LOCAL_INSTALLED): PRIVATE_LINK_STATS := $(link_stats_file)
 
 $(LOCAL_INSTALLED): $(LOCAL_BUILT_MODULE) clean-installed-binaries
 	@$(HOST_ECHO) "Install        : $(PRIVATE_NAME) => $(call pretty-dir,$(PRIVATE_DST))"
-	$(hide) $(call host-install,$(PRIVATE_SRC),$(PRIVATE_DST))
-	$(hide) $(PRIVATE_STRIP_CMD)
+	$(hide) $(cmd-trace-start)$(call host-install,$(PRIVATE_SRC),$(PRIVATE_DST))$(call cmd-trace-end,install,$(PRIVATE_NAME))
+	$(hide) $(cmd-trace-start)$(PRIVATE_STRIP_CMD)$(call cmd-trace-end,strip,$(PRIVATE_NAME))
+	$(hide) $(if $(PRIVATE_LINK_STATS),$(call cmd-link-stats,$(PRIVATE_DST),$(PRIVATE_LINK_STATS)))
 
 $(call generate-dir,$(NDK_APP_DST_DIR))
 $(LOCAL_INSTALLED): $(NDK_APP_DST_DIR)
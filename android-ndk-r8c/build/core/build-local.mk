@@ -37,8 +37,42 @@ ifneq ($(words $(NDK_ROOT)),1)
     $(error Aborting.)
 endif
 
+# init.mk saves a snapshot of the toolchain and platform definitions to
+# NDK_ENV_CACHE and reloads it on later invocations, unless
+# NDK_NO_ENV_CACHE is defined. The project path is not known yet, so
+# place it under NDK_OUT, or under the obj directory of NDK_PROJECT_PATH
+# or of the current directory if it is a project path (see below).
+# Otherwise, don't use a snapshot at all.
+#
+NDK_ENV_CACHE :=
+ifndef NDK_NO_ENV_CACHE
+    __ndk_env_cache_dir := $(strip $(NDK_OUT))
+    ifndef __ndk_env_cache_dir
+        ifneq (,$(filter-out null,$(strip $(NDK_PROJECT_PATH))))
+            __ndk_env_cache_dir := $(strip $(NDK_PROJECT_PATH))/obj
+        else
+            ifndef NDK_PROJECT_PATH
+                ifneq (,$(strip $(wildcard AndroidManifest.xml jni/Android.mk)))
+                    __ndk_env_cache_dir := ./obj
+                endif
+            endif
+        endif
+    endif
+    ifdef __ndk_env_cache_dir
+        NDK_ENV_CACHE := $(__ndk_env_cache_dir)/ndk-env.mk
+    endif
+endif
+
 include $(NDK_ROOT)/build/core/init.mk
 
+# The ndk-build script defines NDK_BUILD_TRACE_LOG when NDK_BUILD_TRACE
+# is used, see cmd-trace-start in definitions.mk
+ifdef NDK_BUILD_TRACE
+    ifndef NDK_BUILD_TRACE_LOG
+        $(call __ndk_info,WARNING: Ignoring NDK_BUILD_TRACE: Only supported by the ndk-build script)
+    endif
+endif
+
 # ====================================================================
 #
 # If NDK_PROJECT_PATH is not defined, find the application's project
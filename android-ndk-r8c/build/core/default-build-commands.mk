@@ -93,6 +93,14 @@ endef
 # when applied to static libraries or object files.
 cmd-strip = $(PRIVATE_STRIP) --strip-unneeded $(call host-path,$1)
 
+# Print the size and number of dynamic relocations of a binary, and their
+# change since the last time it was recorded in a stats file.
+# $1: binary
+# $2: stats file
+cmd-link-stats = $(PRIVATE_READELF) -r $(call host-path,$1) | \
+    $(HOST_AWK) -f $(BUILD_AWK)/link-stats.awk \
+        -v NAME=$(PRIVATE_NAME) -v SIZE=`wc -c < $(call host-path,$1)` -v STATS=$(call host-path,$2)
+
 TARGET_LIBGCC = $(shell $(TARGET_CC) -print-libgcc-file-name)
 TARGET_LDLIBS := -lc -lm
 
@@ -115,3 +123,63 @@ TARGET_AR       = $(TOOLCHAIN_PREFIX)ar
 TARGET_ARFLAGS := crs
 
 TARGET_STRIP    = $(TOOLCHAIN_PREFIX)strip
+
+TARGET_READELF  = $(TOOLCHAIN_PREFIX)readelf
+
+# Link-time optimization, used by modules when LOCAL_LTO or APP_LTO is 'true'.
+#
+# It requires the LTO linker plugin that comes with GCC 4.5 and higher, so
+# TARGET_LTO_PLUGIN is empty for toolchains that can't do it (e.g. GCC 4.4.3
+# or Clang), and the build system then ignores LTO requests.
+#
+# GCC 4.6 doesn't provide the gcc-ar wrapper, so the plugin is given to
+# the archiver directly in order to index the symbols of LTO objects.
+# Note that GCC 4.6 LTO objects also contain regular code, so that static
+# libraries built with LTO can still be linked by modules that don't use it.
+#
+TARGET_LTO_PLUGIN = $(firstword $(wildcard $(addprefix $(TOOLCHAIN_PREBUILT_ROOT)/libexec/gcc/$(patsubst %-,%,$(notdir $(TOOLCHAIN_PREFIX)))/$(TOOLCHAIN_VERSION)/,liblto_plugin.so liblto_plugin-0.dll)))
+
+TARGET_LTO_CFLAGS   := -flto
+TARGET_LTO_LDFLAGS  := -fuse-linker-plugin
+TARGET_LTO_ARFLAGS   = --plugin $(call host-path,$(TARGET_LTO_PLUGIN))
+
+# Profile-guided optimization, used by all modules when APP_PGO is
+# 'instrument' or 'use', see docs/APPLICATION-MK.html.
+#
+# The .gcda profile of each object is named after the object's path in the
+# build tree, relative to NDK_PGO_RUNTIME_DIR (where instrumented binaries
+# write it) or NDK_PGO_PROFILE_DIR (where optimized builds read it). Linking
+# with -fprofile-generate pulls the libgcov runtime.
+#
+# Profiles that don't match the sources anymore are reported as warnings
+# instead of errors, so that stale profiles don't break the build.
+#
+# A toolchain that can't do it defines TARGET_PGO_<mode>_CFLAGS as empty.
+#
+TARGET_PGO_instrument_CFLAGS   = -fprofile-generate=$(NDK_PGO_RUNTIME_DIR)
+TARGET_PGO_instrument_LDFLAGS := -fprofile-generate
+TARGET_PGO_use_CFLAGS          = -fprofile-use=$(call host-path,$(NDK_PGO_PROFILE_DIR)) \
+                                 -fprofile-correction \
+                                 -Wno-error=coverage-mismatch
+TARGET_PGO_use_LDFLAGS        :=
+
+# Linker-level optimizations, used by modules when LOCAL_LINK_OPTIMIZE or
+# APP_LINK_OPTIMIZE is 'true', see docs/APPLICATION-MK.html.
+#
+# Each function and data item is placed in its own section, so that the
+# unused ones are removed by --gc-sections. The sources are not compiled
+# with -fvisibility=hidden, because JNI functions and ANativeActivity_onCreate
+# are often not declared with JNIEXPORT: the version script of shared
+# libraries hides the other symbols instead.
+#
+# The Android dynamic linker only reads the SysV hash table, so the GNU
+# one is added to it instead of replacing it. A toolchain whose linker
+# doesn't support the GNU hash table leaves --hash-style out.
+#
+TARGET_LINK_OPTIMIZE_CFLAGS  := -ffunction-sections -fdata-sections
+TARGET_LINK_OPTIMIZE_LDFLAGS := -Wl,--gc-sections -Wl,-O1 -Wl,--hash-style=both
+
+# The symbols exported by the version script of shared libraries, in
+# addition to LOCAL_EXPORT_SYMBOLS. These are the JNI entry points, and
+# the one looked up by NativeActivity.
+TARGET_LINK_OPTIMIZE_EXPORTS := Java_* JNI_OnLoad JNI_OnUnload ANativeActivity_onCreate
@@ -47,6 +47,16 @@ space  := $(empty) $(empty)
 
 space4 := $(space)$(space)$(space)$(space)
 
+# -----------------------------------------------------------------------------
+# Macro    : newline
+# Returns  : a single newline
+# Usage    : $(newline)
+# -----------------------------------------------------------------------------
+define newline
+
+
+endef
+
 # -----------------------------------------------------------------------------
 # Function : last2
 # Arguments: a list
@@ -82,6 +92,21 @@ remove-duplicates = $(strip \
   )\
   $(__uniq_ret))
 
+# -----------------------------------------------------------------------------
+# Function : reverse-list
+# Arguments: a list
+# Returns  : the list in reverse order.
+# Usage    : $(call reverse-list, <LIST>)
+# Note     : This is equivalent to the 'reverse' function provided by GMSL,
+#            but non-recursive for the same reasons as remove-duplicates.
+# -----------------------------------------------------------------------------
+reverse-list = $(strip \
+  $(eval __reverse_ret :=) \
+  $(foreach __reverse_item,$1,\
+    $(eval __reverse_ret := $(__reverse_item) $(__reverse_ret))\
+  )\
+  $(__reverse_ret))
+
 # -----------------------------------------------------------------------------
 # Macro    : this-makefile
 # Returns  : the name of the current Makefile in the inclusion stack
@@ -281,12 +306,16 @@ generate-dir = $(eval $(call ev-generate-dir,$1))
 #            Introducing a dependency on the latter avoids calling mkdir -p
 #            for every one of them.
 #
+#            This is an order-only dependency, since the timestamp of the
+#            directory changes each time a file is created in it, and this
+#            must not force the other files to be rebuilt.
+#
 # -----------------------------------------------------------------------------
 
 define ev-generate-file-dir
 __ndk_file_dir := $(call parent-dir,$1)
 $$(call generate-dir,$$(__ndk_file_dir))
-$1: $$(__ndk_file_dir)
+$1: | $$(__ndk_file_dir)
 endef
 
 generate-file-dir = $(eval $(call ev-generate-file-dir,$1))
@@ -547,6 +576,16 @@ modules-LOCALS := \
     FILTER_ASM \
     CPP_FEATURES \
     SHORT_COMMANDS \
+    LTO \
+    UNITY_BUILD \
+    UNITY_BATCH_SIZE \
+    UNITY_EXCLUDE \
+    PCH \
+    LINK_OPTIMIZE \
+    EXPORT_SYMBOLS \
+
+# The exported LOCAL_EXPORT_XXXX variables, without the LOCAL_EXPORT_ prefix
+modules-EXPORTS := CFLAGS CPPFLAGS LDLIBS C_INCLUDES
 
 # The following are generated by the build scripts themselves
 
@@ -598,7 +637,9 @@ modules-clear = \
     $(eval __ndk_modules := $(empty_set)) \
     $(eval __ndk_top_modules := $(empty)) \
     $(eval __ndk_import_list := $(empty)) \
-    $(eval __ndk_import_depth := $(empty))
+    $(eval __ndk_import_depth := $(empty)) \
+    $(eval __ndk_export_modules := $(empty)) \
+    $(call modules-closure-reset)
 
 # -----------------------------------------------------------------------------
 # Function : modules-get-list
@@ -641,6 +682,9 @@ module-add = \
   $(foreach __local,$(modules-LOCALS),\
     $(eval __ndk_modules.$1.$(__local) := $(LOCAL_$(__local)))\
   )\
+  $(if $(strip $(foreach __export,$(modules-EXPORTS),$(LOCAL_EXPORT_$(__export)))),\
+    $(eval __ndk_export_modules += $1)\
+  )\
   $(call module-handle-c++-features,$1)
 
 
@@ -686,6 +730,18 @@ module-get-listed-export = $(strip \
         $(call module-get-export,$(__listed_module),$2)\
     ))
 
+# -----------------------------------------------------------------------------
+# Function : modules-filter-exporting
+# Arguments: 1: list of module names
+# Returns  : The modules of $1 that export at least one LOCAL_EXPORT_XXX
+#            variable, in the same order.
+# Usage    : $(call modules-filter-exporting,<module-list>)
+# Rationale: The set of exporting modules is recorded by module-add, so that
+#            the exports of a large closure can be merged without looking at
+#            every module in it.
+# -----------------------------------------------------------------------------
+modules-filter-exporting = $(filter $(__ndk_export_modules),$1)
+
 # -----------------------------------------------------------------------------
 # Function : modules-restore-locals
 # Arguments: 1: module name
@@ -752,9 +808,11 @@ module-add-depends-any = \
 # Used to recompute all dependencies once all module information has been recorded.
 #
 modules-compute-dependencies = \
+    $(call modules-closure-reset)\
     $(foreach __module,$(__ndk_modules),\
         $(call module-compute-depends,$(__module))\
-    )
+    )\
+    $(eval __ndk_closure_frozen := true)
 
 module-compute-depends = \
     $(call module-add-static-depends,$1,$(__ndk_modules.$1.STATIC_LIBRARIES))\
@@ -773,32 +831,193 @@ module-get-installed = $(__ndk_modules.$1.INSTALLED)
 module-get-all-dependencies = $(strip \
     $(call modules-get-closure,$1,depends))
 
-modules-get-closure = \
-    $(eval __closure_deps  := $(strip $(call strip-lib-prefix,$1))) \
-    $(eval __closure_wq    := $(__closure_deps)) \
+# -----------------------------------------------------------------------------
+# Function : modules-get-closure
+# Arguments: 1: list of module names
+#            2: name of the module field listing the dependencies of a module
+# Returns  : The modules of $1 and all the modules they depend on transitively,
+#            in topological order, i.e. each module appears before the ones it
+#            depends on. Otherwise, the order of $1 and of the dependencies
+#            of each module is kept as much as possible.
+# Usage    : $(call modules-get-closure,<list of module names>,<field>)
+# Rationale: Once modules-compute-dependencies has been called, the dependency
+#            graph doesn't change anymore, and the closure of each module is
+#            computed only once, and memoized in __ndk_closure.<field>.<module>.
+#            It is the module followed by the merged closures of its direct
+#            dependencies, see modules-closure-merge.
+#
+#            Before that, or if the graph has cycles, a depth-first search
+#            is performed instead, see modules-closure.
+# -----------------------------------------------------------------------------
+modules-get-closure = $(strip \
+    $(eval __closure_list  := $(strip $(call strip-lib-prefix,$1))) \
     $(eval __closure_field := $(strip $2)) \
-    $(call modules-closure)\
-    $(__closure_deps)
+    $(if $(__ndk_closure_frozen),\
+        $(call modules-closure-memoized),\
+        $(call modules-closure)\
+    )\
+    $(__closure_out))
+
+# Used internally by modules-get-closure
+# Computes the closure of __closure_list into __closure_out from the
+# memoized closures of its modules.
+#
+# The modules whose closure is missing are found first, in post-order, and
+# their closures are only computed once the search is done. Merging the
+# closures deep in the recursion would be slow, because each variable lookup
+# goes through the scope of every $(call) and $(foreach) being expanded.
+#
+# The module whose direct dependencies are __closure_list, if any, is recorded
+# in __ndk_closure_of.<field>.<dependencies joined with '/'>, so that the
+# closure of the list is the one of that module without its first word, e.g.
+# for LOCAL_STATIC_LIBRARIES in build-binary.mk.
+#
+modules-closure-memoized = \
+    $(eval __closure_cycle := $(empty)) \
+    $(eval __closure_keys  := $(empty)) \
+    $(eval __closure_todo  := $(empty)) \
+    $(foreach __closure_root,$(__closure_list),\
+        $(call modules-closure-memo,$(__closure_root))\
+    )\
+    $(if $(__closure_cycle),\
+        $(foreach __closure_key,$(__closure_keys),\
+            $(eval __ndk_closure_done.$(__closure_key) := $(empty))\
+        )\
+        $(call modules-closure),\
+        $(foreach __closure_mod,$(__closure_todo),\
+            $(eval __closure_deps := $(call strip-lib-prefix,$(__ndk_modules.$(__closure_mod).$(__closure_field))))\
+            $(eval __ndk_closure.$(__closure_field).$(__closure_mod) := $(__closure_mod) $(call modules-closure-merge,$(__closure_deps)))\
+            $(eval __closure_key := $(__closure_field).$(subst $(space),/,$(__closure_deps)))\
+            $(eval __ndk_closure_of.$(__closure_key) := $(__closure_mod))\
+            $(eval __ndk_closure_of_keys += $(__closure_key))\
+        )\
+        $(eval __closure_mod := $(__ndk_closure_of.$(__closure_field).$(subst $(space),/,$(__closure_list))))\
+        $(eval __closure_out := $(if $(__closure_mod),\
+            $(call rest,$(__ndk_closure.$(__closure_field).$(__closure_mod))),\
+            $(call modules-closure-merge,$(__closure_list))))\
+    )
+
+# Used internally by modules-closure-memoized
+# $1: module name
+# Appends $1 to __closure_todo after the modules it depends on, if its closure
+# is not memoized yet. If $1 is already being visited, there is a cycle in
+# the dependency graph, and all closures memoized since the start of the
+# current modules-get-closure call are forgotten.
+#
+modules-closure-memo = \
+    $(eval __closure_key := $(__closure_field).$1)\
+    $(if $(__ndk_closure_done.$(__closure_key)),,\
+        $(if $(__ndk_closure_busy.$(__closure_key)),\
+            $(eval __closure_cycle := true),\
+            $(eval __ndk_closure_busy.$(__closure_key) := true)\
+            $(foreach __closure_dep,$(call strip-lib-prefix,$(__ndk_modules.$1.$(__closure_field))),\
+                $(call modules-closure-memo,$(__closure_dep))\
+            )\
+            $(eval __closure_key := $(__closure_field).$1)\
+            $(eval __ndk_closure_done.$(__closure_key) := true)\
+            $(eval __ndk_closure_busy.$(__closure_key) := $(empty))\
+            $(eval __closure_todo += $1)\
+            $(eval __closure_keys += $(__closure_key))\
+            $(eval __ndk_closure_keys += $(__closure_key))\
+        )\
+    )
 
-# Used internally by modules-get-all-dependencies
-# Note the tricky use of conditional recursion to work around the fact that
-# the GNU Make language does not have any conditional looping construct
-# like 'while'.
+# Used internally by modules-closure-memoized
+# $1: list of module names, whose closure is memoized
+# Returns the concatenation of their closures, where only the last occurrence
+# of each module is kept. This is still in topological order, because if a
+# module appears in a closure, all the modules it depends on appear after it
+# in the same closure.
+#
+# Two closures are merged with a single filter-out. For more, filtering each
+# closure against the growing result would be quadratic, so the closures are
+# scanned from the last one, which is kept as is, and the modules found in a
+# closure are marked with a __ndk_closure_seen.<module> variable instead. The
+# marks are set to a stamp that is different for each merge, so they never
+# need to be cleared, and the modules are prefixed with their mark to let
+# filter-out drop the marked ones, then notdir remove the prefix.
+#
+modules-closure-merge = $(strip \
+    $(if $(word 3,$1),\
+        $(eval __ndk_closure_merges += x)\
+        $(eval __closure_stamp  := $(words $(__ndk_closure_merges)))\
+        $(eval __closure_mods   := $(call reverse-list,$1))\
+        $(eval __closure_merged := $(__ndk_closure.$(__closure_field).$(firstword $(__closure_mods))))\
+        $(call modules-closure-mark,$(__closure_merged))\
+        $(foreach __closure_mod,$(call rest,$(__closure_mods)),\
+            $(eval __closure_new := $(notdir $(filter-out $(__closure_stamp)/%,\
+                $(foreach __closure_dep,$(__ndk_closure.$(__closure_field).$(__closure_mod)),\
+                    $(__ndk_closure_seen.$(__closure_dep))/$(__closure_dep)))))\
+            $(call modules-closure-mark,$(__closure_new))\
+            $(eval __closure_merged := $(__closure_new) $(__closure_merged))\
+        )\
+        $(__closure_merged),\
+        $(if $(word 2,$1),\
+            $(filter-out $(__ndk_closure.$(__closure_field).$(word 2,$1)),\
+                $(__ndk_closure.$(__closure_field).$(firstword $1)))\
+            $(__ndk_closure.$(__closure_field).$(word 2,$1)),\
+            $(__ndk_closure.$(__closure_field).$(strip $1)))))
+
+# Used internally by modules-closure-merge
+# $1: list of module names
+# Marks the modules of $1 as seen by the current merge.
+#
+modules-closure-mark = \
+    $(eval $(foreach __closure_dep,$1,\
+        __ndk_closure_seen.$(__closure_dep) := $(__closure_stamp)$(newline)))
+
+# Used internally by modules-get-closure
+# Computes the closure of __closure_list into __closure_out, with a depth-first
+# search of the dependency graph. Visited modules are marked with a
+# __ndk_closure_mark.<module> variable instead of being searched in the result.
+#
+# Modules are visited in reverse order, and prepended to __closure_out once
+# all their dependencies have been, so that the result is the reverse of
+# a post-order traversal.
 #
 modules-closure = \
-    $(eval __closure_mod := $(call first,$(__closure_wq))) \
-    $(eval __closure_wq  := $(call rest,$(__closure_wq))) \
-    $(eval __closure_val := $(call strip-lib-prefix,$(__ndk_modules.$(__closure_mod).$(__closure_field)))) \
-    $(eval __closure_new := $(filter-out $(__closure_deps),$(__closure_val)))\
-    $(eval __closure_deps += $(__closure_new)) \
-    $(eval __closure_wq   := $(strip $(__closure_wq) $(__closure_new)))\
-    $(if $(__closure_wq),$(call modules-closure)) \
+    $(eval __closure_out    := $(empty)) \
+    $(eval __closure_marked := $(empty)) \
+    $(foreach __closure_root,$(call reverse-list,$(__closure_list)),\
+        $(call modules-closure-visit,$(__closure_root))\
+    )\
+    $(foreach __closure_mod,$(__closure_marked),\
+        $(eval __ndk_closure_mark.$(__closure_mod) := $(empty))\
+    )
+
+# Used internally by modules-closure
+# $1: module name
+modules-closure-visit = \
+    $(if $(__ndk_closure_mark.$1),,\
+        $(eval __ndk_closure_mark.$1 := true)\
+        $(eval __closure_marked += $1)\
+        $(foreach __closure_dep,$(call reverse-list,$(call strip-lib-prefix,$(__ndk_modules.$1.$(__closure_field)))),\
+            $(call modules-closure-visit,$(__closure_dep))\
+        )\
+        $(eval __closure_out := $1 $(__closure_out))\
+    )
+
+# Forget all memoized closures. Called whenever the dependency graph
+# may change.
+modules-closure-reset = \
+    $(foreach __closure_key,$(__ndk_closure_keys),\
+        $(eval __ndk_closure.$(__closure_key) := $(empty))\
+        $(eval __ndk_closure_done.$(__closure_key) := $(empty))\
+    )\
+    $(foreach __closure_key,$(__ndk_closure_of_keys),\
+        $(eval __ndk_closure_of.$(__closure_key) := $(empty))\
+    )\
+    $(eval __ndk_closure_keys := $(empty))\
+    $(eval __ndk_closure_of_keys := $(empty))\
+    $(eval __ndk_closure_frozen := $(empty))\
+    $(eval __cxxmodule := $(empty))
 
 # -----------------------------------------------------------------------------
 # Function : module-get-depends
 # Arguments: 1: list of module names
 #            2: local module type (e.g. SHARED_LIBRARIES)
-# Returns  : List all the <local-type> modules $1 depends on transitively.
+# Returns  : List all the <local-type> modules $1 depends on transitively,
+#            in topological order (see modules-get-closure).
 # Usage    : $(call module-get-depends,<list of module names>,<local-type>)
 # Rationale: This computes the closure of all local module dependencies starting from $1
 # -----------------------------------------------------------------------------
@@ -838,12 +1057,13 @@ module-get-c++-sources = \
 module-has-c++-sources = $(strip $(call module-get-c++-sources,$1))
 
 
-# Add C++ dependencies to any module that has C++ sources.
+# Add C++ dependencies to any module that has C++ sources, except the
+# C++ runtime libraries themselves when they are rebuilt from sources.
 # $1: list of C++ runtime static libraries (if any)
 # $2: list of C++ runtime shared libraries (if any)
 #
 modules-add-c++-dependencies = \
-    $(foreach __module,$(__ndk_modules),\
+    $(foreach __module,$(filter-out $1 $2,$(__ndk_modules)),\
         $(if $(call module-has-c++-sources,$(__module)),\
             $(call ndk_log,Module '$(__module)' has C++ sources)\
             $(call module-add-c++-deps,$(__module),$1,$2),\
@@ -914,9 +1134,15 @@ module-handle-c++-features = \
 # $1: module name
 # $2: list of features (e.g. 'rtti' or 'exceptions')
 #
+# This is called several times in a row for the same module, so the features
+# of the last module are kept in __cxxflags, until modules-closure-reset.
+#
 module-has-c++-features = $(strip \
-    $(eval __cxxdeps  := $(call module-get-all-dependencies,$1))\
-    $(eval __cxxflags := $(foreach __cxxdep,$(__cxxdeps),$(__ndk_modules.$(__cxxdep).CPP_FEATURES)))\
+    $(if $(filter $1,$(__cxxmodule)),,\
+        $(eval __cxxmodule := $1)\
+        $(eval __cxxdeps  := $(call module-get-all-dependencies,$1))\
+        $(eval __cxxflags := $(sort $(foreach __cxxdep,$(__cxxdeps),$(__ndk_modules.$(__cxxdep).CPP_FEATURES))))\
+    )\
     $(if $(filter $2,$(__cxxflags)),true,)\
     )
 
@@ -1288,7 +1514,8 @@ NDK_APP_VARS_REQUIRED :=
 NDK_APP_VARS_OPTIONAL := APP_OPTIM APP_CPPFLAGS APP_CFLAGS APP_CXXFLAGS \
                          APP_PLATFORM APP_BUILD_SCRIPT APP_ABI APP_MODULES \
                          APP_PROJECT_PATH APP_STL APP_SHORT_COMMANDS \
-                         APP_PIE
+                         APP_PIE APP_LTO APP_LTO_JOBS APP_PGO \
+                         APP_DEPS_DATABASE APP_LINK_OPTIMIZE
 
 # the list of all variables that may appear in an Application.mk file
 # or defined by the build scripts.
@@ -1341,6 +1568,26 @@ else
 hide = @
 endif
 
+# -----------------------------------------------------------------------------
+# Macro    : cmd-trace-start
+# Function : cmd-trace-end
+# Arguments: 1: event category (e.g. compile, link)
+#            2: event name (e.g. source file or binary name)
+# Usage    : $(hide) $(cmd-trace-start)<command>$(call cmd-trace-end,<category>,<name>)
+# Rationale: When ndk-build is called with NDK_BUILD_TRACE=<file>, it defines
+#            NDK_BUILD_TRACE_LOG and these record the start and end times of
+#            the command, its exit status, and the ABI and module it belongs
+#            to (from the PRIVATE_ABI and PRIVATE_MODULE target-specific
+#            variables) into it. The times are printed by the command in
+#            NDK_BUILD_TRACE_TIME, which ndk-build picks for the host.
+#            ndk-build converts the log into a Chrome trace when make exits.
+#            Both expand to nothing otherwise.
+# -----------------------------------------------------------------------------
+cmd-trace-start = $(if $(NDK_BUILD_TRACE_LOG),__ndk_trace_start=`$(NDK_BUILD_TRACE_TIME)`; )
+cmd-trace-end = $(if $(NDK_BUILD_TRACE_LOG),; __ndk_trace_status=$$?; \
+    echo "$$__ndk_trace_start `$(NDK_BUILD_TRACE_TIME)` $$__ndk_trace_status $1 $(PRIVATE_ABI) $(PRIVATE_MODULE) $2" >> $(NDK_BUILD_TRACE_LOG); \
+    exit $$__ndk_trace_status)
+
 # cmd-convert-deps
 #
 # On Cygwin, we need to convert the .d dependency file generated by
@@ -1380,12 +1627,14 @@ endif
 # _CC: 'compiler' command
 # _FLAGS: 'compiler' flags
 # _TEXT: Display text (e.g. "Compile++ thumb", must be EXACTLY 15 chars long)
+# _PCH: precompiled header stub used by the source, if any (see build-pch)
 #
 define ev-build-file
 $$(_OBJ): PRIVATE_SRC      := $$(_SRC)
 $$(_OBJ): PRIVATE_OBJ      := $$(_OBJ)
 $$(_OBJ): PRIVATE_DEPS     := $$(call host-path,$$(_OBJ).d)
 $$(_OBJ): PRIVATE_MODULE   := $$(LOCAL_MODULE)
+$$(_OBJ): PRIVATE_ABI      := $$(TARGET_ARCH_ABI)
 $$(_OBJ): PRIVATE_TEXT     := "$$(_TEXT)"
 $$(_OBJ): PRIVATE_CC       := $$(_CC)
 $$(_OBJ): PRIVATE_CFLAGS   := $$(_FLAGS)
@@ -1399,10 +1648,10 @@ endif
 
 $$(call generate-file-dir,$$(_OBJ))
 
-$$(_OBJ): $$(_SRC) $$(LOCAL_MAKEFILE) $$(NDK_APP_APPLICATION_MK) $$(NDK_DEPENDENCIES_CONVERTER)
+$$(_OBJ): $$(_SRC) $$(_PCH:%=%.gch) $$(LOCAL_MAKEFILE) $$(NDK_APP_APPLICATION_MK) $$(NDK_DEPENDENCIES_CONVERTER)
 	@$$(HOST_ECHO) "$$(PRIVATE_TEXT)  : $$(PRIVATE_MODULE) <= $$(notdir $$(PRIVATE_SRC))"
-	$$(hide) $$(PRIVATE_CC) -MMD -MP -MF $$(call convert-deps,$$(PRIVATE_DEPS)) $$(PRIVATE_CFLAGS) $$(call host-path,$$(PRIVATE_SRC)) -o $$(call host-path,$$(PRIVATE_OBJ)) \
-	$$(call cmd-convert-deps,$$(PRIVATE_DEPS))
+	$$(hide) $$(cmd-trace-start)$$(PRIVATE_CC) -MMD -MP -MF $$(call convert-deps,$$(PRIVATE_DEPS)) $$(PRIVATE_CFLAGS) $$(call host-path,$$(PRIVATE_SRC)) -o $$(call host-path,$$(PRIVATE_OBJ)) \
+	$$(call cmd-convert-deps,$$(PRIVATE_DEPS))$$(call cmd-trace-end,compile,$$(PRIVATE_SRC))
 endef
 
 # This assumes the same things than ev-build-file, but will handle
@@ -1464,9 +1713,10 @@ else
   $$(_OBJ_ASM_FILTERED): PRIVATE_DST    := $$(_OBJ_ASM_FILTERED)
   $$(_OBJ_ASM_FILTERED): PRIVATE_FILTER := $$(LOCAL_FILTER_ASM)
   $$(_OBJ_ASM_FILTERED): PRIVATE_MODULE := $$(LOCAL_MODULE)
+  $$(_OBJ_ASM_FILTERED): PRIVATE_ABI    := $$(TARGET_ARCH_ABI)
   $$(_OBJ_ASM_FILTERED): $$(_OBJ_ASM_ORIGINAL)
 	@$$(HOST_ECHO) "AsmFilter      : $$(PRIVATE_MODULE) <= $$(notdir $$(PRIVATE_SRC))"
-	$$(hide) $$(PRIVATE_FILTER) $$(PRIVATE_SRC) $$(PRIVATE_DST)
+	$$(hide) $$(cmd-trace-start)$$(PRIVATE_FILTER) $$(PRIVATE_SRC) $$(PRIVATE_DST)$$(call cmd-trace-end,asm-filter,$$(PRIVATE_SRC))
 
   # Then, generate the final object, we need to keep assembler-specific
   # flags which look like -Wa,<option>:
@@ -1488,7 +1738,7 @@ endef
 #             compile-s-source
 # -----------------------------------------------------------------------------
 define  ev-compile-c-source
-_SRC:=$$(LOCAL_PATH)/$(1)
+_SRC:=$$(call get-src-file-path,$(1))
 _OBJ:=$$(LOCAL_OBJS_DIR)/$(2)
 
 _FLAGS := $$($$(my)CFLAGS) \
@@ -1501,6 +1751,7 @@ _FLAGS := $$($$(my)CFLAGS) \
 
 _TEXT := "Compile $$(call get-src-file-text,$1)"
 _CC   := $$(NDK_CCACHE) $$(TARGET_CC)
+_PCH  :=
 
 $$(eval $$(call ev-build-source-file))
 endef
@@ -1536,19 +1787,10 @@ compile-s-source = $(eval $(call ev-compile-c-source,$1,$2))
 # -----------------------------------------------------------------------------
 
 define  ev-compile-cpp-source
-_SRC:=$$(LOCAL_PATH)/$(1)
+_SRC:=$$(call get-src-file-path,$(1))
 _OBJ:=$$(LOCAL_OBJS_DIR)/$(2)
-_FLAGS := $$($$(my)CXXFLAGS) \
-          $$(call get-src-file-target-cflags,$(1)) \
-          $$(call host-c-includes, $$(LOCAL_C_INCLUDES) $$(LOCAL_PATH)) \
-          $$(LOCAL_CFLAGS) \
-          $$(LOCAL_CPPFLAGS) \
-          $$(LOCAL_CXXFLAGS) \
-          $$(NDK_APP_CFLAGS) \
-          $$(NDK_APP_CPPFLAGS) \
-          $$(NDK_APP_CXXFLAGS) \
-          $$(call host-c-includes,$$($(my)C_INCLUDES)) \
-          -c \
+_PCH := $$(if $$(LOCAL_PCH),$$(LOCAL_PCH_HEADER.$(1)))
+_FLAGS := $$(if $$(_PCH),-include $$(call host-path,$$(_PCH)) )$$(call get-cpp-source-flags,$(1))
 
 _CC   := $$(NDK_CCACHE) $$($$(my)CXX)
 _TEXT := "Compile++ $$(call get-src-file-text,$1)"
@@ -1556,6 +1798,28 @@ _TEXT := "Compile++ $$(call get-src-file-text,$1)"
 $$(eval $$(call ev-build-source-file))
 endef
 
+# -----------------------------------------------------------------------------
+# Function  : get-cpp-source-flags
+# Arguments : 1: single C++ source file name (relative to LOCAL_PATH)
+# Returns   : The compiler flags used to compile the source file
+# Usage     : $(call get-cpp-source-flags,<srcfile>)
+# Rationale : Used by ev-compile-cpp-source and build-pch, since the
+#             precompiled headers must be built with the same flags as
+#             the sources that use them.
+# -----------------------------------------------------------------------------
+get-cpp-source-flags = \
+    $($(my)CXXFLAGS) \
+    $(call get-src-file-target-cflags,$1) \
+    $(call host-c-includes, $(LOCAL_C_INCLUDES) $(LOCAL_PATH)) \
+    $(LOCAL_CFLAGS) \
+    $(LOCAL_CPPFLAGS) \
+    $(LOCAL_CXXFLAGS) \
+    $(NDK_APP_CFLAGS) \
+    $(NDK_APP_CPPFLAGS) \
+    $(NDK_APP_CXXFLAGS) \
+    $(call host-c-includes,$($(my)C_INCLUDES)) \
+    -c
+
 # -----------------------------------------------------------------------------
 # Function  : compile-cpp-source
 # Arguments : 1: single C++ source file name (relative to LOCAL_PATH)
@@ -1566,6 +1830,145 @@ endef
 # -----------------------------------------------------------------------------
 compile-cpp-source = $(eval $(call ev-compile-cpp-source,$1,$2))
 
+# -----------------------------------------------------------------------------
+# Template  : ev-build-pch
+# Arguments : 1: precompiled header stub path
+#             2: C++ source file name (relative to LOCAL_PATH) whose flags
+#                are used
+# Returns   : None
+# Usage     : $(eval $(call ev-build-pch,<stub>,<srcfile>))
+# Rationale : Internal template evaluated by build-pch
+# -----------------------------------------------------------------------------
+define ev-build-pch
+$$(call generate-unity-source,$1,$$(LOCAL_PCH))
+
+_SRC   := $1
+_OBJ   := $1.gch
+_PCH   :=
+_FLAGS := $$(call get-cpp-source-flags,$2) -x c++-header
+_CC    := $$(NDK_CCACHE) $$($$(my)CXX)
+_TEXT  := "Precomp++ $$(call get-src-file-text,$2)"
+
+LOCAL_DEPENDENCY_DIRS += $$(dir $$(_OBJ))
+$$(eval $$(call ev-build-file))
+endef
+
+# -----------------------------------------------------------------------------
+# Function  : build-pch
+# Arguments : 1: precompiled header stub path
+#             2: C++ source file name (relative to LOCAL_PATH) whose flags
+#                are used
+# Returns   : None
+# Usage     : $(call build-pch,<stub>,<srcfile>)
+# Rationale : Setup everything required to precompile LOCAL_PCH for the
+#             C++ sources that have the same flags as <srcfile>. The stub
+#             is a generated header that includes LOCAL_PCH, and that is
+#             compiled to <stub>.gch. These sources are then compiled with
+#             '-include <stub>', which makes GCC use <stub>.gch instead,
+#             or fall back to the stub (and thus to LOCAL_PCH) if the
+#             precompiled header can't be used.
+# -----------------------------------------------------------------------------
+build-pch = $(eval $(call ev-build-pch,$1,$2))
+
+# -----------------------------------------------------------------------------
+# Function  : get-src-file-path
+# Arguments : 1: single source file name, as it appears in LOCAL_SRC_FILES
+# Returns   : The path of the source file. This is relative to LOCAL_PATH,
+#             except for the unity sources generated in LOCAL_UNITY_DIR.
+# Usage     : $(call get-src-file-path,<srcfile>)
+# -----------------------------------------------------------------------------
+get-src-file-path = $(if $(filter $1,$(LOCAL_UNITY_SOURCES)),$(LOCAL_UNITY_DIR),$(LOCAL_PATH))/$1
+
+# -----------------------------------------------------------------------------
+# Function  : split-words
+# Arguments : 1: list of words
+#             2: maximum number of words per slice (must be at least 1)
+# Returns   : The list of slices, where the words of each slice are
+#             separated by '|' instead of spaces.
+# Usage     : $(call split-words,<list>,<size>)
+# Example   : $(call split-words,a b c d e,2) => a|b c|d e
+# -----------------------------------------------------------------------------
+split-words = $(strip \
+    $(if $(strip $1),\
+        $(subst $(space),|,$(strip $(wordlist 1,$2,$1)))\
+        $(call split-words,$(wordlist $(words x $(wordlist 1,$2,$1)),$(words $1),$1),$2)\
+    ))
+
+# -----------------------------------------------------------------------------
+# Function  : generate-unity-source
+# Arguments : 1: unity source file path
+#             2: list of source files (relative to LOCAL_PATH) it includes
+# Returns   : None
+# Usage     : $(call generate-unity-source,<unity-file>,<srcfiles>)
+# Rationale : Generate a rule to write a source file that #includes all
+#             the ones given, so that they are compiled at once (a.k.a.
+#             unity or jumbo build). The file is only updated when its
+#             content changes, so that its object is not rebuilt
+#             needlessly.
+# -----------------------------------------------------------------------------
+ifeq ($(HOST_OS),windows)
+unity-include-line = $(HOST_ECHO) \#include "$1"
+else
+unity-include-line = $(HOST_ECHO) '\#include "$1"'
+endif
+
+define ev-generate-unity-source
+__unity_file := $1
+
+.PHONY: $$(__unity_file).tmp
+
+$$(call generate-file-dir,$$(__unity_file).tmp)
+
+$$(__unity_file).tmp: PRIVATE_INCLUDES := $$(call host-path,$$(abspath $$(addprefix $$(LOCAL_PATH)/,$2)))
+$$(__unity_file).tmp:
+	$$(hide) $$(HOST_ECHO_N) "" > $$@ $$(foreach __inc,$$(PRIVATE_INCLUDES),&& $$(call unity-include-line,$$(__inc)) >> $$@)
+
+$$(__unity_file): $$(__unity_file).tmp
+	$$(hide) $$(call copy-if-differ,$$@.tmp,$$@)
+	$$(hide) $$(call host-rm,$$@.tmp)
+endef
+
+generate-unity-source = $(eval $(call ev-generate-unity-source,$1,$2))
+
+# -----------------------------------------------------------------------------
+# Function  : generate-version-script
+# Arguments : 1: version script file path
+#             2: list of exported symbols, or symbol patterns
+# Returns   : None
+# Usage     : $(call generate-version-script,<script-file>,<symbols>)
+# Rationale : Generate a rule to write a linker version script that only
+#             exports the given symbols from a shared library, all the
+#             other ones becoming local. The file is only updated when its
+#             content changes, so that the library is not relinked
+#             needlessly.
+# -----------------------------------------------------------------------------
+ifeq ($(HOST_OS),windows)
+version-script-line = $(HOST_ECHO) $1
+else
+version-script-line = $(HOST_ECHO) '$1'
+endif
+
+define ev-generate-version-script
+__version_script := $1
+
+.PHONY: $$(__version_script).tmp
+
+$$(call generate-file-dir,$$(__version_script).tmp)
+
+$$(__version_script).tmp: PRIVATE_SYMBOLS := $2
+$$(__version_script).tmp:
+	$$(hide) $$(call version-script-line,{) > $$@
+	$$(hide) $$(call version-script-line,global:) >> $$@ $$(foreach __sym,$$(PRIVATE_SYMBOLS),&& $$(call version-script-line,$$(__sym);) >> $$@)
+	$$(hide) $$(call version-script-line,local: *;) >> $$@
+	$$(hide) $$(call version-script-line,};) >> $$@
+
+$$(__version_script): $$(__version_script).tmp
+	$$(hide) $$(call copy-if-differ,$$@.tmp,$$@)
+	$$(hide) $$(call host-rm,$$@.tmp)
+endef
+
+generate-version-script = $(eval $(call ev-generate-version-script,$1,$2))
+
 #
 #  Module imports
 #
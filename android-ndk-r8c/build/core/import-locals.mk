@@ -29,9 +29,12 @@ $(call assert-defined,LOCAL_MODULE)
 all_depends := $(call module-get-all-dependencies,$(LOCAL_MODULE))
 all_depends := $(filter-out $(LOCAL_MODULE),$(all_depends))
 
-imported_CFLAGS     := $(call module-get-listed-export,$(all_depends),CFLAGS)
-imported_CPPFLAGS   := $(call module-get-listed-export,$(all_depends),CPPFLAGS)
-imported_C_INCLUDES := $(call module-get-listed-export,$(all_depends),C_INCLUDES)
+# Only look at the modules that export something.
+export_depends := $(call modules-filter-exporting,$(all_depends))
+
+imported_CFLAGS     := $(call module-get-listed-export,$(export_depends),CFLAGS)
+imported_CPPFLAGS   := $(call module-get-listed-export,$(export_depends),CPPFLAGS)
+imported_C_INCLUDES := $(call module-get-listed-export,$(export_depends),C_INCLUDES)
 
 ifdef NDK_DEBUG_IMPORTS
     $(info Imports for module $(LOCAL_MODULE):)
@@ -58,7 +61,7 @@ LOCAL_C_INCLUDES := $(strip $(LOCAL_C_INCLUDES) $(imported_C_INCLUDES))
 # due to the way Unix linkers work (depending libraries must appear before
 # dependees on final link command).
 #
-imported_LDLIBS := $(call module-get-listed-export,$(all_depends),LDLIBS)
+imported_LDLIBS := $(call module-get-listed-export,$(export_depends),LDLIBS)
 
 LOCAL_LDLIBS := $(strip $(LOCAL_LDLIBS) $(imported_LDLIBS))
 
@@ -303,7 +303,83 @@ $(call ndk_log,Host 'awk' tool: $(HOST_AWK))
 # Location of all awk scripts we use
 BUILD_AWK := $(NDK_ROOT)/build/awk
 
-AWK_TEST := $(shell $(HOST_AWK) -f $(BUILD_AWK)/check-awk.awk)
+# ====================================================================
+#
+# Environment snapshot.
+#
+# Probing the 'awk' tool and reading all toolchain and platform
+# definitions below is done on every invocation. If NDK_ENV_CACHE is
+# defined (see build-local.mk), the results are saved to this file, and
+# reloaded by later invocations instead of being computed again.
+#
+# Loading the snapshot doesn't run any program:
+#
+# - Its content is guarded by a key made of the NDK installation path,
+#   host tag, host 'awk' tool, and the toolchain and platform files
+#   found with $(wildcard ...). A snapshot with another key defines
+#   nothing, and is overwritten below.
+#
+# - It is also a makefile target that depends on the files it was
+#   computed from. If one of them is newer, GNU Make deletes it and
+#   restarts, and it is saved again from scratch.
+#
+# Define NDK_NO_ENV_CACHE to disable this completely.
+#
+# ====================================================================
+
+# The list of variables saved to the snapshot, as patterns
+NDK_ENV_CACHE_VARS := \
+    AWK_TEST \
+    TOOLCHAIN_CONFIGS \
+    NDK_ALL_TOOLCHAINS \
+    NDK_ALL_ABIS \
+    NDK_HOST_ABIS \
+    NDK_ALL_ARCHS \
+    NDK_TOOLCHAIN.% \
+    NDK_ABI.% \
+    NDK_ARCH.% \
+    NDK_PLATFORMS_ROOT \
+    NDK_ALL_PLATFORMS \
+    NDK_PLATFORM_%_ABIS \
+    NDK_PLATFORM_%_SYSROOT \
+    NDK_ALL_PLATFORM_LEVELS \
+    NDK_MAX_PLATFORM_LEVEL
+
+# Saving the snapshot requires a Posix shell.
+ifeq ($(HOST_OS),windows)
+    NDK_ENV_CACHE :=
+endif
+ifdef NDK_NO_ENV_CACHE
+    NDK_ENV_CACHE :=
+endif
+NDK_ENV_CACHE := $(strip $(NDK_ENV_CACHE))
+
+__ndk_env_cached :=
+ifdef NDK_ENV_CACHE
+    # Increment the first item when changing the format or the content of
+    # the snapshot. Note that NDK_PLATFORMS_ROOT is the value provided by
+    # the user, if any.
+    __ndk_env_cache_platforms := $(strip $(NDK_PLATFORMS_ROOT))
+    ifndef __ndk_env_cache_platforms
+        __ndk_env_cache_platforms := $(NDK_ROOT)/platforms $(NDK_ROOT)/build/platforms
+    endif
+    __ndk_env_cache_key := $(strip 1 $(NDK_ROOT) $(HOST_TAG) $(HOST_AWK) $(NDK_PLATFORMS_ROOT) \
+        $(wildcard $(NDK_ROOT)/toolchains/*/config.mk $(NDK_ROOT)/toolchains/*/setup.mk) \
+        $(wildcard $(addsuffix /android-*/arch-*,$(__ndk_env_cache_platforms))))
+
+    ifneq (,$(wildcard $(NDK_ENV_CACHE)))
+        include $(NDK_ENV_CACHE)
+    endif
+    ifdef __ndk_env_cached
+        $(call ndk_log,Using environment snapshot: $(NDK_ENV_CACHE))
+    else
+        $(call ndk_log,Ignoring missing or outdated environment snapshot: $(NDK_ENV_CACHE))
+    endif
+endif
+
+ifndef __ndk_env_cached
+    AWK_TEST := $(shell $(HOST_AWK) -f $(BUILD_AWK)/check-awk.awk)
+endif
 $(call ndk_log,Host 'awk' test returned: $(AWK_TEST))
 ifneq ($(AWK_TEST),Pass)
     $(call __ndk_info,Host 'awk' tool is outdated. Please define HOST_AWK to point to Gawk or Nawk !)
@@ -391,6 +467,9 @@ include $(BUILD_SYSTEM)/definitions.mk
 # the build script to include in each toolchain config.mk
 ADD_TOOLCHAIN := $(BUILD_SYSTEM)/add-toolchain.mk
 
+# This is loaded from the environment snapshot, if any.
+ifndef __ndk_env_cached
+
 # the list of all toolchains in this NDK
 NDK_ALL_TOOLCHAINS :=
 NDK_ALL_ABIS       :=
@@ -405,8 +484,16 @@ NDK_ALL_TOOLCHAINS   := $(sort $(NDK_ALL_TOOLCHAINS))
 NDK_ALL_ABIS         := $(sort $(NDK_ALL_ABIS))
 NDK_ALL_ARCHS        := $(sort $(NDK_ALL_ARCHS))
 
+# The host pseudo-ABIs (see toolchains/host-gcc) are only built when listed
+# explicitly in APP_ABI, so they are not part of NDK_ALL_ABIS, which is used
+# for APP_ABI=all.
+NDK_HOST_ABIS        := $(filter host-%,$(NDK_ALL_ABIS))
+NDK_ALL_ABIS         := $(filter-out $(NDK_HOST_ABIS),$(NDK_ALL_ABIS))
+
+endif # !__ndk_env_cached
+
 # Check that each ABI has a single architecture definition
-$(foreach _abi,$(strip $(NDK_ALL_ABIS)),\
+$(foreach _abi,$(strip $(NDK_ALL_ABIS) $(NDK_HOST_ABIS)),\
   $(if $(filter-out 1,$(words $(NDK_ABI.$(_abi).arch))),\
     $(call __ndk_info,INTERNAL ERROR: The $(_abi) ABI should have exactly one architecture definitions. Found: '$(NDK_ABI.$(_abi).arch)')\
     $(call __ndk_error,Aborting...)\
@@ -465,6 +552,9 @@ $(foreach tc,$(NDK_ALL_TOOLCHAINS),\
 #
 # ====================================================================
 
+# This is loaded from the environment snapshot, if any.
+ifndef __ndk_env_cached
+
 # The platform files were moved in the Android source tree from
 # $TOP/ndk/build/platforms to $TOP/development/ndk/platforms. However,
 # the official NDK release packages still place them under the old
@@ -512,5 +602,67 @@ NDK_MAX_PLATFORM_LEVEL := 3
 $(foreach level,$(NDK_ALL_PLATFORM_LEVELS),\
   $(eval NDK_MAX_PLATFORM_LEVEL := $$(call max,$$(NDK_MAX_PLATFORM_LEVEL),$$(level)))\
 )
+endif # !__ndk_env_cached
 $(call ndk_log,Found max platform level: $(NDK_MAX_PLATFORM_LEVEL))
 
+
+# ====================================================================
+#
+# Save or check the environment snapshot, see the comments about it
+# above.
+#
+# ====================================================================
+
+ifdef NDK_ENV_CACHE
+
+# The files the snapshot is computed from, besides the ones listed in
+# its key.
+__ndk_env_cache_deps := \
+    $(BUILD_SYSTEM)/init.mk \
+    $(BUILD_SYSTEM)/add-toolchain.mk \
+    $(BUILD_SYSTEM)/add-platform.mk \
+    $(BUILD_AWK)/check-awk.awk \
+    $(TOOLCHAIN_CONFIGS)
+
+ifdef __ndk_env_cached
+
+# GNU Make checks this rule before building anything, because the
+# snapshot is an included makefile, so this only costs a few stat()
+# calls. Don't let it become the default goal.
+__ndk_env_cache_goal := $(.DEFAULT_GOAL)
+$(NDK_ENV_CACHE): $(__ndk_env_cache_deps)
+	$(call ndk_log,Removing outdated environment snapshot: $@)
+	$(hide) $(call host-rm,$@)
+.DEFAULT_GOAL := $(__ndk_env_cache_goal)
+
+else # !__ndk_env_cached
+
+# $1: variable name
+# Returns a Makefile line defining the variable to its current value.
+ndk-env-cache-var = $1 := $(subst $$,$$$$,$($1))
+
+# $1: Makefile line
+# Returns the line quoted for the shell.
+ndk-env-cache-quote = '$(subst ','\'',$1)'
+
+__ndk_env_cache_lines := \
+    '\# Environment snapshot generated by build/core/init.mk, do not edit.' \
+    $(call ndk-env-cache-quote,__ndk_env_cache_file_key := $(__ndk_env_cache_key)) \
+    'ifeq ($$(__ndk_env_cache_key),$$(__ndk_env_cache_file_key))' \
+    '__ndk_env_cached := true' \
+    $(foreach __var,$(sort $(filter $(NDK_ENV_CACHE_VARS),$(.VARIABLES))),\
+        $(call ndk-env-cache-quote,$(call ndk-env-cache-var,$(__var)))) \
+    'endif'
+
+$(call ndk_log,Saving environment snapshot: $(NDK_ENV_CACHE))
+__ndk_env_cache_error := $(shell \
+    mkdir -p $(dir $(NDK_ENV_CACHE)) && \
+    printf '%s\n' $(__ndk_env_cache_lines) > $(NDK_ENV_CACHE).$$$$ && \
+    mv -f $(NDK_ENV_CACHE).$$$$ $(NDK_ENV_CACHE) || echo failed)
+ifdef __ndk_env_cache_error
+    $(call __ndk_info,Could not save environment snapshot to $(NDK_ENV_CACHE))
+endif
+
+endif # !__ndk_env_cached
+endif # NDK_ENV_CACHE
+
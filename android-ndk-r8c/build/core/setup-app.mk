@@ -51,12 +51,13 @@ endif
 
 # If APP_ABI is 'all', then set it to all supported ABIs
 # Otherwise, check that we don't have an invalid value here.
+# The host pseudo-ABIs must be listed explicitly.
 #
 ifeq ($(NDK_APP_ABI),all)
     NDK_APP_ABI := $(NDK_ALL_ABIS)
 else
     # check the target ABIs for this application
-    _bad_abis = $(strip $(filter-out $(NDK_ALL_ABIS),$(NDK_APP_ABI)))
+    _bad_abis = $(strip $(filter-out $(NDK_ALL_ABIS) $(NDK_HOST_ABIS),$(NDK_APP_ABI)))
     ifneq ($(_bad_abis),)
         $(call __ndk_info,NDK Application '$(_app)' targets unknown ABI(s): $(_bad_abis))
         $(call __ndk_info,Please fix the APP_ABI definition in $(NDK_APP_APPLICATION_MK))
@@ -73,6 +74,7 @@ ifeq ($(NDK_APP.$(_app).cleaned_binaries),)
     NDK_APP.$(_app).cleaned_binaries := true
     clean-installed-binaries::
 	$(hide) $(call host-rm,$(NDK_ALL_ABIS:%=$(NDK_APP_PROJECT_PATH)/libs/%/lib*.so))
+	$(hide) $(call host-rm,$(NDK_HOST_ABIS:%=$(NDK_APP_PROJECT_PATH)/libs/%/lib*.so))
 	$(hide) $(call host-rm,$(NDK_ALL_ABIS:%=$(NDK_APP_PROJECT_PATH)/libs/%/gdbserver))
 	$(hide) $(call host-rm,$(NDK_ALL_ABIS:%=$(NDK_APP_PROJECT_PATH)/libs/%/gdb.setup))
 endif
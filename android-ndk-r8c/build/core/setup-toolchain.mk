@@ -48,9 +48,10 @@ ifndef NDK_TOOLCHAIN
     TARGET_TOOLCHAIN := $(lastword $(TARGET_TOOLCHAIN_LIST))
 
     # If NDK_TOOLCHAIN_VERSION is defined, we replace the toolchain version
-    # suffix with it.
+    # suffix with it. This doesn't apply to the host pseudo-ABIs, which
+    # only have one toolchain.
     #
-    ifdef NDK_TOOLCHAIN_VERSION
+    ifneq (,$(and $(NDK_TOOLCHAIN_VERSION),$(filter-out host,$(TARGET_ARCH))))
         # We assume the toolchain name uses dashes (-) as separators and doesn't
         # contain any space. The following is a bit subtle, but essentially
         # does the following:
@@ -127,7 +128,13 @@ include $(BUILD_SYSTEM)/default-build-commands.mk
 include $(NDK_TOOLCHAIN.$(TARGET_TOOLCHAIN).setup)
 
 # We expect the gdbserver binary for this toolchain to be located at its root.
+# There is none for the host pseudo-ABIs, whose binaries are debugged with
+# the host's gdb directly.
+ifeq ($(TARGET_ARCH),host)
+TARGET_GDBSERVER :=
+else
 TARGET_GDBSERVER := $(NDK_ROOT)/prebuilt/android-$(TARGET_ARCH)/gdbserver/gdbserver
+endif
 
 # compute NDK_APP_DST_DIR as the destination directory for the generated files
 NDK_APP_DST_DIR := $(NDK_APP_PROJECT_PATH)/libs/$(TARGET_ARCH_ABI)
@@ -141,18 +148,21 @@ NDK_APP_GDBSERVER := $(NDK_APP_DST_DIR)/gdbserver
 NDK_APP_GDBSETUP := $(NDK_APP_DST_DIR)/gdb.setup
 
 ifeq ($(NDK_APP_DEBUGGABLE),true)
+ifdef TARGET_GDBSERVER
 
 installed_modules: $(NDK_APP_GDBSERVER)
 
 $(NDK_APP_GDBSERVER): PRIVATE_NAME    := $(TOOLCHAIN_NAME)
 $(NDK_APP_GDBSERVER): PRIVATE_SRC     := $(TARGET_GDBSERVER)
 $(NDK_APP_GDBSERVER): PRIVATE_DST     := $(NDK_APP_GDBSERVER)
+$(NDK_APP_GDBSERVER): PRIVATE_MODULE  := gdbserver
+$(NDK_APP_GDBSERVER): PRIVATE_ABI     := $(TARGET_ARCH_ABI)
 
 $(call generate-file-dir,$(NDK_APP_GDBSERVER))
 
 $(NDK_APP_GDBSERVER): clean-installed-binaries
 	@ $(HOST_ECHO) "Gdbserver      : [$(PRIVATE_NAME)] $(call pretty-dir,$(PRIVATE_DST))"
-	$(hide) $(call host-install,$(PRIVATE_SRC),$(PRIVATE_DST))
+	$(hide) $(cmd-trace-start)$(call host-install,$(PRIVATE_SRC),$(PRIVATE_DST))$(call cmd-trace-end,install,gdbserver)
 
 installed_modules: $(NDK_APP_GDBSETUP)
 
@@ -169,6 +179,7 @@ $(call generate-file-dir,$(NDK_APP_GDBSETUP))
 
 # This prevents parallel execution to clear gdb.setup after it has been written to
 $(NDK_APP_GDBSETUP): clean-installed-binaries
+endif # TARGET_GDBSERVER
 endif
 
 # free the dictionary of LOCAL_MODULE definitions
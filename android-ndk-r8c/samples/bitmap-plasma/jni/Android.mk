@@ -5,5 +5,8 @@ include $(CLEAR_VARS)
 LOCAL_MODULE    := plasma
 LOCAL_SRC_FILES := plasma.c
 LOCAL_LDLIBS    := -lm -llog -ljnigraphics
+LOCAL_STATIC_LIBRARIES := plasma_kernel
 
 include $(BUILD_SHARED_LIBRARY)
+
+$(call import-module,android/plasma_kernel)
@@ -1,3 +1,4 @@
-# The ARMv7 is significanly faster due to the use of the hardware FPU
+# The ARMv7 is significanly faster due to the use of NEON, when the CPU
+# supports it.
 APP_ABI := armeabi armeabi-v7a
 APP_PLATFORM := android-8
@@ -6,15 +6,13 @@ LOCAL_MODULE := helloneon
 
 LOCAL_SRC_FILES := helloneon.c
 
-ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
-    LOCAL_CFLAGS := -DHAVE_NEON=1
-    LOCAL_SRC_FILES += helloneon-intrinsics.c.neon
-endif
-
-LOCAL_STATIC_LIBRARIES := cpufeatures
+# The NEON FIR filter is in the dsp library, which is only built with NEON
+# support for armeabi-v7a.
+LOCAL_STATIC_LIBRARIES := dsp cpufeatures
 
 LOCAL_LDLIBS := -llog
 
 include $(BUILD_SHARED_LIBRARY)
 
-$(call import-module,cpufeatures)
+$(call import-module,android/dsp)
+$(call import-module,android/cpufeatures)
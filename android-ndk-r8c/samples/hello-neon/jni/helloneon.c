@@ -19,7 +19,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <cpu-features.h>
-#include "helloneon-intrinsics.h"
+#include <dsp.h>
 
 #define DEBUG 0
 
@@ -40,22 +40,6 @@ now_ms(void)
 }
 
 
-/* this is a FIR filter implemented in C */
-static void
-fir_filter_c(short *output, const short* input, const short* kernel, int width, int kernelSize)
-{
-    int  offset = -kernelSize/2;
-    int  nn;
-    for (nn = 0; nn < width; nn++) {
-        int sum = 0;
-        int mm;
-        for (mm = 0; mm < kernelSize; mm++) {
-            sum += kernel[mm]*input[nn+offset+mm];
-        }
-        output[nn] = (short)((sum + 0x8000) >> 16);
-    }
-}
-
 #define  FIR_KERNEL_SIZE   32
 #define  FIR_OUTPUT_SIZE   2560
 #define  FIR_INPUT_SIZE    (FIR_OUTPUT_SIZE + FIR_KERNEL_SIZE)
@@ -83,8 +67,8 @@ Java_com_example_neon_HelloNeon_stringFromJNI( JNIEnv* env,
     char*  str;
     uint64_t features;
     char buffer[512];
-    char tryNeon = 0;
-    double  t0, t1, time_c, time_neon;
+    int impl;
+    double  t0, t1, time_c, time_simd;
 
     /* setup FIR input - whatever */
     {
@@ -92,7 +76,8 @@ Java_com_example_neon_HelloNeon_stringFromJNI( JNIEnv* env,
         for (nn = 0; nn < FIR_INPUT_SIZE; nn++) {
             fir_input_0[nn] = (5*nn) & 255;
         }
-        fir_filter_c(fir_output_expected, fir_input, fir_kernel, FIR_OUTPUT_SIZE, FIR_KERNEL_SIZE);
+        dsp_set_impl(DSP_IMPL_SCALAR);
+        dsp_fir_s16(fir_output_expected, fir_input, fir_kernel, FIR_OUTPUT_SIZE, FIR_KERNEL_SIZE);
     }
 
     /* Benchmark small FIR filter loop - C version */
@@ -100,7 +85,7 @@ Java_com_example_neon_HelloNeon_stringFromJNI( JNIEnv* env,
     {
         int  count = FIR_ITERATIONS;
         for (; count > 0; count--) {
-            fir_filter_c(fir_output, fir_input, fir_kernel, FIR_OUTPUT_SIZE, FIR_KERNEL_SIZE);
+            dsp_fir_s16(fir_output, fir_input, fir_kernel, FIR_OUTPUT_SIZE, FIR_KERNEL_SIZE);
         }
     }
     t1 = now_ms();
@@ -110,37 +95,38 @@ Java_com_example_neon_HelloNeon_stringFromJNI( JNIEnv* env,
     strlcpy(buffer, str, sizeof buffer);
     free(str);
 
-    strlcat(buffer, "Neon version   : ", sizeof buffer);
-
-    if (android_getCpuFamily() != ANDROID_CPU_FAMILY_ARM) {
-        strlcat(buffer, "Not an ARM CPU !\n", sizeof buffer);
-        goto EXIT;
-    }
-
-    features = android_getCpuFeatures();
-    if ((features & ANDROID_CPU_ARM_FEATURE_ARMv7) == 0) {
-        strlcat(buffer, "Not an ARMv7 CPU !\n", sizeof buffer);
-        goto EXIT;
-    }
-
-    /* HAVE_NEON is defined in Android.mk ! */
-#ifdef HAVE_NEON
-    if ((features & ANDROID_CPU_ARM_FEATURE_NEON) == 0) {
-        strlcat(buffer, "CPU doesn't support NEON !\n", sizeof buffer);
+    /* The dsp library selects the NEON implementation on ARMv7 CPUs that
+     * support it, and the SSE2 one on x86 CPUs.
+     */
+    dsp_set_impl(DSP_IMPL_AUTO);
+    impl = dsp_get_impl();
+    if (impl == DSP_IMPL_SCALAR) {
+        strlcat(buffer, "Neon version   : ", sizeof buffer);
+        features = android_getCpuFeatures();
+        if (android_getCpuFamily() != ANDROID_CPU_FAMILY_ARM) {
+            strlcat(buffer, "Not an ARM CPU !\n", sizeof buffer);
+        } else if ((features & ANDROID_CPU_ARM_FEATURE_ARMv7) == 0) {
+            strlcat(buffer, "Not an ARMv7 CPU !\n", sizeof buffer);
+        } else if ((features & ANDROID_CPU_ARM_FEATURE_NEON) == 0) {
+            strlcat(buffer, "CPU doesn't support NEON !\n", sizeof buffer);
+        } else {
+            strlcat(buffer, "Program not compiled with ARMv7 support !\n", sizeof buffer);
+        }
         goto EXIT;
     }
 
-    /* Benchmark small FIR filter loop - Neon version */
+    /* Benchmark small FIR filter loop - SIMD version */
     t0 = now_ms();
     {
         int  count = FIR_ITERATIONS;
         for (; count > 0; count--) {
-            fir_filter_neon_intrinsics(fir_output, fir_input, fir_kernel, FIR_OUTPUT_SIZE, FIR_KERNEL_SIZE);
+            dsp_fir_s16(fir_output, fir_input, fir_kernel, FIR_OUTPUT_SIZE, FIR_KERNEL_SIZE);
         }
     }
     t1 = now_ms();
-    time_neon = t1 - t0;
-    asprintf(&str, "%g ms (x%g faster)\n", time_neon, time_c / (time_neon < 1e-6 ? 1. : time_neon));
+    time_simd = t1 - t0;
+    asprintf(&str, "%s version   : %g ms (x%g faster)\n", impl == DSP_IMPL_NEON ? "Neon" : "SSE2",
+             time_simd, time_c / (time_simd < 1e-6 ? 1. : time_simd));
     strlcat(buffer, str, sizeof buffer);
     free(str);
 
@@ -150,14 +136,11 @@ Java_com_example_neon_HelloNeon_stringFromJNI( JNIEnv* env,
         for (nn = 0; nn < FIR_OUTPUT_SIZE; nn++) {
             if (fir_output[nn] != fir_output_expected[nn]) {
                 if (++fails < 16)
-                    D("neon[%d] = %d expected %d", nn, fir_output[nn], fir_output_expected[nn]);
+                    D("%s[%d] = %d expected %d", dsp_impl_name(impl), nn, fir_output[nn], fir_output_expected[nn]);
             }
         }
         D("%d fails\n", fails);
     }
-#else /* !HAVE_NEON */
-    strlcat(buffer, "Program not compiled with ARMv7 support !\n", sizeof buffer);
-#endif /* !HAVE_NEON */
 EXIT:
     return (*env)->NewStringUTF(env, buffer);
 }
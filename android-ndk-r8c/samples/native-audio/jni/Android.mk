@@ -24,5 +24,9 @@ LOCAL_LDLIBS    += -lOpenSLES
 LOCAL_LDLIBS    += -llog
 # for native asset manager
 LOCAL_LDLIBS    += -landroid
+# for the mixer of the buffer queue player
+LOCAL_STATIC_LIBRARIES := audio_engine
 
 include $(BUILD_SHARED_LIBRARY)
+
+$(call import-module,android/audio_engine)
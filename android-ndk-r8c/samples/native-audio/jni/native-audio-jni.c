@@ -26,7 +26,7 @@
 #include <string.h>
 
 // for __android_log_print(ANDROID_LOG_INFO, "YourApp", "formatted message");
-// #include <android/log.h>
+#include <android/log.h>
 
 // for native audio
 #include <SLES/OpenSLES.h>
@@ -37,6 +37,9 @@
 #include <android/asset_manager.h>
 #include <android/asset_manager_jni.h>
 
+// for the mixer of the buffer queue player
+#include "audio_engine.h"
+
 // pre-recorded sound clips, both are 8 kHz mono 16-bit signed little endian
 
 static const char hello[] =
@@ -96,10 +99,14 @@ static short recorderBuffer[RECORDER_FRAMES];
 static unsigned recorderSize = 0;
 static SLmilliHertz recorderSR;
 
-// pointer and size of the next player buffer to enqueue, and number of remaining buffers
-static short *nextBuffer;
-static unsigned nextSize;
-static int nextCount;
+// the buffer queue player plays the output of a mixer, which resamples the clips to its rate,
+// in short buffers so that a new clip starts playing within a few milliseconds
+#define PLAYER_RATE 16000
+#define PLAYER_FRAMES 160
+#define PLAYER_BUFFERS 2
+static AudioMixer *bqPlayerMixer;
+static short bqPlayerBuffers[PLAYER_BUFFERS][PLAYER_FRAMES];
+static unsigned bqPlayerNextBuffer;
 
 
 // synthesize a mono sawtooth wave and place it into a buffer (called automatically on load)
@@ -117,15 +124,16 @@ void bqPlayerCallback(SLAndroidSimpleBufferQueueItf bq, void *context)
 {
     assert(bq == bqPlayerBufferQueue);
     assert(NULL == context);
-    // for streaming playback, replace this test by logic to find and fill the next buffer
-    if (--nextCount > 0 && NULL != nextBuffer && 0 != nextSize) {
-        SLresult result;
-        // enqueue another buffer
-        result = (*bqPlayerBufferQueue)->Enqueue(bqPlayerBufferQueue, nextBuffer, nextSize);
-        // the most likely other result is SL_RESULT_BUFFER_INSUFFICIENT,
-        // which for this code example would indicate a programming error
-        assert(SL_RESULT_SUCCESS == result);
-    }
+    // mix the next buffer, which is silent when no clip is playing, so that the buffer queue
+    // never runs dry; the mixer never blocks, so this can't make the callback late
+    short *buffer = bqPlayerBuffers[bqPlayerNextBuffer];
+    bqPlayerNextBuffer = (bqPlayerNextBuffer + 1) % PLAYER_BUFFERS;
+    audio_mixer_render(bqPlayerMixer, buffer, PLAYER_FRAMES);
+    SLresult result;
+    result = (*bqPlayerBufferQueue)->Enqueue(bqPlayerBufferQueue, buffer, sizeof(bqPlayerBuffers[0]));
+    // the most likely other result is SL_RESULT_BUFFER_INSUFFICIENT,
+    // which for this code example would indicate a programming error
+    assert(SL_RESULT_SUCCESS == result);
 }
 
 
@@ -194,8 +202,9 @@ void Java_com_example_nativeaudio_NativeAudio_createBufferQueueAudioPlayer(JNIEn
     SLresult result;
 
     // configure audio source
-    SLDataLocator_AndroidSimpleBufferQueue loc_bufq = {SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE, 2};
-    SLDataFormat_PCM format_pcm = {SL_DATAFORMAT_PCM, 1, SL_SAMPLINGRATE_8,
+    SLDataLocator_AndroidSimpleBufferQueue loc_bufq = {SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE,
+        PLAYER_BUFFERS};
+    SLDataFormat_PCM format_pcm = {SL_DATAFORMAT_PCM, 1, SL_SAMPLINGRATE_16,
         SL_PCMSAMPLEFORMAT_FIXED_16, SL_PCMSAMPLEFORMAT_FIXED_16,
         SL_SPEAKER_FRONT_CENTER, SL_BYTEORDER_LITTLEENDIAN};
     SLDataSource audioSrc = {&loc_bufq, &format_pcm};
@@ -204,6 +213,10 @@ void Java_com_example_nativeaudio_NativeAudio_createBufferQueueAudioPlayer(JNIEn
     SLDataLocator_OutputMix loc_outmix = {SL_DATALOCATOR_OUTPUTMIX, outputMixObject};
     SLDataSink audioSnk = {&loc_outmix, NULL};
 
+    // create the mixer, with one voice for the clips
+    bqPlayerMixer = audio_mixer_create(1, 1, PLAYER_RATE);
+    assert(NULL != bqPlayerMixer);
+
     // create audio player
     const SLInterfaceID ids[3] = {SL_IID_BUFFERQUEUE, SL_IID_EFFECTSEND,
             /*SL_IID_MUTESOLO,*/ SL_IID_VOLUME};
@@ -245,6 +258,12 @@ void Java_com_example_nativeaudio_NativeAudio_createBufferQueueAudioPlayer(JNIEn
     result = (*bqPlayerObject)->GetInterface(bqPlayerObject, SL_IID_VOLUME, &bqPlayerVolume);
     assert(SL_RESULT_SUCCESS == result);
 
+    // fill the buffer queue with silence, after which the callback keeps it full
+    unsigned i;
+    for (i = 0; i < PLAYER_BUFFERS; ++i) {
+        bqPlayerCallback(bqPlayerBufferQueue, NULL);
+    }
+
     // set the player's state to playing
     result = (*bqPlayerPlay)->SetPlayState(bqPlayerPlay, SL_PLAYSTATE_PLAYING);
     assert(SL_RESULT_SUCCESS == result);
@@ -487,51 +506,41 @@ jboolean Java_com_example_nativeaudio_NativeAudio_enableReverb(JNIEnv* env, jcla
 jboolean Java_com_example_nativeaudio_NativeAudio_selectClip(JNIEnv* env, jclass clazz, jint which,
         jint count)
 {
-    short *oldBuffer = nextBuffer;
+    const short *clip;
+    unsigned size;
+    int sampleRate = 8000;
     switch (which) {
-    case 0:     // CLIP_NONE
-        nextBuffer = (short *) NULL;
-        nextSize = 0;
-        break;
     case 1:     // CLIP_HELLO
-        nextBuffer = (short *) hello;
-        nextSize = sizeof(hello);
+        clip = (const short *) hello;
+        size = sizeof(hello);
         break;
     case 2:     // CLIP_ANDROID
-        nextBuffer = (short *) android;
-        nextSize = sizeof(android);
+        clip = (const short *) android;
+        size = sizeof(android);
         break;
     case 3:     // CLIP_SAWTOOTH
-        nextBuffer = sawtoothBuffer;
-        nextSize = sizeof(sawtoothBuffer);
+        clip = sawtoothBuffer;
+        size = sizeof(sawtoothBuffer);
         break;
     case 4:     // CLIP_PLAYBACK
-        // we recorded at 16 kHz, but are playing buffers at 8 Khz, so do a primitive down-sample
-        if (recorderSR == SL_SAMPLINGRATE_16) {
-            unsigned i;
-            for (i = 0; i < recorderSize; i += 2 * sizeof(short)) {
-                recorderBuffer[i >> 2] = recorderBuffer[i >> 1];
-            }
-            recorderSR = SL_SAMPLINGRATE_8;
-            recorderSize >>= 1;
-        }
-        nextBuffer = recorderBuffer;
-        nextSize = recorderSize;
+        // the mixer resamples the recording from its own rate
+        clip = recorderBuffer;
+        size = recorderSize;
+        sampleRate = recorderSR / 1000;
         break;
-    default:
-        nextBuffer = NULL;
-        nextSize = 0;
+    default:    // CLIP_NONE
+        clip = NULL;
+        size = 0;
         break;
     }
-    nextCount = count;
-    if (nextSize > 0) {
-        // here we only enqueue one buffer because it is a long clip,
-        // but for streaming playback we would typically enqueue at least 2 buffers to start
-        SLresult result;
-        result = (*bqPlayerBufferQueue)->Enqueue(bqPlayerBufferQueue, nextBuffer, nextSize);
-        if (SL_RESULT_SUCCESS != result) {
-            return JNI_FALSE;
-        }
+    // the new clip replaces the one playing, when the next buffer is mixed
+    if (size == 0) {
+        audio_mixer_stop(bqPlayerMixer, 0);
+        return JNI_TRUE;
+    }
+    if (audio_mixer_play_clip(bqPlayerMixer, 0, clip, size / sizeof(short), sampleRate,
+            count > 0 ? count : 1) != 0) {
+        return JNI_FALSE;
     }
 
     return JNI_TRUE;
@@ -725,6 +734,17 @@ void Java_com_example_nativeaudio_NativeAudio_shutdown(JNIEnv* env, jclass clazz
         bqPlayerVolume = NULL;
     }
 
+    // destroy the mixer, now that the callback can't run anymore
+    if (bqPlayerMixer != NULL) {
+        AudioMixerStats stats;
+        audio_mixer_get_stats(bqPlayerMixer, &stats);
+        __android_log_print(ANDROID_LOG_INFO, "NativeAudio",
+                "%u buffers mixed, %u us at most, %u us at most between two callbacks",
+                stats.renders, stats.maxRenderNs / 1000, stats.maxIntervalNs / 1000);
+        audio_mixer_destroy(bqPlayerMixer);
+        bqPlayerMixer = NULL;
+    }
+
     // destroy file descriptor audio player object, and invalidate all associated interfaces
     if (fdPlayerObject != NULL) {
         (*fdPlayerObject)->Destroy(fdPlayerObject);
@@ -19,8 +19,9 @@ include $(CLEAR_VARS)
 LOCAL_MODULE    := native-plasma
 LOCAL_SRC_FILES := plasma.c
 LOCAL_LDLIBS    := -lm -llog -landroid
-LOCAL_STATIC_LIBRARIES := android_native_app_glue
+LOCAL_STATIC_LIBRARIES := android_native_app_glue plasma_kernel
 
 include $(BUILD_SHARED_LIBRARY)
 
 $(call import-module,android/native_app_glue)
+$(call import-module,android/plasma_kernel)
@@ -1,3 +1,4 @@
-# The ARMv7 is significanly faster due to the use of the hardware FPU
-APP_ABI := armeabi armeabi-v7a
+# The ARMv7 is significanly faster due to the use of NEON, when the CPU
+# supports it. On x86, SSE2 or SSSE3 are used.
+APP_ABI := armeabi armeabi-v7a x86
 APP_PLATFORM := android-10
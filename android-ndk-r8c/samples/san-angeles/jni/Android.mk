@@ -10,8 +10,13 @@ LOCAL_CFLAGS := -DANDROID_NDK \
 LOCAL_SRC_FILES := \
     importgl.c \
     demo.c \
+    shapegen.c \
     app-android.c \
 
 LOCAL_LDLIBS := -lGLESv1_CM -ldl -llog
 
+LOCAL_STATIC_LIBRARIES := android_native_app_frame
+
 include $(BUILD_SHARED_LIBRARY)
+
+$(call import-module,android/native_app_frame)
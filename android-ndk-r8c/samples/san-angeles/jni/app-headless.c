@@ -0,0 +1,245 @@
+/* San Angeles Observation OpenGL ES version example
+ * Copyright 2004-2005 Jetro Lauha
+ * All rights reserved.
+ * Web: http://iki.fi/jetro/
+ *
+ * This source is free software; you can redistribute it and/or
+ * modify it under the terms of EITHER:
+ *   (1) The GNU Lesser General Public License as published by the Free
+ *       Software Foundation; either version 2.1 of the License, or (at
+ *       your option) any later version. The text of the GNU Lesser
+ *       General Public License is included with this source in the
+ *       file LICENSE-LGPL.txt.
+ *   (2) The BSD-style license that is included with this source in
+ *       the file LICENSE-BSD.txt.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files
+ * LICENSE-LGPL.txt and LICENSE-BSD.txt for more details.
+ */
+
+/* Headless benchmark of the supershape mesh generation: it builds the
+ * geometry of the demo without any window or GL context, and prints the
+ * build time and the number of vertices generated per second. It can be
+ * built on a plain Linux host with:
+ *
+ *   NDK=<ndk_root>
+ *   gcc -O2 -I$NDK/sources/android/native_app_frame -o sanangeles-headless \
+ *       app-headless.c shapegen.c \
+ *       $NDK/sources/android/native_app_frame/android_job_system.c \
+ *       -lpthread -lm
+ *
+ * Usage: sanangeles-headless [iterations [workers]]
+ * By default, one worker thread is used per CPU core besides the main
+ * thread. Meshes are also built with the original serial implementation,
+ * as a reference for the time and for the generated vertices.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "android_native_app_frame.h"
+
+#include "shapes.h"
+#include "shapegen.h"
+
+
+#define DEFAULT_ITERATIONS 50
+
+
+static SUPERSHAPE_MESH sMeshes[SUPERSHAPE_COUNT];
+static SUPERSHAPE_MESH sReference[SUPERSHAPE_COUNT];
+
+
+static double getTimeMs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+
+static int allocMeshes(SUPERSHAPE_MESH *meshes)
+{
+    int a;
+    for (a = 0; a < SUPERSHAPE_COUNT; ++a)
+    {
+        const long vertices = superShapeMaxVertices(sSuperShapeParams[a]);
+        meshes[a].params = sSuperShapeParams[a];
+        // Any base color will do, the demo draws them with randomUInt().
+        meshes[a].baseColor[0] = 0.5f + a * 0.02f;
+        meshes[a].baseColor[1] = 0.7f;
+        meshes[a].baseColor[2] = 1.0f - a * 0.02f;
+        meshes[a].vertexArray = (int32_t *)malloc(vertices * 3 * sizeof(int32_t));
+        meshes[a].colorArray = (uint8_t *)malloc(vertices * 4 * sizeof(uint8_t));
+        meshes[a].normalArray = (int32_t *)malloc(vertices * 3 * sizeof(int32_t));
+        meshes[a].count = 0;
+        if (meshes[a].vertexArray == NULL || meshes[a].colorArray == NULL ||
+            meshes[a].normalArray == NULL)
+            return 0;
+    }
+    return 1;
+}
+
+
+static void freeMeshes(SUPERSHAPE_MESH *meshes)
+{
+    int a;
+    for (a = 0; a < SUPERSHAPE_COUNT; ++a)
+    {
+        free(meshes[a].vertexArray);
+        free(meshes[a].colorArray);
+        free(meshes[a].normalArray);
+    }
+}
+
+
+static long countVertices(const SUPERSHAPE_MESH *meshes)
+{
+    long vertices = 0;
+    int a;
+    for (a = 0; a < SUPERSHAPE_COUNT; ++a)
+        vertices += meshes[a].count;
+    return vertices;
+}
+
+
+// Returns the largest difference between two arrays of fixed values.
+static long maxDifference(const int32_t *a, const int32_t *b, long count)
+{
+    long result = 0;
+    long i;
+    for (i = 0; i < count; ++i)
+    {
+        long d = (long)a[i] - b[i];
+        if (d < 0) d = -d;
+        if (d > result) result = d;
+    }
+    return result;
+}
+
+
+// Compares the meshes with the reference, returns 1 when they match.
+static int checkMeshes()
+{
+    long maxVertexDiff = 0, maxNormalDiff = 0, d;
+    int a, result = 1;
+
+    for (a = 0; a < SUPERSHAPE_COUNT; ++a)
+    {
+        const SUPERSHAPE_MESH *mesh = &sMeshes[a];
+        const SUPERSHAPE_MESH *ref = &sReference[a];
+        long i;
+
+        if (mesh->count != ref->count)
+        {
+            fprintf(stderr, "Shape %d: %ld vertices instead of %ld.\n",
+                    a, mesh->count, ref->count);
+            result = 0;
+            continue;
+        }
+        d = maxDifference(mesh->vertexArray, ref->vertexArray, mesh->count * 3);
+        if (d > maxVertexDiff) maxVertexDiff = d;
+        d = maxDifference(mesh->normalArray, ref->normalArray, mesh->count * 3);
+        if (d > maxNormalDiff) maxNormalDiff = d;
+        for (i = 0; i < mesh->count * 4; ++i)
+        {
+            d = (long)mesh->colorArray[i] - ref->colorArray[i];
+            if (d < -1 || d > 1)
+            {
+                fprintf(stderr, "Shape %d: wrong color at vertex %ld.\n",
+                        a, i / 4);
+                result = 0;
+                break;
+            }
+        }
+    }
+
+    printf("max difference with the reference: vertices %ld, normals %ld "
+           "(1/65536 units)\n", maxVertexDiff, maxNormalDiff);
+    // The positions are computed in float instead of double.
+    if (maxVertexDiff > 16)
+    {
+        fprintf(stderr, "The vertices don't match the reference.\n");
+        result = 0;
+    }
+    return result;
+}
+
+
+static void report(const char *name, double ms, int iterations)
+{
+    const double vertices = (double)countVertices(sReference) * iterations;
+    printf("%-10s %8.3f ms per build, %8.2f Mvertices/s\n",
+           name, ms / iterations, vertices / ms / 1000);
+}
+
+
+int main(int argc, char *argv[])
+{
+    int iterations = DEFAULT_ITERATIONS;
+    int workers = -1;
+    struct android_jobs *jobs;
+    double start, referenceMs, serialMs, parallelMs;
+    int a, n, result;
+
+    if (argc > 1)
+        iterations = atoi(argv[1]);
+    if (argc > 2)
+        workers = atoi(argv[2]);
+    if (iterations < 1)
+        iterations = 1;
+
+    if (!allocMeshes(sMeshes) || !allocMeshes(sReference))
+    {
+        fprintf(stderr, "Out of memory.\n");
+        return EXIT_FAILURE;
+    }
+
+    jobs = android_jobs_create(workers);
+    if (jobs == NULL)
+    {
+        fprintf(stderr, "Job system creation failed.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Warm up, and fail early if there is not enough memory.
+    if (superShapeBuildMeshes(sMeshes, SUPERSHAPE_COUNT, jobs) != 0)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        return EXIT_FAILURE;
+    }
+
+    start = getTimeMs();
+    for (n = 0; n < iterations; ++n)
+        for (a = 0; a < SUPERSHAPE_COUNT; ++a)
+            superShapeBuildMeshReference(&sReference[a]);
+    referenceMs = getTimeMs() - start;
+
+    start = getTimeMs();
+    for (n = 0; n < iterations; ++n)
+        superShapeBuildMeshes(sMeshes, SUPERSHAPE_COUNT, NULL);
+    serialMs = getTimeMs() - start;
+
+    start = getTimeMs();
+    for (n = 0; n < iterations; ++n)
+        superShapeBuildMeshes(sMeshes, SUPERSHAPE_COUNT, jobs);
+    parallelMs = getTimeMs() - start;
+
+    printf("%d supershapes, %ld vertices, %d iterations, %d worker threads\n",
+           (int)SUPERSHAPE_COUNT, countVertices(sReference), iterations,
+           android_jobs_worker_count(jobs));
+    report("reference", referenceMs, iterations);
+    report("serial", serialMs, iterations);
+    report("parallel", parallelMs, iterations);
+
+    result = checkMeshes();
+
+    android_jobs_destroy(jobs);
+    freeMeshes(sReference);
+    freeMeshes(sMeshes);
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -28,9 +28,13 @@
 #include <assert.h>
 
 #include "importgl.h"
+#ifndef DISABLE_JOBS
+#include "android_native_app_frame.h"
+#endif
 
 #include "app.h"
 #include "shapes.h"
+#include "shapegen.h"
 #include "cams.h"
 
 
@@ -97,11 +101,6 @@ static GLOBJECT *sSuperShapeObjects[SUPERSHAPE_COUNT] = { NULL };
 static GLOBJECT *sGroundPlane = NULL;
 
 
-typedef struct {
-    float x, y, z;
-} VECTOR3;
-
-
 static void freeGLObject(GLOBJECT *object)
 {
     if (object == NULL)
@@ -166,179 +165,52 @@ static void drawGLObject(GLOBJECT *object)
 }
 
 
-static void vector3Sub(VECTOR3 *dest, VECTOR3 *v1, VECTOR3 *v2)
-{
-    dest->x = v1->x - v2->x;
-    dest->y = v1->y - v2->y;
-    dest->z = v1->z - v2->z;
-}
-
-
-static void superShapeMap(VECTOR3 *point, float r1, float r2, float t, float p)
-{
-    // sphere-mapping of supershape parameters
-    point->x = (float)(cos(t) * cos(p) / r1 / r2);
-    point->y = (float)(sin(t) * cos(p) / r1 / r2);
-    point->z = (float)(sin(p) / r2);
-}
-
-
-static float ssFunc(const float t, const float *p)
+// Creates all the supershape objects, in parallel when possible. The
+// objects are left NULL on failure.
+static void createSuperShapes()
 {
-    return (float)(pow(pow(fabs(cos(p[0] * t / 4)) / p[1], p[4]) +
-                       pow(fabs(sin(p[0] * t / 4)) / p[2], p[5]), 1 / p[3]));
-}
+    SUPERSHAPE_MESH meshes[SUPERSHAPE_COUNT];
+    struct android_jobs *jobs = NULL;
+    int a, b, result;
 
+    // The base colors are drawn first, in order, so that they don't
+    // depend on the order in which the meshes are generated.
+    for (a = 0; a < SUPERSHAPE_COUNT; ++a)
+    {
+        const float *params = sSuperShapeParams[a];
+        GLOBJECT *object = newGLObject(superShapeMaxVertices(params), 3, 1);
+        if (object == NULL)
+            return;
+        sSuperShapeObjects[a] = object;
+        meshes[a].params = params;
+        for (b = 0; b < 3; ++b)
+            meshes[a].baseColor[b] = ((randomUInt() % 155) + 100) / 255.f;
+        meshes[a].vertexArray = object->vertexArray;
+        meshes[a].colorArray = object->colorArray;
+        meshes[a].normalArray = object->normalArray;
+    }
 
-// Creates and returns a supershape object.
-// Based on Paul Bourke's POV-Ray implementation.
-// http://astronomy.swin.edu.au/~pbourke/povray/supershape/
-static GLOBJECT * createSuperShape(const float *params)
-{
-    const int resol1 = (int)params[SUPERSHAPE_PARAMS - 3];
-    const int resol2 = (int)params[SUPERSHAPE_PARAMS - 2];
-    // latitude 0 to pi/2 for no mirrored bottom
-    // (latitudeBegin==0 for -pi/2 to pi/2 originally)
-    const int latitudeBegin = resol2 / 4;
-    const int latitudeEnd = resol2 / 2;    // non-inclusive
-    const int longitudeCount = resol1;
-    const int latitudeCount = latitudeEnd - latitudeBegin;
-    const long triangleCount = longitudeCount * latitudeCount * 2;
-    const long vertices = triangleCount * 3;
-    GLOBJECT *result;
-    float baseColor[3];
-    int a, longitude, latitude;
-    long currentVertex, currentQuad;
-
-    result = newGLObject(vertices, 3, 1);
-    if (result == NULL)
-        return NULL;
-
-    for (a = 0; a < 3; ++a)
-        baseColor[a] = ((randomUInt() % 155) + 100) / 255.f;
-
-    currentQuad = 0;
-    currentVertex = 0;
+#ifndef DISABLE_JOBS
+    jobs = android_jobs_create(-1);
+#endif
+    result = superShapeBuildMeshes(meshes, SUPERSHAPE_COUNT, jobs);
+#ifndef DISABLE_JOBS
+    android_jobs_destroy(jobs);
+#endif
 
-    // longitude -pi to pi
-    for (longitude = 0; longitude < longitudeCount; ++longitude)
+    for (a = 0; a < SUPERSHAPE_COUNT; ++a)
     {
-
-        // latitude 0 to pi/2
-        for (latitude = latitudeBegin; latitude < latitudeEnd; ++latitude)
+        if (result != 0)
         {
-            float t1 = -PI + longitude * 2 * PI / resol1;
-            float t2 = -PI + (longitude + 1) * 2 * PI / resol1;
-            float p1 = -PI / 2 + latitude * 2 * PI / resol2;
-            float p2 = -PI / 2 + (latitude + 1) * 2 * PI / resol2;
-            float r0, r1, r2, r3;
-
-            r0 = ssFunc(t1, params);
-            r1 = ssFunc(p1, &params[6]);
-            r2 = ssFunc(t2, params);
-            r3 = ssFunc(p2, &params[6]);
-
-            if (r0 != 0 && r1 != 0 && r2 != 0 && r3 != 0)
-            {
-                VECTOR3 pa, pb, pc, pd;
-                VECTOR3 v1, v2, n;
-                float ca;
-                int i;
-                //float lenSq, invLenSq;
-
-                superShapeMap(&pa, r0, r1, t1, p1);
-                superShapeMap(&pb, r2, r1, t2, p1);
-                superShapeMap(&pc, r2, r3, t2, p2);
-                superShapeMap(&pd, r0, r3, t1, p2);
-
-                // kludge to set lower edge of the object to fixed level
-                if (latitude == latitudeBegin + 1)
-                    pa.z = pb.z = 0;
-
-                vector3Sub(&v1, &pb, &pa);
-                vector3Sub(&v2, &pd, &pa);
-
-                // Calculate normal with cross product.
-                /*   i    j    k      i    j
-                 * v1.x v1.y v1.z | v1.x v1.y
-                 * v2.x v2.y v2.z | v2.x v2.y
-                 */
-
-                n.x = v1.y * v2.z - v1.z * v2.y;
-                n.y = v1.z * v2.x - v1.x * v2.z;
-                n.z = v1.x * v2.y - v1.y * v2.x;
-
-                /* Pre-normalization of the normals is disabled here because
-                 * they will be normalized anyway later due to automatic
-                 * normalization (GL_NORMALIZE). It is enabled because the
-                 * objects are scaled with glScale.
-                 */
-                /*
-                lenSq = n.x * n.x + n.y * n.y + n.z * n.z;
-                invLenSq = (float)(1 / sqrt(lenSq));
-                n.x *= invLenSq;
-                n.y *= invLenSq;
-                n.z *= invLenSq;
-                */
-
-                ca = pa.z + 0.5f;
-
-                for (i = currentVertex * 3;
-                     i < (currentVertex + 6) * 3;
-                     i += 3)
-                {
-                    result->normalArray[i] = FIXED(n.x);
-                    result->normalArray[i + 1] = FIXED(n.y);
-                    result->normalArray[i + 2] = FIXED(n.z);
-                }
-                for (i = currentVertex * 4;
-                     i < (currentVertex + 6) * 4;
-                     i += 4)
-                {
-                    int a, color[3];
-                    for (a = 0; a < 3; ++a)
-                    {
-                        color[a] = (int)(ca * baseColor[a] * 255);
-                        if (color[a] > 255) color[a] = 255;
-                    }
-                    result->colorArray[i] = (GLubyte)color[0];
-                    result->colorArray[i + 1] = (GLubyte)color[1];
-                    result->colorArray[i + 2] = (GLubyte)color[2];
-                    result->colorArray[i + 3] = 0;
-                }
-                result->vertexArray[currentVertex * 3] = FIXED(pa.x);
-                result->vertexArray[currentVertex * 3 + 1] = FIXED(pa.y);
-                result->vertexArray[currentVertex * 3 + 2] = FIXED(pa.z);
-                ++currentVertex;
-                result->vertexArray[currentVertex * 3] = FIXED(pb.x);
-                result->vertexArray[currentVertex * 3 + 1] = FIXED(pb.y);
-                result->vertexArray[currentVertex * 3 + 2] = FIXED(pb.z);
-                ++currentVertex;
-                result->vertexArray[currentVertex * 3] = FIXED(pd.x);
-                result->vertexArray[currentVertex * 3 + 1] = FIXED(pd.y);
-                result->vertexArray[currentVertex * 3 + 2] = FIXED(pd.z);
-                ++currentVertex;
-                result->vertexArray[currentVertex * 3] = FIXED(pb.x);
-                result->vertexArray[currentVertex * 3 + 1] = FIXED(pb.y);
-                result->vertexArray[currentVertex * 3 + 2] = FIXED(pb.z);
-                ++currentVertex;
-                result->vertexArray[currentVertex * 3] = FIXED(pc.x);
-                result->vertexArray[currentVertex * 3 + 1] = FIXED(pc.y);
-                result->vertexArray[currentVertex * 3 + 2] = FIXED(pc.z);
-                ++currentVertex;
-                result->vertexArray[currentVertex * 3] = FIXED(pd.x);
-                result->vertexArray[currentVertex * 3 + 1] = FIXED(pd.y);
-                result->vertexArray[currentVertex * 3 + 2] = FIXED(pd.z);
-                ++currentVertex;
-            } // r0 && r1 && r2 && r3
-            ++currentQuad;
-        } // latitude
-    } // longitude
-
-    // Set number of vertices in object to the actual amount created.
-    result->count = currentVertex;
-
-    return result;
+            freeGLObject(sSuperShapeObjects[a]);
+            sSuperShapeObjects[a] = NULL;
+        }
+        else
+        {
+            // Set number of vertices in object to the actual amount created.
+            sSuperShapeObjects[a]->count = meshes[a].count;
+        }
+    }
 }
 
 
@@ -479,11 +351,9 @@ void appInit()
 
     seedRandom(15);
 
+    createSuperShapes();
     for (a = 0; a < SUPERSHAPE_COUNT; ++a)
-    {
-        sSuperShapeObjects[a] = createSuperShape(sSuperShapeParams[a]);
         assert(sSuperShapeObjects[a] != NULL);
-    }
     sGroundPlane = createGroundPlane();
     assert(sGroundPlane != NULL);
 }
@@ -0,0 +1,560 @@
+/* San Angeles Observation OpenGL ES version example
+ * Copyright 2004-2005 Jetro Lauha
+ * All rights reserved.
+ * Web: http://iki.fi/jetro/
+ *
+ * This source is free software; you can redistribute it and/or
+ * modify it under the terms of EITHER:
+ *   (1) The GNU Lesser General Public License as published by the Free
+ *       Software Foundation; either version 2.1 of the License, or (at
+ *       your option) any later version. The text of the GNU Lesser
+ *       General Public License is included with this source in the
+ *       file LICENSE-LGPL.txt.
+ *   (2) The BSD-style license that is included with this source in
+ *       the file LICENSE-BSD.txt.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files
+ * LICENSE-LGPL.txt and LICENSE-BSD.txt for more details.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+
+#ifndef DISABLE_JOBS
+#include "android_native_app_frame.h"
+#endif
+
+#include "shapegen.h"
+
+
+#undef PI
+#define PI 3.1415926535897932f
+
+// Number of latitude rows processed at once by buildStripe().
+#define ROW_BATCH 16
+
+// Number of longitude stripes in each job.
+#define STRIPES_PER_JOB 4
+
+
+// Capped conversion from float to fixed.
+static long floatToFixed(float value)
+{
+    if (value < -32768) value = -32768;
+    if (value > 32767) value = 32767;
+    return (long)(value * 65536);
+}
+
+#define FIXED(value) floatToFixed(value)
+
+
+typedef struct {
+    float x, y, z;
+} VECTOR3;
+
+
+static void vector3Sub(VECTOR3 *dest, VECTOR3 *v1, VECTOR3 *v2)
+{
+    dest->x = v1->x - v2->x;
+    dest->y = v1->y - v2->y;
+    dest->z = v1->z - v2->z;
+}
+
+
+static void superShapeMap(VECTOR3 *point, float r1, float r2, float t, float p)
+{
+    // sphere-mapping of supershape parameters
+    point->x = (float)(cos(t) * cos(p) / r1 / r2);
+    point->y = (float)(sin(t) * cos(p) / r1 / r2);
+    point->z = (float)(sin(p) / r2);
+}
+
+
+static float ssFunc(const float t, const float *p)
+{
+    return (float)(pow(pow(fabs(cos(p[0] * t / 4)) / p[1], p[4]) +
+                       pow(fabs(sin(p[0] * t / 4)) / p[2], p[5]), 1 / p[3]));
+}
+
+
+/* The shape is mapped on a grid of longitude and latitude edges. The
+ * point at (t, p) is (cos(t) * cos(p) / r(t) / r(p),
+ * sin(t) * cos(p) / r(t) / r(p), sin(p) / r(p)), so the transcendental
+ * functions only need to be evaluated once per edge, and the grid is
+ * the product of a longitude term and a latitude term. A quad is
+ * skipped when r is 0 on one of its edges, so the position of each quad
+ * in the arrays is also known in advance, and each longitude stripe can
+ * be generated independently.
+ */
+typedef struct {
+    SUPERSHAPE_MESH *mesh;
+    int longitudeCount;
+    int latitudeCount;
+    // Index of the first longitude stripe of the shape among all shapes.
+    int firstStripe;
+    // cos(t) / r(t) and sin(t) / r(t), for longitudeCount + 1 edges.
+    float *lonCos;
+    float *lonSin;
+    // cos(p) / r(p) and sin(p) / r(p), for latitudeCount + 1 edges.
+    float *latCos;
+    float *latSin;
+    /* First vertex of each longitude stripe in the arrays, and first
+     * vertex of each latitude row in a stripe, or -1 when the quads of
+     * the stripe or of the row are skipped.
+     */
+    long *lonVertex;
+    long *latVertex;
+} SHAPEBUILD;
+
+typedef struct {
+    SHAPEBUILD *shapes;
+} SHAPEGEN;
+
+
+static void getLatitudeRange(const float *params, int *latitudeBegin,
+                             int *latitudeEnd)
+{
+    const int resol2 = (int)params[SUPERSHAPE_RESOL2];
+    // latitude 0 to pi/2 for no mirrored bottom
+    // (latitudeBegin==0 for -pi/2 to pi/2 originally)
+    *latitudeBegin = resol2 / 4;
+    *latitudeEnd = resol2 / 2;    // non-inclusive
+}
+
+
+long superShapeMaxVertices(const float *params)
+{
+    const int longitudeCount = (int)params[SUPERSHAPE_RESOL1];
+    int latitudeBegin, latitudeEnd;
+    getLatitudeRange(params, &latitudeBegin, &latitudeEnd);
+    return (long)longitudeCount * (latitudeEnd - latitudeBegin) * 2 * 3;
+}
+
+
+// Computes the edge terms and the quad positions of a shape.
+static void setupShape(SHAPEBUILD *shape)
+{
+    const float *params = shape->mesh->params;
+    const int resol1 = (int)params[SUPERSHAPE_RESOL1];
+    const int resol2 = (int)params[SUPERSHAPE_RESOL2];
+    int latitudeBegin, latitudeEnd;
+    float r, prevR = 0;
+    long stripeVertices, vertex;
+    int i;
+
+    getLatitudeRange(params, &latitudeBegin, &latitudeEnd);
+
+    stripeVertices = 0;
+    for (i = 0; i <= shape->latitudeCount; ++i)
+    {
+        const float p = -PI / 2 + (latitudeBegin + i) * 2 * PI / resol2;
+        r = ssFunc(p, &params[6]);
+        shape->latCos[i] = (float)(cos(p) / r);
+        shape->latSin[i] = (float)(sin(p) / r);
+        if (i > 0)
+        {
+            if (prevR != 0 && r != 0)
+            {
+                shape->latVertex[i - 1] = stripeVertices;
+                stripeVertices += 6;
+            }
+            else
+                shape->latVertex[i - 1] = -1;
+        }
+        prevR = r;
+    }
+
+    vertex = 0;
+    for (i = 0; i <= shape->longitudeCount; ++i)
+    {
+        const float t = -PI + i * 2 * PI / resol1;
+        r = ssFunc(t, params);
+        shape->lonCos[i] = (float)(cos(t) / r);
+        shape->lonSin[i] = (float)(sin(t) / r);
+        if (i > 0)
+        {
+            if (prevR != 0 && r != 0 && stripeVertices > 0)
+            {
+                shape->lonVertex[i - 1] = vertex;
+                vertex += stripeVertices;
+            }
+            else
+                shape->lonVertex[i - 1] = -1;
+        }
+        prevR = r;
+    }
+
+    shape->mesh->count = vertex;
+}
+
+
+/* Generates the quads of one longitude stripe, in batches of rows. The
+ * points, normals and colors of a batch are computed in separate arrays
+ * first, then written to the interleaved output arrays.
+ */
+static void buildStripe(const SHAPEBUILD *shape, int longitude)
+{
+    SUPERSHAPE_MESH *mesh = shape->mesh;
+    const long stripeVertex = shape->lonVertex[longitude];
+    const float ct1 = shape->lonCos[longitude];
+    const float st1 = shape->lonSin[longitude];
+    const float ct2 = shape->lonCos[longitude + 1];
+    const float st2 = shape->lonSin[longitude + 1];
+    // Points of the edges t1 and t2 (z is the same for both).
+    float x1[ROW_BATCH + 1], y1[ROW_BATCH + 1];
+    float x2[ROW_BATCH + 1], y2[ROW_BATCH + 1];
+    float z[ROW_BATCH + 1];
+    // Per quad: z of pa and pb, normal and color.
+    float zab[ROW_BATCH];
+    float nx[ROW_BATCH], ny[ROW_BATCH], nz[ROW_BATCH];
+    int32_t fx1[ROW_BATCH + 1], fy1[ROW_BATCH + 1];
+    int32_t fx2[ROW_BATCH + 1], fy2[ROW_BATCH + 1];
+    int32_t fz[ROW_BATCH + 1], fzab[ROW_BATCH];
+    int32_t fnx[ROW_BATCH], fny[ROW_BATCH], fnz[ROW_BATCH];
+    uint8_t color[ROW_BATCH][3];
+    int first, rows, i, a;
+
+    if (stripeVertex < 0)
+        return;
+
+    for (first = 0; first < shape->latitudeCount; first += rows)
+    {
+        const float *cp = &shape->latCos[first];
+        const float *sp = &shape->latSin[first];
+
+        rows = shape->latitudeCount - first;
+        if (rows > ROW_BATCH)
+            rows = ROW_BATCH;
+
+        for (i = 0; i <= rows; ++i)
+        {
+            x1[i] = ct1 * cp[i];
+            y1[i] = st1 * cp[i];
+            x2[i] = ct2 * cp[i];
+            y2[i] = st2 * cp[i];
+            z[i] = sp[i];
+        }
+        for (i = 0; i < rows; ++i)
+            zab[i] = z[i];
+        // kludge to set lower edge of the object to fixed level
+        if (first == 0 && rows > 1)
+            zab[1] = 0;
+
+        for (i = 0; i < rows; ++i)
+        {
+            // v1 = pb - pa, v2 = pd - pa, n = v1 x v2
+            const float v1x = x2[i] - x1[i];
+            const float v1y = y2[i] - y1[i];
+            const float v1z = zab[i] - zab[i];
+            const float v2x = x1[i + 1] - x1[i];
+            const float v2y = y1[i + 1] - y1[i];
+            const float v2z = z[i + 1] - zab[i];
+            nx[i] = v1y * v2z - v1z * v2y;
+            ny[i] = v1z * v2x - v1x * v2z;
+            nz[i] = v1x * v2y - v1y * v2x;
+        }
+
+        for (i = 0; i <= rows; ++i)
+        {
+            fx1[i] = FIXED(x1[i]);
+            fy1[i] = FIXED(y1[i]);
+            fx2[i] = FIXED(x2[i]);
+            fy2[i] = FIXED(y2[i]);
+            fz[i] = FIXED(z[i]);
+        }
+        for (i = 0; i < rows; ++i)
+        {
+            fzab[i] = FIXED(zab[i]);
+            fnx[i] = FIXED(nx[i]);
+            fny[i] = FIXED(ny[i]);
+            fnz[i] = FIXED(nz[i]);
+        }
+
+        for (i = 0; i < rows; ++i)
+        {
+            const float ca = zab[i] + 0.5f;
+            for (a = 0; a < 3; ++a)
+            {
+                int c = (int)(ca * mesh->baseColor[a] * 255);
+                if (c > 255) c = 255;
+                color[i][a] = (uint8_t)c;
+            }
+        }
+
+        for (i = 0; i < rows; ++i)
+        {
+            const long rowVertex = shape->latVertex[first + i];
+            int32_t *vertices, *normals;
+            uint8_t *colors;
+            int v;
+
+            if (rowVertex < 0)
+                continue;
+            vertices = &mesh->vertexArray[(stripeVertex + rowVertex) * 3];
+            normals = &mesh->normalArray[(stripeVertex + rowVertex) * 3];
+            colors = &mesh->colorArray[(stripeVertex + rowVertex) * 4];
+
+            // pa, pb, pd, pb, pc, pd
+            vertices[0] = fx1[i];     vertices[1] = fy1[i];     vertices[2] = fzab[i];
+            vertices[3] = fx2[i];     vertices[4] = fy2[i];     vertices[5] = fzab[i];
+            vertices[6] = fx1[i + 1]; vertices[7] = fy1[i + 1]; vertices[8] = fz[i + 1];
+            vertices[9] = fx2[i];     vertices[10] = fy2[i];    vertices[11] = fzab[i];
+            vertices[12] = fx2[i + 1];vertices[13] = fy2[i + 1];vertices[14] = fz[i + 1];
+            vertices[15] = fx1[i + 1];vertices[16] = fy1[i + 1];vertices[17] = fz[i + 1];
+
+            for (v = 0; v < 6; ++v)
+            {
+                normals[v * 3] = fnx[i];
+                normals[v * 3 + 1] = fny[i];
+                normals[v * 3 + 2] = fnz[i];
+                colors[v * 4] = color[i][0];
+                colors[v * 4 + 1] = color[i][1];
+                colors[v * 4 + 2] = color[i][2];
+                colors[v * 4 + 3] = 0;
+            }
+        }
+    }
+}
+
+
+static void setupShapes(void *arg, int begin, int end)
+{
+    const SHAPEGEN *gen = (const SHAPEGEN *)arg;
+    int s;
+    for (s = begin; s < end; ++s)
+        setupShape(&gen->shapes[s]);
+}
+
+
+static void buildStripes(void *arg, int begin, int end)
+{
+    const SHAPEGEN *gen = (const SHAPEGEN *)arg;
+    const SHAPEBUILD *shape = gen->shapes;
+    int stripe;
+
+    for (stripe = begin; stripe < end; ++stripe)
+    {
+        while (stripe >= shape->firstStripe + shape->longitudeCount)
+            ++shape;
+        buildStripe(shape, stripe - shape->firstStripe);
+    }
+}
+
+
+static void parallelFor(struct android_jobs *jobs, int count, int grain,
+                        void (*func)(void *, int, int), void *arg)
+{
+#ifndef DISABLE_JOBS
+    if (jobs != NULL)
+    {
+        android_jobs_parallel_for(jobs, count, grain, func, arg);
+        return;
+    }
+#endif
+    (void)jobs;
+    (void)grain;
+    func(arg, 0, count);
+}
+
+
+int superShapeBuildMeshes(SUPERSHAPE_MESH *meshes, int meshCount,
+                          struct android_jobs *jobs)
+{
+    SHAPEGEN gen;
+    float *floats;
+    long *longs;
+    long floatCount = 0, longCount = 0;
+    int stripeCount = 0;
+    int s;
+
+    gen.shapes = (SHAPEBUILD *)malloc(meshCount * sizeof(SHAPEBUILD));
+    if (gen.shapes == NULL)
+        return -1;
+
+    for (s = 0; s < meshCount; ++s)
+    {
+        SHAPEBUILD *shape = &gen.shapes[s];
+        int latitudeBegin, latitudeEnd;
+        getLatitudeRange(meshes[s].params, &latitudeBegin, &latitudeEnd);
+        shape->mesh = &meshes[s];
+        shape->longitudeCount = (int)meshes[s].params[SUPERSHAPE_RESOL1];
+        shape->latitudeCount = latitudeEnd - latitudeBegin;
+        if (shape->longitudeCount < 0)
+            shape->longitudeCount = 0;
+        if (shape->latitudeCount < 0)
+            shape->latitudeCount = 0;
+        shape->firstStripe = stripeCount;
+        stripeCount += shape->longitudeCount;
+        floatCount += (shape->longitudeCount + 1) * 2 +
+                      (shape->latitudeCount + 1) * 2;
+        longCount += shape->longitudeCount + shape->latitudeCount;
+    }
+
+    floats = (float *)malloc(floatCount * sizeof(float));
+    longs = (long *)malloc(longCount * sizeof(long));
+    if (floats == NULL || longs == NULL)
+    {
+        free(longs);
+        free(floats);
+        free(gen.shapes);
+        return -1;
+    }
+
+    floatCount = 0;
+    longCount = 0;
+    for (s = 0; s < meshCount; ++s)
+    {
+        SHAPEBUILD *shape = &gen.shapes[s];
+        shape->lonCos = &floats[floatCount];
+        floatCount += shape->longitudeCount + 1;
+        shape->lonSin = &floats[floatCount];
+        floatCount += shape->longitudeCount + 1;
+        shape->latCos = &floats[floatCount];
+        floatCount += shape->latitudeCount + 1;
+        shape->latSin = &floats[floatCount];
+        floatCount += shape->latitudeCount + 1;
+        shape->lonVertex = &longs[longCount];
+        longCount += shape->longitudeCount;
+        shape->latVertex = &longs[longCount];
+        longCount += shape->latitudeCount;
+    }
+
+    parallelFor(jobs, meshCount, 1, setupShapes, &gen);
+    parallelFor(jobs, stripeCount, STRIPES_PER_JOB, buildStripes, &gen);
+
+    free(longs);
+    free(floats);
+    free(gen.shapes);
+    return 0;
+}
+
+
+// Creates a supershape mesh.
+// Based on Paul Bourke's POV-Ray implementation.
+// http://astronomy.swin.edu.au/~pbourke/povray/supershape/
+void superShapeBuildMeshReference(SUPERSHAPE_MESH *mesh)
+{
+    const float *params = mesh->params;
+    const float *baseColor = mesh->baseColor;
+    const int resol1 = (int)params[SUPERSHAPE_RESOL1];
+    const int resol2 = (int)params[SUPERSHAPE_RESOL2];
+    int latitudeBegin, latitudeEnd;
+    const int longitudeCount = resol1;
+    int longitude, latitude;
+    long currentVertex;
+
+    getLatitudeRange(params, &latitudeBegin, &latitudeEnd);
+
+    currentVertex = 0;
+
+    // longitude -pi to pi
+    for (longitude = 0; longitude < longitudeCount; ++longitude)
+    {
+
+        // latitude 0 to pi/2
+        for (latitude = latitudeBegin; latitude < latitudeEnd; ++latitude)
+        {
+            float t1 = -PI + longitude * 2 * PI / resol1;
+            float t2 = -PI + (longitude + 1) * 2 * PI / resol1;
+            float p1 = -PI / 2 + latitude * 2 * PI / resol2;
+            float p2 = -PI / 2 + (latitude + 1) * 2 * PI / resol2;
+            float r0, r1, r2, r3;
+
+            r0 = ssFunc(t1, params);
+            r1 = ssFunc(p1, &params[6]);
+            r2 = ssFunc(t2, params);
+            r3 = ssFunc(p2, &params[6]);
+
+            if (r0 != 0 && r1 != 0 && r2 != 0 && r3 != 0)
+            {
+                VECTOR3 pa, pb, pc, pd;
+                VECTOR3 v1, v2, n;
+                float ca;
+                long i;
+
+                superShapeMap(&pa, r0, r1, t1, p1);
+                superShapeMap(&pb, r2, r1, t2, p1);
+                superShapeMap(&pc, r2, r3, t2, p2);
+                superShapeMap(&pd, r0, r3, t1, p2);
+
+                // kludge to set lower edge of the object to fixed level
+                if (latitude == latitudeBegin + 1)
+                    pa.z = pb.z = 0;
+
+                vector3Sub(&v1, &pb, &pa);
+                vector3Sub(&v2, &pd, &pa);
+
+                // Calculate normal with cross product.
+                /*   i    j    k      i    j
+                 * v1.x v1.y v1.z | v1.x v1.y
+                 * v2.x v2.y v2.z | v2.x v2.y
+                 */
+
+                n.x = v1.y * v2.z - v1.z * v2.y;
+                n.y = v1.z * v2.x - v1.x * v2.z;
+                n.z = v1.x * v2.y - v1.y * v2.x;
+
+                /* Pre-normalization of the normals is disabled here because
+                 * they will be normalized anyway later due to automatic
+                 * normalization (GL_NORMALIZE). It is enabled because the
+                 * objects are scaled with glScale.
+                 */
+
+                ca = pa.z + 0.5f;
+
+                for (i = currentVertex * 3;
+                     i < (currentVertex + 6) * 3;
+                     i += 3)
+                {
+                    mesh->normalArray[i] = FIXED(n.x);
+                    mesh->normalArray[i + 1] = FIXED(n.y);
+                    mesh->normalArray[i + 2] = FIXED(n.z);
+                }
+                for (i = currentVertex * 4;
+                     i < (currentVertex + 6) * 4;
+                     i += 4)
+                {
+                    int a, color[3];
+                    for (a = 0; a < 3; ++a)
+                    {
+                        color[a] = (int)(ca * baseColor[a] * 255);
+                        if (color[a] > 255) color[a] = 255;
+                    }
+                    mesh->colorArray[i] = (uint8_t)color[0];
+                    mesh->colorArray[i + 1] = (uint8_t)color[1];
+                    mesh->colorArray[i + 2] = (uint8_t)color[2];
+                    mesh->colorArray[i + 3] = 0;
+                }
+                mesh->vertexArray[currentVertex * 3] = FIXED(pa.x);
+                mesh->vertexArray[currentVertex * 3 + 1] = FIXED(pa.y);
+                mesh->vertexArray[currentVertex * 3 + 2] = FIXED(pa.z);
+                ++currentVertex;
+                mesh->vertexArray[currentVertex * 3] = FIXED(pb.x);
+                mesh->vertexArray[currentVertex * 3 + 1] = FIXED(pb.y);
+                mesh->vertexArray[currentVertex * 3 + 2] = FIXED(pb.z);
+                ++currentVertex;
+                mesh->vertexArray[currentVertex * 3] = FIXED(pd.x);
+                mesh->vertexArray[currentVertex * 3 + 1] = FIXED(pd.y);
+                mesh->vertexArray[currentVertex * 3 + 2] = FIXED(pd.z);
+                ++currentVertex;
+                mesh->vertexArray[currentVertex * 3] = FIXED(pb.x);
+                mesh->vertexArray[currentVertex * 3 + 1] = FIXED(pb.y);
+                mesh->vertexArray[currentVertex * 3 + 2] = FIXED(pb.z);
+                ++currentVertex;
+                mesh->vertexArray[currentVertex * 3] = FIXED(pc.x);
+                mesh->vertexArray[currentVertex * 3 + 1] = FIXED(pc.y);
+                mesh->vertexArray[currentVertex * 3 + 2] = FIXED(pc.z);
+                ++currentVertex;
+                mesh->vertexArray[currentVertex * 3] = FIXED(pd.x);
+                mesh->vertexArray[currentVertex * 3 + 1] = FIXED(pd.y);
+                mesh->vertexArray[currentVertex * 3 + 2] = FIXED(pd.z);
+                ++currentVertex;
+            } // r0 && r1 && r2 && r3
+        } // latitude
+    } // longitude
+
+    // Set number of vertices in object to the actual amount created.
+    mesh->count = currentVertex;
+}
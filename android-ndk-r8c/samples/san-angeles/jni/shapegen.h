@@ -0,0 +1,90 @@
+/* San Angeles Observation OpenGL ES version example
+ * Copyright 2004-2005 Jetro Lauha
+ * All rights reserved.
+ * Web: http://iki.fi/jetro/
+ *
+ * This source is free software; you can redistribute it and/or
+ * modify it under the terms of EITHER:
+ *   (1) The GNU Lesser General Public License as published by the Free
+ *       Software Foundation; either version 2.1 of the License, or (at
+ *       your option) any later version. The text of the GNU Lesser
+ *       General Public License is included with this source in the
+ *       file LICENSE-LGPL.txt.
+ *   (2) The BSD-style license that is included with this source in
+ *       the file LICENSE-BSD.txt.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files
+ * LICENSE-LGPL.txt and LICENSE-BSD.txt for more details.
+ */
+
+#ifndef SHAPEGEN_H_INCLUDED
+#define SHAPEGEN_H_INCLUDED
+
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Mesh generation of the supershapes, without any GL calls, so that it
+ * can be used both by the demo and by the headless benchmark
+ * (app-headless.c).
+ *
+ * The meshes are generated with the job system of
+ * sources/android/native_app_frame, unless DISABLE_JOBS is defined.
+ */
+
+struct android_jobs;
+
+// Indices of the mesh resolution in the parameters of a supershape
+// (see sSuperShapeParams in shapes.h).
+#define SUPERSHAPE_RESOL1 12
+#define SUPERSHAPE_RESOL2 13
+
+
+typedef struct {
+    // Input: the parameters of the shape and its base color.
+    const float *params;
+    float baseColor[3];
+
+    /* Output: the arrays must be allocated by the caller for
+     * superShapeMaxVertices() vertices. Vertices and normals have 3
+     * GL_FIXED components, colors have 4 GL_UNSIGNED_BYTE components.
+     * The number of vertices actually generated is set in count.
+     */
+    int32_t *vertexArray;
+    uint8_t *colorArray;
+    int32_t *normalArray;
+    long count;
+} SUPERSHAPE_MESH;
+
+
+// Returns the maximum number of vertices of a supershape.
+extern long superShapeMaxVertices(const float *params);
+
+/* Generates the meshes of meshCount supershapes, spread across the
+ * worker threads of jobs. If jobs is NULL, the meshes are generated by
+ * the calling thread. Returns 0 on success, or -1 if there is not enough
+ * memory.
+ */
+extern int superShapeBuildMeshes(SUPERSHAPE_MESH *meshes, int meshCount,
+                                 struct android_jobs *jobs);
+
+/* Generates one mesh with the original, serial implementation. The
+ * result is the same as the one of superShapeBuildMeshes(), except for
+ * rounding differences of at most a few units of GL_FIXED. Only used as a
+ * reference by the headless benchmark.
+ */
+extern void superShapeBuildMeshReference(SUPERSHAPE_MESH *mesh);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // !SHAPEGEN_H_INCLUDED
@@ -0,0 +1,12 @@
+LOCAL_PATH:= $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE:= audio_engine
+LOCAL_SRC_FILES:= audio_ring.c audio_mixer.c
+LOCAL_EXPORT_C_INCLUDES := $(LOCAL_PATH)
+LOCAL_STATIC_LIBRARIES := dsp
+
+include $(BUILD_STATIC_LIBRARY)
+
+$(call import-module,android/dsp)
@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _AUDIO_ENGINE_H
+#define _AUDIO_ENGINE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The 'audio_engine' static library provides the real-time part of a
+ * low-latency audio player, independently of the audio API:
+ *
+ * 1/ AudioRing, a lock-free ring buffer of 16-bit PCM frames between one
+ *    producer thread (e.g. a decoder or a synthesizer) and one consumer
+ *    thread (the audio callback).
+ *
+ * 2/ AudioMixer, which mixes a fixed number of voices into 16-bit frames.
+ *    Each voice plays either a clip in memory or the frames of an
+ *    AudioRing, at its own sample rate, with its own gain.  Voices are
+ *    resampled with linear interpolation and mixed in float with the
+ *    kernels of the 'dsp' library, which use NEON or SSE2 when available.
+ *
+ * audio_mixer_render() is meant to be called from the audio callback,
+ * e.g. the buffer queue callback of an OpenSL ES player:
+ *
+ *     static void bqPlayerCallback(SLAndroidSimpleBufferQueueItf bq, void* context)
+ *     {
+ *         int16_t* buffer = buffers[next];
+ *         next = (next + 1) % BUFFER_COUNT;
+ *         audio_mixer_render(mixer, buffer, FRAMES);
+ *         (*bq)->Enqueue(bq, buffer, FRAMES * CHANNELS * sizeof(int16_t));
+ *     }
+ *
+ * It never locks, allocates or waits, so that the callback can't miss
+ * its deadline because of another thread.  When the ring of a voice
+ * doesn't have enough frames, silence is rendered instead and an
+ * underrun is counted.  The mixer also keeps statistics about the
+ * latency and the duration of the callbacks.
+ *
+ * See tests/device/test-audio-engine for a test harness that replaces
+ * OpenSL ES with a clock thread calling audio_mixer_render().
+ */
+
+/* -------------------------------------------------------------------- */
+/* Ring buffer                                                          */
+/* -------------------------------------------------------------------- */
+
+typedef struct AudioRing AudioRing;
+
+/**
+ * Create a ring of interleaved 16-bit frames with 'channels' channels.
+ * Its capacity is 'frames' rounded up to a power of two.  Return NULL on
+ * failure.
+ */
+AudioRing* audio_ring_create(int frames, int channels);
+
+void audio_ring_destroy(AudioRing* ring);
+
+/**
+ * Return the capacity of a ring, in frames.
+ */
+int audio_ring_capacity(const AudioRing* ring);
+
+/**
+ * Return the number of channels of a ring.
+ */
+int audio_ring_channels(const AudioRing* ring);
+
+/**
+ * Copy up to 'count' frames to the ring, and return the number of frames
+ * copied, which is less than 'count' if the ring is full.  Only one thread
+ * can write to a ring.
+ */
+int audio_ring_write(AudioRing* ring, const int16_t* frames, int count);
+
+/**
+ * Copy up to 'count' frames from the ring, and return the number of frames
+ * copied, which is less than 'count' if the ring is empty.  Only one
+ * thread can read from a ring.
+ */
+int audio_ring_read(AudioRing* ring, int16_t* frames, int count);
+
+/**
+ * Return the number of frames that can be read from a ring.  It can only
+ * increase until the reader reads them.
+ */
+int audio_ring_readable(const AudioRing* ring);
+
+/**
+ * Return the number of frames that can be written to a ring.  It can only
+ * increase until the writer writes them.
+ */
+int audio_ring_writable(const AudioRing* ring);
+
+/* -------------------------------------------------------------------- */
+/* Mixer                                                                */
+/* -------------------------------------------------------------------- */
+
+typedef struct AudioMixer AudioMixer;
+
+/**
+ * The maximum ratio between the sample rate of a voice and the one of the
+ * mixer.
+ */
+#define AUDIO_MIXER_MAX_RATE_RATIO  8
+
+/**
+ * The statistics of a mixer, since its creation or the last call to
+ * audio_mixer_reset_stats().  Each field is updated atomically by
+ * audio_mixer_render(), but not all of them at once.
+ */
+typedef struct {
+    uint32_t  renders;          /* calls to audio_mixer_render() */
+    uint32_t  frames;           /* frames rendered */
+    uint32_t  underruns;        /* renders where a ring had too few frames */
+    uint32_t  underrunFrames;   /* frames of silence rendered instead */
+    /* The frames queued in the rings, at the rate of the mixer, for the
+     * voice with the most of them, at the start of the last render and
+     * at most.  This is the latency added by the rings.
+     */
+    uint32_t  queuedFrames;
+    uint32_t  maxQueuedFrames;
+    /* The duration of the last and of the longest render. */
+    uint32_t  renderNs;
+    uint32_t  maxRenderNs;
+    /* The longest time between the start of two renders.  It should stay
+     * close to the duration of a buffer.
+     */
+    uint32_t  maxIntervalNs;
+} AudioMixerStats;
+
+/**
+ * Create a mixer of 'voices' voices, rendering interleaved frames of
+ * 'channels' channels at 'sampleRate' Hz.  Return NULL on failure.
+ */
+AudioMixer* audio_mixer_create(int voices, int channels, int sampleRate);
+
+/**
+ * Destroy a mixer.  audio_mixer_render() must not be running.
+ */
+void audio_mixer_destroy(AudioMixer* mixer);
+
+/**
+ * Play 'loops' times a clip of 'count' frames at 'sampleRate' Hz, with the
+ * channels of the mixer, on a voice, instead of what it played.  If 'loops'
+ * is 0, the clip is played until the voice is stopped.  The frames are not
+ * copied.
+ *
+ * This and the other functions that control the voices are meant to be
+ * called from one thread at a time, but can run at the same time as
+ * audio_mixer_render(): they are applied at the start of the next render.
+ * The clips and rings of a voice must stay valid until the voice is
+ * stopped and audio_mixer_is_playing() returns 0, or until the renders
+ * are stopped.
+ *
+ * Return 0 on success, or -1 if a parameter is invalid, e.g. if the rate
+ * ratio is more than AUDIO_MIXER_MAX_RATE_RATIO.
+ */
+int audio_mixer_play_clip(AudioMixer* mixer, int voice, const int16_t* frames,
+                          int count, int sampleRate, int loops);
+
+/**
+ * Play the frames of a ring at 'sampleRate' Hz on a voice, until it is
+ * stopped.  The mixer is the reader of the ring, and the ring must have
+ * the channels of the mixer.  Return 0 on success, or -1 if a parameter
+ * is invalid.
+ */
+int audio_mixer_play_stream(AudioMixer* mixer, int voice, AudioRing* ring,
+                            int sampleRate);
+
+/**
+ * Stop a voice.  Return 0 on success, or -1 if 'voice' is invalid.
+ */
+int audio_mixer_stop(AudioMixer* mixer, int voice);
+
+/**
+ * Return 1 if a voice is playing, or if a command for it is not applied
+ * yet, 0 otherwise.
+ */
+int audio_mixer_is_playing(const AudioMixer* mixer, int voice);
+
+/**
+ * Set the gain of a voice, 1 by default.  It can be called from any
+ * thread.
+ */
+void audio_mixer_set_gain(AudioMixer* mixer, int voice, float gain);
+
+/**
+ * Render 'frames' interleaved frames of all the voices to 'output'.
+ */
+void audio_mixer_render(AudioMixer* mixer, int16_t* output, int frames);
+
+/**
+ * Copy the statistics of a mixer.  It can be called from any thread.
+ */
+void audio_mixer_get_stats(const AudioMixer* mixer, AudioMixerStats* stats);
+
+/**
+ * Reset the statistics of a mixer at the start of the next render.  It
+ * can be called from any thread.
+ */
+void audio_mixer_reset_stats(AudioMixer* mixer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AUDIO_ENGINE_H */
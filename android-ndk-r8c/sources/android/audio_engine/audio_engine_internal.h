@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2010 The Android Open Source Project
+ * Copyright (C) 2012 The Android Open Source Project
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -14,9 +14,20 @@
  * limitations under the License.
  *
  */
-#ifndef HELLONEON_INTRINSICS_H
-#define HELLONEON_INTRINSICS_H
 
-void fir_filter_neon_intrinsics(short *output, const short* input, const short* kernel, int width, int kernelSize);
+#ifndef _AUDIO_ENGINE_INTERNAL_H
+#define _AUDIO_ENGINE_INTERNAL_H
 
-#endif /* HELLONEON_INTRINSICS_H */
+#include "audio_engine.h"
+
+/* The size of a cache line, used to keep the data written by different
+ * threads apart.
+ */
+#define AUDIO_CACHE_LINE  64
+
+/* A full memory barrier.  It is a 'dmb' on ARMv7, a call to the kernel
+ * helper on ARMv5, and an 'mfence' on x86, which never blocks.
+ */
+#define AUDIO_BARRIER()  __sync_synchronize()
+
+#endif /* _AUDIO_ENGINE_INTERNAL_H */
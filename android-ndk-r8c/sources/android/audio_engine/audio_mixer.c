@@ -0,0 +1,462 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "audio_engine_internal.h"
+#include "dsp.h"
+
+#define MAX_VOICES    64
+#define MAX_CHANNELS  8
+
+/* The voices are mixed RENDER_CHUNK frames at a time, so that the mix
+ * buffers don't depend on the size of the buffers of the callback.
+ */
+#define RENDER_CHUNK  256
+
+/* The step between two output frames, in Q16 input frames. */
+#define ONE_STEP  0x10000
+#define MAX_STEP  (AUDIO_MIXER_MAX_RATE_RATIO * ONE_STEP)
+
+/* The input frames needed to resample a chunk at the largest step, plus
+ * the frame after the last one for the interpolation.
+ */
+#define STAGE_FRAMES  (RENDER_CHUNK * AUDIO_MIXER_MAX_RATE_RATIO + 2)
+
+enum {
+    VOICE_STOP = 0,
+    VOICE_CLIP,
+    VOICE_STREAM,
+};
+
+typedef struct {
+    int             type;
+    const int16_t*  clip;
+    int             clipFrames;
+    int             loops;
+    AudioRing*      ring;
+    uint32_t        step;
+} VoiceCommand;
+
+/* The control thread posts commands with a sequence lock: 'seq' is odd
+ * while 'command' is written.  The render thread applies a command only if
+ * 'seq' is even and didn't change while it copied it, and then stores it
+ * in 'applied'.  A command that is not applied yet is replaced by the next
+ * one, and the render thread never waits for the control thread.
+ *
+ * The other fields are only used by the render thread.
+ */
+typedef struct {
+    volatile uint32_t  seq;
+    VoiceCommand       command;
+    volatile float     gain;
+
+    volatile uint32_t  applied;
+    volatile int       playing;
+    int                type;
+    const int16_t*     clip;
+    int                clipFrames;
+    int                clipPos;
+    int                loops;
+    int                ended;
+    AudioRing*         ring;
+    uint32_t           step;
+    uint32_t           frac;
+    /* The input frames not consumed yet, starting with the one at
+     * position 'frac'.
+     */
+    int16_t*           stage;
+    int                staged;
+    char               pad[AUDIO_CACHE_LINE];
+} AudioVoice;
+
+struct AudioMixer {
+    int              voiceCount;
+    int              channels;
+    int              sampleRate;
+    AudioVoice*      voices;
+    float*           mix;
+    float*           buffer;
+    int64_t          lastStartNs;
+    volatile int     resetStats;
+    AudioMixerStats  stats;
+};
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+AudioMixer* audio_mixer_create(int voices, int channels, int sampleRate)
+{
+    AudioMixer*  mixer;
+    int          nn;
+
+    if (voices <= 0 || voices > MAX_VOICES ||
+        channels <= 0 || channels > MAX_CHANNELS || sampleRate <= 0)
+        return NULL;
+
+    mixer = calloc(1, sizeof(*mixer));
+    if (mixer == NULL)
+        return NULL;
+    mixer->voiceCount = voices;
+    mixer->channels   = channels;
+    mixer->sampleRate = sampleRate;
+    mixer->voices = calloc(voices, sizeof(AudioVoice));
+    mixer->mix    = malloc(RENDER_CHUNK * channels * sizeof(float));
+    mixer->buffer = malloc(RENDER_CHUNK * channels * sizeof(float));
+    if (mixer->voices == NULL || mixer->mix == NULL || mixer->buffer == NULL) {
+        audio_mixer_destroy(mixer);
+        return NULL;
+    }
+    for (nn = 0; nn < voices; nn++) {
+        AudioVoice*  voice = &mixer->voices[nn];
+
+        voice->gain  = 1.f;
+        voice->stage = malloc(STAGE_FRAMES * channels * sizeof(int16_t));
+        if (voice->stage == NULL) {
+            audio_mixer_destroy(mixer);
+            return NULL;
+        }
+    }
+    return mixer;
+}
+
+void audio_mixer_destroy(AudioMixer* mixer)
+{
+    int  nn;
+
+    if (mixer == NULL)
+        return;
+    if (mixer->voices != NULL) {
+        for (nn = 0; nn < mixer->voiceCount; nn++)
+            free(mixer->voices[nn].stage);
+        free(mixer->voices);
+    }
+    free(mixer->mix);
+    free(mixer->buffer);
+    free(mixer);
+}
+
+/* Return the step to play frames at 'sampleRate' Hz, or 0 if it is too
+ * large or too small.
+ */
+static uint32_t get_step(const AudioMixer* mixer, int sampleRate)
+{
+    uint64_t  step;
+
+    if (sampleRate <= 0)
+        return 0;
+    step = ((uint64_t)sampleRate << 16) / mixer->sampleRate;
+    if (step > MAX_STEP)
+        return 0;
+    return (uint32_t)step;
+}
+
+static int post_command(AudioMixer* mixer, int voice, const VoiceCommand* command)
+{
+    AudioVoice*  v;
+    uint32_t     seq;
+
+    if (voice < 0 || voice >= mixer->voiceCount)
+        return -1;
+    v = &mixer->voices[voice];
+    seq = v->seq;
+    v->seq = seq + 1;
+    AUDIO_BARRIER();
+    v->command = *command;
+    AUDIO_BARRIER();
+    v->seq = seq + 2;
+    return 0;
+}
+
+int audio_mixer_play_clip(AudioMixer* mixer, int voice, const int16_t* frames,
+                          int count, int sampleRate, int loops)
+{
+    VoiceCommand  command;
+
+    if (frames == NULL || count <= 0 || loops < 0)
+        return -1;
+    memset(&command, 0, sizeof(command));
+    command.type       = VOICE_CLIP;
+    command.clip       = frames;
+    command.clipFrames = count;
+    command.loops      = loops;
+    command.step       = get_step(mixer, sampleRate);
+    if (command.step == 0)
+        return -1;
+    return post_command(mixer, voice, &command);
+}
+
+int audio_mixer_play_stream(AudioMixer* mixer, int voice, AudioRing* ring,
+                            int sampleRate)
+{
+    VoiceCommand  command;
+
+    if (ring == NULL || audio_ring_channels(ring) != mixer->channels)
+        return -1;
+    memset(&command, 0, sizeof(command));
+    command.type = VOICE_STREAM;
+    command.ring = ring;
+    command.step = get_step(mixer, sampleRate);
+    if (command.step == 0)
+        return -1;
+    return post_command(mixer, voice, &command);
+}
+
+int audio_mixer_stop(AudioMixer* mixer, int voice)
+{
+    VoiceCommand  command;
+
+    memset(&command, 0, sizeof(command));
+    command.type = VOICE_STOP;
+    return post_command(mixer, voice, &command);
+}
+
+int audio_mixer_is_playing(const AudioMixer* mixer, int voice)
+{
+    const AudioVoice*  v;
+    uint32_t           applied;
+
+    if (voice < 0 || voice >= mixer->voiceCount)
+        return 0;
+    v = &mixer->voices[voice];
+    applied = v->applied;
+    AUDIO_BARRIER();
+    return v->seq != applied || v->playing;
+}
+
+void audio_mixer_set_gain(AudioMixer* mixer, int voice, float gain)
+{
+    if (voice < 0 || voice >= mixer->voiceCount)
+        return;
+    mixer->voices[voice].gain = gain;
+}
+
+void audio_mixer_get_stats(const AudioMixer* mixer, AudioMixerStats* stats)
+{
+    *stats = mixer->stats;
+}
+
+void audio_mixer_reset_stats(AudioMixer* mixer)
+{
+    mixer->resetStats = 1;
+}
+
+static void apply_command(AudioVoice* voice)
+{
+    uint32_t      seq = voice->seq;
+    VoiceCommand  command;
+
+    if (seq == voice->applied || (seq & 1) != 0)
+        return;
+    AUDIO_BARRIER();
+    command = voice->command;
+    AUDIO_BARRIER();
+    /* Retry at the next render if the command changed meanwhile. */
+    if (voice->seq != seq)
+        return;
+
+    voice->type       = command.type;
+    voice->clip       = command.clip;
+    voice->clipFrames = command.clipFrames;
+    voice->clipPos    = 0;
+    voice->loops      = command.loops;
+    voice->ended      = 0;
+    voice->ring       = command.ring;
+    voice->step       = command.step;
+    voice->frac       = 0;
+    voice->staged     = 0;
+    voice->playing    = (command.type != VOICE_STOP);
+    AUDIO_BARRIER();
+    voice->applied = seq;
+}
+
+/* Add input frames to the stage of a voice, until it has 'needed' frames
+ * or the input is over.
+ */
+static void fill_voice(AudioVoice* voice, int channels, int needed)
+{
+    if (voice->type == VOICE_STREAM) {
+        voice->staged += audio_ring_read(voice->ring,
+                                         voice->stage + voice->staged * channels,
+                                         needed - voice->staged);
+        return;
+    }
+
+    while (voice->staged < needed && !voice->ended) {
+        int16_t*  stage = voice->stage + voice->staged * channels;
+        int       count = voice->clipFrames - voice->clipPos;
+
+        if (count == 0) {
+            if (voice->loops != 1) {
+                if (voice->loops > 1)
+                    voice->loops--;
+                voice->clipPos = 0;
+                continue;
+            }
+            /* The last frame is interpolated with silence. */
+            memset(stage, 0, channels * sizeof(int16_t));
+            voice->staged++;
+            voice->ended = 1;
+            break;
+        }
+        if (count > needed - voice->staged)
+            count = needed - voice->staged;
+        memcpy(stage, voice->clip + voice->clipPos * channels,
+               count * channels * sizeof(int16_t));
+        voice->clipPos += count;
+        voice->staged  += count;
+    }
+}
+
+/* Render up to 'frames' frames of a voice to 'output', and return the
+ * number of frames rendered, which is less than 'frames' only if the
+ * input is over or the ring doesn't have enough frames.
+ */
+static int render_voice(AudioVoice* voice, int channels, float* output, int frames)
+{
+    /* Frames at the rate of the mixer are only converted. */
+    const int  direct = (voice->step == ONE_STEP && voice->frac == 0);
+    int        needed, rendered, consumed;
+
+    if (direct)
+        needed = frames;
+    else
+        needed = (int)((voice->frac + (uint32_t)(frames - 1) * voice->step) >> 16) + 2;
+    if (voice->staged < needed)
+        fill_voice(voice, channels, needed);
+
+    if (voice->staged >= needed) {
+        rendered = frames;
+    } else if (direct) {
+        rendered = voice->staged;
+    } else {
+        /* Output frame 'n' needs the input frames up to
+         * ((frac + n * step) >> 16) + 1.
+         */
+        int64_t  span = ((int64_t)(voice->staged - 1) << 16) - voice->frac;
+        rendered = (span > 0) ? (int)((span + voice->step - 1) / voice->step) : 0;
+    }
+
+    if (rendered > 0) {
+        if (direct) {
+            dsp_s16_to_f32(output, voice->stage, rendered * channels);
+            consumed = rendered;
+        } else {
+            uint32_t  position = voice->frac + (uint32_t)rendered * voice->step;
+
+            dsp_resample_s16_f32(output, voice->stage, channels, rendered,
+                                 voice->frac, voice->step);
+            consumed = (int)(position >> 16);
+            voice->frac = position & 0xffff;
+            /* After an underrun, the frames skipped by the step are not
+             * there yet, and are not skipped later.
+             */
+            if (consumed > voice->staged)
+                consumed = voice->staged;
+        }
+        voice->staged -= consumed;
+        memmove(voice->stage, voice->stage + consumed * channels,
+                voice->staged * channels * sizeof(int16_t));
+    }
+
+    if (rendered < frames && voice->ended) {
+        voice->staged  = 0;
+        voice->playing = 0;
+    }
+    return rendered;
+}
+
+void audio_mixer_render(AudioMixer* mixer, int16_t* output, int frames)
+{
+    const int        channels = mixer->channels;
+    const int64_t    startNs  = now_ns();
+    AudioMixerStats  stats    = mixer->stats;
+    uint32_t         queued   = 0;
+    uint32_t         missing  = 0;
+    int              done, nn;
+
+    if (mixer->resetStats) {
+        memset(&stats, 0, sizeof(stats));
+        mixer->lastStartNs = 0;
+        mixer->resetStats  = 0;
+    }
+    if (mixer->lastStartNs != 0 &&
+        startNs - mixer->lastStartNs > (int64_t)stats.maxIntervalNs)
+        stats.maxIntervalNs = (uint32_t)(startNs - mixer->lastStartNs);
+    mixer->lastStartNs = startNs;
+
+    for (nn = 0; nn < mixer->voiceCount; nn++) {
+        AudioVoice*  voice = &mixer->voices[nn];
+
+        apply_command(voice);
+        if (voice->playing && voice->type == VOICE_STREAM) {
+            uint64_t  frames = audio_ring_readable(voice->ring) + voice->staged;
+            uint32_t  voiceQueued = (uint32_t)((frames << 16) / voice->step);
+
+            if (voiceQueued > queued)
+                queued = voiceQueued;
+        }
+    }
+
+    for (done = 0; done < frames; done += RENDER_CHUNK) {
+        int  count = frames - done;
+        int  mixed = 0;
+
+        if (count > RENDER_CHUNK)
+            count = RENDER_CHUNK;
+        for (nn = 0; nn < mixer->voiceCount; nn++) {
+            AudioVoice*  voice = &mixer->voices[nn];
+            int          rendered;
+
+            if (!voice->playing)
+                continue;
+            if (!mixed) {
+                memset(mixer->mix, 0, count * channels * sizeof(float));
+                mixed = 1;
+            }
+            rendered = render_voice(voice, channels, mixer->buffer, count);
+            if (rendered > 0)
+                dsp_mix_f32(mixer->mix, mixer->buffer, rendered * channels, voice->gain);
+            if (voice->type == VOICE_STREAM)
+                missing += count - rendered;
+        }
+        if (mixed)
+            dsp_f32_to_s16(output + done * channels, mixer->mix, count * channels);
+        else
+            memset(output + done * channels, 0, count * channels * sizeof(int16_t));
+    }
+
+    stats.renders++;
+    stats.frames += frames;
+    if (missing > 0) {
+        stats.underruns++;
+        stats.underrunFrames += missing;
+    }
+    stats.queuedFrames = queued;
+    if (queued > stats.maxQueuedFrames)
+        stats.maxQueuedFrames = queued;
+    stats.renderNs = (uint32_t)(now_ns() - startNs);
+    if (stats.renderNs > stats.maxRenderNs)
+        stats.maxRenderNs = stats.renderNs;
+    mixer->stats = stats;
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio_engine_internal.h"
+
+/* The read and write positions count the frames since the creation of the
+ * ring, and wrap around at 2^32, which is a multiple of the capacity.  The
+ * writer only changes 'writePos' and the reader 'readPos', so no lock is
+ * needed: a barrier makes sure that the frames are copied before the
+ * position that publishes them is updated, and are read after it.
+ *
+ * The positions are on separate cache lines, so that the reader and the
+ * writer don't slow each other down when they run on different cores.
+ */
+struct AudioRing {
+    int16_t*           data;
+    uint32_t           mask;
+    int                channels;
+    char               pad0[AUDIO_CACHE_LINE];
+    volatile uint32_t  writePos;
+    char               pad1[AUDIO_CACHE_LINE];
+    volatile uint32_t  readPos;
+    char               pad2[AUDIO_CACHE_LINE];
+};
+
+AudioRing* audio_ring_create(int frames, int channels)
+{
+    AudioRing*  ring;
+    uint32_t    capacity = 1;
+
+    if (frames <= 0 || frames > (1 << 24) || channels <= 0)
+        return NULL;
+    while (capacity < (uint32_t)frames)
+        capacity <<= 1;
+
+    ring = calloc(1, sizeof(*ring));
+    if (ring == NULL)
+        return NULL;
+    ring->data = malloc(capacity * channels * sizeof(int16_t));
+    if (ring->data == NULL) {
+        free(ring);
+        return NULL;
+    }
+    ring->mask     = capacity - 1;
+    ring->channels = channels;
+    return ring;
+}
+
+void audio_ring_destroy(AudioRing* ring)
+{
+    if (ring == NULL)
+        return;
+    free(ring->data);
+    free(ring);
+}
+
+int audio_ring_capacity(const AudioRing* ring)
+{
+    return (int)ring->mask + 1;
+}
+
+int audio_ring_channels(const AudioRing* ring)
+{
+    return ring->channels;
+}
+
+int audio_ring_readable(const AudioRing* ring)
+{
+    return (int)(ring->writePos - ring->readPos);
+}
+
+int audio_ring_writable(const AudioRing* ring)
+{
+    return (int)(ring->mask + 1 - (ring->writePos - ring->readPos));
+}
+
+/* Copy 'count' frames between the ring at 'pos' and 'frames', in at most
+ * two parts when the end of the ring is reached.
+ */
+static void copy_frames(const AudioRing* ring, uint32_t pos, int16_t* frames,
+                        int count, int toRing)
+{
+    uint32_t  start = pos & ring->mask;
+    uint32_t  first = ring->mask + 1 - start;
+    size_t    frameSize = ring->channels * sizeof(int16_t);
+    int16_t*  data = ring->data + start * ring->channels;
+
+    if (first > (uint32_t)count)
+        first = count;
+    if (toRing) {
+        memcpy(data, frames, first * frameSize);
+        memcpy(ring->data, frames + first * ring->channels, (count - first) * frameSize);
+    } else {
+        memcpy(frames, data, first * frameSize);
+        memcpy(frames + first * ring->channels, ring->data, (count - first) * frameSize);
+    }
+}
+
+int audio_ring_write(AudioRing* ring, const int16_t* frames, int count)
+{
+    uint32_t  writePos = ring->writePos;
+    int       writable = (int)(ring->mask + 1 - (writePos - ring->readPos));
+
+    if (count > writable)
+        count = writable;
+    if (count <= 0)
+        return 0;
+    /* The reader must be done with the frames before they are overwritten. */
+    AUDIO_BARRIER();
+    copy_frames(ring, writePos, (int16_t*)frames, count, 1);
+    AUDIO_BARRIER();
+    ring->writePos = writePos + count;
+    return count;
+}
+
+int audio_ring_read(AudioRing* ring, int16_t* frames, int count)
+{
+    uint32_t  readPos = ring->readPos;
+    int       readable = (int)(ring->writePos - readPos);
+
+    if (count > readable)
+        count = readable;
+    if (count <= 0)
+        return 0;
+    AUDIO_BARRIER();
+    copy_frames(ring, readPos, frames, count, 0);
+    AUDIO_BARRIER();
+    ring->readPos = readPos + count;
+    return count;
+}
@@ -0,0 +1,34 @@
+LOCAL_PATH:= $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE:= dsp
+LOCAL_SRC_FILES:= dsp.c dsp_scalar.c
+LOCAL_EXPORT_C_INCLUDES := $(LOCAL_PATH)
+
+# The results must not depend on how the compiler schedules the float
+# operations of the scalar kernels.
+LOCAL_CFLAGS := -ffp-contract=off
+
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+LOCAL_CFLAGS += -DDSP_HAVE_NEON
+LOCAL_SRC_FILES += dsp_neon.c.neon
+endif
+
+# SSE2 is part of the x86 ABI, so the whole module can use it, and the
+# scalar kernels use SSE instead of x87 for floats, like the SSE2 ones.
+ifneq (,$(filter x86 host,$(TARGET_ARCH)))
+LOCAL_CFLAGS += -DDSP_HAVE_SSE2 -msse2 -mfpmath=sse
+LOCAL_SRC_FILES += dsp_sse2.c
+endif
+
+# The host ABIs don't have cpufeatures, cpuid is used instead.
+ifneq ($(TARGET_ARCH),host)
+LOCAL_STATIC_LIBRARIES := cpufeatures
+endif
+
+include $(BUILD_STATIC_LIBRARY)
+
+ifneq ($(TARGET_ARCH),host)
+$(call import-module,android/cpufeatures)
+endif
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dsp_internal.h"
+
+#if defined(__ANDROID__)
+#include <cpu-features.h>
+#elif defined(DSP_HAVE_SSE2)
+#include <cpuid.h>
+#endif
+
+static const DspFuncs* const  impl_funcs[DSP_IMPL_COUNT] = {
+    [DSP_IMPL_SCALAR] = &dsp_funcs_scalar,
+#ifdef DSP_HAVE_NEON
+    [DSP_IMPL_NEON]   = &dsp_funcs_neon,
+#endif
+#ifdef DSP_HAVE_SSE2
+    [DSP_IMPL_SSE2]   = &dsp_funcs_sse2,
+#endif
+};
+
+static const char* const  impl_names[DSP_IMPL_COUNT] = {
+    [DSP_IMPL_AUTO]   = "auto",
+    [DSP_IMPL_SCALAR] = "scalar",
+    [DSP_IMPL_NEON]   = "neon",
+    [DSP_IMPL_SSE2]   = "sse2",
+};
+
+static int              impl_supported[DSP_IMPL_COUNT];
+static int              impl_best;
+static int              impl_current;
+static const DspFuncs*  funcs;
+static pthread_once_t   init_once = PTHREAD_ONCE_INIT;
+
+static void init_impls(void)
+{
+    impl_supported[DSP_IMPL_SCALAR] = 1;
+
+#if defined(__ANDROID__)
+#  ifdef DSP_HAVE_NEON
+    if (android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
+        (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0)
+        impl_supported[DSP_IMPL_NEON] = 1;
+#  endif
+#  ifdef DSP_HAVE_SSE2
+    /* SSE2 is part of the x86 ABI. */
+    impl_supported[DSP_IMPL_SSE2] = 1;
+#  endif
+#elif defined(DSP_HAVE_SSE2)
+    /* The host ABIs don't have cpufeatures. */
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (edx & bit_SSE2) != 0)
+        impl_supported[DSP_IMPL_SSE2] = 1;
+#endif
+
+    if (impl_supported[DSP_IMPL_NEON])
+        impl_best = DSP_IMPL_NEON;
+    else if (impl_supported[DSP_IMPL_SSE2])
+        impl_best = DSP_IMPL_SSE2;
+    else
+        impl_best = DSP_IMPL_SCALAR;
+
+    impl_current = impl_best;
+    funcs = impl_funcs[impl_best];
+}
+
+static __inline__ const DspFuncs* get_funcs(void)
+{
+    pthread_once(&init_once, init_impls);
+    return funcs;
+}
+
+int dsp_impl_is_supported(int impl)
+{
+    pthread_once(&init_once, init_impls);
+    if (impl == DSP_IMPL_AUTO)
+        return 1;
+    if (impl < 0 || impl >= DSP_IMPL_COUNT)
+        return 0;
+    return impl_supported[impl];
+}
+
+const char* dsp_impl_name(int impl)
+{
+    if (impl < 0 || impl >= DSP_IMPL_COUNT)
+        return NULL;
+    return impl_names[impl];
+}
+
+int dsp_set_impl(int impl)
+{
+    if (!dsp_impl_is_supported(impl))
+        return -1;
+    if (impl == DSP_IMPL_AUTO)
+        impl = impl_best;
+    impl_current = impl;
+    funcs = impl_funcs[impl];
+    return 0;
+}
+
+int dsp_get_impl(void)
+{
+    pthread_once(&init_once, init_impls);
+    return impl_current;
+}
+
+void dsp_fir_s16(int16_t* output, const int16_t* input, const int16_t* kernel,
+                 int width, int kernelSize)
+{
+    get_funcs()->fir_s16(output, input - kernelSize/2, kernel, width, kernelSize);
+}
+
+void dsp_fir_f32(float* output, const float* input, const float* kernel,
+                 int width, int kernelSize)
+{
+    get_funcs()->fir_f32(output, input - kernelSize/2, kernel, width, kernelSize);
+}
+
+void dsp_biquad_f32(const DspBiquad* biquad, DspBiquadState* states,
+                    float* output, const float* input, int frames, int channels)
+{
+    get_funcs()->biquad_f32(biquad, states, output, input, frames, channels);
+}
+
+void dsp_s16_to_f32(float* output, const int16_t* input, int count)
+{
+    get_funcs()->s16_to_f32(output, input, count);
+}
+
+void dsp_f32_to_s16(int16_t* output, const float* input, int count)
+{
+    get_funcs()->f32_to_s16(output, input, count);
+}
+
+void dsp_mix_f32(float* output, const float* input, int count, float gain)
+{
+    get_funcs()->mix_f32(output, input, count, gain);
+}
+
+void dsp_resample_s16_f32(float* output, const int16_t* input, int channels,
+                          int frames, uint32_t position, uint32_t step)
+{
+    get_funcs()->resample_s16_f32(output, input, channels, frames, position, step);
+}
+
+struct DspConvolver {
+    /* The impulse response, reversed, used as a FIR kernel. */
+    float*  kernel;
+    int     length;
+    int     maxBlock;
+    /* The last length-1 input samples, followed by the current block. */
+    float*  history;
+};
+
+DspConvolver* dsp_conv_create(const float* impulse, int length, int maxBlock)
+{
+    DspConvolver*  conv;
+    int            nn;
+
+    if (length <= 0 || maxBlock <= 0)
+        return NULL;
+
+    conv = calloc(1, sizeof(*conv));
+    if (conv == NULL)
+        return NULL;
+    conv->length   = length;
+    conv->maxBlock = maxBlock;
+    conv->kernel   = malloc(length * sizeof(float));
+    conv->history  = calloc(length - 1 + maxBlock, sizeof(float));
+    if (conv->kernel == NULL || conv->history == NULL) {
+        dsp_conv_destroy(conv);
+        return NULL;
+    }
+    for (nn = 0; nn < length; nn++)
+        conv->kernel[nn] = impulse[length - 1 - nn];
+    return conv;
+}
+
+void dsp_conv_process(DspConvolver* conv, float* output, const float* input, int frames)
+{
+    int  tail = conv->length - 1;
+
+    if (frames > conv->maxBlock)
+        frames = conv->maxBlock;
+    if (frames <= 0)
+        return;
+
+    /* Copy the block first, in case 'output' is 'input'. */
+    memcpy(conv->history + tail, input, frames * sizeof(float));
+    get_funcs()->fir_f32(output, conv->history, conv->kernel, frames, conv->length);
+    memmove(conv->history, conv->history + frames, tail * sizeof(float));
+}
+
+void dsp_conv_reset(DspConvolver* conv)
+{
+    memset(conv->history, 0, (conv->length - 1) * sizeof(float));
+}
+
+void dsp_conv_destroy(DspConvolver* conv)
+{
+    if (conv == NULL)
+        return;
+    free(conv->kernel);
+    free(conv->history);
+    free(conv);
+}
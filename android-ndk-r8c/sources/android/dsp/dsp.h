@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _DSP_H
+#define _DSP_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The 'dsp' static library provides common signal processing kernels:
+ * FIR filters on 16-bit and float samples, IIR biquad filters, and the
+ * block convolution of a stream with an impulse response.
+ *
+ * Each kernel has a portable C implementation, a NEON one (armeabi-v7a)
+ * and a SSE2 one (x86).  The implementation is selected once at runtime
+ * with android_getCpuFeatures(), and can be overridden for testing with
+ * dsp_set_impl().  All implementations produce bit-exact results, with
+ * one exception: NEON flushes denormal floats to zero, so the float
+ * kernels can differ on ARM when denormals are involved.
+ *
+ * The library is built with -ffp-contract=off, so that the compiler never
+ * fuses the float multiplications and additions of the C kernels.
+ *
+ * It also provides the building blocks of an audio mixer: conversions
+ * between 16-bit and float samples, mixing, and resampling.
+ */
+
+enum {
+    DSP_IMPL_AUTO = 0,      /* the best supported one */
+    DSP_IMPL_SCALAR,
+    DSP_IMPL_NEON,
+    DSP_IMPL_SSE2,
+
+    DSP_IMPL_COUNT
+};
+
+/**
+ * Return 1 if the CPU supports an implementation, 0 otherwise.
+ */
+int dsp_impl_is_supported(int impl);
+
+/**
+ * Return the name of an implementation, e.g. "neon", or NULL if it is
+ * invalid.
+ */
+const char* dsp_impl_name(int impl);
+
+/**
+ * Select the implementation used by all the kernels, for all threads.
+ * DSP_IMPL_AUTO selects the best supported one, which is the default.
+ * Return 0 on success, or -1 if it is not supported.  This is meant for
+ * tests and benchmarks, and must not be called while a kernel runs.
+ */
+int dsp_set_impl(int impl);
+
+/**
+ * Return the implementation used by the kernels.
+ */
+int dsp_get_impl(void);
+
+/* -------------------------------------------------------------------- */
+/* FIR filters                                                          */
+/* -------------------------------------------------------------------- */
+
+/**
+ * Filter 'width' 16-bit samples with a kernel of 'kernelSize' Q16 taps,
+ * centered on each sample:
+ *
+ *     output[n] = (sum(kernel[m] * input[n - kernelSize/2 + m]) + 0x8000) >> 16
+ *
+ * The sum is computed on 32 bits, and wraps around on overflow.
+ * 'input' must thus be readable from input[-kernelSize/2] to
+ * input[width - kernelSize/2 + kernelSize - 1].
+ */
+void dsp_fir_s16(int16_t* output, const int16_t* input, const int16_t* kernel,
+                 int width, int kernelSize);
+
+/**
+ * Same as dsp_fir_s16() on floats, without any scaling:
+ *
+ *     output[n] = sum(kernel[m] * input[n - kernelSize/2 + m])
+ *
+ * The products are summed in the order of increasing 'm'.
+ */
+void dsp_fir_f32(float* output, const float* input, const float* kernel,
+                 int width, int kernelSize);
+
+/* -------------------------------------------------------------------- */
+/* IIR biquad filters                                                   */
+/* -------------------------------------------------------------------- */
+
+/**
+ * The normalized coefficients of a biquad filter (a0 == 1).
+ */
+typedef struct {
+    float  b0, b1, b2;
+    float  a1, a2;
+} DspBiquad;
+
+/**
+ * The state of a biquad filter for one channel: the last two inputs and
+ * outputs.  Initialize it to zeros.
+ */
+typedef struct {
+    float  x1, x2;
+    float  y1, y2;
+} DspBiquadState;
+
+/**
+ * Filter 'frames' frames of interleaved samples with 'channels' channels,
+ * using the same coefficients and one state per channel, in direct form I:
+ *
+ *     y = b0*x + b1*x1 + b2*x2 - a1*y1 - a2*y2
+ *
+ * evaluated from left to right.  'output' can be equal to 'input'.  The
+ * SIMD implementations process 4 channels at a time, so they are only
+ * faster with 4 channels or more.
+ */
+void dsp_biquad_f32(const DspBiquad* biquad, DspBiquadState* states,
+                    float* output, const float* input, int frames, int channels);
+
+/* -------------------------------------------------------------------- */
+/* Block convolution                                                    */
+/* -------------------------------------------------------------------- */
+
+/**
+ * A convolver filters a stream of float samples with an impulse response,
+ * one block at a time:
+ *
+ *     output[n] = sum(impulse[m] * input[n - m])
+ *
+ * where the input samples before the first block are zeros.  It uses
+ * dsp_fir_f32() on the end of the previous blocks and the current one.
+ */
+typedef struct DspConvolver DspConvolver;
+
+/**
+ * Create a convolver for an impulse response of 'length' samples, which
+ * is copied, and blocks of at most 'maxBlock' samples.  Return NULL on
+ * failure.
+ */
+DspConvolver* dsp_conv_create(const float* impulse, int length, int maxBlock);
+
+/**
+ * Filter the next block of 'frames' samples, at most 'maxBlock'.
+ * 'output' can be equal to 'input'.
+ */
+void dsp_conv_process(DspConvolver* conv, float* output, const float* input, int frames);
+
+/**
+ * Forget the previous blocks, as if the stream restarted.
+ */
+void dsp_conv_reset(DspConvolver* conv);
+
+void dsp_conv_destroy(DspConvolver* conv);
+
+/* -------------------------------------------------------------------- */
+/* Mixing                                                               */
+/* -------------------------------------------------------------------- */
+
+/**
+ * Convert 16-bit samples to floats in [-1, 1):
+ *
+ *     output[n] = input[n] / 32768
+ */
+void dsp_s16_to_f32(float* output, const int16_t* input, int count);
+
+/**
+ * Convert floats to 16-bit samples, rounded to the nearest integer (ties
+ * to even) and saturated:
+ *
+ *     output[n] = round(clamp(input[n] * 32768, -32768, 32767))
+ *
+ * The result is undefined for NaNs.
+ */
+void dsp_f32_to_s16(int16_t* output, const float* input, int count);
+
+/**
+ * Add samples scaled by a gain to a mix:
+ *
+ *     output[n] = output[n] + input[n] * gain
+ */
+void dsp_mix_f32(float* output, const float* input, int count, float gain);
+
+/**
+ * Resample 'frames' frames of interleaved 16-bit samples with linear
+ * interpolation, and convert them to floats like dsp_s16_to_f32().
+ * Positions are Q16 frame indices: output frame 'n' is read at
+ * p = position + n * step, i.e. for each channel 'c':
+ *
+ *     i = p >> 16, f = (p & 0xffff) / 65536
+ *     a = input[i*channels + c], b = input[(i+1)*channels + c]
+ *     output[n*channels + c] = (a + (b - a) * f) / 32768
+ *
+ * evaluated from left to right.  'input' must thus be readable up to the
+ * frame ((position + (frames - 1) * step) >> 16) + 1, and that position
+ * must fit in 32 bits.  The SIMD implementations handle 1 and 2 channels,
+ * and fall back to C for more.
+ */
+void dsp_resample_s16_f32(float* output, const int16_t* input, int channels,
+                          int frames, uint32_t position, uint32_t step);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DSP_H */
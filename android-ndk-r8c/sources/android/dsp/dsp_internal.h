@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _DSP_INTERNAL_H
+#define _DSP_INTERNAL_H
+
+#include "dsp.h"
+
+/* The kernels of one implementation. Unlike the public FIR functions,
+ * 'input' points to the first sample used for output[0], i.e.:
+ *
+ *     output[n] = sum(kernel[m] * input[n + m])
+ */
+typedef struct {
+    void (*fir_s16)(int16_t* output, const int16_t* input, const int16_t* kernel,
+                    int width, int kernelSize);
+    void (*fir_f32)(float* output, const float* input, const float* kernel,
+                    int width, int kernelSize);
+    void (*biquad_f32)(const DspBiquad* biquad, DspBiquadState* states,
+                       float* output, const float* input, int frames, int channels);
+    void (*s16_to_f32)(float* output, const int16_t* input, int count);
+    void (*f32_to_s16)(int16_t* output, const float* input, int count);
+    void (*mix_f32)(float* output, const float* input, int count, float gain);
+    void (*resample_s16_f32)(float* output, const int16_t* input, int channels,
+                             int frames, uint32_t position, uint32_t step);
+} DspFuncs;
+
+extern const DspFuncs  dsp_funcs_scalar;
+extern const DspFuncs  dsp_funcs_neon;
+extern const DspFuncs  dsp_funcs_sse2;
+
+/* The scalar kernels, also used by the SIMD ones for the remaining
+ * samples or channels.
+ */
+void dsp_fir_s16_scalar(int16_t* output, const int16_t* input, const int16_t* kernel,
+                        int width, int kernelSize);
+void dsp_fir_f32_scalar(float* output, const float* input, const float* kernel,
+                        int width, int kernelSize);
+void dsp_biquad_f32_scalar(const DspBiquad* biquad, DspBiquadState* states,
+                           float* output, const float* input, int frames,
+                           int channels, int stride);
+void dsp_s16_to_f32_scalar(float* output, const int16_t* input, int count);
+void dsp_f32_to_s16_scalar(int16_t* output, const float* input, int count);
+void dsp_mix_f32_scalar(float* output, const float* input, int count, float gain);
+void dsp_resample_s16_f32_scalar(float* output, const int16_t* input, int channels,
+                                 int frames, uint32_t position, uint32_t step);
+
+/* Round a 32-bit FIR sum to a Q16 sample, like the SIMD kernels do. */
+static __inline__ int16_t dsp_round_q16(uint32_t sum)
+{
+    return (int16_t)((int32_t)(sum + 0x8000) >> 16);
+}
+
+/* Scale factors of the sample conversions, which are powers of two so
+ * that the conversions are exact.
+ */
+#define DSP_S16_SCALE       32768.f
+#define DSP_S16_INV_SCALE   (1.f / 32768.f)
+#define DSP_Q16_INV_SCALE   (1.f / 65536.f)
+
+/* Adding and subtracting 1.5 * 2^23 rounds a float of magnitude below 2^22
+ * to the nearest integer, ties to even, like CVTPS2DQ does with the
+ * default rounding mode. NEON only has truncating conversions.
+ */
+#define DSP_ROUND_MAGIC     12582912.f
+
+#endif /* _DSP_INTERNAL_H */
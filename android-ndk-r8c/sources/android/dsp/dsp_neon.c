@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* The NEON kernels, only built for armeabi-v7a with -mfpu=neon. They must
+ * only be used if android_getCpuFeatures() reports NEON.
+ */
+
+#include <arm_neon.h>
+
+#include "dsp_internal.h"
+
+static void fir_s16(int16_t* output, const int16_t* input, const int16_t* kernel,
+                    int width, int kernelSize)
+{
+    const int32x4_t  round = vdupq_n_s32(0x8000);
+    int  nn, mm;
+
+    for (nn = 0; nn + 8 <= width; nn += 8) {
+        int32x4_t  lo = vdupq_n_s32(0);
+        int32x4_t  hi = vdupq_n_s32(0);
+        for (mm = 0; mm < kernelSize; mm++) {
+            int16x8_t  x = vld1q_s16(input + nn + mm);
+            lo = vmlal_n_s16(lo, vget_low_s16(x), kernel[mm]);
+            hi = vmlal_n_s16(hi, vget_high_s16(x), kernel[mm]);
+        }
+        lo = vshrq_n_s32(vaddq_s32(lo, round), 16);
+        hi = vshrq_n_s32(vaddq_s32(hi, round), 16);
+        vst1q_s16(output + nn, vcombine_s16(vmovn_s32(lo), vmovn_s32(hi)));
+    }
+    dsp_fir_s16_scalar(output + nn, input + nn, kernel, width - nn, kernelSize);
+}
+
+static void fir_f32(float* output, const float* input, const float* kernel,
+                    int width, int kernelSize)
+{
+    int  nn, mm;
+
+    /* Each lane sums the products of one output in the same order as the
+     * scalar kernel. VMUL and VADD are used instead of VMLA to make it
+     * clear that the products are rounded before the additions.
+     */
+    for (nn = 0; nn + 8 <= width; nn += 8) {
+        float32x4_t  lo = vdupq_n_f32(0.f);
+        float32x4_t  hi = vdupq_n_f32(0.f);
+        for (mm = 0; mm < kernelSize; mm++) {
+            lo = vaddq_f32(lo, vmulq_n_f32(vld1q_f32(input + nn + mm), kernel[mm]));
+            hi = vaddq_f32(hi, vmulq_n_f32(vld1q_f32(input + nn + mm + 4), kernel[mm]));
+        }
+        vst1q_f32(output + nn, lo);
+        vst1q_f32(output + nn + 4, hi);
+    }
+    dsp_fir_f32_scalar(output + nn, input + nn, kernel, width - nn, kernelSize);
+}
+
+static void biquad_f32(const DspBiquad* biquad, DspBiquadState* states,
+                       float* output, const float* input, int frames, int channels)
+{
+    int  cc, ff;
+
+    /* The samples of a channel depend on each other, so 4 channels are
+     * filtered at a time instead.
+     */
+    for (cc = 0; cc + 4 <= channels; cc += 4) {
+        DspBiquadState*  s = states + cc;
+        float        saved[4][4];
+        float32x4_t  x1, x2, y1, y2;
+        int          ii;
+
+        for (ii = 0; ii < 4; ii++) {
+            saved[0][ii] = s[ii].x1;
+            saved[1][ii] = s[ii].x2;
+            saved[2][ii] = s[ii].y1;
+            saved[3][ii] = s[ii].y2;
+        }
+        x1 = vld1q_f32(saved[0]);
+        x2 = vld1q_f32(saved[1]);
+        y1 = vld1q_f32(saved[2]);
+        y2 = vld1q_f32(saved[3]);
+
+        for (ff = 0; ff < frames; ff++) {
+            float32x4_t  x = vld1q_f32(input + ff*channels + cc);
+            float32x4_t  y = vmulq_n_f32(x, biquad->b0);
+            y = vaddq_f32(y, vmulq_n_f32(x1, biquad->b1));
+            y = vaddq_f32(y, vmulq_n_f32(x2, biquad->b2));
+            y = vsubq_f32(y, vmulq_n_f32(y1, biquad->a1));
+            y = vsubq_f32(y, vmulq_n_f32(y2, biquad->a2));
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = y;
+            vst1q_f32(output + ff*channels + cc, y);
+        }
+
+        vst1q_f32(saved[0], x1);
+        vst1q_f32(saved[1], x2);
+        vst1q_f32(saved[2], y1);
+        vst1q_f32(saved[3], y2);
+        for (ii = 0; ii < 4; ii++) {
+            s[ii].x1 = saved[0][ii];
+            s[ii].x2 = saved[1][ii];
+            s[ii].y1 = saved[2][ii];
+            s[ii].y2 = saved[3][ii];
+        }
+    }
+    dsp_biquad_f32_scalar(biquad, states + cc, output + cc, input + cc, frames,
+                          channels - cc, channels);
+}
+
+static void s16_to_f32(float* output, const int16_t* input, int count)
+{
+    int  nn;
+
+    for (nn = 0; nn + 8 <= count; nn += 8) {
+        int16x8_t  x = vld1q_s16(input + nn);
+        float32x4_t  lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(x)));
+        float32x4_t  hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(x)));
+        vst1q_f32(output + nn, vmulq_n_f32(lo, DSP_S16_INV_SCALE));
+        vst1q_f32(output + nn + 4, vmulq_n_f32(hi, DSP_S16_INV_SCALE));
+    }
+    dsp_s16_to_f32_scalar(output + nn, input + nn, count - nn);
+}
+
+static void f32_to_s16(int16_t* output, const float* input, int count)
+{
+    const float32x4_t  lo = vdupq_n_f32(-32768.f);
+    const float32x4_t  hi = vdupq_n_f32(32767.f);
+    const float32x4_t  magic = vdupq_n_f32(DSP_ROUND_MAGIC);
+    int  nn;
+
+    /* VCVT truncates, so round with DSP_ROUND_MAGIC first, like the C
+     * kernel. The rounded values are integers, converted exactly.
+     */
+    for (nn = 0; nn + 8 <= count; nn += 8) {
+        float32x4_t  a = vmulq_n_f32(vld1q_f32(input + nn), DSP_S16_SCALE);
+        float32x4_t  b = vmulq_n_f32(vld1q_f32(input + nn + 4), DSP_S16_SCALE);
+        a = vminq_f32(vmaxq_f32(a, lo), hi);
+        b = vminq_f32(vmaxq_f32(b, lo), hi);
+        a = vsubq_f32(vaddq_f32(a, magic), magic);
+        b = vsubq_f32(vaddq_f32(b, magic), magic);
+        vst1q_s16(output + nn, vcombine_s16(vmovn_s32(vcvtq_s32_f32(a)),
+                                            vmovn_s32(vcvtq_s32_f32(b))));
+    }
+    dsp_f32_to_s16_scalar(output + nn, input + nn, count - nn);
+}
+
+static void mix_f32(float* output, const float* input, int count, float gain)
+{
+    int  nn;
+
+    for (nn = 0; nn + 8 <= count; nn += 8) {
+        float32x4_t  a = vld1q_f32(output + nn);
+        float32x4_t  b = vld1q_f32(output + nn + 4);
+        a = vaddq_f32(a, vmulq_n_f32(vld1q_f32(input + nn), gain));
+        b = vaddq_f32(b, vmulq_n_f32(vld1q_f32(input + nn + 4), gain));
+        vst1q_f32(output + nn, a);
+        vst1q_f32(output + nn + 4, b);
+    }
+    dsp_mix_f32_scalar(output + nn, input + nn, count - nn, gain);
+}
+
+/* Interpolate 4 samples from the gathered samples and fractions. */
+static __inline__ float32x4_t lerp4(const int32_t* a, const int32_t* b, const int32_t* f)
+{
+    float32x4_t  va = vcvtq_f32_s32(vld1q_s32(a));
+    float32x4_t  vb = vcvtq_f32_s32(vld1q_s32(b));
+    float32x4_t  vf = vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(f)), DSP_Q16_INV_SCALE);
+    float32x4_t  v = vaddq_f32(va, vmulq_f32(vsubq_f32(vb, va), vf));
+    return vmulq_n_f32(v, DSP_S16_INV_SCALE);
+}
+
+static void resample_s16_f32(float* output, const int16_t* input, int channels,
+                             int frames, uint32_t position, uint32_t step)
+{
+    int32_t  a[4], b[4], f[4];
+    int  nn, kk;
+
+    /* The samples are loaded one by one, and only the interpolation is
+     * done 4 samples at a time.
+     */
+    if (channels == 1) {
+        for (nn = 0; nn + 4 <= frames; nn += 4) {
+            for (kk = 0; kk < 4; kk++) {
+                const int16_t*  in = input + (position >> 16);
+                a[kk] = in[0];
+                b[kk] = in[1];
+                f[kk] = position & 0xffff;
+                position += step;
+            }
+            vst1q_f32(output + nn, lerp4(a, b, f));
+        }
+    } else if (channels == 2) {
+        for (nn = 0; nn + 2 <= frames; nn += 2) {
+            for (kk = 0; kk < 4; kk += 2) {
+                const int16_t*  in = input + (position >> 16) * 2;
+                a[kk]     = in[0];
+                a[kk + 1] = in[1];
+                b[kk]     = in[2];
+                b[kk + 1] = in[3];
+                f[kk] = f[kk + 1] = position & 0xffff;
+                position += step;
+            }
+            vst1q_f32(output + nn*2, lerp4(a, b, f));
+        }
+    } else {
+        nn = 0;
+    }
+    dsp_resample_s16_f32_scalar(output + nn*channels, input, channels, frames - nn,
+                                position, step);
+}
+
+const DspFuncs  dsp_funcs_neon = {
+    fir_s16,
+    fir_f32,
+    biquad_f32,
+    s16_to_f32,
+    f32_to_s16,
+    mix_f32,
+    resample_s16_f32,
+};
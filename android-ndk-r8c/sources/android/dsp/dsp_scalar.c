@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "dsp_internal.h"
+
+void dsp_fir_s16_scalar(int16_t* output, const int16_t* input, const int16_t* kernel,
+                        int width, int kernelSize)
+{
+    int  nn, mm;
+    for (nn = 0; nn < width; nn++) {
+        /* Unsigned, so that overflows wrap around like in the SIMD kernels. */
+        uint32_t  sum = 0;
+        for (mm = 0; mm < kernelSize; mm++)
+            sum += (uint32_t)(kernel[mm] * input[nn + mm]);
+        output[nn] = dsp_round_q16(sum);
+    }
+}
+
+void dsp_fir_f32_scalar(float* output, const float* input, const float* kernel,
+                        int width, int kernelSize)
+{
+    int  nn, mm;
+    for (nn = 0; nn < width; nn++) {
+        float  sum = 0.f;
+        for (mm = 0; mm < kernelSize; mm++)
+            sum += kernel[mm] * input[nn + mm];
+        output[nn] = sum;
+    }
+}
+
+void dsp_biquad_f32_scalar(const DspBiquad* biquad, DspBiquadState* states,
+                           float* output, const float* input, int frames,
+                           int channels, int stride)
+{
+    int  cc, ff;
+    for (cc = 0; cc < channels; cc++) {
+        DspBiquadState  s = states[cc];
+        for (ff = 0; ff < frames; ff++) {
+            float  x = input[ff*stride + cc];
+            float  y = biquad->b0*x + biquad->b1*s.x1 + biquad->b2*s.x2
+                     - biquad->a1*s.y1 - biquad->a2*s.y2;
+            s.x2 = s.x1;
+            s.x1 = x;
+            s.y2 = s.y1;
+            s.y1 = y;
+            output[ff*stride + cc] = y;
+        }
+        states[cc] = s;
+    }
+}
+
+static void biquad_f32(const DspBiquad* biquad, DspBiquadState* states,
+                       float* output, const float* input, int frames, int channels)
+{
+    dsp_biquad_f32_scalar(biquad, states, output, input, frames, channels, channels);
+}
+
+void dsp_s16_to_f32_scalar(float* output, const int16_t* input, int count)
+{
+    int  nn;
+    for (nn = 0; nn < count; nn++)
+        output[nn] = input[nn] * DSP_S16_INV_SCALE;
+}
+
+void dsp_f32_to_s16_scalar(int16_t* output, const float* input, int count)
+{
+    int  nn;
+    for (nn = 0; nn < count; nn++) {
+        float  v = input[nn] * DSP_S16_SCALE;
+        if (v < -32768.f)
+            v = -32768.f;
+        if (v > 32767.f)
+            v = 32767.f;
+        output[nn] = (int16_t)((v + DSP_ROUND_MAGIC) - DSP_ROUND_MAGIC);
+    }
+}
+
+void dsp_mix_f32_scalar(float* output, const float* input, int count, float gain)
+{
+    int  nn;
+    for (nn = 0; nn < count; nn++)
+        output[nn] = output[nn] + input[nn] * gain;
+}
+
+void dsp_resample_s16_f32_scalar(float* output, const int16_t* input, int channels,
+                                 int frames, uint32_t position, uint32_t step)
+{
+    int  nn, cc;
+    for (nn = 0; nn < frames; nn++) {
+        const int16_t*  in = input + (position >> 16) * channels;
+        float  f = (float)(position & 0xffff) * DSP_Q16_INV_SCALE;
+        for (cc = 0; cc < channels; cc++) {
+            float  a = in[cc];
+            float  b = in[channels + cc];
+            output[nn*channels + cc] = (a + (b - a) * f) * DSP_S16_INV_SCALE;
+        }
+        position += step;
+    }
+}
+
+const DspFuncs  dsp_funcs_scalar = {
+    dsp_fir_s16_scalar,
+    dsp_fir_f32_scalar,
+    biquad_f32,
+    dsp_s16_to_f32_scalar,
+    dsp_f32_to_s16_scalar,
+    dsp_mix_f32_scalar,
+    dsp_resample_s16_f32_scalar,
+};
@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* The SSE2 kernels, built for the x86 and host ABIs with -msse2. SSE2 is
+ * part of the x86 ABI.
+ */
+
+#include <emmintrin.h>
+
+#include "dsp_internal.h"
+
+static void fir_s16(int16_t* output, const int16_t* input, const int16_t* kernel,
+                    int width, int kernelSize)
+{
+    const __m128i  round = _mm_set1_epi32(0x8000);
+    int  nn, mm;
+
+    for (nn = 0; nn + 8 <= width; nn += 8) {
+        __m128i  lo = _mm_setzero_si128();
+        __m128i  hi = _mm_setzero_si128();
+
+        /* PMADDWD sums the products of two consecutive taps, so interleave
+         * the samples of 8 outputs for taps 'mm' and 'mm+1'.
+         */
+        for (mm = 0; mm + 2 <= kernelSize; mm += 2) {
+            __m128i  a = _mm_loadu_si128((const __m128i*)(input + nn + mm));
+            __m128i  b = _mm_loadu_si128((const __m128i*)(input + nn + mm + 1));
+            __m128i  k = _mm_set1_epi32((uint16_t)kernel[mm] |
+                                        ((uint32_t)(uint16_t)kernel[mm + 1] << 16));
+            lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), k));
+            hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), k));
+        }
+        if (mm < kernelSize) {
+            __m128i  a = _mm_loadu_si128((const __m128i*)(input + nn + mm));
+            __m128i  k = _mm_set1_epi32((uint16_t)kernel[mm]);
+            __m128i  z = _mm_setzero_si128();
+            lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, z), k));
+            hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, z), k));
+        }
+        /* After the shift, the values fit in 16 bits, so the saturation of
+         * PACKSSDW never happens.
+         */
+        lo = _mm_srai_epi32(_mm_add_epi32(lo, round), 16);
+        hi = _mm_srai_epi32(_mm_add_epi32(hi, round), 16);
+        _mm_storeu_si128((__m128i*)(output + nn), _mm_packs_epi32(lo, hi));
+    }
+    dsp_fir_s16_scalar(output + nn, input + nn, kernel, width - nn, kernelSize);
+}
+
+static void fir_f32(float* output, const float* input, const float* kernel,
+                    int width, int kernelSize)
+{
+    int  nn, mm;
+
+    /* Each lane sums the products of one output in the same order as the
+     * scalar kernel.
+     */
+    for (nn = 0; nn + 8 <= width; nn += 8) {
+        __m128  lo = _mm_setzero_ps();
+        __m128  hi = _mm_setzero_ps();
+        for (mm = 0; mm < kernelSize; mm++) {
+            __m128  k = _mm_set1_ps(kernel[mm]);
+            lo = _mm_add_ps(lo, _mm_mul_ps(k, _mm_loadu_ps(input + nn + mm)));
+            hi = _mm_add_ps(hi, _mm_mul_ps(k, _mm_loadu_ps(input + nn + mm + 4)));
+        }
+        _mm_storeu_ps(output + nn, lo);
+        _mm_storeu_ps(output + nn + 4, hi);
+    }
+    dsp_fir_f32_scalar(output + nn, input + nn, kernel, width - nn, kernelSize);
+}
+
+static void biquad_f32(const DspBiquad* biquad, DspBiquadState* states,
+                       float* output, const float* input, int frames, int channels)
+{
+    const __m128  b0 = _mm_set1_ps(biquad->b0);
+    const __m128  b1 = _mm_set1_ps(biquad->b1);
+    const __m128  b2 = _mm_set1_ps(biquad->b2);
+    const __m128  a1 = _mm_set1_ps(biquad->a1);
+    const __m128  a2 = _mm_set1_ps(biquad->a2);
+    int  cc, ff;
+
+    /* The samples of a channel depend on each other, so 4 channels are
+     * filtered at a time instead.
+     */
+    for (cc = 0; cc + 4 <= channels; cc += 4) {
+        DspBiquadState*  s = states + cc;
+        __m128  x1 = _mm_setr_ps(s[0].x1, s[1].x1, s[2].x1, s[3].x1);
+        __m128  x2 = _mm_setr_ps(s[0].x2, s[1].x2, s[2].x2, s[3].x2);
+        __m128  y1 = _mm_setr_ps(s[0].y1, s[1].y1, s[2].y1, s[3].y1);
+        __m128  y2 = _mm_setr_ps(s[0].y2, s[1].y2, s[2].y2, s[3].y2);
+        float   saved[4][4];
+        int     ii;
+
+        for (ff = 0; ff < frames; ff++) {
+            __m128  x = _mm_loadu_ps(input + ff*channels + cc);
+            __m128  y = _mm_mul_ps(b0, x);
+            y = _mm_add_ps(y, _mm_mul_ps(b1, x1));
+            y = _mm_add_ps(y, _mm_mul_ps(b2, x2));
+            y = _mm_sub_ps(y, _mm_mul_ps(a1, y1));
+            y = _mm_sub_ps(y, _mm_mul_ps(a2, y2));
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = y;
+            _mm_storeu_ps(output + ff*channels + cc, y);
+        }
+
+        _mm_storeu_ps(saved[0], x1);
+        _mm_storeu_ps(saved[1], x2);
+        _mm_storeu_ps(saved[2], y1);
+        _mm_storeu_ps(saved[3], y2);
+        for (ii = 0; ii < 4; ii++) {
+            s[ii].x1 = saved[0][ii];
+            s[ii].x2 = saved[1][ii];
+            s[ii].y1 = saved[2][ii];
+            s[ii].y2 = saved[3][ii];
+        }
+    }
+    dsp_biquad_f32_scalar(biquad, states + cc, output + cc, input + cc, frames,
+                          channels - cc, channels);
+}
+
+static void s16_to_f32(float* output, const int16_t* input, int count)
+{
+    const __m128  scale = _mm_set1_ps(DSP_S16_INV_SCALE);
+    int  nn;
+
+    for (nn = 0; nn + 8 <= count; nn += 8) {
+        __m128i  x = _mm_loadu_si128((const __m128i*)(input + nn));
+        /* Sign-extend by unpacking each sample in the high half. */
+        __m128i  lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        __m128i  hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        _mm_storeu_ps(output + nn, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(output + nn + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    dsp_s16_to_f32_scalar(output + nn, input + nn, count - nn);
+}
+
+static void f32_to_s16(int16_t* output, const float* input, int count)
+{
+    const __m128  scale = _mm_set1_ps(DSP_S16_SCALE);
+    const __m128  lo = _mm_set1_ps(-32768.f);
+    const __m128  hi = _mm_set1_ps(32767.f);
+    int  nn;
+
+    for (nn = 0; nn + 8 <= count; nn += 8) {
+        __m128  a = _mm_mul_ps(_mm_loadu_ps(input + nn), scale);
+        __m128  b = _mm_mul_ps(_mm_loadu_ps(input + nn + 4), scale);
+        a = _mm_min_ps(_mm_max_ps(a, lo), hi);
+        b = _mm_min_ps(_mm_max_ps(b, lo), hi);
+        _mm_storeu_si128((__m128i*)(output + nn),
+                         _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+    dsp_f32_to_s16_scalar(output + nn, input + nn, count - nn);
+}
+
+static void mix_f32(float* output, const float* input, int count, float gain)
+{
+    const __m128  g = _mm_set1_ps(gain);
+    int  nn;
+
+    for (nn = 0; nn + 8 <= count; nn += 8) {
+        __m128  a = _mm_loadu_ps(output + nn);
+        __m128  b = _mm_loadu_ps(output + nn + 4);
+        a = _mm_add_ps(a, _mm_mul_ps(_mm_loadu_ps(input + nn), g));
+        b = _mm_add_ps(b, _mm_mul_ps(_mm_loadu_ps(input + nn + 4), g));
+        _mm_storeu_ps(output + nn, a);
+        _mm_storeu_ps(output + nn + 4, b);
+    }
+    dsp_mix_f32_scalar(output + nn, input + nn, count - nn, gain);
+}
+
+/* Interpolate 4 samples, with the fractions in the low 16 bits of 'p'. */
+static __inline__ __m128 lerp4(__m128i a, __m128i b, __m128i p)
+{
+    __m128  va = _mm_cvtepi32_ps(a);
+    __m128  vb = _mm_cvtepi32_ps(b);
+    __m128  vf = _mm_cvtepi32_ps(_mm_and_si128(p, _mm_set1_epi32(0xffff)));
+    __m128  v;
+    vf = _mm_mul_ps(vf, _mm_set1_ps(DSP_Q16_INV_SCALE));
+    v = _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), vf));
+    return _mm_mul_ps(v, _mm_set1_ps(DSP_S16_INV_SCALE));
+}
+
+static void resample_s16_f32(float* output, const int16_t* input, int channels,
+                             int frames, uint32_t position, uint32_t step)
+{
+    int  nn;
+
+    /* There is no gather in SSE2, so the samples are loaded one by one,
+     * and only the interpolation is done 4 samples at a time.
+     */
+    if (channels == 1) {
+        __m128i  p = _mm_setr_epi32(position, position + step, position + 2*step,
+                                    position + 3*step);
+        const __m128i  step4 = _mm_set1_epi32(4*step);
+        for (nn = 0; nn + 4 <= frames; nn += 4) {
+            const int16_t*  in0 = input + (position >> 16);
+            const int16_t*  in1 = input + ((position + step) >> 16);
+            const int16_t*  in2 = input + ((position + 2*step) >> 16);
+            const int16_t*  in3 = input + ((position + 3*step) >> 16);
+            __m128i  a = _mm_setr_epi32(in0[0], in1[0], in2[0], in3[0]);
+            __m128i  b = _mm_setr_epi32(in0[1], in1[1], in2[1], in3[1]);
+            _mm_storeu_ps(output + nn, lerp4(a, b, p));
+            p = _mm_add_epi32(p, step4);
+            position += 4*step;
+        }
+    } else if (channels == 2) {
+        __m128i  p = _mm_setr_epi32(position, position, position + step, position + step);
+        const __m128i  step2 = _mm_set1_epi32(2*step);
+        for (nn = 0; nn + 2 <= frames; nn += 2) {
+            const int16_t*  in0 = input + (position >> 16) * 2;
+            const int16_t*  in1 = input + ((position + step) >> 16) * 2;
+            __m128i  a = _mm_setr_epi32(in0[0], in0[1], in1[0], in1[1]);
+            __m128i  b = _mm_setr_epi32(in0[2], in0[3], in1[2], in1[3]);
+            _mm_storeu_ps(output + nn*2, lerp4(a, b, p));
+            p = _mm_add_epi32(p, step2);
+            position += 2*step;
+        }
+    } else {
+        nn = 0;
+    }
+    dsp_resample_s16_f32_scalar(output + nn*channels, input, channels, frames - nn,
+                                position, step);
+}
+
+const DspFuncs  dsp_funcs_sse2 = {
+    fir_s16,
+    fir_f32,
+    biquad_f32,
+    s16_to_f32,
+    f32_to_s16,
+    mix_f32,
+    resample_s16_f32,
+};
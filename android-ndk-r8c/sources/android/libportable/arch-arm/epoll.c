@@ -14,7 +14,18 @@
  * limitations under the License.
  */
 
+#include <stddef.h>
 #include <sys/epoll.h>
+#include <epoll_portable.h>
+
+/*
+ * The native struct epoll_event has the same layout as the portable one,
+ * so the events are passed through without any copy.
+ */
+typedef char epoll_event_has_portable_layout
+    [sizeof(struct epoll_event) == sizeof(struct epoll_event_portable) &&
+     offsetof(struct epoll_event, data) ==
+         offsetof(struct epoll_event_portable, data) ? 1 : -1];
 
 int epoll_ctl_portable(int epfd, int op, int fd, struct epoll_event *event)
 {
@@ -15,6 +15,7 @@
  */
 
 #include <pthread.h>
+#include <stdlib.h>
 #include <errno.h>
 #include <errno_portable.h>
 
@@ -25,215 +26,264 @@
 #error Bad build environment
 #endif
 
+/*
+ * Translation tables, indexed by errno value. A zero entry means that the
+ * value is the same for native and portable errnos. EDQUOT is 1133 on MIPS,
+ * so it is handled separately to keep the native table small.
+ */
+static const unsigned short ntop_errno_table[] = {
+    [ENAMETOOLONG] = ENAMETOOLONG_PORTABLE,
+    [ENOLCK] = ENOLCK_PORTABLE,
+    [ENOSYS] = ENOSYS_PORTABLE,
+    [ENOTEMPTY] = ENOTEMPTY_PORTABLE,
+    [ELOOP] = ELOOP_PORTABLE,
+    [EWOULDBLOCK] = EWOULDBLOCK_PORTABLE,
+    [ENOMSG] = ENOMSG_PORTABLE,
+    [EIDRM] = EIDRM_PORTABLE,
+    [ECHRNG] = ECHRNG_PORTABLE,
+    [EL2NSYNC] = EL2NSYNC_PORTABLE,
+    [EL3HLT] = EL3HLT_PORTABLE,
+    [EL3RST] = EL3RST_PORTABLE,
+    [ELNRNG] = ELNRNG_PORTABLE,
+    [EUNATCH] = EUNATCH_PORTABLE,
+    [ENOCSI] = ENOCSI_PORTABLE,
+    [EL2HLT] = EL2HLT_PORTABLE,
+    [EBADE] = EBADE_PORTABLE,
+    [EBADR] = EBADR_PORTABLE,
+    [EXFULL] = EXFULL_PORTABLE,
+    [ENOANO] = ENOANO_PORTABLE,
+    [EBADRQC] = EBADRQC_PORTABLE,
+    [EBADSLT] = EBADSLT_PORTABLE,
+    [EDEADLOCK] = EDEADLOCK_PORTABLE,
+    [EBFONT] = EBFONT_PORTABLE,
+    [ENOSTR] = ENOSTR_PORTABLE,
+    [ENODATA] = ENODATA_PORTABLE,
+    [ETIME] = ETIME_PORTABLE,
+    [ENOSR] = ENOSR_PORTABLE,
+    [ENONET] = ENONET_PORTABLE,
+    [ENOPKG] = ENOPKG_PORTABLE,
+    [EREMOTE] = EREMOTE_PORTABLE,
+    [ENOLINK] = ENOLINK_PORTABLE,
+    [EADV] = EADV_PORTABLE,
+    [ESRMNT] = ESRMNT_PORTABLE,
+    [ECOMM] = ECOMM_PORTABLE,
+    [EPROTO] = EPROTO_PORTABLE,
+    [EMULTIHOP] = EMULTIHOP_PORTABLE,
+    [EDOTDOT] = EDOTDOT_PORTABLE,
+    [EBADMSG] = EBADMSG_PORTABLE,
+    [EOVERFLOW] = EOVERFLOW_PORTABLE,
+    [ENOTUNIQ] = ENOTUNIQ_PORTABLE,
+    [EBADFD] = EBADFD_PORTABLE,
+    [EREMCHG] = EREMCHG_PORTABLE,
+    [ELIBACC] = ELIBACC_PORTABLE,
+    [ELIBBAD] = ELIBBAD_PORTABLE,
+    [ELIBSCN] = ELIBSCN_PORTABLE,
+    [ELIBMAX] = ELIBMAX_PORTABLE,
+    [ELIBEXEC] = ELIBEXEC_PORTABLE,
+    [EILSEQ] = EILSEQ_PORTABLE,
+    [ERESTART] = ERESTART_PORTABLE,
+    [ESTRPIPE] = ESTRPIPE_PORTABLE,
+    [EUSERS] = EUSERS_PORTABLE,
+    [ENOTSOCK] = ENOTSOCK_PORTABLE,
+    [EDESTADDRREQ] = EDESTADDRREQ_PORTABLE,
+    [EMSGSIZE] = EMSGSIZE_PORTABLE,
+    [EPROTOTYPE] = EPROTOTYPE_PORTABLE,
+    [ENOPROTOOPT] = ENOPROTOOPT_PORTABLE,
+    [EPROTONOSUPPORT] = EPROTONOSUPPORT_PORTABLE,
+    [ESOCKTNOSUPPORT] = ESOCKTNOSUPPORT_PORTABLE,
+    [EOPNOTSUPP] = EOPNOTSUPP_PORTABLE,
+    [EPFNOSUPPORT] = EPFNOSUPPORT_PORTABLE,
+    [EAFNOSUPPORT] = EAFNOSUPPORT_PORTABLE,
+    [EADDRINUSE] = EADDRINUSE_PORTABLE,
+    [EADDRNOTAVAIL] = EADDRNOTAVAIL_PORTABLE,
+    [ENETDOWN] = ENETDOWN_PORTABLE,
+    [ENETUNREACH] = ENETUNREACH_PORTABLE,
+    [ENETRESET] = ENETRESET_PORTABLE,
+    [ECONNABORTED] = ECONNABORTED_PORTABLE,
+    [ECONNRESET] = ECONNRESET_PORTABLE,
+    [ENOBUFS] = ENOBUFS_PORTABLE,
+    [EISCONN] = EISCONN_PORTABLE,
+    [ENOTCONN] = ENOTCONN_PORTABLE,
+    [ESHUTDOWN] = ESHUTDOWN_PORTABLE,
+    [ETOOMANYREFS] = ETOOMANYREFS_PORTABLE,
+    [ETIMEDOUT] = ETIMEDOUT_PORTABLE,
+    [ECONNREFUSED] = ECONNREFUSED_PORTABLE,
+    [EHOSTDOWN] = EHOSTDOWN_PORTABLE,
+    [EHOSTUNREACH] = EHOSTUNREACH_PORTABLE,
+    [EALREADY] = EALREADY_PORTABLE,
+    [EINPROGRESS] = EINPROGRESS_PORTABLE,
+    [ESTALE] = ESTALE_PORTABLE,
+    [EUCLEAN] = EUCLEAN_PORTABLE,
+    [ENOTNAM] = ENOTNAM_PORTABLE,
+    [ENAVAIL] = ENAVAIL_PORTABLE,
+    [EISNAM] = EISNAM_PORTABLE,
+    [EREMOTEIO] = EREMOTEIO_PORTABLE,
+    [ENOMEDIUM] = ENOMEDIUM_PORTABLE,
+    [EMEDIUMTYPE] = EMEDIUMTYPE_PORTABLE,
+    [ECANCELED] = ECANCELED_PORTABLE,
+    [ENOKEY] = ENOKEY_PORTABLE,
+    [EKEYEXPIRED] = EKEYEXPIRED_PORTABLE,
+    [EKEYREVOKED] = EKEYREVOKED_PORTABLE,
+    [EKEYREJECTED] = EKEYREJECTED_PORTABLE,
+    [EOWNERDEAD] = EOWNERDEAD_PORTABLE,
+    [ENOTRECOVERABLE] = ENOTRECOVERABLE_PORTABLE,
+};
+
+static const unsigned short pton_errno_table[] = {
+    [ENAMETOOLONG_PORTABLE] = ENAMETOOLONG,
+    [ENOLCK_PORTABLE] = ENOLCK,
+    [ENOSYS_PORTABLE] = ENOSYS,
+    [ENOTEMPTY_PORTABLE] = ENOTEMPTY,
+    [ELOOP_PORTABLE] = ELOOP,
+    [EWOULDBLOCK_PORTABLE] = EWOULDBLOCK,
+    [ENOMSG_PORTABLE] = ENOMSG,
+    [EIDRM_PORTABLE] = EIDRM,
+    [ECHRNG_PORTABLE] = ECHRNG,
+    [EL2NSYNC_PORTABLE] = EL2NSYNC,
+    [EL3HLT_PORTABLE] = EL3HLT,
+    [EL3RST_PORTABLE] = EL3RST,
+    [ELNRNG_PORTABLE] = ELNRNG,
+    [EUNATCH_PORTABLE] = EUNATCH,
+    [ENOCSI_PORTABLE] = ENOCSI,
+    [EL2HLT_PORTABLE] = EL2HLT,
+    [EBADE_PORTABLE] = EBADE,
+    [EBADR_PORTABLE] = EBADR,
+    [EXFULL_PORTABLE] = EXFULL,
+    [ENOANO_PORTABLE] = ENOANO,
+    [EBADRQC_PORTABLE] = EBADRQC,
+    [EBADSLT_PORTABLE] = EBADSLT,
+    [EDEADLOCK_PORTABLE] = EDEADLOCK,
+    [EBFONT_PORTABLE] = EBFONT,
+    [ENOSTR_PORTABLE] = ENOSTR,
+    [ENODATA_PORTABLE] = ENODATA,
+    [ETIME_PORTABLE] = ETIME,
+    [ENOSR_PORTABLE] = ENOSR,
+    [ENONET_PORTABLE] = ENONET,
+    [ENOPKG_PORTABLE] = ENOPKG,
+    [EREMOTE_PORTABLE] = EREMOTE,
+    [ENOLINK_PORTABLE] = ENOLINK,
+    [EADV_PORTABLE] = EADV,
+    [ESRMNT_PORTABLE] = ESRMNT,
+    [ECOMM_PORTABLE] = ECOMM,
+    [EPROTO_PORTABLE] = EPROTO,
+    [EMULTIHOP_PORTABLE] = EMULTIHOP,
+    [EDOTDOT_PORTABLE] = EDOTDOT,
+    [EBADMSG_PORTABLE] = EBADMSG,
+    [EOVERFLOW_PORTABLE] = EOVERFLOW,
+    [ENOTUNIQ_PORTABLE] = ENOTUNIQ,
+    [EBADFD_PORTABLE] = EBADFD,
+    [EREMCHG_PORTABLE] = EREMCHG,
+    [ELIBACC_PORTABLE] = ELIBACC,
+    [ELIBBAD_PORTABLE] = ELIBBAD,
+    [ELIBSCN_PORTABLE] = ELIBSCN,
+    [ELIBMAX_PORTABLE] = ELIBMAX,
+    [ELIBEXEC_PORTABLE] = ELIBEXEC,
+    [EILSEQ_PORTABLE] = EILSEQ,
+    [ERESTART_PORTABLE] = ERESTART,
+    [ESTRPIPE_PORTABLE] = ESTRPIPE,
+    [EUSERS_PORTABLE] = EUSERS,
+    [ENOTSOCK_PORTABLE] = ENOTSOCK,
+    [EDESTADDRREQ_PORTABLE] = EDESTADDRREQ,
+    [EMSGSIZE_PORTABLE] = EMSGSIZE,
+    [EPROTOTYPE_PORTABLE] = EPROTOTYPE,
+    [ENOPROTOOPT_PORTABLE] = ENOPROTOOPT,
+    [EPROTONOSUPPORT_PORTABLE] = EPROTONOSUPPORT,
+    [ESOCKTNOSUPPORT_PORTABLE] = ESOCKTNOSUPPORT,
+    [EOPNOTSUPP_PORTABLE] = EOPNOTSUPP,
+    [EPFNOSUPPORT_PORTABLE] = EPFNOSUPPORT,
+    [EAFNOSUPPORT_PORTABLE] = EAFNOSUPPORT,
+    [EADDRINUSE_PORTABLE] = EADDRINUSE,
+    [EADDRNOTAVAIL_PORTABLE] = EADDRNOTAVAIL,
+    [ENETDOWN_PORTABLE] = ENETDOWN,
+    [ENETUNREACH_PORTABLE] = ENETUNREACH,
+    [ENETRESET_PORTABLE] = ENETRESET,
+    [ECONNABORTED_PORTABLE] = ECONNABORTED,
+    [ECONNRESET_PORTABLE] = ECONNRESET,
+    [ENOBUFS_PORTABLE] = ENOBUFS,
+    [EISCONN_PORTABLE] = EISCONN,
+    [ENOTCONN_PORTABLE] = ENOTCONN,
+    [ESHUTDOWN_PORTABLE] = ESHUTDOWN,
+    [ETOOMANYREFS_PORTABLE] = ETOOMANYREFS,
+    [ETIMEDOUT_PORTABLE] = ETIMEDOUT,
+    [ECONNREFUSED_PORTABLE] = ECONNREFUSED,
+    [EHOSTDOWN_PORTABLE] = EHOSTDOWN,
+    [EHOSTUNREACH_PORTABLE] = EHOSTUNREACH,
+    [EALREADY_PORTABLE] = EALREADY,
+    [EINPROGRESS_PORTABLE] = EINPROGRESS,
+    [ESTALE_PORTABLE] = ESTALE,
+    [EUCLEAN_PORTABLE] = EUCLEAN,
+    [ENOTNAM_PORTABLE] = ENOTNAM,
+    [ENAVAIL_PORTABLE] = ENAVAIL,
+    [EISNAM_PORTABLE] = EISNAM,
+    [EREMOTEIO_PORTABLE] = EREMOTEIO,
+    [EDQUOT_PORTABLE] = EDQUOT,
+    [ENOMEDIUM_PORTABLE] = ENOMEDIUM,
+    [EMEDIUMTYPE_PORTABLE] = EMEDIUMTYPE,
+    [ECANCELED_PORTABLE] = ECANCELED,
+    [ENOKEY_PORTABLE] = ENOKEY,
+    [EKEYEXPIRED_PORTABLE] = EKEYEXPIRED,
+    [EKEYREVOKED_PORTABLE] = EKEYREVOKED,
+    [EKEYREJECTED_PORTABLE] = EKEYREJECTED,
+    [EOWNERDEAD_PORTABLE] = EOWNERDEAD,
+    [ENOTRECOVERABLE_PORTABLE] = ENOTRECOVERABLE,
+};
+
+#define ERRNO_TABLE_SIZE(table)  (int)(sizeof(table) / sizeof(table[0]))
+
 __hidden int ntop_errno(int native_errno)
 {
-    switch (native_errno) {
-      case ENAMETOOLONG: return ENAMETOOLONG_PORTABLE;
-      case ENOLCK: return ENOLCK_PORTABLE;
-      case ENOSYS: return ENOSYS_PORTABLE;
-      case ENOTEMPTY: return ENOTEMPTY_PORTABLE;
-      case ELOOP: return ELOOP_PORTABLE;
-      case EWOULDBLOCK: return EWOULDBLOCK_PORTABLE;
-      case ENOMSG: return ENOMSG_PORTABLE;
-      case EIDRM: return EIDRM_PORTABLE;
-      case ECHRNG: return ECHRNG_PORTABLE;
-      case EL2NSYNC: return EL2NSYNC_PORTABLE;
-      case EL3HLT: return EL3HLT_PORTABLE;
-      case EL3RST: return EL3RST_PORTABLE;
-      case ELNRNG: return ELNRNG_PORTABLE;
-      case EUNATCH: return EUNATCH_PORTABLE;
-      case ENOCSI: return ENOCSI_PORTABLE;
-      case EL2HLT: return EL2HLT_PORTABLE;
-      case EBADE: return EBADE_PORTABLE;
-      case EBADR: return EBADR_PORTABLE;
-      case EXFULL: return EXFULL_PORTABLE;
-      case ENOANO: return ENOANO_PORTABLE;
-      case EBADRQC: return EBADRQC_PORTABLE;
-      case EBADSLT: return EBADSLT_PORTABLE;
-      case EDEADLOCK: return EDEADLOCK_PORTABLE;
-      case EBFONT: return EBFONT_PORTABLE;
-      case ENOSTR: return ENOSTR_PORTABLE;
-      case ENODATA: return ENODATA_PORTABLE;
-      case ETIME: return ETIME_PORTABLE;
-      case ENOSR: return ENOSR_PORTABLE;
-      case ENONET: return ENONET_PORTABLE;
-      case ENOPKG: return ENOPKG_PORTABLE;
-      case EREMOTE: return EREMOTE_PORTABLE;
-      case ENOLINK: return ENOLINK_PORTABLE;
-      case EADV: return EADV_PORTABLE;
-      case ESRMNT: return ESRMNT_PORTABLE;
-      case ECOMM: return ECOMM_PORTABLE;
-      case EPROTO: return EPROTO_PORTABLE;
-      case EMULTIHOP: return EMULTIHOP_PORTABLE;
-      case EDOTDOT: return EDOTDOT_PORTABLE;
-      case EBADMSG: return EBADMSG_PORTABLE;
-      case EOVERFLOW: return EOVERFLOW_PORTABLE;
-      case ENOTUNIQ: return ENOTUNIQ_PORTABLE;
-      case EBADFD: return EBADFD_PORTABLE;
-      case EREMCHG: return EREMCHG_PORTABLE;
-      case ELIBACC: return ELIBACC_PORTABLE;
-      case ELIBBAD: return ELIBBAD_PORTABLE;
-      case ELIBSCN: return ELIBSCN_PORTABLE;
-      case ELIBMAX: return ELIBMAX_PORTABLE;
-      case ELIBEXEC: return ELIBEXEC_PORTABLE;
-      case EILSEQ: return EILSEQ_PORTABLE;
-      case ERESTART: return ERESTART_PORTABLE;
-      case ESTRPIPE: return ESTRPIPE_PORTABLE;
-      case EUSERS: return EUSERS_PORTABLE;
-      case ENOTSOCK: return ENOTSOCK_PORTABLE;
-      case EDESTADDRREQ: return EDESTADDRREQ_PORTABLE;
-      case EMSGSIZE: return EMSGSIZE_PORTABLE;
-      case EPROTOTYPE: return EPROTOTYPE_PORTABLE;
-      case ENOPROTOOPT: return ENOPROTOOPT_PORTABLE;
-      case EPROTONOSUPPORT: return EPROTONOSUPPORT_PORTABLE;
-      case ESOCKTNOSUPPORT: return ESOCKTNOSUPPORT_PORTABLE;
-      case EOPNOTSUPP: return EOPNOTSUPP_PORTABLE;
-      case EPFNOSUPPORT: return EPFNOSUPPORT_PORTABLE;
-      case EAFNOSUPPORT: return EAFNOSUPPORT_PORTABLE;
-      case EADDRINUSE: return EADDRINUSE_PORTABLE;
-      case EADDRNOTAVAIL: return EADDRNOTAVAIL_PORTABLE;
-      case ENETDOWN: return ENETDOWN_PORTABLE;
-      case ENETUNREACH: return ENETUNREACH_PORTABLE;
-      case ENETRESET: return ENETRESET_PORTABLE;
-      case ECONNABORTED: return ECONNABORTED_PORTABLE;
-      case ECONNRESET: return ECONNRESET_PORTABLE;
-      case ENOBUFS: return ENOBUFS_PORTABLE;
-      case EISCONN: return EISCONN_PORTABLE;
-      case ENOTCONN: return ENOTCONN_PORTABLE;
-      case ESHUTDOWN: return ESHUTDOWN_PORTABLE;
-      case ETOOMANYREFS: return ETOOMANYREFS_PORTABLE;
-      case ETIMEDOUT: return ETIMEDOUT_PORTABLE;
-      case ECONNREFUSED: return ECONNREFUSED_PORTABLE;
-      case EHOSTDOWN: return EHOSTDOWN_PORTABLE;
-      case EHOSTUNREACH: return EHOSTUNREACH_PORTABLE;
-      case EALREADY: return EALREADY_PORTABLE;
-      case EINPROGRESS: return EINPROGRESS_PORTABLE;
-      case ESTALE: return ESTALE_PORTABLE;
-      case EUCLEAN: return EUCLEAN_PORTABLE;
-      case ENOTNAM: return ENOTNAM_PORTABLE;
-      case ENAVAIL: return ENAVAIL_PORTABLE;
-      case EISNAM: return EISNAM_PORTABLE;
-      case EREMOTEIO: return EREMOTEIO_PORTABLE;
-      case EDQUOT: return EDQUOT_PORTABLE;
-      case ENOMEDIUM: return ENOMEDIUM_PORTABLE;
-      case EMEDIUMTYPE: return EMEDIUMTYPE_PORTABLE;
-      case ECANCELED: return ECANCELED_PORTABLE;
-      case ENOKEY: return ENOKEY_PORTABLE;
-      case EKEYEXPIRED: return EKEYEXPIRED_PORTABLE;
-      case EKEYREVOKED: return EKEYREVOKED_PORTABLE;
-      case EKEYREJECTED: return EKEYREJECTED_PORTABLE;
-      case EOWNERDEAD: return EOWNERDEAD_PORTABLE;
-      case ENOTRECOVERABLE: return ENOTRECOVERABLE_PORTABLE;
+    if ((unsigned)native_errno < ERRNO_TABLE_SIZE(ntop_errno_table)) {
+        int portable_errno = ntop_errno_table[native_errno];
+        if (portable_errno != 0)
+            return portable_errno;
+    } else if (native_errno == EDQUOT) {
+        return EDQUOT_PORTABLE;
     }
     return native_errno;
 }
 
 static inline int pton_errno(int portable_errno)
 {
-    switch (portable_errno) {
-      case ENAMETOOLONG_PORTABLE: return ENAMETOOLONG;
-      case ENOLCK_PORTABLE: return ENOLCK;
-      case ENOSYS_PORTABLE: return ENOSYS;
-      case ENOTEMPTY_PORTABLE: return ENOTEMPTY;
-      case ELOOP_PORTABLE: return ELOOP;
-      case EWOULDBLOCK_PORTABLE: return EWOULDBLOCK;
-      case ENOMSG_PORTABLE: return ENOMSG;
-      case EIDRM_PORTABLE: return EIDRM;
-      case ECHRNG_PORTABLE: return ECHRNG;
-      case EL2NSYNC_PORTABLE: return EL2NSYNC;
-      case EL3HLT_PORTABLE: return EL3HLT;
-      case EL3RST_PORTABLE: return EL3RST;
-      case ELNRNG_PORTABLE: return ELNRNG;
-      case EUNATCH_PORTABLE: return EUNATCH;
-      case ENOCSI_PORTABLE: return ENOCSI;
-      case EL2HLT_PORTABLE: return EL2HLT;
-      case EBADE_PORTABLE: return EBADE;
-      case EBADR_PORTABLE: return EBADR;
-      case EXFULL_PORTABLE: return EXFULL;
-      case ENOANO_PORTABLE: return ENOANO;
-      case EBADRQC_PORTABLE: return EBADRQC;
-      case EBADSLT_PORTABLE: return EBADSLT;
-      case EDEADLOCK_PORTABLE: return EDEADLOCK;
-      case EBFONT_PORTABLE: return EBFONT;
-      case ENOSTR_PORTABLE: return ENOSTR;
-      case ENODATA_PORTABLE: return ENODATA;
-      case ETIME_PORTABLE: return ETIME;
-      case ENOSR_PORTABLE: return ENOSR;
-      case ENONET_PORTABLE: return ENONET;
-      case ENOPKG_PORTABLE: return ENOPKG;
-      case EREMOTE_PORTABLE: return EREMOTE;
-      case ENOLINK_PORTABLE: return ENOLINK;
-      case EADV_PORTABLE: return EADV;
-      case ESRMNT_PORTABLE: return ESRMNT;
-      case ECOMM_PORTABLE: return ECOMM;
-      case EPROTO_PORTABLE: return EPROTO;
-      case EMULTIHOP_PORTABLE: return EMULTIHOP;
-      case EDOTDOT_PORTABLE: return EDOTDOT;
-      case EBADMSG_PORTABLE: return EBADMSG;
-      case EOVERFLOW_PORTABLE: return EOVERFLOW;
-      case ENOTUNIQ_PORTABLE: return ENOTUNIQ;
-      case EBADFD_PORTABLE: return EBADFD;
-      case EREMCHG_PORTABLE: return EREMCHG;
-      case ELIBACC_PORTABLE: return ELIBACC;
-      case ELIBBAD_PORTABLE: return ELIBBAD;
-      case ELIBSCN_PORTABLE: return ELIBSCN;
-      case ELIBMAX_PORTABLE: return ELIBMAX;
-      case ELIBEXEC_PORTABLE: return ELIBEXEC;
-      case EILSEQ_PORTABLE: return EILSEQ;
-      case ERESTART_PORTABLE: return ERESTART;
-      case ESTRPIPE_PORTABLE: return ESTRPIPE;
-      case EUSERS_PORTABLE: return EUSERS;
-      case ENOTSOCK_PORTABLE: return ENOTSOCK;
-      case EDESTADDRREQ_PORTABLE: return EDESTADDRREQ;
-      case EMSGSIZE_PORTABLE: return EMSGSIZE;
-      case EPROTOTYPE_PORTABLE: return EPROTOTYPE;
-      case ENOPROTOOPT_PORTABLE: return ENOPROTOOPT;
-      case EPROTONOSUPPORT_PORTABLE: return EPROTONOSUPPORT;
-      case ESOCKTNOSUPPORT_PORTABLE: return ESOCKTNOSUPPORT;
-      case EOPNOTSUPP_PORTABLE: return EOPNOTSUPP;
-      case EPFNOSUPPORT_PORTABLE: return EPFNOSUPPORT;
-      case EAFNOSUPPORT_PORTABLE: return EAFNOSUPPORT;
-      case EADDRINUSE_PORTABLE: return EADDRINUSE;
-      case EADDRNOTAVAIL_PORTABLE: return EADDRNOTAVAIL;
-      case ENETDOWN_PORTABLE: return ENETDOWN;
-      case ENETUNREACH_PORTABLE: return ENETUNREACH;
-      case ENETRESET_PORTABLE: return ENETRESET;
-      case ECONNABORTED_PORTABLE: return ECONNABORTED;
-      case ECONNRESET_PORTABLE: return ECONNRESET;
-      case ENOBUFS_PORTABLE: return ENOBUFS;
-      case EISCONN_PORTABLE: return EISCONN;
-      case ENOTCONN_PORTABLE: return ENOTCONN;
-      case ESHUTDOWN_PORTABLE: return ESHUTDOWN;
-      case ETOOMANYREFS_PORTABLE: return ETOOMANYREFS;
-      case ETIMEDOUT_PORTABLE: return ETIMEDOUT;
-      case ECONNREFUSED_PORTABLE: return ECONNREFUSED;
-      case EHOSTDOWN_PORTABLE: return EHOSTDOWN;
-      case EHOSTUNREACH_PORTABLE: return EHOSTUNREACH;
-      case EALREADY_PORTABLE: return EALREADY;
-      case EINPROGRESS_PORTABLE: return EINPROGRESS;
-      case ESTALE_PORTABLE: return ESTALE;
-      case EUCLEAN_PORTABLE: return EUCLEAN;
-      case ENOTNAM_PORTABLE: return ENOTNAM;
-      case ENAVAIL_PORTABLE: return ENAVAIL;
-      case EISNAM_PORTABLE: return EISNAM;
-      case EREMOTEIO_PORTABLE: return EREMOTEIO;
-      case EDQUOT_PORTABLE: return EDQUOT;
-      case ENOMEDIUM_PORTABLE: return ENOMEDIUM;
-      case EMEDIUMTYPE_PORTABLE: return EMEDIUMTYPE;
-      case ECANCELED_PORTABLE: return ECANCELED;
-      case ENOKEY_PORTABLE: return ENOKEY;
-      case EKEYEXPIRED_PORTABLE: return EKEYEXPIRED;
-      case EKEYREVOKED_PORTABLE: return EKEYREVOKED;
-      case EKEYREJECTED_PORTABLE: return EKEYREJECTED;
-      case EOWNERDEAD_PORTABLE: return EOWNERDEAD;
-      case ENOTRECOVERABLE_PORTABLE: return ENOTRECOVERABLE;
+    if ((unsigned)portable_errno < ERRNO_TABLE_SIZE(pton_errno_table)) {
+        int native_errno = pton_errno_table[portable_errno];
+        if (native_errno != 0)
+            return native_errno;
     }
     return portable_errno;
 }
 
+struct errno_state {
+    int pshadow;                /* copy of last portable errno */
+    int perrno;                 /* portable errno that may be modified by app */
+};
+
+/*
+ * Bionic doesn't support __thread (see docs/system/libc/OVERVIEW.html), and
+ * the NDK toolchains emulate it with a pthread key and an allocation per thread,
+ * so a pthread key is used directly. Define LIBPORTABLE_USE_TLS to use
+ * __thread instead, with a toolchain and C library that support native TLS.
+ */
+#ifdef LIBPORTABLE_USE_TLS
+
+static __thread struct errno_state errno_state_tls;
+
+/* Return the thread-specific portable errno */
+static inline struct errno_state *errno_key_data(void)
+{
+    return &errno_state_tls;
+}
+
+#else /* !LIBPORTABLE_USE_TLS */
+
 /* Key for the thread-specific portable errno */
 static pthread_key_t errno_key;
 
+/*
+ * The key plus one once it is allocated, 0 before. It is a single word, so
+ * that the key can be read without pthread_once() or a memory barrier.
+ */
+static volatile int errno_key_cache;
+
 /* Once-only initialisation of the key */
 static pthread_once_t errno_key_once = PTHREAD_ONCE_INIT;
 
@@ -247,31 +297,35 @@ static void errno_key_destroy(void *buf)
 /* Allocate the key */
 static void errno_key_create(void)
 {
-    pthread_key_create(&errno_key, errno_key_destroy);
+    if (pthread_key_create(&errno_key, errno_key_destroy) == 0)
+        errno_key_cache = (int)errno_key + 1;
 }
 
-struct errno_state {
-    int pshadow;                /* copy of last portable errno */
-    int perrno;                 /* portable errno that may be modified by app */
-};
-
 /* Return the thread-specific portable errno */
 static struct errno_state *errno_key_data(void)
 {
     struct errno_state *data;
     static struct errno_state errno_state;
+    int key = errno_key_cache;
 
-    pthread_once(&errno_key_once, errno_key_create);
-    data = (struct errno_state *)pthread_getspecific(errno_key);
+    if (key == 0) {
+        pthread_once(&errno_key_once, errno_key_create);
+        key = errno_key_cache;
+        if (key == 0)
+            return &errno_state;
+    }
+    data = (struct errno_state *)pthread_getspecific((pthread_key_t)(key - 1));
     if (data == NULL) {
-        data = malloc(sizeof(struct errno_state));
-        pthread_setspecific(errno_key, data);
+        data = calloc(1, sizeof(struct errno_state));
+        pthread_setspecific((pthread_key_t)(key - 1), data);
     }
     if (data == NULL)
         data = &errno_state;
     return data;
 }
 
+#endif /* !LIBPORTABLE_USE_TLS */
+
 /*
  * Attempt to return a thread specific location containnig the portable errno.
  * This can be assigned to without affecting the native errno. If the key
@@ -54,14 +54,15 @@ int poll_portable(struct pollfd *fds, nfds_t nfds, long timeout)
   nfds_t i;
   int ret;
 
+  /* The array is converted in place, in a single pass each way. */
   for (i = 0; i < nfds; i++)
-      fds->events = mips_change_portable_events(fds->events);
+      fds[i].events = mips_change_portable_events(fds[i].events);
 
   ret = poll(fds, nfds, timeout);
 
   for (i = 0; i < nfds; i++) {
-      fds->events = change_mips_events(fds->events);
-      fds->revents = change_mips_events(fds->revents);
+      fds[i].events = change_mips_events(fds[i].events);
+      fds[i].revents = change_mips_events(fds[i].revents);
   }
 
   return ret;
@@ -14,13 +14,27 @@
  * limitations under the License.
  */
 
+#include <string.h>
 #include <sys/epoll.h>
 #include <epoll_portable.h>
 
+/*
+ * The x86 struct epoll_event is packed (12 bytes), while the portable one
+ * is 16 bytes, so the events must be converted. A portable array of 'max'
+ * events is always large enough to hold 'max' native events, so it is used
+ * as the native buffer by epoll_wait() and then widened in place.
+ */
+typedef char epoll_event_x86_fits_in_portable
+    [sizeof(struct epoll_event) <= sizeof(struct epoll_event_portable) ? 1 : -1];
+
 int epoll_ctl_portable(int epfd, int op, int fd, struct epoll_event_portable *event)
 {
     struct epoll_event x86_epoll_event;
 
+    /* EPOLL_CTL_DEL ignores the event, which may be NULL. */
+    if (event == NULL)
+        return epoll_ctl(epfd, op, fd, NULL);
+
     x86_epoll_event.events = event->events;
     x86_epoll_event.data = event->data;
 
@@ -29,12 +43,21 @@ int epoll_ctl_portable(int epfd, int op, int fd, struct epoll_event_portable *ev
 
 int epoll_wait_portable(int epfd, struct epoll_event_portable *events, int max, int timeout)
 {
+    struct epoll_event *x86_epoll_events = (struct epoll_event *)(void *)events;
     struct epoll_event x86_epoll_event;
-    int ret = epoll_wait(epfd, &x86_epoll_event, max, timeout);
-
-    events->events = x86_epoll_event.events;
-    events->data = x86_epoll_event.data;
+    int ret = epoll_wait(epfd, x86_epoll_events, max, timeout);
+    int i;
+
+    /*
+     * Widen from the last event to the first one: portable event i never
+     * overlaps the native events 0..i-1 that are still to be converted.
+     */
+    for (i = ret - 1; i >= 0; i--) {
+        memcpy(&x86_epoll_event, &x86_epoll_events[i], sizeof(x86_epoll_event));
+        events[i].events = x86_epoll_event.events;
+        memset(events[i].__padding, 0, sizeof(events[i].__padding));
+        events[i].data = x86_epoll_event.data;
+    }
 
     return ret;
 }
-
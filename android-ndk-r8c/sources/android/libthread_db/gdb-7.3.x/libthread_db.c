@@ -2,7 +2,6 @@
  * Copyright 2006 The Android Open Source Project
  */
 
-#include <dirent.h>
 #include <sys/ptrace.h>
 #include <stdint.h>
 #include <thread_db.h>
@@ -11,10 +10,13 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <string.h>
+#include <sys/syscall.h>
 
+#ifndef DEBUG
 #define DEBUG 1
+#endif
 #if DEBUG
-#  include <string.h>  /* for strerror() */
 #  define D(...)  fprintf(stderr, "libthread_db:%s: ", __FUNCTION__), fprintf(stderr, __VA_ARGS__)
 #else
 #  define D(...)  do{}while(0)
@@ -103,6 +105,356 @@ EXIT:
 }
 
 
+/*
+ * Listing /proc/<pid>/task with opendir()/readdir() every time gdbserver
+ * asks is slow for processes with thousands of threads, so each agent
+ * keeps a cache of the threads, sorted by tid:
+ *
+ * - The task directory stays open, and is read again from its start with
+ *   large getdents64() calls.
+ * - Each new listing is merged with the cached one, which tells which
+ *   threads appeared since the previous one, and keeps what is known
+ *   about the others.
+ * - The state of a thread is read from /proc/<pid>/task/<tid>/stat when
+ *   it is needed, at most once per listing. It can't be kept longer: a
+ *   thread traced by gdbserver stays listed as a zombie after it exits,
+ *   until gdbserver waits on it, and the main thread stays a zombie until
+ *   the whole process exits.
+ */
+
+#define DIRENTS_SIZE  (64*1024)
+
+/* An entry returned by getdents64() */
+struct td_dirent64 {
+    uint64_t        d_ino;
+    int64_t         d_off;
+    unsigned short  d_reclen;
+    unsigned char   d_type;
+    char            d_name[1];
+};
+
+typedef struct {
+    pid_t           tid;
+    td_thr_state_e  state;
+    unsigned        state_generation;  /* listing 'state' was read in, 0 if none */
+    unsigned        generation;        /* first listing of the thread */
+} td_thread_entry;
+
+struct td_thread_cache {
+    struct td_thread_cache * next;     /* in gCaches */
+    pid_t               pid;
+    int                 task_fd;       /* /proc/<pid>/task */
+    unsigned            generation;    /* number of listings */
+    unsigned            reported;      /* last listing iterated over */
+    int                 iterating;
+    td_thread_entry *   threads;
+    int                 count;
+    td_thread_entry *   merged;        /* spare array for the merge */
+    int                 capacity;      /* of 'threads' and 'merged' */
+    pid_t *             tids;          /* tids of the last listing */
+    int                 tids_capacity;
+    char *              dirents;       /* DIRENTS_SIZE bytes */
+};
+
+/* td_thr_get_info() only gets a pid and a tid, so it finds the cache of
+ * the agent in this list.
+ */
+static struct td_thread_cache * gCaches;
+
+
+static struct td_thread_cache *
+_thread_cache_new(pid_t pid)
+{
+    char path[32];
+    struct td_thread_cache * cache;
+
+    cache = (struct td_thread_cache *)calloc(1, sizeof *cache);
+    if (!cache) {
+        return NULL;
+    }
+    cache->pid = pid;
+    cache->dirents = (char *)malloc(DIRENTS_SIZE);
+    snprintf(path, sizeof path, "/proc/%d/task", pid);
+    cache->task_fd = open(path, O_RDONLY | O_DIRECTORY);
+    if (!cache->dirents || cache->task_fd < 0) {
+        D("Could not open %s: %s\n", path, strerror(errno));
+        if (cache->task_fd >= 0)
+            close(cache->task_fd);
+        free(cache->dirents);
+        free(cache);
+        return NULL;
+    }
+    /* not for the processes that gdbserver starts */
+    fcntl(cache->task_fd, F_SETFD, FD_CLOEXEC);
+
+    cache->next = gCaches;
+    gCaches = cache;
+    return cache;
+}
+
+
+static void
+_thread_cache_free(struct td_thread_cache * cache)
+{
+    struct td_thread_cache ** link;
+
+    if (!cache) {
+        return;
+    }
+    for (link = &gCaches; *link != NULL; link = &(*link)->next) {
+        if (*link == cache) {
+            *link = cache->next;
+            break;
+        }
+    }
+    close(cache->task_fd);
+    free(cache->threads);
+    free(cache->merged);
+    free(cache->tids);
+    free(cache->dirents);
+    free(cache);
+}
+
+
+static struct td_thread_cache *
+_thread_cache_find(pid_t pid)
+{
+    struct td_thread_cache * cache;
+
+    for (cache = gCaches; cache != NULL; cache = cache->next) {
+        if (cache->pid == pid) {
+            return cache;
+        }
+    }
+    return NULL;
+}
+
+
+static int
+_compare_tids(const void * a, const void * b)
+{
+    pid_t x = *(const pid_t *)a;
+    pid_t y = *(const pid_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+
+/* Read the tids in the task directory into cache->tids, sorted, and
+ * return their number, or -1 on error.
+ */
+static int
+_thread_cache_list(struct td_thread_cache * cache)
+{
+    int count = 0;
+    int sorted = 1;
+
+    if (lseek(cache->task_fd, 0, SEEK_SET) < 0) {
+        D("Could not rewind the task directory of %d: %s\n", cache->pid, strerror(errno));
+        return -1;
+    }
+    for (;;) {
+        int len, pos;
+
+        do {
+            len = syscall(__NR_getdents64, cache->task_fd, cache->dirents, DIRENTS_SIZE);
+        } while (len < 0 && errno == EINTR);
+
+        if (len < 0) {
+            D("Could not read the task directory of %d: %s\n", cache->pid, strerror(errno));
+            return -1;
+        }
+        if (len == 0) {
+            break;
+        }
+        for (pos = 0; pos < len; ) {
+            struct td_dirent64 * entry = (struct td_dirent64 *)(cache->dirents + pos);
+            pid_t tid;
+
+            pos += entry->d_reclen;
+            if (entry->d_name[0] == '.')   /* skip . and .. */
+                continue;
+
+            tid = atoi(entry->d_name);
+            if (tid <= 0)  /* should not happen - be safe */
+                continue;
+
+            if (count == cache->tids_capacity) {
+                int capacity = count ? 2*count : 256;
+                pid_t * tids = (pid_t *)realloc(cache->tids, capacity * sizeof(pid_t));
+                if (!tids) {
+                    return -1;
+                }
+                cache->tids = tids;
+                cache->tids_capacity = capacity;
+            }
+            if (count > 0 && tid < cache->tids[count-1]) {
+                sorted = 0;
+            }
+            cache->tids[count++] = tid;
+        }
+    }
+
+    /* The kernel lists the threads by creation time, which is also the
+     * order of the tids until they wrap around.
+     */
+    if (!sorted) {
+        qsort(cache->tids, count, sizeof(pid_t), _compare_tids);
+    }
+    return count;
+}
+
+
+/* List the threads again, and merge them with the cached ones. Return 0
+ * on success, or -1 on error.
+ */
+static int
+_thread_cache_refresh(struct td_thread_cache * cache)
+{
+    int count = _thread_cache_list(cache);
+    int old = 0, n = 0, i;
+
+    if (count < 0) {
+        return -1;
+    }
+    if (count > cache->capacity) {
+        int capacity = cache->capacity ? cache->capacity : 256;
+        td_thread_entry * threads;
+
+        while (capacity < count)
+            capacity *= 2;
+        threads = (td_thread_entry *)realloc(cache->threads, capacity * sizeof(td_thread_entry));
+        if (!threads) {
+            return -1;
+        }
+        cache->threads = threads;
+        free(cache->merged);
+        cache->merged = (td_thread_entry *)malloc(capacity * sizeof(td_thread_entry));
+        if (!cache->merged) {
+            return -1;
+        }
+        cache->capacity = capacity;
+    }
+
+    cache->generation++;
+    for (i = 0; i < count; i++) {
+        pid_t tid = cache->tids[i];
+
+        /* A thread can be listed twice if others exit meanwhile */
+        if (n > 0 && cache->merged[n-1].tid == tid)
+            continue;
+
+        while (old < cache->count && cache->threads[old].tid < tid)
+            old++;
+        if (old < cache->count && cache->threads[old].tid == tid) {
+            cache->merged[n] = cache->threads[old++];
+        } else {
+            cache->merged[n].tid = tid;
+            cache->merged[n].state = TD_THR_UNKNOWN;
+            cache->merged[n].state_generation = 0;
+            cache->merged[n].generation = cache->generation;
+        }
+        n++;
+    }
+
+    {
+        td_thread_entry * threads = cache->threads;
+        cache->threads = cache->merged;
+        cache->merged = threads;
+        cache->count = n;
+    }
+    return 0;
+}
+
+
+static td_thread_entry *
+_thread_cache_lookup(struct td_thread_cache * cache, pid_t tid)
+{
+    int lo = 0, hi = cache->count;
+
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (cache->threads[mid].tid < tid)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo < cache->count && cache->threads[lo].tid == tid) {
+        return &cache->threads[lo];
+    }
+    return NULL;
+}
+
+
+/* Read the state of a thread from its stat file, relative to 'task_fd'
+ * if it is not -1.
+ */
+static td_thr_state_e
+_get_thread_state(pid_t pid, int task_fd, pid_t tid)
+{
+    char path[64];
+    char buff[128];
+    char* paren;
+    int  fd, len;
+
+    if (task_fd >= 0) {
+        snprintf(path, sizeof path, "%d/stat", tid);
+        fd = openat(task_fd, path, O_RDONLY);
+    } else {
+        snprintf(path, sizeof path, "/proc/%d/task/%d/stat", pid, tid);
+        fd = open(path, O_RDONLY);
+    }
+    if (fd < 0) {
+        /* the thread exited and was reaped */
+        if (errno == ENOENT || errno == ESRCH) {
+            return TD_THR_ZOMBIE;
+        }
+        /* gdbserver ignores the threads in an unknown state, so keep the
+         * previous behaviour for other errors.
+         */
+        D("Could not open %s: %s\n", path, strerror(errno));
+        return TD_THR_SLEEP;
+    }
+
+    do {
+        len = read(fd, buff, sizeof buff-1);
+    } while (len < 0 && errno == EINTR);
+    close(fd);
+
+    if (len <= 0) {
+        return (len < 0 && errno == ESRCH) ? TD_THR_ZOMBIE : TD_THR_SLEEP;
+    }
+    buff[len] = 0;
+
+    /* The state follows the command name, which is between parentheses
+     * and can contain anything, including parentheses.
+     */
+    paren = strrchr(buff, ')');
+    if (paren == NULL || paren[1] != ' ') {
+        D("Could not parse %s: '%.*s'\n", path, len, buff);
+        return TD_THR_SLEEP;
+    }
+    switch (paren[2]) {
+        case 'Z':   /* zombie */
+        case 'X':   /* dead */
+        case 'x':
+            return TD_THR_ZOMBIE;
+    }
+    return TD_THR_SLEEP;
+}
+
+
+static td_thr_state_e
+_thread_cache_state(struct td_thread_cache * cache, td_thread_entry * entry)
+{
+    if (entry->state_generation != cache->generation) {
+        entry->state = _get_thread_state(cache->pid, cache->task_fd, entry->tid);
+        entry->state_generation = cache->generation;
+    }
+    return entry->state;
+}
+
+
 td_err_e
 td_ta_new(struct ps_prochandle * proc_handle, td_thragent_t ** agent_out)
 {
@@ -124,13 +476,20 @@ td_ta_new(struct ps_prochandle * proc_handle, td_thragent_t ** agent_out)
      * are no threads to attach to (gdbserver will attach to the main thread
      * though).
      */
+    int target_pid = ps_getpid(proc_handle);
+    struct td_thread_cache * cache;
+
+    /* List the threads once, for this check and for td_ta_thr_iter() */
+    cache = _thread_cache_new(target_pid);
+    if (cache && _thread_cache_refresh(cache) < 0) {
+        _thread_cache_free(cache);
+        cache = NULL;
+    }
+
     do {
-        char  path[64];
-        DIR*  dir;
-        struct dirent *entry;
         pid_t     my_pid = getpid();
-        int       target_pid = ps_getpid(proc_handle);
         uint64_t  my_caps, tid_caps;
+        int       i;
 
         D("Probing system for platform bug.\n");
 
@@ -144,6 +503,7 @@ td_ta_new(struct ps_prochandle * proc_handle, td_thragent_t ** agent_out)
         if (_get_task_permitted_caps(my_pid, my_pid, &my_caps) < 0) {
             /* something is really fishy here */
             D("Could not get gdbserver permitted caps!\n");
+            _thread_cache_free(cache);
             return TD_NOLIBTHREAD;
         }
 
@@ -151,37 +511,27 @@ td_ta_new(struct ps_prochandle * proc_handle, td_thragent_t ** agent_out)
          * permitted capabilities set to our own. If they differ,
          * the thread attach will fail. Booo...
          */
-        snprintf(path, sizeof path, "/proc/%d/task", target_pid);
-        dir = opendir(path);
-        if (!dir) {
-            D("Could not open %s: %s\n", path, strerror(errno));
+        if (!cache) {
+            D("Could not list the threads of %d\n", target_pid);
             break;
         }
-        while ((entry = readdir(dir)) != NULL) {
-            int  tid;
-
-            if (entry->d_name[0] == '.')   /* skip . and .. */
-                continue;
-
-            tid = atoi(entry->d_name);
-            if (tid == 0)  /* should not happen - be safe */
-                continue;
+        for (i = 0; i < cache->count; i++) {
+            int  tid = cache->threads[i].tid;
 
             if (_get_task_permitted_caps(target_pid, tid, &tid_caps) < 0) {
                 /* again, something is fishy */
                 D("Could not get permitted caps for thread %d\n", tid);
-                closedir(dir);
+                _thread_cache_free(cache);
                 return TD_NOLIBTHREAD;
             }
 
             if (tid_caps != my_caps) {
                 /* AAAARGH !! The permitted capabilities set differ. */
                 D("AAAAAH, Can't debug threads!\n");
-                closedir(dir);
+                _thread_cache_free(cache);
                 return TD_NOLIBTHREAD;
             }
         }
-        closedir(dir);
         D("Victory: We can debug theads!\n");
     } while (0);
 
@@ -189,11 +539,13 @@ td_ta_new(struct ps_prochandle * proc_handle, td_thragent_t ** agent_out)
 
     agent = (td_thragent_t *)malloc(sizeof(td_thragent_t));
     if (!agent) {
+        _thread_cache_free(cache);
         return TD_MALLOC;
     }
 
-    agent->pid = ps_getpid(proc_handle);
+    agent->pid = target_pid;
     agent->ph = proc_handle;
+    agent->cache = cache;
     *agent_out = agent;
 
     return TD_OK;
@@ -203,6 +555,7 @@ td_ta_new(struct ps_prochandle * proc_handle, td_thragent_t ** agent_out)
 td_err_e
 td_ta_delete(td_thragent_t * ta)
 {
+    _thread_cache_free(ta->cache);
     free(ta);
     // FIXME: anything else to do?
     return TD_OK;
@@ -278,10 +631,17 @@ td_ta_map_lwp2thr(td_thragent_t const * agent, lwpid_t lwpid,
 td_err_e
 td_thr_get_info(td_thrhandle_t const * handle, td_thrinfo_t * info)
 {
+    struct td_thread_cache * cache = _thread_cache_find(handle->pid);
+    td_thread_entry * entry = cache ? _thread_cache_lookup(cache, handle->tid) : NULL;
+
     info->ti_tid = handle->tid;
     info->ti_lid = handle->tid; // Our pthreads uses kernel ids for tids
-    info->ti_state = TD_THR_SLEEP; /* XXX this needs to be read from /proc/<pid>/task/<tid>.
-                                      This is only used to see if the thread is a zombie or not */
+    // This is only used to see if the thread is a zombie or not
+    if (entry) {
+        info->ti_state = _thread_cache_state(cache, entry);
+    } else {
+        info->ti_state = _get_thread_state(handle->pid, cache ? cache->task_fd : -1, handle->tid);
+    }
     return TD_OK;
 }
 
@@ -330,39 +690,63 @@ td_ta_clear_event(const td_thragent_t * ta_arg, td_thr_events_t * event)
 }
 
 
-td_err_e
-td_ta_thr_iter(td_thragent_t const * agent, td_thr_iter_f * func, void * cookie,
-               td_thr_state_e state, int32_t prio, sigset_t * sigmask, uint32_t user_flags)
+static td_err_e
+_thread_cache_iter(td_thragent_t const * agent, td_thr_iter_f * func, void * cookie,
+                   td_thr_state_e state, int changed_only)
 {
     td_err_e err = TD_OK;
-    char path[32];
-    DIR * dir;
-    struct dirent * entry;
+    struct td_thread_cache * cache = agent->cache;
     td_thrhandle_t handle;
+    unsigned reported;
+    int i;
 
-    snprintf(path, sizeof(path), "/proc/%d/task/", agent->pid);
-    dir = opendir(path);
-    if (!dir) {
+    if (!cache) {
         return TD_NOEVENT;
     }
+    /* a callback that iterates again gets the same listing */
+    if (!cache->iterating && _thread_cache_refresh(cache) < 0) {
+        return TD_NOEVENT;
+    }
+    reported = cache->reported;
+    cache->reported = cache->generation;
 
+    cache->iterating++;
     handle.pid = agent->pid;
-    while ((entry = readdir(dir)) != NULL) {
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+    for (i = 0; i < cache->count; i++) {
+        td_thread_entry * entry = &cache->threads[i];
+
+        if (changed_only && entry->generation <= reported) {
             continue;
         }
-        handle.tid = atoi(entry->d_name);
+        if (state != TD_THR_ANY_STATE && _thread_cache_state(cache, entry) != state) {
+            continue;
+        }
+        handle.tid = entry->tid;
         if (func(&handle, cookie) != 0) {
-	    err = TD_DBERR;
+            err = TD_DBERR;
             break;
         }
     }
-
-    closedir(dir);
+    cache->iterating--;
 
     return err;
 }
 
+
+td_err_e
+td_ta_thr_iter(td_thragent_t const * agent, td_thr_iter_f * func, void * cookie,
+               td_thr_state_e state, int32_t prio, sigset_t * sigmask, uint32_t user_flags)
+{
+    return _thread_cache_iter(agent, func, cookie, state, 0);
+}
+
+
+td_err_e
+td_ta_thr_iter_changed(td_thragent_t const * agent, td_thr_iter_f * func, void * cookie)
+{
+    return _thread_cache_iter(agent, func, cookie, TD_THR_ANY_STATE, 1);
+}
+
 td_err_e
 td_thr_tls_get_addr(const td_thrhandle_t * th,
 		    psaddr_t map_address, size_t offset, psaddr_t * address)
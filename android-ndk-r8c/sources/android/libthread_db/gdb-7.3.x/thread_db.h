@@ -69,10 +69,13 @@ typedef uint32_t td_notify_e;
 typedef uint32_t td_thr_state_e;
 typedef pthread_t thread_t;
 
+struct td_thread_cache;
+
 typedef struct
 {
     pid_t pid;
     struct ps_prochandle *ph;
+    struct td_thread_cache *cache; // private to libthread_db
 } td_thragent_t;
 
 typedef struct
@@ -154,6 +157,12 @@ extern td_err_e td_thr_event_enable(td_thrhandle_t const * handle,
 extern td_err_e td_ta_thr_iter(td_thragent_t const * agent, td_thr_iter_f * func, void * cookie,
                                td_thr_state_e state, int32_t prio, sigset_t * sigmask, uint32_t user_flags);
 
+/* Android extension: like td_ta_thr_iter(), but only for the threads that
+ * appeared since the previous call to either function, so that a debugger
+ * can look for new threads without going through all the known ones. */
+extern td_err_e td_ta_thr_iter_changed(td_thragent_t const * agent, td_thr_iter_f * func,
+                                       void * cookie);
+
 extern char const ** td_symbol_list(void);
 
 extern td_err_e td_thr_event_enable(td_thrhandle_t const * handle, td_event_e event);
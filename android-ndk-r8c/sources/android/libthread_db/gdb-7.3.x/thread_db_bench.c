@@ -0,0 +1,296 @@
+/*
+ * Copyright 2012 The Android Open Source Project
+ */
+
+/* Benchmark of the thread enumeration of libthread_db, on a Linux host.
+ *
+ * It starts a process with many threads, whose main thread exits so that
+ * it stays as a zombie, and lists its threads the way gdbserver does:
+ * td_ta_thr_iter() with a callback that calls td_thr_get_info() for each
+ * thread. The time is compared with opendir()/readdir() on each call,
+ * which libthread_db did before, and with td_ta_thr_iter_changed(). Then
+ * the process starts a few more threads, which must be the only ones that
+ * td_ta_thr_iter_changed() reports. Build it with:
+ *
+ *   gcc -O2 -DDEBUG=0 -DPTRACE_PEEKUSR=PTRACE_PEEKUSER -I. -o thread_db_bench \
+ *       thread_db_bench.c libthread_db.c -lpthread
+ *
+ * Usage: thread_db_bench [threads [iterations]]
+ */
+
+#include <dirent.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <thread_db.h>
+
+#define DEFAULT_THREADS     2000
+#define DEFAULT_ITERATIONS  50
+#define MORE_THREADS        10
+
+/* What gdbserver provides to libthread_db */
+struct ps_prochandle {
+    pid_t pid;
+};
+
+pid_t
+ps_getpid(struct ps_prochandle *ph)
+{
+    return ph->pid;
+}
+
+int
+ps_pglobal_lookup(void *ph, const char *obj, const char *name, void **sym_addr)
+{
+    return TD_NOEVENT;
+}
+
+
+static double
+now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+
+/* The process being listed */
+
+static int gCommands[2];
+static int gAcks[2];
+
+static void *
+sleeper(void *arg)
+{
+    for (;;)
+        pause();
+    return NULL;
+}
+
+static int
+start_sleepers(int count)
+{
+    pthread_attr_t attr;
+    pthread_t thread;
+    int i;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, 64 * 1024);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    for (i = 0; i < count; i++) {
+        if (pthread_create(&thread, &attr, sleeper, NULL) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+/* Start MORE_THREADS threads for each command, until the pipe is closed */
+static void *
+controller(void *arg)
+{
+    char c;
+
+    while (read(gCommands[0], &c, 1) == 1) {
+        c = start_sleepers(MORE_THREADS) == 0 ? 'y' : 'n';
+        write(gAcks[1], &c, 1);
+    }
+    _exit(0);
+    return NULL;
+}
+
+static void
+child_main(int threads)
+{
+    pthread_t thread;
+    char c;
+
+    c = (start_sleepers(threads) == 0 &&
+         pthread_create(&thread, NULL, controller, NULL) == 0) ? 'y' : 'n';
+    write(gAcks[1], &c, 1);
+    /* the main thread becomes a zombie until the process exits */
+    pthread_exit(NULL);
+}
+
+
+/* The enumeration of libthread_db before the thread cache */
+
+static int
+reference_iter(pid_t pid, td_thr_iter_f *func, void *cookie)
+{
+    char path[32];
+    DIR *dir;
+    struct dirent *entry;
+    td_thrhandle_t handle;
+
+    snprintf(path, sizeof(path), "/proc/%d/task/", pid);
+    dir = opendir(path);
+    if (!dir)
+        return TD_NOEVENT;
+    handle.pid = pid;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+        handle.tid = atoi(entry->d_name);
+        if (func(&handle, cookie) != 0)
+            break;
+    }
+    closedir(dir);
+    return TD_OK;
+}
+
+typedef struct {
+    int threads;
+    int zombies;
+    pid_t zombie;
+} counts_t;
+
+static int
+count_reference(td_thrhandle_t const *handle, void *cookie)
+{
+    counts_t *counts = cookie;
+    counts->threads++;
+    return 0;
+}
+
+/* What the callback of gdbserver does first */
+static int
+count_info(td_thrhandle_t const *handle, void *cookie)
+{
+    counts_t *counts = cookie;
+    td_thrinfo_t info;
+
+    if (td_thr_get_info(handle, &info) != TD_OK)
+        return 1;
+    counts->threads++;
+    if (info.ti_state == TD_THR_ZOMBIE) {
+        counts->zombies++;
+        counts->zombie = info.ti_lid;
+    }
+    return 0;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    int threads = DEFAULT_THREADS;
+    int iterations = DEFAULT_ITERATIONS;
+    struct ps_prochandle proc;
+    td_thragent_t *agent;
+    counts_t counts;
+    double start, reference_ms, iter_ms, changed_ms;
+    int i, failures = 0;
+    pid_t pid;
+    char c;
+
+    if (argc > 1)
+        threads = atoi(argv[1]);
+    if (argc > 2)
+        iterations = atoi(argv[2]);
+    if (threads < 1)
+        threads = 1;
+    if (iterations < 1)
+        iterations = 1;
+
+    if (pipe(gCommands) < 0 || pipe(gAcks) < 0) {
+        perror("pipe");
+        return EXIT_FAILURE;
+    }
+    pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return EXIT_FAILURE;
+    }
+    if (pid == 0) {
+        close(gCommands[1]);
+        child_main(threads);
+    }
+    close(gCommands[0]);
+    if (read(gAcks[0], &c, 1) != 1 || c != 'y') {
+        fprintf(stderr, "Could not start %d threads.\n", threads);
+        kill(pid, SIGKILL);
+        return EXIT_FAILURE;
+    }
+    /* the sleepers, the controller and the main thread */
+    threads += 2;
+
+    proc.pid = pid;
+    start = now_ms();
+    if (td_ta_new(&proc, &agent) != TD_OK) {
+        fprintf(stderr, "td_ta_new() failed.\n");
+        kill(pid, SIGKILL);
+        return EXIT_FAILURE;
+    }
+    printf("%d threads, td_ta_new() in %.2f ms\n", threads, now_ms() - start);
+
+    start = now_ms();
+    for (i = 0; i < iterations; i++) {
+        memset(&counts, 0, sizeof counts);
+        reference_iter(pid, count_reference, &counts);
+    }
+    reference_ms = (now_ms() - start) / iterations;
+    if (counts.threads != threads) {
+        fprintf(stderr, "readdir() listed %d threads instead of %d.\n", counts.threads, threads);
+        failures++;
+    }
+
+    start = now_ms();
+    for (i = 0; i < iterations; i++) {
+        memset(&counts, 0, sizeof counts);
+        td_ta_thr_iter(agent, count_info, &counts, TD_THR_ANY_STATE,
+                       TD_THR_LOWEST_PRIORITY, TD_SIGNO_MASK, TD_THR_ANY_USER_FLAGS);
+    }
+    iter_ms = (now_ms() - start) / iterations;
+    if (counts.threads != threads || counts.zombies != 1 || counts.zombie != pid) {
+        fprintf(stderr, "td_ta_thr_iter() listed %d threads and %d zombies instead of %d and 1.\n",
+                counts.threads, counts.zombies, threads);
+        failures++;
+    }
+
+    start = now_ms();
+    for (i = 0; i < iterations; i++) {
+        memset(&counts, 0, sizeof counts);
+        td_ta_thr_iter_changed(agent, count_info, &counts);
+    }
+    changed_ms = (now_ms() - start) / iterations;
+    if (counts.threads != 0) {
+        fprintf(stderr, "td_ta_thr_iter_changed() listed %d threads instead of 0.\n",
+                counts.threads);
+        failures++;
+    }
+
+    printf("readdir() on each call:            %8.3f ms per listing (without thread states)\n",
+           reference_ms);
+    printf("td_ta_thr_iter() + td_thr_get_info: %8.3f ms per listing\n", iter_ms);
+    printf("td_ta_thr_iter_changed():          %8.3f ms per listing\n", changed_ms);
+
+    c = 'n';
+    if (write(gCommands[1], &c, 1) != 1 || read(gAcks[0], &c, 1) != 1 || c != 'y') {
+        fprintf(stderr, "Could not start %d more threads.\n", MORE_THREADS);
+        failures++;
+    } else {
+        memset(&counts, 0, sizeof counts);
+        td_ta_thr_iter_changed(agent, count_info, &counts);
+        if (counts.threads != MORE_THREADS) {
+            fprintf(stderr, "td_ta_thr_iter_changed() listed %d new threads instead of %d.\n",
+                    counts.threads, MORE_THREADS);
+            failures++;
+        }
+    }
+
+    td_ta_delete(agent);
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+
+    if (failures) {
+        return EXIT_FAILURE;
+    }
+    printf("OK\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,19 @@
+LOCAL_PATH:= $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE:= android_native_app_frame
+LOCAL_SRC_FILES:= android_frame_scheduler.c android_job_system.c
+LOCAL_EXPORT_C_INCLUDES := $(LOCAL_PATH)
+
+# The host ABIs don't have cpufeatures, sysconf() is used instead.
+ifneq ($(TARGET_ARCH),host)
+LOCAL_STATIC_LIBRARIES := cpufeatures
+LOCAL_EXPORT_LDLIBS := -llog
+endif
+
+include $(BUILD_STATIC_LIBRARY)
+
+ifneq ($(TARGET_ARCH),host)
+$(call import-module,android/cpufeatures)
+endif
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "android_native_app_frame.h"
+
+int64_t android_frame_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void android_frame_init(struct android_frame_scheduler* scheduler, int64_t targetFrameNs) {
+    memset(scheduler, 0, sizeof(*scheduler));
+    scheduler->targetFrameNs = targetFrameNs > 0 ? targetFrameNs : ANDROID_FRAME_NS_60HZ;
+    scheduler->nextFrameNs = android_frame_now_ns();
+}
+
+int android_frame_poll_timeout(const struct android_frame_scheduler* scheduler) {
+    int64_t delay = scheduler->nextFrameNs - android_frame_now_ns();
+    if (delay <= 0) {
+        return 0;
+    }
+    // Round up, so that the looper doesn't return just before the slot
+    // and spin with a 0 timeout.
+    return (int)((delay + 999999) / 1000000);
+}
+
+void android_frame_begin(struct android_frame_scheduler* scheduler) {
+    int64_t now = android_frame_now_ns();
+    int64_t slot = scheduler->nextFrameNs;
+
+    // Skip the slots that were entirely missed, instead of catching up.
+    if (now >= slot + scheduler->targetFrameNs) {
+        int64_t skipped = (now - slot) / scheduler->targetFrameNs;
+        scheduler->stats.skippedFrames += (uint32_t)skipped;
+        slot += skipped * scheduler->targetFrameNs;
+    }
+    scheduler->frameStartNs = now;
+    scheduler->nextFrameNs = slot + scheduler->targetFrameNs;
+}
+
+int android_frame_end(struct android_frame_scheduler* scheduler) {
+    int64_t now = android_frame_now_ns();
+    int64_t frameNs = now - scheduler->frameStartNs;
+    struct android_frame_stats* stats = &scheduler->stats;
+    int late = now > scheduler->nextFrameNs;
+
+    if (stats->frames == 0 || frameNs < stats->minFrameNs) {
+        stats->minFrameNs = frameNs;
+    }
+    if (frameNs > stats->maxFrameNs) {
+        stats->maxFrameNs = frameNs;
+    }
+    stats->totalFrameNs += frameNs;
+    stats->lastFrameNs = frameNs;
+    stats->frames++;
+    if (late) {
+        stats->lateFrames++;
+    }
+    scheduler->frameStartNs = 0;
+    return late;
+}
+
+void android_frame_reset_stats(struct android_frame_scheduler* scheduler) {
+    memset(&scheduler->stats, 0, sizeof(scheduler->stats));
+}
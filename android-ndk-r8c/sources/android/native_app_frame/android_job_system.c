@@ -0,0 +1,346 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "android_native_app_frame.h"
+
+#ifdef __ANDROID__
+#include <android/log.h>
+#include <cpu-features.h>
+#define LOGE(...) ((void)__android_log_print(ANDROID_LOG_ERROR, "native_app_frame", __VA_ARGS__))
+#else
+#include <stdio.h>
+#define LOGE(...) ((void)(fprintf(stderr, "native_app_frame: " __VA_ARGS__), fputc('\n', stderr)))
+#endif
+
+/*
+ * Each worker thread has its own queue of jobs, and all the other threads
+ * share an extra one.  A thread pushes and pops jobs at the tail of its
+ * queue (the most recent ones, which are likely to be in its cache), and
+ * steals jobs from the head of the other queues when its own is empty.
+ *
+ * The queues are protected by a mutex each, which is only contended when
+ * a job is stolen.  Idle workers sleep on a condition variable.
+ */
+
+#define JOB_QUEUE_INITIAL_CAPACITY 64
+
+struct android_job {
+    android_job_func func;
+    void* arg;
+    struct android_job_group* group;
+};
+
+struct job_queue {
+    pthread_mutex_t lock;
+    struct android_job* jobs;
+    int capacity;
+    int head;
+    int count;
+};
+
+struct android_jobs {
+    int workerCount;
+    // One queue per requested worker, plus a last one shared by the other
+    // threads.  It is fixed before the workers start.
+    int queueCount;
+    struct job_queue* queues;
+    pthread_t* threads;
+    // Set in each worker thread to its index + 1.
+    pthread_key_t workerKey;
+
+    pthread_mutex_t sleepLock;
+    pthread_cond_t sleepCond;
+    volatile int32_t queued;
+    volatile int32_t sleepers;
+    volatile int32_t stop;
+};
+
+struct worker_start {
+    struct android_jobs* jobs;
+    int index;
+};
+
+static int job_queue_push(struct job_queue* queue, const struct android_job* job) {
+    int i;
+
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count == queue->capacity) {
+        int capacity = queue->capacity ? queue->capacity * 2 : JOB_QUEUE_INITIAL_CAPACITY;
+        struct android_job* jobs = (struct android_job*)malloc(capacity * sizeof(*jobs));
+        if (jobs == NULL) {
+            pthread_mutex_unlock(&queue->lock);
+            return -1;
+        }
+        for (i = 0; i < queue->count; i++) {
+            jobs[i] = queue->jobs[(queue->head + i) % queue->capacity];
+        }
+        free(queue->jobs);
+        queue->jobs = jobs;
+        queue->capacity = capacity;
+        queue->head = 0;
+    }
+    queue->jobs[(queue->head + queue->count) % queue->capacity] = *job;
+    queue->count++;
+    pthread_mutex_unlock(&queue->lock);
+    return 0;
+}
+
+// Take the most recent job (fromTail) or the oldest one.
+static int job_queue_pop(struct job_queue* queue, struct android_job* job, int fromTail) {
+    int found = 0;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count > 0) {
+        if (fromTail) {
+            *job = queue->jobs[(queue->head + queue->count - 1) % queue->capacity];
+        } else {
+            *job = queue->jobs[queue->head];
+            queue->head = (queue->head + 1) % queue->capacity;
+        }
+        queue->count--;
+        found = 1;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return found;
+}
+
+static int current_queue(struct android_jobs* jobs) {
+    long index = (long)pthread_getspecific(jobs->workerKey);
+    return index > 0 ? (int)index - 1 : jobs->queueCount - 1;
+}
+
+static void run_job(const struct android_job* job) {
+    job->func(job->arg);
+    // Full barrier: the effects of the job are visible once the group is done.
+    __sync_fetch_and_sub(&job->group->pending, 1);
+}
+
+// Run one job from the given queue, or stolen from another one.  Return 0
+// if there was none.
+static int run_one_job(struct android_jobs* jobs, int index) {
+    struct android_job job;
+    int queueCount = jobs->queueCount;
+    int found = job_queue_pop(&jobs->queues[index], &job, 1);
+    int i;
+
+    for (i = 1; !found && i < queueCount; i++) {
+        found = job_queue_pop(&jobs->queues[(index + i) % queueCount], &job, 0);
+    }
+    if (!found) {
+        return 0;
+    }
+    __sync_fetch_and_sub(&jobs->queued, 1);
+    run_job(&job);
+    return 1;
+}
+
+static void* worker_entry(void* param) {
+    struct worker_start* start = (struct worker_start*)param;
+    struct android_jobs* jobs = start->jobs;
+    int index = start->index;
+
+    free(start);
+    pthread_setspecific(jobs->workerKey, (void*)(long)(index + 1));
+
+    while (!jobs->stop) {
+        if (run_one_job(jobs, index)) {
+            continue;
+        }
+        pthread_mutex_lock(&jobs->sleepLock);
+        // Pairs with android_jobs_submit(): either the job is seen queued
+        // here, or this thread is seen sleeping there.
+        __sync_fetch_and_add(&jobs->sleepers, 1);
+        while (__sync_fetch_and_add(&jobs->queued, 0) == 0 && !jobs->stop) {
+            pthread_cond_wait(&jobs->sleepCond, &jobs->sleepLock);
+        }
+        __sync_fetch_and_sub(&jobs->sleepers, 1);
+        pthread_mutex_unlock(&jobs->sleepLock);
+    }
+    return NULL;
+}
+
+static int default_worker_count(void) {
+#ifdef __ANDROID__
+    int cpus = android_getCpuCount();
+#else
+    int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return cpus > 1 ? cpus - 1 : 0;
+}
+
+struct android_jobs* android_jobs_create(int workerCount) {
+    struct android_jobs* jobs;
+    int i;
+
+    if (workerCount < 0) {
+        workerCount = default_worker_count();
+    }
+    jobs = (struct android_jobs*)calloc(1, sizeof(*jobs));
+    if (jobs == NULL) {
+        return NULL;
+    }
+    jobs->queues = (struct job_queue*)calloc(workerCount + 1, sizeof(*jobs->queues));
+    jobs->threads = (pthread_t*)calloc(workerCount ? workerCount : 1, sizeof(*jobs->threads));
+    if (jobs->queues == NULL || jobs->threads == NULL
+            || pthread_key_create(&jobs->workerKey, NULL) != 0) {
+        free(jobs->queues);
+        free(jobs->threads);
+        free(jobs);
+        return NULL;
+    }
+    jobs->queueCount = workerCount + 1;
+    for (i = 0; i < jobs->queueCount; i++) {
+        pthread_mutex_init(&jobs->queues[i].lock, NULL);
+    }
+    pthread_mutex_init(&jobs->sleepLock, NULL);
+    pthread_cond_init(&jobs->sleepCond, NULL);
+
+    for (i = 0; i < workerCount; i++) {
+        struct worker_start* start = (struct worker_start*)malloc(sizeof(*start));
+        if (start == NULL) {
+            break;
+        }
+        start->jobs = jobs;
+        start->index = i;
+        if (pthread_create(&jobs->threads[i], NULL, worker_entry, start) != 0) {
+            LOGE("Could not create worker thread: %s", strerror(errno));
+            free(start);
+            break;
+        }
+    }
+    // The queues of the workers that could not be created stay empty.
+    jobs->workerCount = i;
+    return jobs;
+}
+
+void android_jobs_destroy(struct android_jobs* jobs) {
+    int i;
+
+    if (jobs == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&jobs->sleepLock);
+    jobs->stop = 1;
+    pthread_cond_broadcast(&jobs->sleepCond);
+    pthread_mutex_unlock(&jobs->sleepLock);
+
+    for (i = 0; i < jobs->workerCount; i++) {
+        pthread_join(jobs->threads[i], NULL);
+    }
+    for (i = 0; i < jobs->queueCount; i++) {
+        pthread_mutex_destroy(&jobs->queues[i].lock);
+        free(jobs->queues[i].jobs);
+    }
+    pthread_cond_destroy(&jobs->sleepCond);
+    pthread_mutex_destroy(&jobs->sleepLock);
+    pthread_key_delete(jobs->workerKey);
+    free(jobs->queues);
+    free(jobs->threads);
+    free(jobs);
+}
+
+int android_jobs_worker_count(const struct android_jobs* jobs) {
+    return jobs->workerCount;
+}
+
+int android_jobs_submit(struct android_jobs* jobs, struct android_job_group* group,
+        android_job_func func, void* arg) {
+    struct android_job job;
+
+    job.func = func;
+    job.arg = arg;
+    job.group = group;
+    // Count the job before it can be run, so that the group can't be seen
+    // as done in between.
+    __sync_fetch_and_add(&group->pending, 1);
+
+    if (job_queue_push(&jobs->queues[current_queue(jobs)], &job) != 0) {
+        run_job(&job);
+        return -1;
+    }
+    __sync_fetch_and_add(&jobs->queued, 1);
+    if (__sync_fetch_and_add(&jobs->sleepers, 0) > 0) {
+        pthread_mutex_lock(&jobs->sleepLock);
+        pthread_cond_signal(&jobs->sleepCond);
+        pthread_mutex_unlock(&jobs->sleepLock);
+    }
+    return 0;
+}
+
+void android_jobs_wait(struct android_jobs* jobs, struct android_job_group* group) {
+    int index = current_queue(jobs);
+
+    while (__sync_fetch_and_add(&group->pending, 0) > 0) {
+        // Help instead of blocking.  When nothing is left in the queues,
+        // the last jobs of the group are running on other threads.
+        if (!run_one_job(jobs, index)) {
+            sched_yield();
+        }
+    }
+}
+
+struct parallel_for_range {
+    android_job_range_func func;
+    void* arg;
+    int begin;
+    int end;
+};
+
+static void parallel_for_job(void* param) {
+    struct parallel_for_range* range = (struct parallel_for_range*)param;
+    range->func(range->arg, range->begin, range->end);
+}
+
+void android_jobs_parallel_for(struct android_jobs* jobs, int count, int grain,
+        android_job_range_func func, void* arg) {
+    struct android_job_group group = ANDROID_JOB_GROUP_INIT;
+    struct parallel_for_range* ranges;
+    int rangeCount;
+    int i;
+
+    if (count <= 0) {
+        return;
+    }
+    if (grain <= 0) {
+        grain = 1;
+    }
+    rangeCount = (count + grain - 1) / grain;
+    if (rangeCount == 1 || jobs->workerCount == 0) {
+        func(arg, 0, count);
+        return;
+    }
+    ranges = (struct parallel_for_range*)malloc(rangeCount * sizeof(*ranges));
+    if (ranges == NULL) {
+        func(arg, 0, count);
+        return;
+    }
+    for (i = 0; i < rangeCount; i++) {
+        ranges[i].func = func;
+        ranges[i].arg = arg;
+        ranges[i].begin = i * grain;
+        ranges[i].end = i == rangeCount - 1 ? count : (i + 1) * grain;
+        android_jobs_submit(jobs, &group, parallel_for_job, &ranges[i]);
+    }
+    android_jobs_wait(jobs, &group);
+    free(ranges);
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _ANDROID_NATIVE_APP_FRAME_H
+#define _ANDROID_NATIVE_APP_FRAME_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The 'android_native_app_frame' static library is an optional companion
+ * of 'android_native_app_glue'.  It provides:
+ *
+ * 1/ A frame scheduler, that paces the rendering loop of the app thread
+ *    to a target frame time instead of rendering as fast as possible, and
+ *    keeps statistics about frame times and late frames.  It replaces the
+ *    usual "ALooper_pollAll(animating ? 0 : -1, ...)" loop with:
+ *
+ *        struct android_frame_scheduler frames;
+ *        android_frame_init(&frames, ANDROID_FRAME_NS_60HZ);
+ *
+ *        while (1) {
+ *            int timeout = animating ? android_frame_poll_timeout(&frames) : -1;
+ *            while ((ident = ALooper_pollAll(timeout, NULL, &events,
+ *                    (void**)&source)) >= 0) {
+ *                ... process the event ...
+ *                timeout = animating ? android_frame_poll_timeout(&frames) : -1;
+ *            }
+ *            if (animating) {
+ *                android_frame_begin(&frames);
+ *                ... update and draw ...
+ *                android_frame_end(&frames);
+ *            }
+ *        }
+ *
+ *    The events are thus processed while waiting for the next frame. Note
+ *    that the NDK has no access to the display's vsync: frames are paced
+ *    with the monotonic clock, and eglSwapBuffers() still blocks when the
+ *    display is not ready.
+ *
+ * 2/ A work-stealing job system, to spread the work of a frame (e.g.
+ *    animation, physics or culling) across all the CPU cores.  Jobs are
+ *    submitted to a group, then the submitting thread waits for the group
+ *    and runs jobs itself in the meantime.  The worker threads sleep when
+ *    there is nothing to do, e.g. between frames.
+ *
+ * Both can be used independently, and from any thread.
+ */
+
+/* -------------------------------------------------------------------- */
+/* Frame scheduler                                                      */
+/* -------------------------------------------------------------------- */
+
+/**
+ * Common target frame times, in nanoseconds.
+ */
+#define ANDROID_FRAME_NS_60HZ  16666667LL
+#define ANDROID_FRAME_NS_30HZ  33333333LL
+
+/**
+ * Frame time statistics, since android_frame_init() or
+ * android_frame_reset_stats().  Frame times are measured from
+ * android_frame_begin() to android_frame_end().
+ */
+struct android_frame_stats {
+    // Number of frames.
+    uint32_t frames;
+
+    // Number of frames that ended after the start of the next frame slot.
+    uint32_t lateFrames;
+
+    // Number of frame slots that were skipped because of late frames.
+    uint32_t skippedFrames;
+
+    // Frame times, in nanoseconds.
+    int64_t minFrameNs;
+    int64_t maxFrameNs;
+    int64_t totalFrameNs;
+    int64_t lastFrameNs;
+};
+
+/**
+ * State of a frame scheduler.  Frames start on a regular grid of slots of
+ * targetFrameNs.  When a frame is late, the next frame starts immediately
+ * in the current slot, and the grid is shifted so that the application
+ * does not try to catch up with several frames in a row.
+ */
+struct android_frame_scheduler {
+    // Target frame time, in nanoseconds.
+    int64_t targetFrameNs;
+
+    // Start of the next frame slot, in nanoseconds of CLOCK_MONOTONIC.
+    int64_t nextFrameNs;
+
+    // Start of the current frame, or 0 outside of a frame.
+    int64_t frameStartNs;
+
+    struct android_frame_stats stats;
+};
+
+/**
+ * Return the current time of CLOCK_MONOTONIC, in nanoseconds.
+ */
+int64_t android_frame_now_ns(void);
+
+/**
+ * Initialize a frame scheduler with the given target frame time.  The
+ * first frame can start immediately.
+ */
+void android_frame_init(struct android_frame_scheduler* scheduler, int64_t targetFrameNs);
+
+/**
+ * Return the timeout in milliseconds to pass to ALooper_pollAll() while
+ * waiting for the next frame, i.e. 0 if it is time to start it.
+ */
+int android_frame_poll_timeout(const struct android_frame_scheduler* scheduler);
+
+/**
+ * Mark the start of a frame.
+ */
+void android_frame_begin(struct android_frame_scheduler* scheduler);
+
+/**
+ * Mark the end of a frame and update the statistics.  Return 1 if the
+ * frame was late, 0 otherwise.
+ */
+int android_frame_end(struct android_frame_scheduler* scheduler);
+
+/**
+ * Reset the statistics, e.g. after printing them.
+ */
+void android_frame_reset_stats(struct android_frame_scheduler* scheduler);
+
+/* -------------------------------------------------------------------- */
+/* Job system                                                           */
+/* -------------------------------------------------------------------- */
+
+struct android_jobs;
+
+/**
+ * A job function, called with the argument given to android_jobs_submit().
+ */
+typedef void (*android_job_func)(void* arg);
+
+/**
+ * A group of jobs that can be waited for.  It must be initialized to 0,
+ * e.g. with ANDROID_JOB_GROUP_INIT, and must stay valid until
+ * android_jobs_wait() returns.
+ */
+struct android_job_group {
+    volatile int32_t pending;
+};
+
+#define ANDROID_JOB_GROUP_INIT { 0 }
+
+/**
+ * Create a job system with 'workerCount' worker threads.  If 'workerCount'
+ * is negative, one worker per CPU core other than the one of the calling
+ * thread is created, i.e. android_getCpuCount() - 1.  With 0 workers, all
+ * the jobs are run by android_jobs_wait().  Return NULL on failure.
+ */
+struct android_jobs* android_jobs_create(int workerCount);
+
+/**
+ * Stop the worker threads and free the job system.  All the groups must
+ * have been waited for.
+ */
+void android_jobs_destroy(struct android_jobs* jobs);
+
+/**
+ * Return the number of worker threads of a job system.
+ */
+int android_jobs_worker_count(const struct android_jobs* jobs);
+
+/**
+ * Queue a job in a group.  It can be called from any thread, including
+ * from a job.  Return 0 on success, or -1 if there is not enough memory,
+ * in which case the job is run immediately by the calling thread.
+ */
+int android_jobs_submit(struct android_jobs* jobs, struct android_job_group* group,
+        android_job_func func, void* arg);
+
+/**
+ * Wait until all the jobs of a group have run.  The calling thread runs
+ * queued jobs while waiting, so this can also be called from a job.
+ */
+void android_jobs_wait(struct android_jobs* jobs, struct android_job_group* group);
+
+/**
+ * A job function for android_jobs_parallel_for(), called for the
+ * elements [begin, end) of a range.
+ */
+typedef void (*android_job_range_func)(void* arg, int begin, int end);
+
+/**
+ * Call 'func' on [0, count), split in ranges of at most 'grain' elements
+ * run in parallel, and wait for them.
+ */
+void android_jobs_parallel_for(struct android_jobs* jobs, int count, int grain,
+        android_job_range_func func, void* arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ANDROID_NATIVE_APP_FRAME_H */
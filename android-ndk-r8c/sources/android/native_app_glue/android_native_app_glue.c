@@ -18,8 +18,10 @@
 #include <jni.h>
 
 #include <errno.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/eventfd.h>
 #include <sys/resource.h>
 
 #include "android_native_app_glue.h"
@@ -35,6 +37,11 @@
 #  define LOGV(...)  ((void)0)
 #endif
 
+/* Not defined by all C library headers; this is the Linux value. */
+#ifndef EFD_SEMAPHORE
+#  define EFD_SEMAPHORE 1
+#endif
+
 static void free_saved_state(struct android_app* android_app) {
     pthread_mutex_lock(&android_app->mutex);
     if (android_app->savedState != NULL) {
@@ -45,19 +52,45 @@ static void free_saved_state(struct android_app* android_app) {
     pthread_mutex_unlock(&android_app->mutex);
 }
 
-int8_t android_app_read_cmd(struct android_app* android_app) {
-    int8_t cmd;
-    if (read(android_app->msgread, &cmd, sizeof(cmd)) == sizeof(cmd)) {
-        switch (cmd) {
-            case APP_CMD_SAVE_STATE:
-                free_saved_state(android_app);
-                break;
-        }
-        return cmd;
+static int read_cmd_wakeup(struct android_app* android_app) {
+    if (android_app->msgread == android_app->msgwrite) {
+        uint64_t count;
+        return read(android_app->msgread, &count, sizeof(count)) == sizeof(count);
     } else {
+        int8_t byte;
+        return read(android_app->msgread, &byte, sizeof(byte)) == sizeof(byte);
+    }
+}
+
+int8_t android_app_read_cmd(struct android_app* android_app) {
+    uint32_t head = android_app->cmdHead;
+    if (!read_cmd_wakeup(android_app) || head == android_app->cmdTail) {
         LOGE("No data on command pipe!");
+        return -1;
+    }
+
+    // Read the entry before releasing its slot to the main thread.
+    __sync_synchronize();
+    android_app->currentCmd = android_app->cmdRing[head % ANDROID_APP_CMD_RING_SIZE];
+    __sync_synchronize();
+    android_app->cmdHead = head + 1;
+    // Publish cmdHead before checking cmdWriterWaiting, which the main
+    // thread sets before checking cmdHead: either it sees the free slot,
+    // or it is waiting (or about to, with the mutex held) and is woken up.
+    __sync_synchronize();
+    if (android_app->cmdWriterWaiting) {
+        pthread_mutex_lock(&android_app->mutex);
+        pthread_cond_broadcast(&android_app->cond);
+        pthread_mutex_unlock(&android_app->mutex);
     }
-    return -1;
+
+    int8_t cmd = android_app->currentCmd.cmd;
+    switch (cmd) {
+        case APP_CMD_SAVE_STATE:
+            free_saved_state(android_app);
+            break;
+    }
+    return cmd;
 }
 
 static void print_cur_config(struct android_app* android_app) {
@@ -93,7 +126,7 @@ void android_app_pre_exec_cmd(struct android_app* android_app, int8_t cmd) {
             if (android_app->inputQueue != NULL) {
                 AInputQueue_detachLooper(android_app->inputQueue);
             }
-            android_app->inputQueue = android_app->pendingInputQueue;
+            android_app->inputQueue = (AInputQueue*)android_app->currentCmd.data;
             if (android_app->inputQueue != NULL) {
                 LOGV("Attaching input queue to looper");
                 AInputQueue_attachLooper(android_app->inputQueue,
@@ -107,7 +140,7 @@ void android_app_pre_exec_cmd(struct android_app* android_app, int8_t cmd) {
         case APP_CMD_INIT_WINDOW:
             LOGV("APP_CMD_INIT_WINDOW\n");
             pthread_mutex_lock(&android_app->mutex);
-            android_app->window = android_app->pendingWindow;
+            android_app->window = (ANativeWindow*)android_app->currentCmd.data;
             pthread_cond_broadcast(&android_app->cond);
             pthread_mutex_unlock(&android_app->mutex);
             break;
@@ -128,6 +161,11 @@ void android_app_pre_exec_cmd(struct android_app* android_app, int8_t cmd) {
             pthread_mutex_unlock(&android_app->mutex);
             break;
 
+        case APP_CMD_CONTENT_RECT_CHANGED:
+            LOGV("APP_CMD_CONTENT_RECT_CHANGED\n");
+            android_app->contentRect = android_app->currentCmd.rect;
+            break;
+
         case APP_CMD_CONFIG_CHANGED:
             LOGV("APP_CMD_CONFIG_CHANGED\n");
             AConfiguration_fromAssetManager(android_app->config,
@@ -164,6 +202,13 @@ void android_app_post_exec_cmd(struct android_app* android_app, int8_t cmd) {
             free_saved_state(android_app);
             break;
     }
+
+    if (android_app->currentCmd.ack) {
+        pthread_mutex_lock(&android_app->mutex);
+        android_app->cmdAckSeq = android_app->currentCmd.seq;
+        pthread_cond_broadcast(&android_app->cond);
+        pthread_mutex_unlock(&android_app->mutex);
+    }
 }
 
 void app_dummy() {
@@ -184,19 +229,70 @@ static void android_app_destroy(struct android_app* android_app) {
     // Can't touch android_app object after this.
 }
 
+// Maximum number of events passed to onInputBatch at once.
+#define INPUT_BATCH_MAX 64
+
+static int is_batched_input(struct android_app* app, AInputEvent* event) {
+    return app->onInputBatch != NULL
+            && AInputEvent_getType(event) == AINPUT_EVENT_TYPE_MOTION
+            && (AMotionEvent_getAction(event) & AMOTION_EVENT_ACTION_MASK)
+                    == AMOTION_EVENT_ACTION_MOVE;
+}
+
+static void flush_input_batch(struct android_app* app, AInputEvent** batch, int32_t* count) {
+    if (*count == 0) {
+        return;
+    }
+    LOGV("Input batch: %d move events\n", *count);
+    int32_t handled = app->onInputBatch(app, batch, *count);
+    int32_t i;
+    for (i = 0; i < *count; i++) {
+        AInputQueue_finishEvent(app->inputQueue, batch[i], handled);
+    }
+    *count = 0;
+}
+
 static void process_input(struct android_app* app, struct android_poll_source* source) {
-    AInputEvent* event = NULL;
-    if (AInputQueue_getEvent(app->inputQueue, &event) >= 0) {
+    AInputEvent* batch[INPUT_BATCH_MAX];
+    int32_t batchCount = 0;
+    int32_t budget = app->inputEventBudget > 0
+            ? app->inputEventBudget : ANDROID_APP_DEFAULT_INPUT_BUDGET;
+    int32_t count;
+
+    // Drain all the available events, up to the budget, instead of going
+    // back to the looper for each of them.
+    for (count = 0; count < budget; count++) {
+        AInputEvent* event = NULL;
+        if (count > 0 && AInputQueue_hasEvents(app->inputQueue) <= 0) {
+            break;
+        }
+        if (AInputQueue_getEvent(app->inputQueue, &event) < 0) {
+            if (count == 0) {
+                LOGE("Failure reading next input event: %s\n", strerror(errno));
+            }
+            break;
+        }
         LOGV("New input event: type=%d\n", AInputEvent_getType(event));
         if (AInputQueue_preDispatchEvent(app->inputQueue, event)) {
-            return;
+            continue;
         }
+        if (is_batched_input(app, event)) {
+            if (batchCount > 0
+                    && (batchCount == INPUT_BATCH_MAX
+                        || AInputEvent_getDeviceId(event) != AInputEvent_getDeviceId(batch[0])
+                        || AInputEvent_getSource(event) != AInputEvent_getSource(batch[0]))) {
+                flush_input_batch(app, batch, &batchCount);
+            }
+            batch[batchCount++] = event;
+            continue;
+        }
+        // Keep the events in order.
+        flush_input_batch(app, batch, &batchCount);
         int32_t handled = 0;
         if (app->onInputEvent != NULL) handled = app->onInputEvent(app, event);
         AInputQueue_finishEvent(app->inputQueue, event, handled);
-    } else {
-        LOGE("Failure reading next input event: %s\n", strerror(errno));
     }
+    flush_input_batch(app, batch, &batchCount);
 }
 
 static void process_cmd(struct android_app* app, struct android_poll_source* source) {
@@ -256,13 +352,19 @@ static struct android_app* android_app_create(ANativeActivity* activity,
         memcpy(android_app->savedState, savedState, savedStateSize);
     }
 
-    int msgpipe[2];
-    if (pipe(msgpipe)) {
-        LOGE("could not create pipe: %s", strerror(errno));
-        return NULL;
+    int msgfd = eventfd(0, EFD_SEMAPHORE);
+    if (msgfd >= 0) {
+        android_app->msgread = msgfd;
+        android_app->msgwrite = msgfd;
+    } else {
+        int msgpipe[2];
+        if (pipe(msgpipe)) {
+            LOGE("could not create pipe: %s", strerror(errno));
+            return NULL;
+        }
+        android_app->msgread = msgpipe[0];
+        android_app->msgwrite = msgpipe[1];
     }
-    android_app->msgread = msgpipe[0];
-    android_app->msgwrite = msgpipe[1];
 
     pthread_attr_t attr; 
     pthread_attr_init(&attr);
@@ -279,56 +381,108 @@ static struct android_app* android_app_create(ANativeActivity* activity,
     return android_app;
 }
 
-static void android_app_write_cmd(struct android_app* android_app, int8_t cmd) {
-    if (write(android_app->msgwrite, &cmd, sizeof(cmd)) != sizeof(cmd)) {
+// Send a command to the app thread, and return its sequence number.  If
+// 'ack' is non-zero, android_app_wait_cmd() can be used to wait until the
+// app thread has processed it.  Only called from the main thread.
+static uint32_t android_app_write_cmd(struct android_app* android_app, int8_t cmd,
+        void* data, const ARect* rect, int ack) {
+    uint32_t tail = android_app->cmdTail;
+    if (tail - android_app->cmdHead == ANDROID_APP_CMD_RING_SIZE) {
+        // Wait for the app thread to free a slot, see android_app_read_cmd().
+        pthread_mutex_lock(&android_app->mutex);
+        android_app->cmdWriterWaiting = 1;
+        __sync_synchronize();
+        while (tail - android_app->cmdHead == ANDROID_APP_CMD_RING_SIZE) {
+            pthread_cond_wait(&android_app->cond, &android_app->mutex);
+        }
+        android_app->cmdWriterWaiting = 0;
+        pthread_mutex_unlock(&android_app->mutex);
+    }
+    // Don't write the slot before the app thread is done reading it.
+    __sync_synchronize();
+
+    struct android_app_cmd* entry = &android_app->cmdRing[tail % ANDROID_APP_CMD_RING_SIZE];
+    uint32_t seq = ++android_app->cmdSeq;
+    entry->cmd = cmd;
+    entry->ack = ack;
+    entry->seq = seq;
+    entry->data = data;
+    if (rect != NULL) {
+        entry->rect = *rect;
+    } else {
+        memset(&entry->rect, 0, sizeof(entry->rect));
+    }
+    // Publish the entry before waking up the app thread.
+    __sync_synchronize();
+    android_app->cmdTail = tail + 1;
+
+    int written;
+    if (android_app->msgread == android_app->msgwrite) {
+        uint64_t count = 1;
+        written = write(android_app->msgwrite, &count, sizeof(count)) == sizeof(count);
+    } else {
+        written = write(android_app->msgwrite, &cmd, sizeof(cmd)) == sizeof(cmd);
+    }
+    if (!written) {
         LOGE("Failure writing android_app cmd: %s\n", strerror(errno));
     }
+    return seq;
 }
 
-static void android_app_set_input(struct android_app* android_app, AInputQueue* inputQueue) {
+static void android_app_wait_cmd(struct android_app* android_app, uint32_t seq) {
     pthread_mutex_lock(&android_app->mutex);
-    android_app->pendingInputQueue = inputQueue;
-    android_app_write_cmd(android_app, APP_CMD_INPUT_CHANGED);
-    while (android_app->inputQueue != android_app->pendingInputQueue) {
+    while ((int32_t)(android_app->cmdAckSeq - seq) < 0) {
         pthread_cond_wait(&android_app->cond, &android_app->mutex);
     }
     pthread_mutex_unlock(&android_app->mutex);
 }
 
+// The main thread only waits for the commands after which it may release
+// something the app thread uses: the previous input queue or window.
+// Attaching a new one does not block it.
+static void android_app_set_input(struct android_app* android_app, AInputQueue* inputQueue) {
+    int ack = android_app->pendingInputQueue != NULL;
+    android_app->pendingInputQueue = inputQueue;
+    uint32_t seq = android_app_write_cmd(android_app, APP_CMD_INPUT_CHANGED,
+            inputQueue, NULL, ack);
+    if (ack) {
+        android_app_wait_cmd(android_app, seq);
+    }
+}
+
 static void android_app_set_window(struct android_app* android_app, ANativeWindow* window) {
-    pthread_mutex_lock(&android_app->mutex);
     if (android_app->pendingWindow != NULL) {
-        android_app_write_cmd(android_app, APP_CMD_TERM_WINDOW);
+        uint32_t seq = android_app_write_cmd(android_app, APP_CMD_TERM_WINDOW, NULL, NULL, 1);
+        android_app_wait_cmd(android_app, seq);
     }
     android_app->pendingWindow = window;
     if (window != NULL) {
-        android_app_write_cmd(android_app, APP_CMD_INIT_WINDOW);
-    }
-    while (android_app->window != android_app->pendingWindow) {
-        pthread_cond_wait(&android_app->cond, &android_app->mutex);
+        android_app_write_cmd(android_app, APP_CMD_INIT_WINDOW, window, NULL, 0);
     }
-    pthread_mutex_unlock(&android_app->mutex);
 }
 
+// Start and resume don't need to wait, but pause and stop do, so that the
+// app has stopped drawing when the activity is paused.
 static void android_app_set_activity_state(struct android_app* android_app, int8_t cmd) {
-    pthread_mutex_lock(&android_app->mutex);
-    android_app_write_cmd(android_app, cmd);
-    while (android_app->activityState != cmd) {
-        pthread_cond_wait(&android_app->cond, &android_app->mutex);
+    int ack = cmd == APP_CMD_PAUSE || cmd == APP_CMD_STOP;
+    uint32_t seq = android_app_write_cmd(android_app, cmd, NULL, NULL, ack);
+    if (ack) {
+        android_app_wait_cmd(android_app, seq);
     }
-    pthread_mutex_unlock(&android_app->mutex);
 }
 
 static void android_app_free(struct android_app* android_app) {
+    android_app_write_cmd(android_app, APP_CMD_DESTROY, NULL, NULL, 0);
     pthread_mutex_lock(&android_app->mutex);
-    android_app_write_cmd(android_app, APP_CMD_DESTROY);
     while (!android_app->destroyed) {
         pthread_cond_wait(&android_app->cond, &android_app->mutex);
     }
     pthread_mutex_unlock(&android_app->mutex);
 
     close(android_app->msgread);
-    close(android_app->msgwrite);
+    if (android_app->msgwrite != android_app->msgread) {
+        close(android_app->msgwrite);
+    }
     pthread_cond_destroy(&android_app->cond);
     pthread_mutex_destroy(&android_app->mutex);
     free(android_app);
@@ -356,11 +510,11 @@ static void* onSaveInstanceState(ANativeActivity* activity, size_t* outLen) {
     LOGV("SaveInstanceState: %p\n", activity);
     pthread_mutex_lock(&android_app->mutex);
     android_app->stateSaved = 0;
-    android_app_write_cmd(android_app, APP_CMD_SAVE_STATE);
-    while (!android_app->stateSaved) {
-        pthread_cond_wait(&android_app->cond, &android_app->mutex);
-    }
+    pthread_mutex_unlock(&android_app->mutex);
+    uint32_t seq = android_app_write_cmd(android_app, APP_CMD_SAVE_STATE, NULL, NULL, 1);
+    android_app_wait_cmd(android_app, seq);
 
+    pthread_mutex_lock(&android_app->mutex);
     if (android_app->savedState != NULL) {
         savedState = android_app->savedState;
         *outLen = android_app->savedStateSize;
@@ -386,19 +540,19 @@ static void onStop(ANativeActivity* activity) {
 static void onConfigurationChanged(ANativeActivity* activity) {
     struct android_app* android_app = (struct android_app*)activity->instance;
     LOGV("ConfigurationChanged: %p\n", activity);
-    android_app_write_cmd(android_app, APP_CMD_CONFIG_CHANGED);
+    android_app_write_cmd(android_app, APP_CMD_CONFIG_CHANGED, NULL, NULL, 0);
 }
 
 static void onLowMemory(ANativeActivity* activity) {
     struct android_app* android_app = (struct android_app*)activity->instance;
     LOGV("LowMemory: %p\n", activity);
-    android_app_write_cmd(android_app, APP_CMD_LOW_MEMORY);
+    android_app_write_cmd(android_app, APP_CMD_LOW_MEMORY, NULL, NULL, 0);
 }
 
 static void onWindowFocusChanged(ANativeActivity* activity, int focused) {
     LOGV("WindowFocusChanged: %p -- %d\n", activity, focused);
     android_app_write_cmd((struct android_app*)activity->instance,
-            focused ? APP_CMD_GAINED_FOCUS : APP_CMD_LOST_FOCUS);
+            focused ? APP_CMD_GAINED_FOCUS : APP_CMD_LOST_FOCUS, NULL, NULL, 0);
 }
 
 static void onNativeWindowCreated(ANativeActivity* activity, ANativeWindow* window) {
@@ -411,6 +565,28 @@ static void onNativeWindowDestroyed(ANativeActivity* activity, ANativeWindow* wi
     android_app_set_window((struct android_app*)activity->instance, NULL);
 }
 
+static void onNativeWindowResized(ANativeActivity* activity, ANativeWindow* window) {
+    LOGV("NativeWindowResized: %p -- %p\n", activity, window);
+    android_app_write_cmd((struct android_app*)activity->instance,
+            APP_CMD_WINDOW_RESIZED, window, NULL, 0);
+}
+
+static void onNativeWindowRedrawNeeded(ANativeActivity* activity, ANativeWindow* window) {
+    struct android_app* android_app = (struct android_app*)activity->instance;
+    LOGV("NativeWindowRedrawNeeded: %p -- %p\n", activity, window);
+    // The window must have been redrawn when this returns.
+    uint32_t seq = android_app_write_cmd(android_app, APP_CMD_WINDOW_REDRAW_NEEDED,
+            window, NULL, 1);
+    android_app_wait_cmd(android_app, seq);
+}
+
+static void onContentRectChanged(ANativeActivity* activity, const ARect* rect) {
+    LOGV("ContentRectChanged: %p -- (%d,%d)-(%d,%d)\n", activity,
+            rect->left, rect->top, rect->right, rect->bottom);
+    android_app_write_cmd((struct android_app*)activity->instance,
+            APP_CMD_CONTENT_RECT_CHANGED, NULL, rect, 0);
+}
+
 static void onInputQueueCreated(ANativeActivity* activity, AInputQueue* queue) {
     LOGV("InputQueueCreated: %p -- %p\n", activity, queue);
     android_app_set_input((struct android_app*)activity->instance, queue);
@@ -435,6 +611,9 @@ void ANativeActivity_onCreate(ANativeActivity* activity,
     activity->callbacks->onWindowFocusChanged = onWindowFocusChanged;
     activity->callbacks->onNativeWindowCreated = onNativeWindowCreated;
     activity->callbacks->onNativeWindowDestroyed = onNativeWindowDestroyed;
+    activity->callbacks->onNativeWindowResized = onNativeWindowResized;
+    activity->callbacks->onNativeWindowRedrawNeeded = onNativeWindowRedrawNeeded;
+    activity->callbacks->onContentRectChanged = onContentRectChanged;
     activity->callbacks->onInputQueueCreated = onInputQueueCreated;
     activity->callbacks->onInputQueueDestroyed = onInputQueueDestroyed;
 
@@ -100,6 +100,33 @@ struct android_poll_source {
     void (*process)(struct android_app* app, struct android_poll_source* source);
 };
 
+/**
+ * Number of entries of the command ring of android_app.  The main thread
+ * waits when it is full, which should not happen in practice.
+ */
+#define ANDROID_APP_CMD_RING_SIZE 32
+
+/**
+ * A command sent from the main thread to the app thread, with its payload.
+ * Private to the glue code.
+ */
+struct android_app_cmd {
+    // The command, one of APP_CMD_XXX.
+    int8_t cmd;
+
+    // Non-zero if the main thread waits until the command is processed.
+    int8_t ack;
+
+    // Sequence number of the command.
+    uint32_t seq;
+
+    // The ANativeWindow or AInputQueue of the command, if any.
+    void* data;
+
+    // The content rect of APP_CMD_CONTENT_RECT_CHANGED.
+    ARect rect;
+};
+
 /**
  * This is the interface for the standard glue code of a threaded
  * application.  In this model, the application's code is running
@@ -122,6 +149,20 @@ struct android_app {
     // dispatching.
     int32_t (*onInputEvent)(struct android_app* app, AInputEvent* event);
 
+    // Optionally fill this in to receive consecutive AMOTION_EVENT_ACTION_MOVE
+    // events from the same device and source together, instead of one
+    // onInputEvent call each.  Each event still holds its own historical
+    // samples (see AMotionEvent_getHistorySize()).  The events have already
+    // been pre-dispatched, and will all be finished upon return.  Return 1
+    // if you have handled them, 0 for any default dispatching.
+    int32_t (*onInputBatch)(struct android_app* app, AInputEvent** events, int32_t count);
+
+    // Maximum number of input events processed each time LOOPER_ID_INPUT is
+    // returned, so that commands and other sources are not delayed by a
+    // burst of events.  The remaining ones are processed on the next poll.
+    // 0 means ANDROID_APP_DEFAULT_INPUT_BUDGET.
+    int32_t inputEventBudget;
+
     // The ANativeActivity object instance that this app is running in.
     ANativeActivity* activity;
 
@@ -167,9 +208,23 @@ struct android_app {
     pthread_mutex_t mutex;
     pthread_cond_t cond;
 
+    // Commands are written to cmdRing by the main thread, and read by the
+    // app thread.  msgread is readable while there are commands to read:
+    // it is an eventfd in semaphore mode (msgread == msgwrite) or, if not
+    // supported by the kernel, a pipe with one byte per command.
     int msgread;
     int msgwrite;
 
+    struct android_app_cmd cmdRing[ANDROID_APP_CMD_RING_SIZE];
+    volatile uint32_t cmdHead;
+    volatile uint32_t cmdTail;
+    // Set by the main thread, with the mutex held, while it waits for
+    // the app thread to free a slot of cmdRing.
+    volatile int cmdWriterWaiting;
+    uint32_t cmdSeq;
+    uint32_t cmdAckSeq;
+    struct android_app_cmd currentCmd;
+
     pthread_t thread;
 
     struct android_poll_source cmdPollSource;
@@ -184,6 +239,11 @@ struct android_app {
     ARect pendingContentRect;
 };
 
+/**
+ * Default value of android_app::inputEventBudget.
+ */
+#define ANDROID_APP_DEFAULT_INPUT_BUDGET 64
+
 enum {
     /**
      * Looper data ID of commands coming from the app's main thread, which
@@ -0,0 +1,51 @@
+LOCAL_PATH:= $(call my-dir)
+
+# The x86 kernels are built from the same source file in two modules, so
+# that only plasma_rows_ssse3() can use SSSE3 instructions.
+plasma_kernel_sse :=
+ifneq (,$(filter x86 host,$(TARGET_ARCH)))
+plasma_kernel_sse := true
+endif
+
+ifdef plasma_kernel_sse
+include $(CLEAR_VARS)
+LOCAL_MODULE:= plasma_kernel_sse2
+LOCAL_SRC_FILES:= plasma_kernel_sse.c
+LOCAL_CFLAGS:= -msse2
+include $(BUILD_STATIC_LIBRARY)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE:= plasma_kernel_ssse3
+LOCAL_SRC_FILES:= plasma_kernel_sse.c
+LOCAL_CFLAGS:= -mssse3
+include $(BUILD_STATIC_LIBRARY)
+endif
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE:= plasma_kernel
+LOCAL_SRC_FILES:= plasma_kernel.c
+LOCAL_EXPORT_C_INCLUDES := $(LOCAL_PATH)
+LOCAL_STATIC_LIBRARIES := android_native_app_frame
+
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+LOCAL_CFLAGS += -DPLASMA_HAVE_NEON
+LOCAL_SRC_FILES += plasma_kernel_neon.c.neon
+endif
+
+ifdef plasma_kernel_sse
+LOCAL_CFLAGS += -DPLASMA_HAVE_SSE
+LOCAL_STATIC_LIBRARIES += plasma_kernel_sse2 plasma_kernel_ssse3
+endif
+
+# The host ABIs don't have cpufeatures, cpuid is used instead.
+ifneq ($(TARGET_ARCH),host)
+LOCAL_STATIC_LIBRARIES += cpufeatures
+endif
+
+include $(BUILD_STATIC_LIBRARY)
+
+$(call import-module,android/native_app_frame)
+ifneq ($(TARGET_ARCH),host)
+$(call import-module,android/cpufeatures)
+endif
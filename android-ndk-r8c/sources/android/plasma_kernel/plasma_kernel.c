@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "android_native_app_frame.h"
+#include "plasma_kernel.h"
+#include "plasma_kernel_internal.h"
+
+#if defined(__ANDROID__)
+#include <cpu-features.h>
+#elif defined(PLASMA_HAVE_SSE)
+#include <cpuid.h>
+#endif
+
+/* We're going to perform computations for every pixel of the target
+ * bitmap. floating-point operations are very slow on ARMv5, and not
+ * too bad on ARMv7 with the exception of trigonometric functions.
+ *
+ * For better performance on all platforms, we're going to use fixed-point
+ * arithmetic and all kinds of tricks
+ */
+
+#define  FIXED_FROM_FLOAT(x)  ((Fixed)((x)*FIXED_ONE))
+
+typedef int32_t  Angle;
+
+#define  ANGLE_BITS              9
+
+#if ANGLE_BITS < 8
+#  error ANGLE_BITS must be at least 8
+#endif
+
+#define  ANGLE_2PI               (1 << ANGLE_BITS)
+#define  ANGLE_PI                (1 << (ANGLE_BITS-1))
+
+#if ANGLE_BITS <= FIXED_BITS
+#  define  ANGLE_FROM_FIXED(x)     (Angle)((x) >> (FIXED_BITS - ANGLE_BITS))
+#else
+#  define  ANGLE_FROM_FIXED(x)     (Angle)((x) << (ANGLE_BITS - FIXED_BITS))
+#endif
+
+static Fixed  angle_sin_tab[ANGLE_2PI+1];
+
+static void init_angles(void)
+{
+    int  nn;
+    for (nn = 0; nn < ANGLE_2PI+1; nn++) {
+        double  radians = nn*M_PI/ANGLE_PI;
+        angle_sin_tab[nn] = FIXED_FROM_FLOAT(sin(radians));
+    }
+}
+
+static __inline__ Fixed angle_sin( Angle  a )
+{
+    return angle_sin_tab[(uint32_t)a & (ANGLE_2PI-1)];
+}
+
+static __inline__ Fixed fixed_sin( Fixed  f )
+{
+    return angle_sin(ANGLE_FROM_FIXED(f));
+}
+
+#if PALETTE_BITS > FIXED_BITS
+#  error PALETTE_BITS must be smaller than FIXED_BITS
+#endif
+
+uint16_t  plasma_palette[PALETTE_SIZE];
+
+static uint16_t  make565(int red, int green, int blue)
+{
+    return (uint16_t)( ((red   << 8) & 0xf800) |
+                       ((green << 2) & 0x03e0) |
+                       ((blue  >> 3) & 0x001f) );
+}
+
+/* The palette is made of 4 linear ramps of PALETTE_SIZE/4 entries. Within
+ * ramp 'nn >> 6', 'jj' is (nn & 63)*255/64, which the SIMD kernels compute
+ * directly.
+ */
+static void init_palette(void)
+{
+    int  nn, mm = 0;
+    /* fun with colors */
+    for (nn = 0; nn < PALETTE_SIZE/4; nn++) {
+        int  jj = (nn-mm)*4*255/PALETTE_SIZE;
+        plasma_palette[nn] = make565(255, jj, 255-jj);
+    }
+
+    for ( mm = nn; nn < PALETTE_SIZE/2; nn++ ) {
+        int  jj = (nn-mm)*4*255/PALETTE_SIZE;
+        plasma_palette[nn] = make565(255-jj, 255, jj);
+    }
+
+    for ( mm = nn; nn < PALETTE_SIZE*3/4; nn++ ) {
+        int  jj = (nn-mm)*4*255/PALETTE_SIZE;
+        plasma_palette[nn] = make565(0, 255-jj, 255);
+    }
+
+    for ( mm = nn; nn < PALETTE_SIZE; nn++ ) {
+        int  jj = (nn-mm)*4*255/PALETTE_SIZE;
+        plasma_palette[nn] = make565(jj, 0, 255);
+    }
+}
+
+static int kernel_supported[PLASMA_KERNEL_COUNT];
+
+static const PlasmaRowsFunc kernel_funcs[PLASMA_KERNEL_COUNT] = {
+    [PLASMA_KERNEL_SCALAR] = plasma_rows_scalar,
+#ifdef PLASMA_HAVE_NEON
+    [PLASMA_KERNEL_NEON]   = plasma_rows_neon,
+#endif
+#ifdef PLASMA_HAVE_SSE
+    [PLASMA_KERNEL_SSE2]   = plasma_rows_sse2,
+    [PLASMA_KERNEL_SSSE3]  = plasma_rows_ssse3,
+#endif
+};
+
+static const char* const kernel_names[PLASMA_KERNEL_COUNT] = {
+    [PLASMA_KERNEL_AUTO]   = "auto",
+    [PLASMA_KERNEL_SCALAR] = "scalar",
+    [PLASMA_KERNEL_NEON]   = "neon",
+    [PLASMA_KERNEL_SSE2]   = "sse2",
+    [PLASMA_KERNEL_SSSE3]  = "ssse3",
+};
+
+static void init_kernels(void)
+{
+    kernel_supported[PLASMA_KERNEL_SCALAR] = 1;
+
+#if defined(__ANDROID__)
+    uint64_t features = android_getCpuFeatures();
+#  ifdef PLASMA_HAVE_NEON
+    if (android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
+        (features & ANDROID_CPU_ARM_FEATURE_NEON) != 0)
+        kernel_supported[PLASMA_KERNEL_NEON] = 1;
+#  endif
+#  ifdef PLASMA_HAVE_SSE
+    /* SSE2 is part of the x86 ABI. */
+    kernel_supported[PLASMA_KERNEL_SSE2] = 1;
+    if ((features & ANDROID_CPU_X86_FEATURE_SSSE3) != 0)
+        kernel_supported[PLASMA_KERNEL_SSSE3] = 1;
+#  endif
+    (void)features;
+#elif defined(PLASMA_HAVE_SSE)
+    /* The host ABIs don't have cpufeatures. */
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        if ((edx & bit_SSE2) != 0)
+            kernel_supported[PLASMA_KERNEL_SSE2] = 1;
+        if ((ecx & bit_SSSE3) != 0)
+            kernel_supported[PLASMA_KERNEL_SSSE3] = 1;
+    }
+#endif
+}
+
+static pthread_once_t  init_once = PTHREAD_ONCE_INIT;
+
+static void init_tables(void)
+{
+    init_palette();
+    init_angles();
+    init_kernels();
+}
+
+int plasma_kernel_is_supported(int kernel)
+{
+    pthread_once(&init_once, init_tables);
+    if (kernel == PLASMA_KERNEL_AUTO)
+        return 1;
+    if (kernel < 0 || kernel >= PLASMA_KERNEL_COUNT)
+        return 0;
+    return kernel_supported[kernel];
+}
+
+int plasma_kernel_best(void)
+{
+    /* In order of preference. */
+    static const int  best[] = {
+        PLASMA_KERNEL_NEON,
+        PLASMA_KERNEL_SSSE3,
+        PLASMA_KERNEL_SSE2,
+    };
+    size_t  nn;
+
+    for (nn = 0; nn < sizeof(best)/sizeof(best[0]); nn++) {
+        if (plasma_kernel_is_supported(best[nn]))
+            return best[nn];
+    }
+    return PLASMA_KERNEL_SCALAR;
+}
+
+const char* plasma_kernel_name(int kernel)
+{
+    if (kernel < 0 || kernel >= PLASMA_KERNEL_COUNT)
+        return NULL;
+    return kernel_names[kernel];
+}
+
+/* The scalar kernel. */
+void plasma_rows_scalar(uint8_t* pixels, int32_t stride, int32_t width,
+                        const Fixed* xterm, const Fixed* yterm, int32_t rows)
+{
+    int  yy, xx;
+    for (yy = 0; yy < rows; yy++) {
+        uint16_t*  line = (uint16_t*)pixels;
+        Fixed      base = yterm[yy];
+
+        for (xx = 0; xx < width; xx++)
+            line[xx] = plasma_palette_from_fixed((base + xterm[xx]) >> 2);
+
+        pixels += stride;
+    }
+}
+
+typedef struct {
+    uint8_t*        pixels;
+    int32_t         stride;
+    int32_t         width;
+    const Fixed*    xterm;
+    const Fixed*    yterm;
+    PlasmaRowsFunc  func;
+} RenderArgs;
+
+static void render_tiles(void* arg, int begin, int end)
+{
+    RenderArgs*  args = (RenderArgs*)arg;
+    args->func(args->pixels + (ptrdiff_t)begin * args->stride, args->stride,
+               args->width, args->xterm, args->yterm + begin, end - begin);
+}
+
+int plasma_render(const PlasmaBuffer* buffer, double t_ms, int kernel,
+                  struct android_jobs* jobs)
+{
+    RenderArgs  args;
+    Fixed*      terms;
+    int         nn;
+
+    if (kernel == PLASMA_KERNEL_AUTO)
+        kernel = plasma_kernel_best();
+    if (!plasma_kernel_is_supported(kernel))
+        return -1;
+    if (buffer->width <= 0 || buffer->height <= 0)
+        return 0;
+
+    terms = malloc((buffer->width + buffer->height) * sizeof(Fixed));
+    if (terms == NULL)
+        return -1;
+
+    args.pixels = (uint8_t*)buffer->pixels;
+    args.stride = buffer->stride;
+    args.width  = buffer->width;
+    args.xterm  = terms;
+    args.yterm  = terms + buffer->width;
+    args.func   = kernel_funcs[kernel];
+
+    /* The same increments as the original per-pixel loops. */
+    Fixed yt1 = FIXED_FROM_FLOAT(t_ms/1230.);
+    Fixed yt2 = yt1;
+    Fixed xt1 = FIXED_FROM_FLOAT(t_ms/3000.);
+    Fixed xt2 = xt1;
+
+#define  YT1_INCR   FIXED_FROM_FLOAT(1/100.)
+#define  YT2_INCR   FIXED_FROM_FLOAT(1/163.)
+#define  XT1_INCR   FIXED_FROM_FLOAT(1/173.)
+#define  XT2_INCR   FIXED_FROM_FLOAT(1/242.)
+
+    for (nn = 0; nn < buffer->height; nn++) {
+        terms[buffer->width + nn] = fixed_sin(yt1) + fixed_sin(yt2);
+        yt1 += YT1_INCR;
+        yt2 += YT2_INCR;
+    }
+    for (nn = 0; nn < buffer->width; nn++) {
+        terms[nn] = fixed_sin(xt1) + fixed_sin(xt2);
+        xt1 += XT1_INCR;
+        xt2 += XT2_INCR;
+    }
+
+    if (jobs != NULL)
+        android_jobs_parallel_for(jobs, buffer->height, PLASMA_TILE_ROWS,
+                                  render_tiles, &args);
+    else
+        render_tiles(&args, 0, buffer->height);
+
+    free(terms);
+    return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _PLASMA_KERNEL_H
+#define _PLASMA_KERNEL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The 'plasma_kernel' static library renders the plasma effect of the
+ * bitmap-plasma and native-plasma samples into a RGB_565 buffer.  It is
+ * also used as a pixel throughput benchmark, see
+ * tests/device/test-plasma-kernel.
+ *
+ * It has several implementations of the same kernel, which all produce
+ * exactly the same pixels:
+ *
+ *  - a portable C one,
+ *  - a NEON one, built for armeabi-v7a and used if the CPU has NEON,
+ *  - a SSE2 one, used on all x86 CPUs,
+ *  - a SSSE3 one, used on x86 CPUs that have SSSE3.
+ *
+ * The best one is selected at runtime with the 'cpufeatures' library.
+ * The rendering can also be split in tiles of PLASMA_TILE_ROWS rows that
+ * are rendered in parallel by the job system of 'android_native_app_frame'.
+ */
+
+struct android_jobs;
+
+enum {
+    PLASMA_KERNEL_AUTO = 0,     /* the best supported one */
+    PLASMA_KERNEL_SCALAR,
+    PLASMA_KERNEL_NEON,
+    PLASMA_KERNEL_SSE2,
+    PLASMA_KERNEL_SSSE3,
+
+    PLASMA_KERNEL_COUNT
+};
+
+/* The number of rows rendered by each job. */
+#define PLASMA_TILE_ROWS  16
+
+/**
+ * A RGB_565 buffer, e.g. a locked Bitmap or ANativeWindow.
+ */
+typedef struct {
+    void*    pixels;
+    int32_t  width;
+    int32_t  height;
+    /* The number of bytes between two rows. */
+    int32_t  stride;
+} PlasmaBuffer;
+
+/**
+ * Return 1 if the CPU supports a kernel, 0 otherwise.
+ */
+int plasma_kernel_is_supported(int kernel);
+
+/**
+ * Return the fastest kernel supported by the CPU.
+ */
+int plasma_kernel_best(void);
+
+/**
+ * Return the name of a kernel, e.g. "neon", or NULL if it is invalid.
+ */
+const char* plasma_kernel_name(int kernel);
+
+/**
+ * Render the plasma at time 't_ms' (in milliseconds) into 'buffer', with
+ * the given kernel.  If 'jobs' is not NULL, the tiles are rendered in
+ * parallel by its worker threads and the calling thread, otherwise they
+ * are all rendered by the calling thread.  Return 0 on success, or -1 if
+ * the kernel is not supported or if there is not enough memory.
+ */
+int plasma_render(const PlasmaBuffer* buffer, double t_ms, int kernel,
+                  struct android_jobs* jobs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PLASMA_KERNEL_H */
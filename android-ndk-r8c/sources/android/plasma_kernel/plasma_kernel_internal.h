@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _PLASMA_KERNEL_INTERNAL_H
+#define _PLASMA_KERNEL_INTERNAL_H
+
+#include <stdint.h>
+
+/* Fixed-point numbers with 16 fractional bits, like in the original
+ * samples.
+ */
+typedef int32_t  Fixed;
+
+#define  FIXED_BITS           16
+#define  FIXED_ONE            (1 << FIXED_BITS)
+#define  FIXED_FRAC(x)        ((x) & ((1 << FIXED_BITS)-1))
+
+/* Color palette used for rendering the plasma. */
+#define  PALETTE_BITS   8
+#define  PALETTE_SIZE   (1 << PALETTE_BITS)
+
+extern uint16_t  plasma_palette[PALETTE_SIZE];
+
+static __inline__ uint16_t  plasma_palette_from_fixed( Fixed  x )
+{
+    if (x < 0) x = -x;
+    if (x >= FIXED_ONE) x = FIXED_ONE-1;
+    int  idx = FIXED_FRAC(x) >> (FIXED_BITS - PALETTE_BITS);
+    return plasma_palette[idx & (PALETTE_SIZE-1)];
+}
+
+/* The plasma value of a pixel is the sum of a term that only depends on
+ * its row and one that only depends on its column. Both are computed once
+ * per frame, and a kernel renders 'rows' rows starting at 'pixels' where
+ * pixel (x,y) is:
+ *
+ *     plasma_palette_from_fixed((yterm[y] + xterm[x]) >> 2)
+ *
+ * The SIMD kernels compute the palette colors arithmetically instead of
+ * looking them up in plasma_palette, see init_palette() in plasma_kernel.c.
+ */
+typedef void (*PlasmaRowsFunc)(uint8_t* pixels, int32_t stride, int32_t width,
+                               const Fixed* xterm, const Fixed* yterm, int32_t rows);
+
+void plasma_rows_scalar(uint8_t* pixels, int32_t stride, int32_t width,
+                        const Fixed* xterm, const Fixed* yterm, int32_t rows);
+void plasma_rows_neon(uint8_t* pixels, int32_t stride, int32_t width,
+                      const Fixed* xterm, const Fixed* yterm, int32_t rows);
+void plasma_rows_sse2(uint8_t* pixels, int32_t stride, int32_t width,
+                      const Fixed* xterm, const Fixed* yterm, int32_t rows);
+void plasma_rows_ssse3(uint8_t* pixels, int32_t stride, int32_t width,
+                       const Fixed* xterm, const Fixed* yterm, int32_t rows);
+
+#endif /* _PLASMA_KERNEL_INTERNAL_H */
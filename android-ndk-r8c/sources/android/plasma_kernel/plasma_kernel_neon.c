@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* The NEON kernel, only built for armeabi-v7a with -mfpu=neon. It must
+ * only be called if android_getCpuFeatures() reports NEON.
+ */
+
+#include <arm_neon.h>
+
+#include "plasma_kernel_internal.h"
+
+/* Return the palette indices of 8 pixels, clamped to 255. */
+static __inline__ uint16x8_t plasma_index8(int32x4_t lo, int32x4_t hi)
+{
+    lo = vabsq_s32(vshrq_n_s32(lo, 2));
+    hi = vabsq_s32(vshrq_n_s32(hi, 2));
+    /* |x| <= FIXED_ONE, so the indices are at most 256 before clamping. */
+    int16x8_t  idx = vcombine_s16(vshrn_n_s32(lo, FIXED_BITS - PALETTE_BITS),
+                                  vshrn_n_s32(hi, FIXED_BITS - PALETTE_BITS));
+    return vminq_u16(vreinterpretq_u16_s16(idx), vdupq_n_u16(255));
+}
+
+/* Return the palette colors of 8 indices, see init_palette(). */
+static __inline__ uint16x8_t plasma_colors8(uint16x8_t idx)
+{
+    const uint16x8_t  c255 = vdupq_n_u16(255);
+    uint16x8_t  ramp = vshrq_n_u16(idx, 6);
+    uint16x8_t  jj   = vshrq_n_u16(vmulq_n_u16(vandq_u16(idx, vdupq_n_u16(63)), 255), 6);
+    uint16x8_t  ij   = vsubq_u16(c255, jj);
+    uint16x8_t  m0   = vceqq_u16(ramp, vdupq_n_u16(0));
+    uint16x8_t  m1   = vceqq_u16(ramp, vdupq_n_u16(1));
+    uint16x8_t  m2   = vceqq_u16(ramp, vdupq_n_u16(2));
+    uint16x8_t  m3   = vceqq_u16(ramp, vdupq_n_u16(3));
+    uint16x8_t  red, green, blue;
+
+    red   = vorrq_u16(vorrq_u16(vandq_u16(m0, c255), vandq_u16(m1, ij)), vandq_u16(m3, jj));
+    green = vorrq_u16(vorrq_u16(vandq_u16(m0, jj), vandq_u16(m1, c255)), vandq_u16(m2, ij));
+    blue  = vorrq_u16(vorrq_u16(vandq_u16(m0, ij), vandq_u16(m1, jj)),
+                      vandq_u16(vorrq_u16(m2, m3), c255));
+
+    return vorrq_u16(vorrq_u16(vandq_u16(vshlq_n_u16(red, 8), vdupq_n_u16(0xf800)),
+                               vandq_u16(vshlq_n_u16(green, 2), vdupq_n_u16(0x03e0))),
+                     vshrq_n_u16(blue, 3));
+}
+
+void plasma_rows_neon(uint8_t* pixels, int32_t stride, int32_t width,
+                      const Fixed* xterm, const Fixed* yterm, int32_t rows)
+{
+    int  yy, xx;
+
+    for (yy = 0; yy < rows; yy++) {
+        uint16_t*  line = (uint16_t*)pixels;
+        int32x4_t  base = vdupq_n_s32(yterm[yy]);
+
+        for (xx = 0; xx + 8 <= width; xx += 8) {
+            int32x4_t  lo = vaddq_s32(base, vld1q_s32(xterm + xx));
+            int32x4_t  hi = vaddq_s32(base, vld1q_s32(xterm + xx + 4));
+            vst1q_u16(line + xx, plasma_colors8(plasma_index8(lo, hi)));
+        }
+        for (; xx < width; xx++)
+            line[xx] = plasma_palette_from_fixed((yterm[yy] + xterm[xx]) >> 2);
+
+        pixels += stride;
+    }
+}
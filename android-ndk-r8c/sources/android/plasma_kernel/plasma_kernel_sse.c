@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* The x86 kernels. This file is built twice, with -msse2 for
+ * plasma_rows_sse2() and with -mssse3 for plasma_rows_ssse3(), in
+ * separate modules (see Android.mk), since the SSSE3 one must not be
+ * called on CPUs that don't support it.
+ */
+
+#include "plasma_kernel_internal.h"
+
+#ifdef __SSSE3__
+#  include <tmmintrin.h>
+#  define  PLASMA_ROWS_SSE  plasma_rows_ssse3
+#else
+#  include <emmintrin.h>
+#  define  PLASMA_ROWS_SSE  plasma_rows_sse2
+#endif
+
+/* Return the palette indices of 4 pixels, before clamping them to 255. */
+static __inline__ __m128i plasma_index4(__m128i ii)
+{
+    __m128i  x = _mm_srai_epi32(ii, 2);
+#ifdef __SSSE3__
+    x = _mm_abs_epi32(x);
+#else
+    __m128i  sign = _mm_srai_epi32(x, 31);
+    x = _mm_sub_epi32(_mm_xor_si128(x, sign), sign);
+#endif
+    /* |x| <= FIXED_ONE, so this is at most 256. */
+    return _mm_srli_epi32(x, FIXED_BITS - PALETTE_BITS);
+}
+
+/* Return the palette colors of 8 indices, see init_palette(). */
+static __inline__ __m128i plasma_colors8(__m128i idx)
+{
+    const __m128i  c255 = _mm_set1_epi16(255);
+    __m128i  ramp = _mm_srli_epi16(idx, 6);
+    __m128i  jj   = _mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(idx, _mm_set1_epi16(63)),
+                                                   c255), 6);
+    __m128i  ij   = _mm_sub_epi16(c255, jj);
+    __m128i  m0   = _mm_cmpeq_epi16(ramp, _mm_setzero_si128());
+    __m128i  m1   = _mm_cmpeq_epi16(ramp, _mm_set1_epi16(1));
+    __m128i  m2   = _mm_cmpeq_epi16(ramp, _mm_set1_epi16(2));
+    __m128i  m3   = _mm_cmpeq_epi16(ramp, _mm_set1_epi16(3));
+    __m128i  red, green, blue;
+
+    red   = _mm_or_si128(_mm_or_si128(_mm_and_si128(m0, c255), _mm_and_si128(m1, ij)),
+                         _mm_and_si128(m3, jj));
+    green = _mm_or_si128(_mm_or_si128(_mm_and_si128(m0, jj), _mm_and_si128(m1, c255)),
+                         _mm_and_si128(m2, ij));
+    blue  = _mm_or_si128(_mm_or_si128(_mm_and_si128(m0, ij), _mm_and_si128(m1, jj)),
+                         _mm_and_si128(_mm_or_si128(m2, m3), c255));
+
+    return _mm_or_si128(
+               _mm_or_si128(_mm_and_si128(_mm_slli_epi16(red, 8),
+                                          _mm_set1_epi16((short)0xf800)),
+                            _mm_and_si128(_mm_slli_epi16(green, 2),
+                                          _mm_set1_epi16(0x03e0))),
+               _mm_srli_epi16(blue, 3));
+}
+
+void PLASMA_ROWS_SSE(uint8_t* pixels, int32_t stride, int32_t width,
+                     const Fixed* xterm, const Fixed* yterm, int32_t rows)
+{
+    const __m128i  c255 = _mm_set1_epi16(255);
+    int  yy, xx;
+
+    for (yy = 0; yy < rows; yy++) {
+        uint16_t*  line = (uint16_t*)pixels;
+        __m128i    base = _mm_set1_epi32(yterm[yy]);
+
+        for (xx = 0; xx + 8 <= width; xx += 8) {
+            __m128i  lo  = _mm_add_epi32(base, _mm_loadu_si128((const __m128i*)(xterm + xx)));
+            __m128i  hi  = _mm_add_epi32(base, _mm_loadu_si128((const __m128i*)(xterm + xx + 4)));
+            __m128i  idx = _mm_min_epi16(_mm_packs_epi32(plasma_index4(lo), plasma_index4(hi)),
+                                         c255);
+            _mm_storeu_si128((__m128i*)(line + xx), plasma_colors8(idx));
+        }
+        for (; xx < width; xx++)
+            line[xx] = plasma_palette_from_fixed((yterm[yy] + xterm[xx]) >> 2);
+
+        pixels += stride;
+    }
+}
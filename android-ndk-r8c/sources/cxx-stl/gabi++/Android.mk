@@ -2,6 +2,18 @@ LOCAL_PATH:= $(call my-dir)
 
 include $(LOCAL_PATH)/sources.mk
 
+# Normally, we distribute the NDK with prebuilt binaries of GAbi++
+# in $LOCAL_PATH/libs/<abi>/. Rebuild them from sources when they are
+# missing, e.g. for the host-x86 and host-x86_64 ABIs.
+#
+GABIXX_FORCE_REBUILD := $(strip $(GABIXX_FORCE_REBUILD))
+ifndef GABIXX_FORCE_REBUILD
+  ifeq (,$(strip $(wildcard $(LOCAL_PATH)/libs/$(TARGET_ARCH_ABI)/libgabi++_static.a)))
+    $(call __ndk_info,WARNING: Rebuilding GAbi++ libraries from sources!)
+    GABIXX_FORCE_REBUILD := true
+  endif
+endif
+
 ifeq (,$(GABIXX_FORCE_REBUILD))
 
   include $(CLEAR_VARS)
@@ -21,11 +33,11 @@ ifeq (,$(GABIXX_FORCE_REBUILD))
 else # ! GABIXX_FORCE_REBUILD
 
   # Shared version of the library
-  # Note that the module is named libgabi++_shared to avoid
+  # Note that the library is named libgabi++_shared to avoid
   # any conflict with any potential system library named libgabi++
   #
   include $(CLEAR_VARS)
-  LOCAL_MODULE:= libgabi++_shared
+  LOCAL_MODULE:= gabi++_shared
   LOCAL_CPP_EXTENSION := .cc
   LOCAL_SRC_FILES:= $(libgabi++_src_files)
   LOCAL_EXPORT_C_INCLUDES := $(libgabi++_c_includes)
@@ -36,7 +48,7 @@ else # ! GABIXX_FORCE_REBUILD
   # And now the static version
   #
   include $(CLEAR_VARS)
-  LOCAL_MODULE:= libgabi++_static
+  LOCAL_MODULE:= gabi++_static
   LOCAL_SRC_FILES:= $(libgabi++_src_files)
   LOCAL_CPP_EXTENSION := .cc
   LOCAL_EXPORT_C_INCLUDES := $(libgabi++_c_includes)
@@ -45,6 +45,14 @@
 #include <stddef.h>
 #include <pthread.h>
 
+/* The GNU C library only provides a non-portable name for it, which is
+ * used when building for the host-x86 and host-x86_64 ABIs.
+ */
+#if !defined(PTHREAD_RECURSIVE_MUTEX_INITIALIZER) && \
+    defined(PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP)
+#define PTHREAD_RECURSIVE_MUTEX_INITIALIZER PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP
+#endif
+
 /* In this implementation, we use a single global mutex+condvar pair.
  *
  * Pros: portable and doesn't require playing with futexes, atomics
@@ -1,5 +1,12 @@
 LOCAL_PATH := $(call my-dir)
 
+# There are no prebuilt GNU libstdc++ binaries for the host ABIs.
+ifeq (host,$(TARGET_ARCH))
+    $(call __ndk_info,The GNU libstdc++ runtime (APP_STL := $(NDK_APP_STL)) is not supported for the $(TARGET_ARCH_ABI) ABI.)
+    $(call __ndk_info,Please use STLport or GAbi++ or the system C++ runtime instead.)
+    $(call __ndk_error,Aborting)
+endif
+
 # Compute the compiler flags to export by the module.
 # This is controlled by the APP_GNUSTL_FORCE_CPP_FEATURES variable.
 # See docs/APPLICATION-MK.html for all details.
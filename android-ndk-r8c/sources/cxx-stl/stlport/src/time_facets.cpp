@@ -428,7 +428,7 @@ void _STLP_CALL __write_formatted_timeT(_STLP_BASIC_IOSTRING(_Ch) &buf,
         break;
       {
         int diff;
-#    if defined (__USE_BSD) || defined (__BEOS__)
+#    if defined (__USE_BSD) || defined (__USE_MISC) || defined (__BEOS__)
         diff = t->tm_gmtoff;
 #    else
         diff = t->__tm_gmtoff;
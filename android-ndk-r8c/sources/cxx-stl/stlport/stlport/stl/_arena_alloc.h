@@ -0,0 +1,426 @@
+#ifndef _STLP_ARENA_ALLOC_H
+#define _STLP_ARENA_ALLOC_H
+
+/*
+ * Arena backed allocators.
+ * arena_allocator<_Tp> is a stateful allocator that only holds a pointer
+ * to an arena_resource. Rebound copies share the same resource, so the
+ * nodes of a list, slist, set/map (_Rb_tree) or hash container
+ * (_hashtable and its bucket vector) all come from the arena the container
+ * was constructed with.
+ *
+ * Two resources are provided:
+ * - monotonic_buffer_arena hands out memory by bumping a pointer through
+ *   geometrically growing blocks. deallocate is a no-op; everything is given
+ *   back to the upstream resource at once by release() or the destructor.
+ * - unsynchronized_pool_arena adds per size free lists on top of a monotonic
+ *   arena so that memory of erased nodes is recycled. Requests bigger than
+ *   _S_max_bytes, or aligned on more than _S_max_align, go straight to the
+ *   upstream resource.
+ * None of them do any locking: an arena must only be used by one thread at
+ * a time. A resource must outlive every container allocating from it.
+ * A default constructed arena_allocator uses new_delete_arena() which simply
+ * forwards to operator new and delete.
+ */
+
+#ifndef _STLP_INTERNAL_ALLOC_H
+#  include <stl/_alloc.h>
+#endif
+
+_STLP_BEGIN_NAMESPACE
+
+class arena_resource {
+public:
+  enum { _S_max_align = 2 * sizeof(void*) };
+
+  virtual ~arena_resource() {}
+
+  void* allocate(size_t __bytes, size_t __align = _S_max_align)
+  { return do_allocate(__bytes, __align); }
+  void deallocate(void* __p, size_t __bytes, size_t __align = _S_max_align)
+  { do_deallocate(__p, __bytes, __align); }
+
+protected:
+  virtual void* do_allocate(size_t __bytes, size_t __align) = 0;
+  virtual void do_deallocate(void* __p, size_t __bytes, size_t __align) = 0;
+};
+
+_STLP_MOVE_TO_PRIV_NAMESPACE
+
+class _New_delete_arena : public arena_resource {
+protected:
+  virtual void* do_allocate(size_t __bytes, size_t)
+  { return __stl_new(__bytes); }
+  virtual void do_deallocate(void* __p, size_t, size_t)
+  { __stl_delete(__p); }
+};
+
+inline char* _Arena_align_up(char* __p, size_t __align)
+{ return __REINTERPRET_CAST(char*, (__REINTERPRET_CAST(size_t, __p) + __align - 1) & ~(__align - 1)); }
+
+inline size_t _Arena_round_up(size_t __n, size_t __align)
+{ return (__n + __align - 1) & ~(__align - 1); }
+
+// Alignment of _Tp, capped to what the resources guaranty.
+template <class _Tp>
+struct _Arena_align_of {
+  struct _Probe { char _M_c; _Tp _M_t; };
+  enum { _Align = sizeof(_Probe) - sizeof(_Tp) };
+  enum { _Ret = (size_t)_Align < (size_t)arena_resource::_S_max_align ? (size_t)_Align
+                                                                     : (size_t)arena_resource::_S_max_align };
+};
+
+_STLP_MOVE_TO_STD_NAMESPACE
+
+inline arena_resource* new_delete_arena() _STLP_NOTHROW {
+  static _STLP_PRIV _New_delete_arena __r;
+  return &__r;
+}
+
+class monotonic_buffer_arena : public arena_resource {
+  struct _Block {
+    _Block* _M_next;
+    size_t _M_size;
+  };
+public:
+  enum { _S_default_size = 1024 };
+
+  explicit monotonic_buffer_arena(arena_resource* __upstream = new_delete_arena())
+    : _M_upstream(__upstream), _M_blocks(0), _M_buf(0), _M_buf_size(0),
+      _M_cur(0), _M_end(0), _M_initial_size(_S_default_size), _M_next_size(_S_default_size) {}
+
+  explicit monotonic_buffer_arena(size_t __initial_size,
+                                  arena_resource* __upstream = new_delete_arena())
+    : _M_upstream(__upstream), _M_blocks(0), _M_buf(0), _M_buf_size(0), _M_cur(0), _M_end(0),
+      _M_initial_size(__initial_size > sizeof(_Block) ? __initial_size : _S_default_size),
+      _M_next_size(_M_initial_size) {}
+
+  // Serves allocations from [__buf, __buf + __size) before asking the upstream resource.
+  monotonic_buffer_arena(void* __buf, size_t __size,
+                         arena_resource* __upstream = new_delete_arena())
+    : _M_upstream(__upstream), _M_blocks(0),
+      _M_buf(__STATIC_CAST(char*, __buf)), _M_buf_size(__size),
+      _M_cur(_M_buf), _M_end(_M_buf + __size),
+      _M_initial_size(2 * __size > (size_t)_S_default_size ? 2 * __size : (size_t)_S_default_size),
+      _M_next_size(_M_initial_size) {}
+
+  ~monotonic_buffer_arena() { release(); }
+
+  // Gives back every block to the upstream resource, all memory obtained
+  // from this arena becomes invalid.
+  void release() {
+    while (_M_blocks != 0) {
+      _Block* __next = _M_blocks->_M_next;
+      _M_upstream->deallocate(_M_blocks, _M_blocks->_M_size);
+      _M_blocks = __next;
+    }
+    _M_cur = _M_buf;
+    _M_end = _M_buf + _M_buf_size;
+    _M_next_size = _M_initial_size;
+  }
+
+  arena_resource* upstream_resource() const { return _M_upstream; }
+
+protected:
+  virtual void* do_allocate(size_t __bytes, size_t __align) {
+    if (__bytes == 0)
+      __bytes = 1;
+    char* __p = _STLP_PRIV _Arena_align_up(_M_cur, __align);
+    if (_M_cur == 0 || __p > _M_end || __STATIC_CAST(size_t, _M_end - __p) < __bytes) {
+      if (__bytes > _S_max_block() - __align) {
+        _STLP_THROW_BAD_ALLOC;
+      }
+      _M_new_block(__bytes + __align);
+      __p = _STLP_PRIV _Arena_align_up(_M_cur, __align);
+    }
+    _M_cur = __p + __bytes;
+    return __p;
+  }
+
+  virtual void do_deallocate(void*, size_t, size_t) {}
+
+private:
+  // Biggest request a block can hold.
+  static size_t _S_max_block()
+  { return __STATIC_CAST(size_t, -1) - sizeof(_Block); }
+
+  void _M_new_block(size_t __min_bytes) {
+    size_t __size = _M_next_size;
+    while (__size - sizeof(_Block) < __min_bytes) {
+      // Doubling would wrap around: ask for exactly what is needed.
+      if (__size > __STATIC_CAST(size_t, -1) / 2) {
+        __size = __min_bytes + sizeof(_Block);
+        break;
+      }
+      __size *= 2;
+    }
+    _Block* __b = __STATIC_CAST(_Block*, _M_upstream->allocate(__size));
+    __b->_M_next = _M_blocks;
+    __b->_M_size = __size;
+    _M_blocks = __b;
+    _M_cur = __REINTERPRET_CAST(char*, __b) + sizeof(_Block);
+    _M_end = __REINTERPRET_CAST(char*, __b) + __size;
+    _M_next_size = __size > __STATIC_CAST(size_t, -1) / 2 ? __size : __size * 2;
+  }
+
+  // Not copyable.
+  monotonic_buffer_arena(const monotonic_buffer_arena&);
+  monotonic_buffer_arena& operator=(const monotonic_buffer_arena&);
+
+  arena_resource* _M_upstream;
+  _Block* _M_blocks;
+  char* _M_buf;
+  size_t _M_buf_size;
+  char* _M_cur;
+  char* _M_end;
+  size_t _M_initial_size;
+  size_t _M_next_size;
+};
+
+class unsynchronized_pool_arena : public arena_resource {
+  struct _Free_obj {
+    _Free_obj* _M_next;
+  };
+  struct _Large_block {
+    _Large_block* _M_prev;
+    _Large_block* _M_next;
+    size_t _M_size;
+  };
+public:
+  enum { _S_grain = sizeof(void*) };
+  enum { _S_max_bytes = 256 };
+  enum { _S_nb_lists = _S_max_bytes / _S_grain };
+
+  explicit unsynchronized_pool_arena(arena_resource* __upstream = new_delete_arena())
+    : _M_chunks(__upstream), _M_large(0) {
+    for (size_t __i = 0; __i < (size_t)_S_nb_lists; ++__i)
+      _M_free[__i] = 0;
+  }
+
+  ~unsynchronized_pool_arena() { release(); }
+
+  // Gives back all the memory, even the one still in use, to the upstream resource.
+  void release() {
+    arena_resource* __upstream = upstream_resource();
+    while (_M_large != 0) {
+      _Large_block* __next = _M_large->_M_next;
+      __upstream->deallocate(_M_large, _M_large->_M_size);
+      _M_large = __next;
+    }
+    for (size_t __i = 0; __i < (size_t)_S_nb_lists; ++__i)
+      _M_free[__i] = 0;
+    _M_chunks.release();
+  }
+
+  arena_resource* upstream_resource() const { return _M_chunks.upstream_resource(); }
+
+protected:
+  virtual void* do_allocate(size_t __bytes, size_t __align) {
+    size_t __size = _S_pool_size(__bytes, __align);
+    if (__size > (size_t)_S_max_bytes) {
+      // The upstream resource only guaranties _S_max_align: room is left to
+      // align the returned pointer up, and the block is found back through
+      // the pointer stored just before it.
+      if (__align < (size_t)_S_max_align)
+        __align = _S_max_align;
+      if (__bytes > __STATIC_CAST(size_t, -1) - _S_large_header() - __align) {
+        _STLP_THROW_BAD_ALLOC;
+      }
+      size_t __total = _S_large_header() + __align + __bytes;
+      _Large_block* __b = __STATIC_CAST(_Large_block*, upstream_resource()->allocate(__total));
+      __b->_M_prev = 0;
+      __b->_M_next = _M_large;
+      __b->_M_size = __total;
+      if (_M_large != 0)
+        _M_large->_M_prev = __b;
+      _M_large = __b;
+      char* __p = _STLP_PRIV _Arena_align_up(__REINTERPRET_CAST(char*, __b) + _S_large_header(), __align);
+      __REINTERPRET_CAST(_Large_block**, __p)[-1] = __b;
+      return __p;
+    }
+    _Free_obj*& __list = _M_free[__size / _S_grain - 1];
+    if (__list != 0) {
+      _Free_obj* __ret = __list;
+      __list = __ret->_M_next;
+      return __ret;
+    }
+    return _M_chunks.allocate(__size, _S_max_align);
+  }
+
+  virtual void do_deallocate(void* __p, size_t __bytes, size_t __align) {
+    size_t __size = _S_pool_size(__bytes, __align);
+    if (__size > (size_t)_S_max_bytes) {
+      _Large_block* __b = __STATIC_CAST(_Large_block**, __p)[-1];
+      if (__b->_M_prev != 0)
+        __b->_M_prev->_M_next = __b->_M_next;
+      else
+        _M_large = __b->_M_next;
+      if (__b->_M_next != 0)
+        __b->_M_next->_M_prev = __b->_M_prev;
+      upstream_resource()->deallocate(__b, __b->_M_size);
+      return;
+    }
+    _Free_obj*& __list = _M_free[__size / _S_grain - 1];
+    _Free_obj* __obj = __STATIC_CAST(_Free_obj*, __p);
+    __obj->_M_next = __list;
+    __list = __obj;
+  }
+
+private:
+  // Free lists are only keyed by size: a block freed by a request may be
+  // handed back to a more aligned one, so every pool block is carved at
+  // _S_max_align. Over aligned requests are served as large blocks.
+  static size_t _S_pool_size(size_t __bytes, size_t __align) {
+    if (__align > (size_t)_S_max_align || __bytes > (size_t)_S_max_bytes)
+      return (size_t)_S_max_bytes + 1;
+    if (__bytes == 0)
+      __bytes = 1;
+    return _STLP_PRIV _Arena_round_up(__bytes, __align > (size_t)_S_grain ? __align : (size_t)_S_grain);
+  }
+
+  // The block header and the pointer back to it.
+  static size_t _S_large_header()
+  { return sizeof(_Large_block) + sizeof(_Large_block*); }
+
+  // Not copyable.
+  unsynchronized_pool_arena(const unsynchronized_pool_arena&);
+  unsynchronized_pool_arena& operator=(const unsynchronized_pool_arena&);
+
+  monotonic_buffer_arena _M_chunks;
+  _Large_block* _M_large;
+  _Free_obj* _M_free[_S_nb_lists];
+};
+
+template <class _Tp>
+class arena_allocator {
+public:
+  typedef size_t     size_type;
+  typedef ptrdiff_t  difference_type;
+  typedef _Tp*       pointer;
+  typedef const _Tp* const_pointer;
+  typedef _Tp&       reference;
+  typedef const _Tp& const_reference;
+  typedef _Tp        value_type;
+
+#ifdef _STLP_MEMBER_TEMPLATE_CLASSES
+  template <class _NewType> struct rebind {
+    typedef arena_allocator<_NewType> other;
+  };
+#endif
+
+  arena_allocator() _STLP_NOTHROW : _M_resource(new_delete_arena()) {}
+  arena_allocator(arena_resource* __r) _STLP_NOTHROW : _M_resource(__r) {}
+  arena_allocator(const arena_allocator<_Tp>& __a) _STLP_NOTHROW : _M_resource(__a._M_resource) {}
+
+#if defined (_STLP_MEMBER_TEMPLATES) /* && defined (_STLP_FUNCTION_PARTIAL_ORDER) */
+  template <class _OtherType> arena_allocator(const arena_allocator<_OtherType>& __a)
+    _STLP_NOTHROW : _M_resource(__a.resource()) {}
+#endif
+
+  ~arena_allocator() _STLP_NOTHROW {}
+
+  pointer address(reference __x) const { return &__x; }
+  const_pointer address(const_reference __x) const { return &__x; }
+
+  // __n is permitted to be 0.  The C++ standard says nothing about what
+  // the return value is when __n == 0.
+  _Tp* allocate(size_type __n, const void* = 0) {
+    if (__n > max_size()) {
+      _STLP_THROW_BAD_ALLOC;
+    }
+    if (__n != 0) {
+      size_type __buf_size = __n * sizeof(value_type);
+      _Tp* __ret = __STATIC_CAST(_Tp*, _M_resource->allocate(__buf_size, _STLP_PRIV _Arena_align_of<_Tp>::_Ret));
+#if defined (_STLP_DEBUG_UNINITIALIZED) && !defined (_STLP_DEBUG_ALLOC)
+      memset((char*)__ret, _STLP_SHRED_BYTE, __buf_size);
+#endif
+      return __ret;
+    }
+    else
+      return 0;
+  }
+
+  void deallocate(pointer __p, size_type __n) {
+    _STLP_ASSERT( (__p == 0) == (__n == 0) )
+    if (__p != 0) {
+#if defined (_STLP_DEBUG_UNINITIALIZED) && !defined (_STLP_DEBUG_ALLOC)
+      memset((char*)__p, _STLP_SHRED_BYTE, __n * sizeof(value_type));
+#endif
+      _M_resource->deallocate(__p, __n * sizeof(value_type), _STLP_PRIV _Arena_align_of<_Tp>::_Ret);
+    }
+  }
+
+  size_type max_size() const _STLP_NOTHROW
+  { return size_t(-1) / sizeof(_Tp); }
+
+  void construct(pointer __p, const _Tp& __val) { new(__p) _Tp(__val); }
+  void destroy(pointer _p) { _p->~_Tp(); }
+
+  arena_resource* resource() const { return _M_resource; }
+
+#if defined (_STLP_USE_PARTIAL_SPEC_WORKAROUND) && !defined (_STLP_FUNCTION_TMPL_PARTIAL_ORDER)
+  void _M_swap_workaround(arena_allocator<_Tp>& __x)
+  { _STLP_STD::swap(_M_resource, __x._M_resource); }
+#endif
+
+private:
+  arena_resource* _M_resource;
+};
+
+_STLP_TEMPLATE_NULL
+class arena_allocator<void> {
+public:
+  typedef size_t      size_type;
+  typedef ptrdiff_t   difference_type;
+  typedef void*       pointer;
+  typedef const void* const_pointer;
+  typedef void        value_type;
+#ifdef _STLP_MEMBER_TEMPLATE_CLASSES
+  template <class _NewType> struct rebind {
+    typedef arena_allocator<_NewType> other;
+  };
+#endif
+};
+
+template <class _T1, class _T2>
+inline bool operator==(const arena_allocator<_T1>& __a1,
+                       const arena_allocator<_T2>& __a2)
+{ return __a1.resource() == __a2.resource(); }
+
+#ifdef _STLP_FUNCTION_TMPL_PARTIAL_ORDER
+template <class _T1, class _T2>
+inline bool operator!=(const arena_allocator<_T1>& __a1,
+                       const arena_allocator<_T2>& __a2)
+{ return __a1.resource() != __a2.resource(); }
+#endif
+
+
+#if defined (_STLP_CLASS_PARTIAL_SPECIALIZATION)
+
+template <class _Tp, class _Atype>
+struct _Alloc_traits<_Tp, arena_allocator<_Atype> >
+{ typedef arena_allocator<_Tp> allocator_type; };
+
+#endif
+
+#if defined (_STLP_DONT_SUPPORT_REBIND_MEMBER_TEMPLATE)
+
+template <class _Tp1, class _Tp2>
+inline arena_allocator<_Tp2>&
+__stl_alloc_rebind(arena_allocator<_Tp1>& __x, const _Tp2*)
+{ return (arena_allocator<_Tp2>&)__x; }
+
+template <class _Tp1, class _Tp2>
+inline arena_allocator<_Tp2>
+__stl_alloc_create(arena_allocator<_Tp1>& __x, const _Tp2*)
+{ return arena_allocator<_Tp2>(__x.resource()); }
+
+#endif /* _STLP_DONT_SUPPORT_REBIND_MEMBER_TEMPLATE */
+
+_STLP_END_NAMESPACE
+
+#endif /* _STLP_ARENA_ALLOC_H */
+
+// Local Variables:
+// mode:C++
+// End:
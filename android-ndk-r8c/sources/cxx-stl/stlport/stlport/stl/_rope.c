@@ -103,6 +103,14 @@ void _Rope_iterator_base<_CharT,_Alloc>::_S_setbuf(
   case _RopeRep::_S_function:
   case _RopeRep::_S_substringfn:
     {
+      _CharT* __flat = __CONST_CAST(_CharT*, _Rope_flat_data(__leaf));
+      if (0 != __flat) {
+        // Substring of a leaf: iterate over the base characters in place.
+        __x._M_buf_start = __flat;
+        __x._M_buf_ptr = __flat + (__pos - __leaf_pos);
+        __x._M_buf_end = __flat + __leaf->_M_size._M_data;
+        break;
+      }
       size_t __len = _S_iterator_buf_len;
       size_t __buf_start_pos = __leaf_pos;
       size_t __leaf_end = __leaf_pos + __leaf->_M_size._M_data;
@@ -741,13 +749,67 @@ public:
     : _M_pattern(__p), _M_count(0) {}
   ~_Rope_find_char_char_consumer() {}
   bool operator() (const _CharT* __leaf, size_t __n) {
-    size_t __i;
-    for (__i = 0; __i < __n; ++__i) {
-      if (__leaf[__i] == _M_pattern) {
-        _M_count += __i; return false;
+    // find() resolves to memchr for plain chars.
+    const _CharT* __hit = _STLP_STD::find(__leaf, __leaf + __n, _M_pattern);
+    _M_count += __hit - __leaf;
+    return __hit == __leaf + __n;
+  }
+};
+
+template<class _CharT>
+class _Rope_compare_char_consumer : public _Rope_char_consumer<_CharT> {
+private:
+  const _CharT* _M_pattern;
+public:
+  _Rope_compare_char_consumer(const _CharT* __p)
+    : _M_pattern(__p) {}
+  ~_Rope_compare_char_consumer() {}
+  bool operator() (const _CharT* __leaf, size_t __n) {
+    if (char_traits<_CharT>::compare(__leaf, _M_pattern, __n) != 0)
+      return false;
+    _M_pattern += __n; return true;
+  }
+};
+
+// Looks for a character sequence one piece at a time. Candidates are
+// located with find() on the first character; only a match running
+// off the end of a piece has to go back to the tree.
+template<class _CharT, class _Alloc>
+class _Rope_find_seq_char_consumer : public _Rope_char_consumer<_CharT> {
+private:
+  _Rope_RopeRep<_CharT,_Alloc>* _M_root;
+  const _CharT* _M_pattern;
+  size_t _M_len;
+  size_t _M_pos;   // Position of the current piece in the rope
+public:
+  size_t _M_result;
+  _Rope_find_seq_char_consumer(_Rope_RopeRep<_CharT,_Alloc>* __r,
+                               const _CharT* __p, size_t __len,
+                               size_t __start, size_t __not_found)
+    : _M_root(__r), _M_pattern(__p), _M_len(__len), _M_pos(__start),
+      _M_result(__not_found) {}
+  ~_Rope_find_seq_char_consumer() {}
+  bool operator() (const _CharT* __leaf, size_t __n) {
+    const _CharT* __end = __leaf + __n;
+    for (const _CharT* __p = __leaf; ; ++__p) {
+      __p = _STLP_STD::find(__p, __end, _M_pattern[0]);
+      if (__p == __end) break;
+      size_t __avail = __end - __p;
+      if (__avail >= _M_len) {
+        if (char_traits<_CharT>::compare(__p + 1, _M_pattern + 1, _M_len - 1) == 0) {
+          _M_result = _M_pos + (__p - __leaf);
+          return false;
+        }
+      } else if (char_traits<_CharT>::compare(__p + 1, _M_pattern + 1, __avail - 1) == 0) {
+        size_t __at = _M_pos + (__p - __leaf);
+        _Rope_compare_char_consumer<_CharT> __c(_M_pattern + __avail);
+        if (_S_apply_to_pieces(__c, _M_root, __at + __avail, __at + _M_len)) {
+          _M_result = __at;
+          return false;
+        }
       }
     }
-    _M_count += __n; return true;
+    _M_pos += __n; return true;
   }
 };
 
@@ -791,6 +853,9 @@ bool _S_apply_to_pieces(_CharConsumer& __c,
   typedef _Rope_RopeFunction<_CharT,_Alloc> _RopeFunction;
 
   if (0 == __r) return true;
+  // Leaves, flattened subtrees and substrings of leaves go in one piece.
+  const _CharT* __flat = _Rope_flat_data(__r);
+  if (0 != __flat) return __c(__flat + __begin, __end - __begin);
   switch(__r->_M_tag) {
   case _RopeRep::_S_concat:
   {
@@ -913,10 +978,28 @@ size_t rope<_CharT,_Alloc>::find(_CharT __pattern, size_t __start) const {
   return __result_pos;
 }
 
+template <class _CharT, class _Alloc>
+size_t rope<_CharT,_Alloc>::_M_find_seq(const _CharT* __s, size_t __n,
+                                        size_t __pos) const {
+  size_t __len = size();
+  if (__pos >= __len || __n > __len - __pos) return __len;
+  if (0 == __n) return __pos;
+  _RopeRep* __r = _M_tree_ptr._M_data;
+  _Rope_find_seq_char_consumer<_CharT,_Alloc> __c(__r, __s, __n, __pos, __len);
+  // Only positions up to __len - __n can start a match.
+  _S_apply_to_pieces(__c, __r, __pos, __len - __n + 1);
+  return __c._M_result;
+}
+
 template <class _CharT, class _Alloc>
 _CharT*
 rope<_CharT,_Alloc>::_S_flatten(_Rope_RopeRep<_CharT, _Alloc>* __r, _CharT* __buffer) {
   if (0 == __r) return __buffer;
+  // Reuse whatever a previous c_str() already flattened, so that
+  // flattening an appended-to rope only walks the new pieces.
+  const _CharT* __flat = _Rope_flat_data(__r);
+  if (0 != __flat)
+    return _STLP_PRIV __ucopy_n(__flat, __r->_M_size._M_data, __buffer).second;
   switch(__r->_M_tag) {
   case _RopeRep::_S_concat:
   {
@@ -1122,11 +1205,10 @@ template <class _CharT, class _Alloc>
 _CharT
 rope<_CharT,_Alloc>::_S_fetch(_RopeRep* __r, size_type __i)
 {
-    _CharT* __cstr = __r->_M_c_string;
-
     _STLP_ASSERT(__i < __r->_M_size._M_data)
-    if (0 != __cstr) return __cstr[__i];
     for(;;) {
+      const _CharT* __flat = _Rope_flat_data(__r);
+      if (0 != __flat) return __flat[__i];
       switch(__r->_M_tag) {
   case _RopeRep::_S_concat:
       {
@@ -610,6 +610,38 @@ public:
   { _M_base->_M_unref_nonnil(); }
 };
 
+/*
+ * Returns a pointer to contiguous storage holding the characters
+ * of __r, or 0 if there is none. Leaves, nodes with a cached
+ * flattened string and substrings of either are served in place;
+ * anything else has to go through flattening or its char_producer.
+ * The result is owned by the tree and is not 0 terminated.
+ */
+template<class _CharT, class _Alloc>
+inline const _CharT* _Rope_flat_data(const _Rope_RopeRep<_CharT,_Alloc>* __r) {
+  typedef _Rope_RopeRep<_CharT,_Alloc> _RopeRep;
+  typedef _Rope_RopeLeaf<_CharT,_Alloc> _RopeLeaf;
+  typedef _Rope_RopeSubstring<_CharT,_Alloc> _RopeSubstring;
+  const _CharT* __cstr = __r->_M_c_string;
+  if (0 != __cstr) return __cstr;
+  switch (__r->_M_tag) {
+  case _RopeRep::_S_leaf:
+    return __STATIC_CAST(const _RopeLeaf*, __r)->_M_data;
+  case _RopeRep::_S_substringfn:
+    {
+      const _RopeSubstring* __sub = __STATIC_CAST(const _RopeSubstring*, __r);
+      const _RopeRep* __base = __sub->_M_base;
+      __cstr = __base->_M_c_string;
+      if (0 == __cstr && _RopeRep::_S_leaf == __base->_M_tag) {
+        __cstr = __STATIC_CAST(const _RopeLeaf*, __base)->_M_data;
+      }
+      return (0 != __cstr) ? __cstr + __sub->_M_start : 0;
+    }
+  default:
+    return 0;
+  }
+}
+
 /*
  * Self-destructing pointers to Rope_rep.
  * These are not conventional smart pointers.  Their
@@ -1296,6 +1328,10 @@ private:
                             size_t __start, size_t __len,
                             _CharT* __buffer);
 
+  // Position of the first occurrence of __s[0, __n) at or after __pos,
+  // or size() if there is none.  Scans the tree leaf by leaf.
+  size_t _M_find_seq(const _CharT* __s, size_t __n, size_t __pos) const;
+
   // fbp : HP aCC prohibits access to protected min_len from within static methods ( ?? )
 public:
   static const unsigned long _S_min_len[__ROPE_DEPTH_SIZE];
@@ -1976,8 +2012,14 @@ public:
 # endif
 
     size_type __result_pos;
-    const_iterator __result = _STLP_STD::search(const_begin() + (ptrdiff_t)__pos, const_end(), __s.begin(), __s.end() );
-    __result_pos = __result.index();
+    _RopeRep* __pattern = __s._M_tree_ptr._M_data;
+    const _CharT* __flat = (0 == __pattern) ? _S_empty_c_str : _Rope_flat_data(__pattern);
+    if (0 != __flat) {
+      __result_pos = _M_find_seq(__flat, __s.size(), __pos);
+    } else {
+      const_iterator __result = _STLP_STD::search(const_begin() + (ptrdiff_t)__pos, const_end(), __s.begin(), __s.end() );
+      __result_pos = __result.index();
+    }
 # ifndef _STLP_OLD_ROPE_SEMANTICS
     if (__result_pos == size()) __result_pos = npos;
 # endif
@@ -1985,10 +2027,7 @@ public:
   }
   size_type find(_CharT __c, size_type __pos = 0) const;
   size_type find(const _CharT* __s, size_type __pos = 0) const {
-    size_type __result_pos;
-    const_iterator __result = _STLP_STD::search(const_begin() + (ptrdiff_t)__pos, const_end(),
-                                                __s, __s + _S_char_ptr_len(__s));
-    __result_pos = __result.index();
+    size_type __result_pos = _M_find_seq(__s, _S_char_ptr_len(__s), __pos);
 # ifndef _STLP_OLD_ROPE_SEMANTICS
     if (__result_pos == size()) __result_pos = npos;
 # endif
@@ -63,8 +63,10 @@
 // Include most of the gcc settings.
 #include <stl/config/_gcc.h>
 
-// Do not use glibc, Android is missing some things.
+// Do not use glibc, Android is missing some things. Host builds do use it.
+#ifdef __ANDROID__
 #undef _STLP_USE_GLIBC
+#endif
 
 // No exceptions.
 #define _STLP_NO_UNCAUGHT_EXCEPT_SUPPORT 1
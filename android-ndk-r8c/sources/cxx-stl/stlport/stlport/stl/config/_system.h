@@ -59,8 +59,10 @@
 #  elif defined (__HP_aCC)
 #    include <stl/config/_hpacc.h>
 #  endif
-#elif defined (__ANDROID__)
-/* Android mobile phone platform. Somewhat but not entirely GNU/Linux-like */
+#elif defined (__ANDROID__) || defined (ANDROID)
+/* Android mobile phone platform. Somewhat but not entirely GNU/Linux-like.
+ * ANDROID is also defined by ndk-build for the host-x86 and host-x86_64
+ * ABIs, which use the same configuration on top of the host's C library. */
 #  include <stl/config/_android.h>
 #elif defined (linux) || defined (__linux__)
 #  include <stl/config/_linux.h>
@@ -0,0 +1,118 @@
+# Check that NDK_BUILD_TRACE=<file> records every compile, assembler
+# filter, archive, link, install and strip command into a valid Chrome
+# trace-event file (see check-trace.py), prints a summary of the slowest
+# translation units and modules, and also works when the build fails.
+#
+
+PROGDIR=$(dirname $0)
+PROGDIR=$(cd "$PROGDIR" && pwd)
+
+TRACE=$PROGDIR/obj/trace.json
+
+cleanup ()
+{
+    rm -rf "$PROGDIR/obj" "$PROGDIR/libs" "$PROGDIR/build.log"
+}
+
+fail ()
+{
+    echo "ERROR: $@"
+    cleanup
+    exit 1
+}
+
+# $1+: ndk-build arguments
+run_build ()
+{
+    $NDK/ndk-build -C "$PROGDIR" "$@" > "$PROGDIR/build.log" 2>&1
+    if [ $? != 0 ]; then
+        cat "$PROGDIR/build.log"
+        fail "Could not build: $@"
+    fi
+}
+
+# $1: message that must appear in the build log
+check_log ()
+{
+    if ! grep -q -F -e "$1" "$PROGDIR/build.log"; then
+        cat "$PROGDIR/build.log"
+        fail "Missing '$1' in build log"
+    fi
+}
+
+# $1+: check-trace.py arguments
+check_trace ()
+{
+    if [ -z "$PYTHON" ]; then
+        return
+    fi
+    $PYTHON "$PROGDIR/check-trace.py" "$TRACE" "$@"
+    if [ $? != 0 ]; then
+        fail "Invalid build trace: $TRACE"
+    fi
+}
+
+PYTHON=
+for PROG in python python3; do
+    if $PROG -c "import json" > /dev/null 2>&1; then
+        PYTHON=$PROG
+        break
+    fi
+done
+if [ -z "$PYTHON" ]; then
+    echo "WARNING: Python not found, the trace file won't be checked!"
+fi
+
+cleanup
+
+run_build -j4 NDK_BUILD_TRACE=obj/trace.json "$@"
+if [ ! -f "$TRACE" ]; then
+    fail "Missing trace file: $TRACE"
+fi
+if [ -f "$TRACE.log" ]; then
+    fail "The trace log was not removed"
+fi
+check_log "Build trace    : $TRACE"
+check_log "Slowest translation units:"
+check_log "Slowest modules:"
+check_trace \
+    compile:trace_static:/static.c \
+    archive:trace_static:libtrace_static.a \
+    compile:trace_shared:/shared.c \
+    asm-filter:trace_shared:/shared.s \
+    compile:trace_shared:/shared.filtered.s \
+    compile:trace_shared:/shared2.cpp \
+    asm-filter:trace_shared:/shared2.s \
+    compile:trace_shared:/shared2.filtered.s \
+    link:trace_shared:libtrace_shared.so \
+    install:trace_shared:libtrace_shared.so \
+    strip:trace_shared:libtrace_shared.so \
+    compile:trace_exe:/main.c \
+    link:trace_exe:trace_exe \
+    install:trace_exe:trace_exe \
+    strip:trace_exe:trace_exe
+
+# A no-op build only reinstalls the binaries.
+run_build NDK_BUILD_TRACE=obj/trace.json "$@"
+check_trace install:trace_exe:trace_exe strip:trace_exe:trace_exe
+if grep -q -e '"cat":"\(compile\|archive\|link\)"' "$TRACE"; then
+    fail "A no-op build traced build commands"
+fi
+
+# Failed commands are recorded too.
+$NDK/ndk-build -C "$PROGDIR" -B NDK_BUILD_TRACE=obj/trace.json TRACE_BROKEN=1 "$@" > "$PROGDIR/build.log" 2>&1
+if [ $? = 0 ]; then
+    fail "The broken build succeeded"
+fi
+check_log "1 command(s) failed"
+check_trace compile:trace_exe:/main.c
+
+# Without NDK_BUILD_TRACE, nothing is recorded.
+rm -f "$TRACE"
+run_build -B "$@"
+if [ -f "$TRACE" -o -f "$TRACE.log" ]; then
+    fail "A trace was generated without NDK_BUILD_TRACE"
+fi
+
+cleanup
+echo "Build traces work."
@@ -0,0 +1,111 @@
+#!/usr/bin/env python
+#
+# Check that a file generated with NDK_BUILD_TRACE is a valid Chrome
+# trace-event file, and that it contains the expected events.
+#
+# Usage: check-trace.py <trace-file> [<category>:<module>:<name> ...]
+#
+# Each <category>:<module>:<name> is an event that must be present, where
+# <name> can be a suffix of the actual event name (e.g. the source file
+# name without its directory).
+#
+
+import json
+import sys
+
+CATEGORIES = ('compile', 'asm-filter', 'archive', 'link', 'install', 'strip')
+
+
+def fail(message):
+    sys.stderr.write('ERROR: %s\n' % message)
+    sys.exit(1)
+
+
+def check_int(event, key):
+    value = event.get(key)
+    if not isinstance(value, int) or isinstance(value, bool) or value < 0:
+        fail('Invalid %s in %s' % (key, event))
+    return value
+
+
+def check_string(obj, key, event):
+    value = obj.get(key)
+    if not isinstance(value, type(u'')) and not isinstance(value, str):
+        fail('Invalid %s in %s' % (key, event))
+    return value
+
+
+def main(argv):
+    if len(argv) < 2:
+        fail('Usage: check-trace.py <trace-file> [<category>:<module>:<name> ...]')
+
+    with open(argv[1]) as f:
+        try:
+            trace = json.load(f)
+        except ValueError as e:
+            fail('Invalid JSON in %s: %s' % (argv[1], e))
+
+    if not isinstance(trace, dict) or not isinstance(trace.get('traceEvents'), list):
+        fail('Missing traceEvents list')
+
+    commands = []
+    slots = {}
+    for event in trace['traceEvents']:
+        if not isinstance(event, dict):
+            fail('Invalid event: %s' % event)
+        check_string(event, 'name', event)
+        pid = check_int(event, 'pid')
+        tid = check_int(event, 'tid')
+        args = event.get('args')
+        if not isinstance(args, dict):
+            fail('Missing args in %s' % event)
+        phase = event.get('ph')
+        if phase == 'M':
+            if event['name'] not in ('process_name', 'thread_name'):
+                fail('Unknown metadata event: %s' % event)
+            check_string(args, 'name', event)
+        elif phase == 'X':
+            ts = check_int(event, 'ts')
+            dur = check_int(event, 'dur')
+            check_string(args, 'abi', event)
+            category = check_string(event, 'cat', event)
+            if pid == 1:
+                if category not in CATEGORIES:
+                    fail('Unknown category in %s' % event)
+                check_string(args, 'module', event)
+                if not isinstance(args.get('status'), int):
+                    fail('Invalid status in %s' % event)
+                commands.append(event)
+                # Commands that ran in the same job slot can't overlap.
+                slots.setdefault(tid, []).append((ts, ts + dur))
+            elif pid == 2:
+                if category != 'module':
+                    fail('Unknown category in %s' % event)
+                check_int(args, 'commands')
+                check_int(args, 'time_us')
+            else:
+                fail('Unknown pid in %s' % event)
+        else:
+            fail('Unknown phase in %s' % event)
+
+    for tid, spans in slots.items():
+        spans.sort()
+        for n in range(1, len(spans)):
+            if spans[n][0] < spans[n - 1][1]:
+                fail('Overlapping commands in job slot %d' % tid)
+
+    for expected in argv[2:]:
+        category, module, name = expected.split(':', 2)
+        for event in commands:
+            if (event['cat'] == category and
+                    event['args']['module'] == module and
+                    event['name'].endswith(name)):
+                break
+        else:
+            fail('Missing %s event for %s <= %s' % (category, module, name))
+
+    print('%d commands in %d job slots' % (len(commands), len(slots)))
+
+
+if __name__ == '__main__':
+    main(sys.argv)
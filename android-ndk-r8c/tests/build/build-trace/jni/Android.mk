@@ -0,0 +1,22 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := trace_static
+LOCAL_SRC_FILES := static.c
+include $(BUILD_STATIC_LIBRARY)
+
+# Uses 'cp' as a no-op assembler filter.
+include $(CLEAR_VARS)
+LOCAL_MODULE := trace_shared
+LOCAL_SRC_FILES := shared.c shared2.cpp
+LOCAL_STATIC_LIBRARIES := trace_static
+LOCAL_FILTER_ASM := cp
+include $(BUILD_SHARED_LIBRARY)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := trace_exe
+LOCAL_SRC_FILES := main.c
+ifdef TRACE_BROKEN
+LOCAL_CFLAGS := -DTRACE_BROKEN
+endif
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,8 @@
+#ifdef TRACE_BROKEN
+#error This is used to check that failed builds are traced
+#endif
+
+int main(void)
+{
+    return 0;
+}
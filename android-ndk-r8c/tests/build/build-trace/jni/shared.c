@@ -0,0 +1,7 @@
+extern int trace_static(int x);
+extern int trace_shared2(int x);
+
+int trace_shared(int x)
+{
+    return trace_static(x) + trace_shared2(x);
+}
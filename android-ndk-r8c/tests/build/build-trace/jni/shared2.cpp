@@ -0,0 +1,4 @@
+extern "C" int trace_shared2(int x)
+{
+    return x + 1;
+}
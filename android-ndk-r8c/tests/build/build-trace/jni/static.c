@@ -0,0 +1,4 @@
+int trace_static(int x)
+{
+    return x * 2;
+}
@@ -0,0 +1,206 @@
+# Check that APP_DEPS_DATABASE doesn't change what is rebuilt when
+# headers are modified or removed, that the module databases are only
+# updated for rebuilt objects, and that they are regenerated when
+# removed.
+#
+# Then compare the latency of no-op builds of a module with many
+# sources, with and without the databases.
+#
+
+PROGDIR=$(dirname $0)
+PROGDIR=$(cd "$PROGDIR" && pwd)
+
+# Number of generated sources for the timing comparison.
+SOURCE_COUNT=500
+
+# Number of no-op builds timed for each case.
+RUN_COUNT=10
+
+DATABASE=$PROGDIR/obj/local/x86/objs/deps_test/deps.mk
+
+cleanup ()
+{
+    rm -rf "$PROGDIR/obj" "$PROGDIR/libs" "$PROGDIR/jni/gen" "$PROGDIR/jni/timing" "$PROGDIR/build.log"
+}
+
+fail ()
+{
+    echo "ERROR: $@"
+    cleanup
+    exit 1
+}
+
+# $1+: ndk-build arguments
+run_build ()
+{
+    $NDK/ndk-build -C "$PROGDIR" "$@" > "$PROGDIR/build.log" 2>&1
+    if [ $? != 0 ]; then
+        cat "$PROGDIR/build.log"
+        fail "Could not build: $@"
+    fi
+}
+
+# $1+: list of words
+sort_words ()
+{
+    echo $@ | tr ' ' '\n' | sort | tr '\n' ' '
+}
+
+# $1: expected list of compiled files, in any order
+check_compiled ()
+{
+    local COMPILED EXPECTED
+    COMPILED=$(sort_words $(grep -e "^Compile" "$PROGDIR/build.log" | sed -e 's/.* <= //'))
+    EXPECTED=$(sort_words $1)
+    if [ "$COMPILED" != "$EXPECTED" ]; then
+        fail "Compiled '$COMPILED' instead of '$EXPECTED'"
+    fi
+}
+
+# $1: file to modify
+modify ()
+{
+    # Ensure the new timestamp is more recent than the objects'.
+    sleep 1
+    touch "$PROGDIR/jni/$1"
+}
+
+# $1: value of APP_DEPS_DATABASE
+# $2+: ndk-build arguments
+check_rebuilds ()
+{
+    local MODE=$1
+    shift
+    cleanup
+    mkdir -p "$PROGDIR/jni/gen" || fail "Could not create $PROGDIR/jni/gen"
+    cp "$PROGDIR/jni/include/extra.h" "$PROGDIR/jni/gen/extra.h"
+
+    run_build APP_DEPS_DATABASE=$MODE "$@"
+    check_compiled "lib.c main.c a.c b.c c.cpp"
+
+    run_build APP_DEPS_DATABASE=$MODE "$@"
+    check_compiled ""
+
+    modify include/a.h
+    run_build APP_DEPS_DATABASE=$MODE "$@"
+    check_compiled "main.c a.c"
+
+    modify include/common.h
+    run_build APP_DEPS_DATABASE=$MODE "$@"
+    check_compiled "lib.c a.c b.c"
+
+    # Removing a header must not break the build.
+    rm -f "$PROGDIR/jni/gen/extra.h"
+    run_build APP_DEPS_DATABASE=$MODE "$@"
+    check_compiled "c.cpp"
+
+    modify include/extra.h
+    run_build APP_DEPS_DATABASE=$MODE "$@"
+    check_compiled "c.cpp"
+
+    run_build APP_DEPS_DATABASE=$MODE "$@"
+    check_compiled ""
+}
+
+cleanup
+
+check_rebuilds false "$@"
+if [ -f "$DATABASE" ]; then
+    fail "APP_DEPS_DATABASE=false generated a database"
+fi
+
+check_rebuilds true "$@"
+if [ ! -f "$DATABASE" ]; then
+    fail "Missing dependency database: $DATABASE"
+fi
+if grep -q -e "gen/extra.h" "$DATABASE"; then
+    fail "The database still lists a removed header"
+fi
+if [ "$(grep -c -e '\.o: ' "$DATABASE")" != 4 ]; then
+    cat "$DATABASE"
+    fail "The database should have one rule per object"
+fi
+
+# A removed database is regenerated from all dependency files.
+rm -f "$DATABASE"
+run_build APP_DEPS_DATABASE=true "$@"
+check_compiled ""
+if [ ! -f "$DATABASE" ]; then
+    fail "The dependency database was not regenerated"
+fi
+modify include/common.h
+run_build APP_DEPS_DATABASE=true "$@"
+check_compiled "lib.c a.c b.c"
+
+# Switching modes must not rebuild anything.
+run_build APP_DEPS_DATABASE=false "$@"
+check_compiled ""
+modify include/a.h
+run_build APP_DEPS_DATABASE=false "$@"
+check_compiled "main.c a.c"
+run_build APP_DEPS_DATABASE=true "$@"
+check_compiled ""
+
+# Timing comparison.
+mkdir -p "$PROGDIR/jni/timing" || fail "Could not create $PROGDIR/jni/timing"
+cat > "$PROGDIR/jni/timing/Android.mk" <<EOT
+LOCAL_PATH := \$(call my-dir)
+
+include \$(CLEAR_VARS)
+LOCAL_MODULE := deps_timing
+LOCAL_SRC_FILES := \$(notdir \$(wildcard \$(LOCAL_PATH)/*.c))
+LOCAL_C_INCLUDES := \$(LOCAL_PATH)/../include
+include \$(BUILD_STATIC_LIBRARY)
+EOT
+NUM=0
+while [ $NUM -lt $SOURCE_COUNT ]; do
+    cat > "$PROGDIR/jni/timing/timing$NUM.c" <<EOT
+#include <stdio.h>
+#include <string.h>
+#include "common.h"
+
+int timing$NUM(const char* name)
+{
+    return (int)strlen(name) + COMMON_VALUE + $NUM;
+}
+EOT
+    NUM=$(( $NUM + 1 ))
+done
+
+# Out: current time, in milliseconds
+now_ms ()
+{
+    local NOW=$(date +%s%N)
+    case $NOW in
+        *N) echo $(( $(date +%s) * 1000 ));;
+        *) echo $(( $NOW / 1000000 ));;
+    esac
+}
+
+# $1+: ndk-build arguments
+# Out: BUILD_TIME, average no-op build time in milliseconds
+time_no_op_build ()
+{
+    local RUN=0 START END
+    run_build APP_MODULES=deps_timing "$@"
+    START=$(now_ms)
+    while [ $RUN -lt $RUN_COUNT ]; do
+        run_build APP_MODULES=deps_timing "$@"
+        check_compiled ""
+        RUN=$(( $RUN + 1 ))
+    done
+    END=$(now_ms)
+    BUILD_TIME=$(( ($END - $START) / $RUN_COUNT ))
+}
+
+time_no_op_build APP_DEPS_DATABASE=false "$@"
+TIME_FILES=$BUILD_TIME
+time_no_op_build APP_DEPS_DATABASE=true "$@"
+TIME_DATABASE=$BUILD_TIME
+echo "No-op build of $SOURCE_COUNT sources: ${TIME_FILES}ms with dependency files, ${TIME_DATABASE}ms with the database"
+if [ "$TIME_DATABASE" -gt "$TIME_FILES" ]; then
+    echo "WARNING: The dependency database made the build slower!"
+fi
+
+cleanup
+echo "Dependency databases work."
@@ -0,0 +1,18 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := deps_lib
+LOCAL_SRC_FILES := lib.c
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/include
+include $(BUILD_STATIC_LIBRARY)
+
+# build.sh may create headers under gen/ to override the ones in include/
+include $(CLEAR_VARS)
+LOCAL_MODULE := deps_test
+LOCAL_SRC_FILES := main.c a.c b.c c.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/gen $(LOCAL_PATH)/include
+LOCAL_STATIC_LIBRARIES := deps_lib
+include $(BUILD_SHARED_LIBRARY)
+
+# The module generated by build.sh, if any.
+-include $(LOCAL_PATH)/timing/Android.mk
@@ -0,0 +1,7 @@
+#include "a.h"
+#include "common.h"
+
+int a(void)
+{
+    return COMMON_VALUE + 1;
+}
@@ -0,0 +1,6 @@
+#include "common.h"
+
+int b(void)
+{
+    return COMMON_VALUE + 2;
+}
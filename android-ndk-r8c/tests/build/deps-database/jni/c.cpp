@@ -0,0 +1,6 @@
+#include "extra.h"
+
+extern "C" int c(void)
+{
+    return EXTRA_VALUE;
+}
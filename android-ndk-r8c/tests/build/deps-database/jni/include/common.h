@@ -0,0 +1,6 @@
+#ifndef COMMON_H
+#define COMMON_H
+
+#define COMMON_VALUE 42
+
+#endif /* COMMON_H */
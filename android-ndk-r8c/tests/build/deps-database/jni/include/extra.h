@@ -0,0 +1,6 @@
+#ifndef EXTRA_H
+#define EXTRA_H
+
+#define EXTRA_VALUE 1
+
+#endif /* EXTRA_H */
@@ -0,0 +1,6 @@
+#include "common.h"
+
+int lib(void)
+{
+    return COMMON_VALUE;
+}
@@ -0,0 +1,10 @@
+#include "a.h"
+
+extern int b(void);
+extern int c(void);
+extern int lib(void);
+
+int deps_test(void)
+{
+    return a() + b() + c() + lib();
+}
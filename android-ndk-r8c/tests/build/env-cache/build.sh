@@ -0,0 +1,199 @@
+# Check that the environment snapshot saved by init.mk is reused by
+# later invocations, that it is regenerated when it is outdated, that
+# it is ignored when NDK_NO_ENV_CACHE is defined, and that it doesn't
+# change the build.
+#
+# Then compare the latency of no-op builds of a single module, and of a
+# project with many modules, with and without the snapshot.
+#
+
+PROGDIR=$(dirname $0)
+PROGDIR=$(cd "$PROGDIR" && pwd)
+
+# Number of generated modules for the timing comparison.
+MODULE_COUNT=200
+
+# Number of no-op builds timed for each case.
+RUN_COUNT=10
+
+SNAPSHOT=$PROGDIR/obj/ndk-env.mk
+
+# A copy of one platform, to check that changing the platforms
+# invalidates the snapshot.
+PLATFORMS=$PROGDIR/platforms
+
+cleanup ()
+{
+    rm -rf "$PROGDIR/obj" "$PROGDIR/libs" "$PROGDIR/jni/modules" "$PROGDIR/build.log" "$PLATFORMS"
+}
+
+fail ()
+{
+    echo "ERROR: $@"
+    cleanup
+    exit 1
+}
+
+# $1+: ndk-build arguments
+run_build ()
+{
+    $NDK/ndk-build -C "$PROGDIR" "$@" > "$PROGDIR/build.log" 2>&1
+    if [ $? != 0 ]; then
+        cat "$PROGDIR/build.log"
+        fail "Could not build: $@"
+    fi
+}
+
+# $1: message that must appear in the build log
+check_log ()
+{
+    if ! grep -q -F -e "$1" "$PROGDIR/build.log"; then
+        fail "Missing '$1' in build log"
+    fi
+}
+
+# $1: message that must not appear in the build log
+check_no_log ()
+{
+    if grep -q -F -e "$1" "$PROGDIR/build.log"; then
+        fail "Unexpected '$1' in build log"
+    fi
+}
+
+check_no_op ()
+{
+    if grep -q -e "^Compile" "$PROGDIR/build.log"; then
+        fail "A no-op build compiled something"
+    fi
+}
+
+cleanup
+
+run_build NDK_LOG=1 "$@"
+check_log "Saving environment snapshot"
+if [ ! -f "$SNAPSHOT" ]; then
+    fail "Missing environment snapshot: $SNAPSHOT"
+fi
+
+run_build NDK_LOG=1 "$@"
+check_log "Using environment snapshot"
+check_no_log "Saving environment snapshot"
+check_no_op
+
+# The snapshot's rule must not become the default goal.
+touch "$PROGDIR/jni/main.c"
+run_build "$@"
+check_log "Compile"
+
+# A snapshot older than the toolchain files is removed, and GNU Make
+# restarts to save it again.
+touch -t 200001010000 "$SNAPSHOT"
+run_build NDK_LOG=1 "$@"
+check_log "Removing outdated environment snapshot"
+check_log "Saving environment snapshot"
+check_no_op
+run_build NDK_LOG=1 "$@"
+check_log "Using environment snapshot"
+check_no_log "Saving environment snapshot"
+
+# A new platform architecture changes the key of the snapshot.
+mkdir -p "$PLATFORMS/android-9" || fail "Could not create $PLATFORMS"
+cp -r "$NDK/platforms/android-9/arch-x86" "$PLATFORMS/android-9/" || fail "Could not copy android-9"
+run_build NDK_LOG=1 NDK_PLATFORMS_ROOT="$PLATFORMS" "$@"
+check_log "Saving environment snapshot"
+run_build NDK_LOG=1 NDK_PLATFORMS_ROOT="$PLATFORMS" "$@"
+check_log "Using environment snapshot"
+mkdir -p "$PLATFORMS/android-9/arch-arm"
+run_build NDK_LOG=1 NDK_PLATFORMS_ROOT="$PLATFORMS" "$@"
+check_log "Ignoring missing or outdated environment snapshot"
+check_log "Saving environment snapshot"
+ABIS=$($NDK/ndk-build -C "$PROGDIR" --no-print-directory NDK_PLATFORMS_ROOT="$PLATFORMS" "$@" DUMP_NDK_PLATFORM_android-9_ABIS 2>/dev/null)
+if [ "$ABIS" != "arm x86" ]; then
+    fail "The snapshot didn't record the new platform architecture: '$ABIS'"
+fi
+rm -rf "$PLATFORMS"
+run_build NDK_LOG=1 "$@"
+check_log "Saving environment snapshot"
+
+run_build NDK_LOG=1 NDK_NO_ENV_CACHE=1 "$@"
+check_no_log "environment snapshot"
+check_no_op
+
+# The snapshot must not change the environment.
+for VAR in NDK_ALL_TOOLCHAINS NDK_ALL_ABIS NDK_HOST_ABIS NDK_ALL_ARCHS NDK_ALL_PLATFORMS NDK_MAX_PLATFORM_LEVEL; do
+    CACHED=$($NDK/ndk-build -C "$PROGDIR" "$@" DUMP_$VAR 2>/dev/null)
+    UNCACHED=$($NDK/ndk-build -C "$PROGDIR" "$@" NDK_NO_ENV_CACHE=1 DUMP_$VAR 2>/dev/null)
+    if [ "$CACHED" != "$UNCACHED" ]; then
+        fail "$VAR is '$CACHED' with the snapshot, instead of '$UNCACHED'"
+    fi
+done
+
+# Out: current time, in milliseconds
+now_ms ()
+{
+    local NOW=$(date +%s%N)
+    case $NOW in
+        *N) echo $(( $(date +%s) * 1000 ));;
+        *) echo $(( $NOW / 1000000 ));;
+    esac
+}
+
+# $1+: ndk-build arguments
+# Out: BUILD_TIME, average no-op build time in milliseconds
+time_no_op_build ()
+{
+    local RUN=0 START END
+    run_build "$@"
+    START=$(now_ms)
+    while [ $RUN -lt $RUN_COUNT ]; do
+        run_build "$@"
+        check_no_op
+        RUN=$(( $RUN + 1 ))
+    done
+    END=$(now_ms)
+    BUILD_TIME=$(( ($END - $START) / $RUN_COUNT ))
+}
+
+# $1: description of the project
+# $2+: ndk-build arguments
+# The snapshot only saves a few milliseconds per invocation, so this
+# just prints the timings: they are within noise for big projects.
+compare_no_op_builds ()
+{
+    local DESC=$1 TIME_UNCACHED TIME_CACHED
+    shift
+    time_no_op_build NDK_NO_ENV_CACHE=1 "$@"
+    TIME_UNCACHED=$BUILD_TIME
+    time_no_op_build "$@"
+    TIME_CACHED=$BUILD_TIME
+    echo "No-op build of $DESC: ${TIME_UNCACHED}ms without the environment snapshot, ${TIME_CACHED}ms with it"
+}
+
+# Startup latency first, then with many modules.
+compare_no_op_builds "1 module" "$@"
+
+NUM=0
+while [ $NUM -lt $MODULE_COUNT ]; do
+    MODULE_DIR=$PROGDIR/jni/modules/module$NUM
+    mkdir -p "$MODULE_DIR" || fail "Could not create $MODULE_DIR"
+    cat > "$MODULE_DIR/Android.mk" <<EOT
+LOCAL_PATH := \$(call my-dir)
+
+include \$(CLEAR_VARS)
+LOCAL_MODULE := module$NUM
+LOCAL_SRC_FILES := module$NUM.c
+include \$(BUILD_SHARED_LIBRARY)
+EOT
+    cat > "$MODULE_DIR/module$NUM.c" <<EOT
+int module$NUM(void)
+{
+    return $NUM;
+}
+EOT
+    NUM=$(( $NUM + 1 ))
+done
+
+compare_no_op_builds "$MODULE_COUNT modules" "$@"
+
+cleanup
+echo "Environment snapshots work."
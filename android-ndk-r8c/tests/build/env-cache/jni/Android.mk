@@ -0,0 +1,9 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := env_cache_test
+LOCAL_SRC_FILES := main.c
+include $(BUILD_SHARED_LIBRARY)
+
+# The modules generated by build.sh, if any.
+include $(call all-makefiles-under,$(LOCAL_PATH)/modules)
@@ -0,0 +1 @@
+APP_ABI := x86
@@ -0,0 +1,4 @@
+int env_cache_test(void)
+{
+    return 0;
+}
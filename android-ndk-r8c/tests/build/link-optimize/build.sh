@@ -0,0 +1,142 @@
+# Check that APP_LINK_OPTIMIZE removes unused code and data, only exports
+# the JNI entry points (even without JNIEXPORT) and LOCAL_EXPORT_SYMBOLS
+# from shared libraries, adds the GNU hash table, and can be disabled per
+# module with LOCAL_LINK_OPTIMIZE := false. The installed binaries are
+# inspected with readelf, which can be set with READELF.
+#
+# Also check that the size and relocation changes of each module are
+# reported when the option is switched.
+#
+
+PROGDIR=$(dirname $0)
+PROGDIR=$(cd "$PROGDIR" && pwd)
+
+READELF=${READELF:-readelf}
+
+cleanup ()
+{
+    rm -rf "$PROGDIR/obj" "$PROGDIR/libs" "$PROGDIR/build.log"
+}
+
+fail ()
+{
+    echo "ERROR: $@"
+    cleanup
+    exit 1
+}
+
+# $1+: ndk-build arguments
+run_build ()
+{
+    $NDK/ndk-build -C "$PROGDIR" "$@" > "$PROGDIR/build.log" 2>&1
+    if [ $? != 0 ]; then
+        cat "$PROGDIR/build.log"
+        fail "Could not build: $@"
+    fi
+}
+
+# $1: regular expression that must match a line of the build log
+check_log ()
+{
+    if ! grep -q -e "$1" "$PROGDIR/build.log"; then
+        cat "$PROGDIR/build.log"
+        fail "No line matching '$1' in the build log"
+    fi
+}
+
+# $1: binary
+# Out: its defined dynamic symbols
+dynamic_symbols ()
+{
+    $READELF --dyn-syms -W "$1" | awk '$5 != "LOCAL" && $7 != "UND" && $8 != "" { print $8 }'
+}
+
+# $1: binary
+# $2: symbol
+# $3: 'yes' if it must be a dynamic symbol of the binary, 'no' otherwise
+check_exported ()
+{
+    if dynamic_symbols "$1" | grep -q -x -e "$2"; then
+        if [ "$3" != "yes" ]; then
+            fail "$1 should not export $2"
+        fi
+    elif [ "$3" = "yes" ]; then
+        fail "$1 should export $2"
+    fi
+}
+
+# $1: binary
+# $2: section name
+# $3: 'yes' if the binary must have it, 'no' otherwise
+check_section ()
+{
+    if $READELF -S -W "$1" | grep -q -F -e " $2 "; then
+        if [ "$3" != "yes" ]; then
+            fail "$1 should not have a $2 section"
+        fi
+    elif [ "$3" = "yes" ]; then
+        fail "$1 should have a $2 section"
+    fi
+}
+
+if ! $READELF --version > /dev/null 2>&1; then
+    echo "WARNING: Could not run '$READELF', skipping test."
+    exit 0
+fi
+
+cleanup
+
+run_build APP_LINK_OPTIMIZE=false "$@"
+check_log "^LinkStats *: liblo_shared.so: [0-9]* bytes, [0-9]* relocations$"
+for LIB in $PROGDIR/libs/*/liblo_shared.so; do
+    check_exported $LIB Java_com_example_linkoptimize_Native_compute yes
+    check_exported $LIB lo_internal0 yes
+    check_exported $LIB lo_static_unused yes
+done
+
+# The changes are reported after a rebuild with the option enabled.
+run_build -B "$@"
+check_log "^LinkStats *: liblo_shared.so: [0-9]* bytes (-[0-9]*), [0-9]* relocations (-[0-9]*)$"
+for LIB in $PROGDIR/libs/*/liblo_shared.so; do
+    ABI=$(basename $(dirname $LIB))
+    check_exported $LIB Java_com_example_linkoptimize_Native_compute yes
+    check_exported $LIB Java_com_example_linkoptimize_Native_plain yes
+    check_exported $LIB JNI_OnLoad yes
+    check_exported $LIB lo_internal0 no
+    check_exported $LIB lo_internal_sum no
+    check_exported $LIB lo_static_add no
+    case $ABI in
+        mips*) ;;
+        *) check_section $LIB .gnu.hash yes
+    esac
+    check_section $LIB .hash yes
+    # Unused code and data are removed, even from the unstripped binary.
+    if $READELF -s -W "$PROGDIR/obj/local/$ABI/liblo_shared.so" | grep -q -e " lo_static_\(unused\|table\)$"; then
+        fail "Unused code or data in $PROGDIR/obj/local/$ABI/liblo_shared.so"
+    fi
+done
+for LIB in $PROGDIR/libs/*/liblo_exports.so; do
+    check_exported $LIB lo_exports_api yes
+    check_exported $LIB lo_exports_private no
+done
+for LIB in $PROGDIR/libs/*/liblo_plain.so; do
+    check_exported $LIB lo_plain_api yes
+    check_exported $LIB lo_plain_internal yes
+done
+
+# Nothing is reported when the binaries don't change.
+run_build "$@"
+if grep -q -e "^LinkStats" "$PROGDIR/build.log"; then
+    cat "$PROGDIR/build.log"
+    fail "A no-op build reported link changes"
+fi
+
+# Nor when the option isn't used.
+rm -rf "$PROGDIR/obj" "$PROGDIR/libs"
+run_build APP_LINK_OPTIMIZE= "$@"
+if grep -q -e "^LinkStats *: liblo_shared.so" "$PROGDIR/build.log"; then
+    fail "Link changes were reported without APP_LINK_OPTIMIZE"
+fi
+
+cleanup
+echo "Link optimizations work."
@@ -0,0 +1,30 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := lo_static
+LOCAL_SRC_FILES := static.c
+include $(BUILD_STATIC_LIBRARY)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := lo_shared
+LOCAL_SRC_FILES := shared.c
+LOCAL_STATIC_LIBRARIES := lo_static
+include $(BUILD_SHARED_LIBRARY)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := lo_exports
+LOCAL_SRC_FILES := exports.c
+LOCAL_EXPORT_SYMBOLS := lo_exports_api
+include $(BUILD_SHARED_LIBRARY)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := lo_plain
+LOCAL_SRC_FILES := plain.c
+LOCAL_LINK_OPTIMIZE := false
+include $(BUILD_SHARED_LIBRARY)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := lo_exe
+LOCAL_SRC_FILES := main.c
+LOCAL_STATIC_LIBRARIES := lo_static
+include $(BUILD_EXECUTABLE)
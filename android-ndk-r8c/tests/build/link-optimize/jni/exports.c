@@ -0,0 +1,9 @@
+int lo_exports_private(int x)
+{
+    return x * 2;
+}
+
+int lo_exports_api(int x)
+{
+    return lo_exports_private(x) + 1;
+}
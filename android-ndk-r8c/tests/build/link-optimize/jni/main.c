@@ -0,0 +1,9 @@
+#include <stdio.h>
+
+extern int lo_static_add(int a, int b);
+
+int main(void)
+{
+    printf("%d\n", lo_static_add(1, 2));
+    return 0;
+}
@@ -0,0 +1,9 @@
+int lo_plain_internal(int x)
+{
+    return x * 2;
+}
+
+int lo_plain_api(int x)
+{
+    return lo_plain_internal(x) + 1;
+}
@@ -0,0 +1,38 @@
+#include <jni.h>
+
+extern int lo_static_add(int a, int b);
+
+/* Global functions are called through the PLT, unless they are hidden. */
+int lo_internal0(int x) { return x * 3 + 1; }
+int lo_internal1(int x) { return x * 5 + 2; }
+int lo_internal2(int x) { return x * 7 + 3; }
+int lo_internal3(int x) { return x * 11 + 4; }
+int lo_internal4(int x) { return x * 13 + 5; }
+int lo_internal5(int x) { return x * 17 + 6; }
+int lo_internal6(int x) { return x * 19 + 7; }
+int lo_internal7(int x) { return x * 23 + 8; }
+
+int lo_internal_sum(int x)
+{
+    return lo_internal0(x) + lo_internal1(x) + lo_internal2(x) +
+           lo_internal3(x) + lo_internal4(x) + lo_internal5(x) +
+           lo_internal6(x) + lo_internal7(x);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_example_linkoptimize_Native_compute(JNIEnv* env, jclass clazz, jint x)
+{
+    return lo_static_add(lo_internal_sum(x), 1);
+}
+
+/* Not declared with JNIEXPORT, like many JNI functions, but exported too. */
+jint
+Java_com_example_linkoptimize_Native_plain(JNIEnv* env, jclass clazz, jint x)
+{
+    return lo_internal0(x);
+}
+
+JNIEXPORT jint JNI_OnLoad(JavaVM* vm, void* reserved)
+{
+    return JNI_VERSION_1_4;
+}
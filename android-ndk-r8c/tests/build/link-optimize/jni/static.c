@@ -0,0 +1,12 @@
+int lo_static_add(int a, int b)
+{
+    return a + b;
+}
+
+/* Never used, so removed by --gc-sections. */
+int lo_static_table[4096] = { 1 };
+
+int lo_static_unused(int n)
+{
+    return lo_static_table[n];
+}
@@ -0,0 +1,79 @@
+# Check that APP_LTO adds -flto to the compile and link commands, archives
+# with the LTO plugin, and still works with whole static libraries, prebuilt
+# static libraries and modules that disable it with LOCAL_LTO := false.
+# The number of parallel LTO jobs must follow the -j given to ndk-build.
+#
+
+PROGDIR=$(dirname $0)
+PROGDIR=$(cd "$PROGDIR" && pwd)
+
+case "$NDK_TOOLCHAIN_VERSION" in
+    4.4.3|clang*)
+        echo "No link-time optimization support with NDK_TOOLCHAIN_VERSION=$NDK_TOOLCHAIN_VERSION"
+        exit 0
+        ;;
+esac
+
+cleanup ()
+{
+    rm -rf "$PROGDIR/obj" "$PROGDIR/libs" "$PROGDIR/jni/prebuilt" "$PROGDIR/build.log"
+}
+
+fail ()
+{
+    echo "ERROR: $@"
+    cleanup
+    exit 1
+}
+
+# $1: pattern selecting commands in build.log
+# $2: string these commands must (or must not if $3 is 'no') contain
+check_commands ()
+{
+    local COMMANDS
+    COMMANDS=$(grep -e "$1" "$PROGDIR/build.log")
+    if [ -z "$COMMANDS" ]; then
+        fail "No command matching '$1' in the build log"
+    fi
+    if echo "$COMMANDS" | grep -v -q -F -e "$2"; then
+        if [ "$3" != "no" ]; then
+            fail "Commands matching '$1' should contain '$2':
+$COMMANDS"
+        fi
+    elif [ "$3" = "no" ]; then
+        fail "Commands matching '$1' should not contain '$2':
+$COMMANDS"
+    fi
+}
+
+cleanup
+
+# First, build the non-LTO library used as a prebuilt by the second pass.
+$NDK/ndk-build -C "$PROGDIR" APP_MODULES=plain "$@" || fail "Could not build libplain.a"
+for LIB in $PROGDIR/obj/local/*/libplain.a; do
+    ABI=$(basename $(dirname $LIB))
+    mkdir -p "$PROGDIR/jni/prebuilt/$ABI" && cp "$LIB" "$PROGDIR/jni/prebuilt/$ABI/" ||
+        fail "Could not copy $LIB"
+done
+rm -rf "$PROGDIR/obj" "$PROGDIR/libs"
+
+# Then build everything with LTO, showing the commands.
+$NDK/ndk-build -C "$PROGDIR" V=1 "$@" -j3 > "$PROGDIR/build.log" 2>&1
+if [ $? != 0 ]; then
+    cat "$PROGDIR/build.log"
+    fail "Could not build the LTO modules"
+fi
+
+check_commands "jni/static.c " " -flto "
+check_commands "jni/shared.c " " -flto "
+check_commands "jni/plain.c " " -flto" no
+check_commands "jni/main.c " " -flto" no
+check_commands "-ar .*/liblto_static.a " "--plugin "
+check_commands "-soname,liblto_shared.so" "-fuse-linker-plugin"
+check_commands "-soname,liblto_shared.so" " -flto=3"
+check_commands "-soname,liblto_shared.so" "--whole-archive"
+check_commands "-soname,liblto_shared.so" "/libplain.a"
+check_commands "-o [^ ]*/no_lto_exe\$" "-fuse-linker-plugin" no
+
+cleanup
+echo "Link-time optimization commands are correct."
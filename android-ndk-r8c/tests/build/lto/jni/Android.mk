@@ -0,0 +1,48 @@
+# Check that APP_LTO/LOCAL_LTO work with static, whole static and prebuilt
+# libraries. See build.sh which generates the prebuilt library.
+#
+LOCAL_PATH := $(call my-dir)
+
+# Built without LTO, build.sh copies it to prebuilt/<abi>/
+include $(CLEAR_VARS)
+LOCAL_MODULE := plain
+LOCAL_SRC_FILES := plain.c
+LOCAL_LTO := false
+include $(BUILD_STATIC_LIBRARY)
+
+have_prebuilt := $(wildcard $(LOCAL_PATH)/prebuilt/$(TARGET_ARCH_ABI)/libplain.a)
+ifdef have_prebuilt
+include $(CLEAR_VARS)
+LOCAL_MODULE := plain_prebuilt
+LOCAL_SRC_FILES := prebuilt/$(TARGET_ARCH_ABI)/libplain.a
+include $(PREBUILT_STATIC_LIBRARY)
+endif
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := lto_static
+LOCAL_SRC_FILES := static.c
+include $(BUILD_STATIC_LIBRARY)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := lto_whole
+LOCAL_SRC_FILES := whole.c
+include $(BUILD_STATIC_LIBRARY)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := lto_shared
+LOCAL_SRC_FILES := shared.c
+LOCAL_STATIC_LIBRARIES := lto_static
+LOCAL_WHOLE_STATIC_LIBRARIES := lto_whole
+ifdef have_prebuilt
+LOCAL_CFLAGS := -DHAVE_PREBUILT
+LOCAL_STATIC_LIBRARIES += plain_prebuilt
+endif
+include $(BUILD_SHARED_LIBRARY)
+
+# A module without LTO can still use a static library built with it.
+include $(CLEAR_VARS)
+LOCAL_MODULE := no_lto_exe
+LOCAL_SRC_FILES := main.c
+LOCAL_STATIC_LIBRARIES := lto_static
+LOCAL_LTO := false
+include $(BUILD_EXECUTABLE)
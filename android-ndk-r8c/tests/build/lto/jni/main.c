@@ -0,0 +1,9 @@
+#include <stdio.h>
+
+extern int lto_static_add(int a, int b);
+
+int main(void)
+{
+    printf("%d\n", lto_static_add(40, 2));
+    return 0;
+}
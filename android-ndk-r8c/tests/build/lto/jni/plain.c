@@ -0,0 +1,4 @@
+int plain_mul(int a, int b)
+{
+    return a * b;
+}
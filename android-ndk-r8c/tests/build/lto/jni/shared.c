@@ -0,0 +1,12 @@
+extern int lto_static_add(int a, int b);
+#ifdef HAVE_PREBUILT
+extern int plain_mul(int a, int b);
+#endif
+
+int lto_shared_compute(int x)
+{
+#ifdef HAVE_PREBUILT
+    x = plain_mul(x, 3);
+#endif
+    return lto_static_add(x, 1);
+}
@@ -0,0 +1,4 @@
+int lto_static_add(int a, int b)
+{
+    return a + b;
+}
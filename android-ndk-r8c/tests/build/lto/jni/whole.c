@@ -0,0 +1,5 @@
+/* Not referenced by shared.c, kept through LOCAL_WHOLE_STATIC_LIBRARIES */
+int lto_whole_sub(int a, int b)
+{
+    return a - b;
+}
@@ -0,0 +1,124 @@
+# Check that the static libraries a module depends on are linked in
+# topological order, then check the dependency closure and the imported
+# exports of a generated graph of many modules, and report the time
+# needed to evaluate it.
+#
+
+PROGDIR=$(dirname $0)
+PROGDIR=$(cd "$PROGDIR" && pwd)
+
+# Number of generated modules.
+MODULE_COUNT=1000
+
+SCALING_DIR=$PROGDIR/jni/scaling
+
+cleanup ()
+{
+    rm -rf "$PROGDIR/obj" "$PROGDIR/libs" "$SCALING_DIR" "$PROGDIR/build.log"
+}
+
+fail ()
+{
+    echo "ERROR: $@"
+    cleanup
+    exit 1
+}
+
+# $1+: ndk-build arguments
+run_build ()
+{
+    $NDK/ndk-build -C "$PROGDIR" "$@" > "$PROGDIR/build.log" 2>&1
+    if [ $? != 0 ]; then
+        cat "$PROGDIR/build.log"
+        fail "Could not build: $@"
+    fi
+}
+
+# $1: module name
+# Out: the static libraries on the link command of module $1, in order
+get_linked_libraries ()
+{
+    grep -e "-o [^ ]*/lib$1\.so" "$PROGDIR/build.log" | tr ' ' '\n' | \
+        sed -n -e 's|.*/lib\([^/]*\)\.a$|\1|p' | tr '\n' ' '
+}
+
+cleanup
+
+run_build APP_MODULES=closure_test V=1 "$@"
+LIBS=$(get_linked_libraries closure_test)
+if [ "$LIBS" != "closure_c closure_b " ]; then
+    fail "closure_test links '$LIBS' instead of 'closure_c closure_b'"
+fi
+
+# Generate a chain of static libraries, each one also depending on the
+# seventh next one, and a shared library depending on the first one.
+# One library out of ten exports a compiler flag.
+mkdir -p "$SCALING_DIR" || fail "Could not create $SCALING_DIR"
+cat > "$SCALING_DIR/scaling.c" <<EOT
+int scaling(void)
+{
+    return 0;
+}
+EOT
+(
+    echo 'LOCAL_PATH := $(call my-dir)'
+    NUM=0
+    while [ $NUM -lt $MODULE_COUNT ]; do
+        echo ''
+        echo 'include $(CLEAR_VARS)'
+        echo "LOCAL_MODULE := scaling_$NUM"
+        echo 'LOCAL_SRC_FILES := scaling.c'
+        DEPS=
+        for NEXT in $(( $NUM + 1 )) $(( $NUM + 7 )); do
+            if [ $NEXT -lt $MODULE_COUNT ]; then
+                DEPS="$DEPS scaling_$NEXT"
+            fi
+        done
+        echo "LOCAL_STATIC_LIBRARIES :=$DEPS"
+        if [ $(( $NUM % 10 )) = 0 ]; then
+            echo "LOCAL_EXPORT_CFLAGS := -DSCALING_$NUM"
+        fi
+        echo 'include $(BUILD_STATIC_LIBRARY)'
+        NUM=$(( $NUM + 1 ))
+    done
+    echo ''
+    echo 'include $(CLEAR_VARS)'
+    echo 'LOCAL_MODULE := scaling_top'
+    echo 'LOCAL_SRC_FILES := scaling.c'
+    echo 'LOCAL_STATIC_LIBRARIES := scaling_0'
+    echo 'include $(BUILD_SHARED_LIBRARY)'
+) > "$SCALING_DIR/Android.mk"
+
+# Only evaluate the build scripts, nothing needs to be compiled.
+START=$(date +%s)
+run_build -n APP_MODULES=scaling_top V=1 "$@"
+END=$(date +%s)
+
+EXPECTED=
+NUM=0
+while [ $NUM -lt $MODULE_COUNT ]; do
+    EXPECTED="${EXPECTED}scaling_$NUM "
+    NUM=$(( $NUM + 1 ))
+done
+LIBS=$(get_linked_libraries scaling_top)
+if [ "$LIBS" != "$EXPECTED" ]; then
+    fail "scaling_top doesn't link all the generated libraries in order"
+fi
+
+# scaling_1 imports the flags exported by all the libraries after it.
+FLAGS=$(grep -e "-o [^ ]*/scaling_1/scaling\.o" "$PROGDIR/build.log" | \
+    tr ' ' '\n' | grep -e "^-DSCALING_" | tr '\n' ' ')
+EXPECTED=
+NUM=10
+while [ $NUM -lt $MODULE_COUNT ]; do
+    EXPECTED="$EXPECTED-DSCALING_$NUM "
+    NUM=$(( $NUM + 10 ))
+done
+if [ "$FLAGS" != "$EXPECTED" ]; then
+    fail "scaling_1 imports '$FLAGS' instead of '$EXPECTED'"
+fi
+
+echo "Evaluating $MODULE_COUNT modules took $(( $END - $START ))s"
+
+cleanup
+echo "Module closures work."
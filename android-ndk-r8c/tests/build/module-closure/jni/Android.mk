@@ -0,0 +1,25 @@
+# closure_c depends on closure_b, so it must appear before it on the
+# link command of closure_test, even though closure_test lists them in
+# the opposite order.
+#
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := closure_b
+LOCAL_SRC_FILES := b.c
+include $(BUILD_STATIC_LIBRARY)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := closure_c
+LOCAL_SRC_FILES := c.c
+LOCAL_STATIC_LIBRARIES := closure_b
+include $(BUILD_STATIC_LIBRARY)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := closure_test
+LOCAL_SRC_FILES := main.c
+LOCAL_STATIC_LIBRARIES := closure_b closure_c
+include $(BUILD_SHARED_LIBRARY)
+
+# The modules generated by build.sh, if any.
+-include $(LOCAL_PATH)/scaling/Android.mk
@@ -0,0 +1,4 @@
+int closure_b(void)
+{
+    return 2;
+}
@@ -0,0 +1,6 @@
+extern int closure_b(void);
+
+int closure_c(void)
+{
+    return closure_b() + 1;
+}
@@ -0,0 +1,6 @@
+extern int closure_c(void);
+
+int closure_test(void)
+{
+    return closure_c();
+}
@@ -0,0 +1,193 @@
+# Check that LOCAL_PCH precompiles a header that is used by all the C++
+# sources of a module, that modifying the header or one of its includes
+# rebuilds the precompiled header and the C++ objects, that sources with
+# different target-specific flags use different precompiled headers, and
+# that it works with LOCAL_SHORT_COMMANDS.
+#
+# Then compare the build times of a generated module with many C++
+# sources including a large header, with and without LOCAL_PCH.
+#
+
+PROGDIR=$(dirname $0)
+PROGDIR=$(cd "$PROGDIR" && pwd)
+
+# Number of generated sources for the timing comparison.
+TIMING_COUNT=32
+
+# Number of functions in the generated header for the timing comparison.
+TIMING_HEADER_SIZE=3000
+
+OBJS_DIR=$PROGDIR/obj/local/x86/objs
+
+cleanup ()
+{
+    rm -rf "$PROGDIR/obj" "$PROGDIR/libs" "$PROGDIR/jni/timing" "$PROGDIR/build.log"
+}
+
+fail ()
+{
+    echo "ERROR: $@"
+    cleanup
+    exit 1
+}
+
+# $1+: ndk-build arguments
+run_build ()
+{
+    $NDK/ndk-build -C "$PROGDIR" "$@" > "$PROGDIR/build.log" 2>&1
+    if [ $? != 0 ]; then
+        cat "$PROGDIR/build.log"
+        fail "Could not build: $@"
+    fi
+}
+
+# $1+: list of words
+sort_words ()
+{
+    echo $@ | tr ' ' '\n' | sort | tr '\n' ' '
+}
+
+# $1: regular expression matching the build log lines to check
+# $2: expected list of files, in any order
+check_files ()
+{
+    local FILES EXPECTED
+    FILES=$(sort_words $(grep -e "$1" "$PROGDIR/build.log" | sed -e 's/.* <= //'))
+    EXPECTED=$(sort_words $2)
+    if [ "$FILES" != "$EXPECTED" ]; then
+        fail "Built '$FILES' instead of '$EXPECTED'"
+    fi
+}
+
+# $1: expected list of compiled files, in any order
+check_compiled ()
+{
+    check_files "^Compile" "$1"
+}
+
+# $1: expected list of precompiled headers, in any order
+check_precompiled ()
+{
+    check_files "^Precomp" "$1"
+}
+
+cleanup
+
+run_build APP_MODULES="pch_test pch_short" "$@"
+check_precompiled "pch.h pch.h"
+check_compiled "a.cpp b.cpp c.c a.cpp b.cpp"
+if grep -q -e "not used because" "$PROGDIR/build.log"; then
+    cat "$PROGDIR/build.log"
+    fail "A precompiled header was rejected"
+fi
+for MODULE in pch_test pch_short; do
+    if [ ! -f "$OBJS_DIR/$MODULE/pch-1/pch.h.gch" ]; then
+        fail "Missing precompiled header for $MODULE"
+    fi
+done
+if ! grep -q -e "-include" "$OBJS_DIR/pch_short/a.o.cflags"; then
+    fail "Missing -include in $OBJS_DIR/pch_short/a.o.cflags"
+fi
+if [ ! -f "$OBJS_DIR/pch_short/pch-1/pch.h.gch.cflags" ]; then
+    fail "The precompiled header doesn't use LOCAL_SHORT_COMMANDS"
+fi
+
+# GCC prints '! <file>' when -H is used and a precompiled header is
+# used, so check that it is for each C++ source.
+run_build -B APP_MODULES=pch_test APP_CPPFLAGS=-H "$@"
+if [ "$(grep -c -e '^! .*/pch_test/pch-1/pch.h.gch' "$PROGDIR/build.log")" != 2 ]; then
+    cat "$PROGDIR/build.log"
+    fail "The precompiled header was not used by all C++ sources"
+fi
+
+run_build APP_MODULES="pch_test pch_short" "$@"
+check_precompiled ""
+check_compiled ""
+
+sleep 1
+touch "$PROGDIR/jni/engine.h"
+run_build APP_MODULES="pch_test pch_short" "$@"
+check_precompiled "pch.h pch.h"
+check_compiled "a.cpp b.cpp a.cpp b.cpp"
+
+sleep 1
+touch "$PROGDIR/jni/b.cpp"
+run_build APP_MODULES="pch_test pch_short" "$@"
+check_precompiled ""
+check_compiled "b.cpp b.cpp"
+
+# ARM and Thumb sources use different precompiled headers.
+$NDK/ndk-build -C "$PROGDIR" -n V=1 APP_MODULES=pch_modes "$@" APP_ABI=armeabi > "$PROGDIR/build.log" 2>&1
+if [ $? != 0 ]; then
+    cat "$PROGDIR/build.log"
+    fail "Could not build pch_modes"
+fi
+if [ "$(grep -c -e '-x c++-header' "$PROGDIR/build.log")" != 2 ]; then
+    fail "pch_modes should use two precompiled headers"
+fi
+if ! grep -q -e "-include [^ ]*/pch_modes/pch-1/pch.h .*-mthumb .*a\.cpp" "$PROGDIR/build.log"; then
+    fail "a.cpp should use the Thumb precompiled header"
+fi
+if ! grep -q -e "-include [^ ]*/pch_modes/pch-2/pch.h .*b\.cpp" "$PROGDIR/build.log"; then
+    fail "b.cpp should use the ARM precompiled header"
+fi
+
+# Timing comparison.
+mkdir -p "$PROGDIR/jni/timing" || fail "Could not create $PROGDIR/jni/timing"
+(
+    echo "#ifndef ENGINE_H"
+    echo "#define ENGINE_H"
+    echo "#include <stddef.h>"
+    echo "template <typename T, int N> struct Vector {"
+    echo "    T items[N];"
+    echo "    size_t size() const { return N; }"
+    echo "    T& operator[](size_t n) { return items[n % N]; }"
+    echo "};"
+    NUM=0
+    while [ $NUM -lt $TIMING_HEADER_SIZE ]; do
+        echo "template <typename T> inline T engine$NUM(Vector<T, 4>& v) { return v[$NUM] + (T)v.size(); }"
+        NUM=$(( $NUM + 1 ))
+    done
+    echo "#endif"
+) > "$PROGDIR/jni/timing/engine.h"
+NUM=0
+while [ $NUM -lt $TIMING_COUNT ]; do
+    cat > "$PROGDIR/jni/timing/timing$NUM.cpp" <<EOF
+#include "engine.h"
+
+int timing$NUM(Vector<int, 4>& values)
+{
+    int total = 0;
+    for (size_t n = 0; n < values.size(); ++n)
+        total += engine$NUM(values);
+    return total;
+}
+EOF
+    NUM=$(( $NUM + 1 ))
+done
+
+# $1: value of LOCAL_PCH
+# $2+: ndk-build arguments
+# Out: BUILD_TIME, in seconds
+time_build ()
+{
+    local PCH=$1 START END
+    shift
+    rm -rf "$PROGDIR/obj"
+    START=$(date +%s)
+    run_build APP_MODULES=pch_timing PCH_TIMING=$PCH "$@"
+    END=$(date +%s)
+    BUILD_TIME=$(( $END - $START ))
+}
+
+time_build "" "$@"
+TIME_NORMAL=$BUILD_TIME
+time_build timing/engine.h "$@"
+TIME_PCH=$BUILD_TIME
+echo "Building $TIMING_COUNT C++ sources: ${TIME_NORMAL}s normally, ${TIME_PCH}s with LOCAL_PCH"
+if [ "$TIME_PCH" -gt "$TIME_NORMAL" ]; then
+    echo "WARNING: The precompiled header made the build slower!"
+fi
+
+cleanup
+echo "Precompiled headers work."
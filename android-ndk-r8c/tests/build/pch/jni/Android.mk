@@ -0,0 +1,37 @@
+# Check LOCAL_PCH. See build.sh, which also generates the sources of
+# the pch_timing module.
+#
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := pch_test
+LOCAL_SRC_FILES := a.cpp b.cpp c.c
+LOCAL_PCH := pch.h
+LOCAL_CPPFLAGS := -Winvalid-pch
+include $(BUILD_STATIC_LIBRARY)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := pch_short
+LOCAL_SRC_FILES := a.cpp b.cpp
+LOCAL_PCH := pch.h
+LOCAL_SHORT_COMMANDS := true
+include $(BUILD_STATIC_LIBRARY)
+
+# Sources compiled in ARM and Thumb modes need different precompiled
+# headers.
+ifneq (,$(filter armeabi%,$(TARGET_ARCH_ABI)))
+include $(CLEAR_VARS)
+LOCAL_MODULE := pch_modes
+LOCAL_SRC_FILES := a.cpp b.cpp.arm
+LOCAL_PCH := pch.h
+include $(BUILD_STATIC_LIBRARY)
+endif
+
+timing_sources := $(wildcard $(LOCAL_PATH)/timing/*.cpp)
+ifdef timing_sources
+include $(CLEAR_VARS)
+LOCAL_MODULE := pch_timing
+LOCAL_SRC_FILES := $(timing_sources:$(LOCAL_PATH)/%=%)
+LOCAL_PCH := $(PCH_TIMING)
+include $(BUILD_STATIC_LIBRARY)
+endif
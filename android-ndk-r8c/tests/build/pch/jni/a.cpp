@@ -0,0 +1,6 @@
+#include "pch.h"
+
+int a(Engine& engine)
+{
+    return engine.get(1);
+}
@@ -0,0 +1,6 @@
+// Relies on LOCAL_PCH to include pch.h
+
+int b(Engine& engine)
+{
+    return engine.get(2);
+}
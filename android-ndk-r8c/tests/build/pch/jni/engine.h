@@ -0,0 +1,17 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+template <typename T>
+struct Table {
+    T values[16];
+
+    T& operator[](size_t n) { return values[n % 16]; }
+};
+
+struct Engine {
+    Table<int> values;
+
+    int get(size_t n) { return values[n]; }
+};
+
+#endif /* ENGINE_H */
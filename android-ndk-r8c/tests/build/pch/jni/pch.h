@@ -0,0 +1,7 @@
+#ifndef PCH_H
+#define PCH_H
+
+#include <stddef.h>
+#include "engine.h"
+
+#endif /* PCH_H */
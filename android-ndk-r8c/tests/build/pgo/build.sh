@@ -0,0 +1,103 @@
+# Check APP_PGO end-to-end: build the instrumented x86 executable, run it
+# on the host to collect its profiles, then build it again with them.
+# The .gcda files must be found at the path of each object under
+# NDK_PGO_PROFILE_DIR, and sources modified since must be reported.
+#
+
+PROGDIR=$(dirname $0)
+PROGDIR=$(cd "$PROGDIR" && pwd)
+
+case "$NDK_TOOLCHAIN_VERSION" in
+    clang*)
+        echo "No profile-guided optimization support with NDK_TOOLCHAIN_VERSION=$NDK_TOOLCHAIN_VERSION"
+        exit 0
+        ;;
+esac
+
+# The static x86 executable can only run on a x86 Linux host.
+case "$(uname -s)-$(uname -m)" in
+    Linux-i?86|Linux-x86_64)
+        ;;
+    *)
+        echo "Can't run x86 executables on this host, skipping."
+        exit 0
+        ;;
+esac
+
+cleanup ()
+{
+    rm -rf "$PROGDIR/obj" "$PROGDIR/libs" "$PROGDIR/pgo" "$PROGDIR/build.log"
+}
+
+fail ()
+{
+    echo "ERROR: $@"
+    cleanup
+    exit 1
+}
+
+# $1: pattern selecting commands in build.log
+# $2: string these commands must contain
+check_commands ()
+{
+    local COMMANDS
+    COMMANDS=$(grep -e "$1" "$PROGDIR/build.log")
+    if [ -z "$COMMANDS" ]; then
+        fail "No command matching '$1' in the build log"
+    fi
+    if echo "$COMMANDS" | grep -v -q -F -e "$2"; then
+        fail "Commands matching '$1' should contain '$2':
+$COMMANDS"
+    fi
+}
+
+# $1: APP_PGO mode
+# $2+: extra ndk-build arguments
+build_pgo ()
+{
+    local MODE=$1
+    shift
+    $NDK/ndk-build -C "$PROGDIR" -B V=1 "$@" APP_ABI=x86 APP_PGO=$MODE > "$PROGDIR/build.log" 2>&1
+    if [ $? != 0 ]; then
+        cat "$PROGDIR/build.log"
+        fail "Could not build with APP_PGO=$MODE"
+    fi
+}
+
+cleanup
+
+build_pgo instrument "$@" NDK_PGO_RUNTIME_DIR="$PROGDIR/pgo"
+check_commands "jni/main.c " " -fprofile-generate=$PROGDIR/pgo "
+check_commands "jni/lib.c " " -fprofile-generate=$PROGDIR/pgo "
+check_commands "-o [^ ]*/pgo_test\$" " -fprofile-generate "
+
+"$PROGDIR/libs/x86/pgo_test" || fail "The instrumented executable failed"
+
+cd "$PROGDIR"
+for OBJ in obj/local/x86/objs*/*/*.o; do
+    if [ ! -f "pgo/${OBJ%.o}.gcda" ]; then
+        fail "No profile written for $OBJ"
+    fi
+done
+
+build_pgo use "$@" NDK_PGO_PROFILE_DIR="$PROGDIR/pgo"
+check_commands "jni/main.c " " -fprofile-use=$PROGDIR/pgo "
+check_commands "jni/lib.c " " -fprofile-use=$PROGDIR/pgo "
+if grep -q -i -e "warning" "$PROGDIR/build.log"; then
+    cat "$PROGDIR/build.log"
+    fail "Unexpected warnings when using fresh profiles"
+fi
+
+"$PROGDIR/libs/x86/pgo_test" || fail "The optimized executable failed"
+
+# Pretend that lib.c was modified after profiling.
+sleep 1
+touch "$PROGDIR/jni/lib.c"
+build_pgo use "$@" NDK_PGO_PROFILE_DIR="$PROGDIR/pgo"
+if ! grep -q -e "Stale profiles .* module pgo_lib" "$PROGDIR/build.log"; then
+    cat "$PROGDIR/build.log"
+    fail "Stale profile of lib.c not reported"
+fi
+
+cleanup
+echo "Profile-guided optimization works."
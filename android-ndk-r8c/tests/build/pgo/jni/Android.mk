@@ -0,0 +1,17 @@
+# Check APP_PGO with an executable and a static library.
+# See build.sh which runs the instrumented executable on the host.
+#
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := pgo_lib
+LOCAL_SRC_FILES := lib.c
+include $(BUILD_STATIC_LIBRARY)
+
+# Linked statically so that the x86 executable runs on a x86 Linux host.
+include $(CLEAR_VARS)
+LOCAL_MODULE := pgo_test
+LOCAL_SRC_FILES := main.c
+LOCAL_STATIC_LIBRARIES := pgo_lib
+LOCAL_LDFLAGS := -static
+include $(BUILD_EXECUTABLE)
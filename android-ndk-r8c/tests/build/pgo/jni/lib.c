@@ -0,0 +1,10 @@
+int pgo_lib_classify(int n)
+{
+    if (n % 15 == 0)
+        return 3;
+    if (n % 5 == 0)
+        return 2;
+    if (n % 3 == 0)
+        return 1;
+    return 0;
+}
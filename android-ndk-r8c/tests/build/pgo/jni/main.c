@@ -0,0 +1,15 @@
+#include <stdio.h>
+
+extern int pgo_lib_classify(int n);
+
+int main(void)
+{
+    int counts[4] = { 0, 0, 0, 0 };
+    int n;
+
+    for (n = 1; n <= 1500; n++)
+        counts[pgo_lib_classify(n)]++;
+
+    printf("%d %d %d %d\n", counts[0], counts[1], counts[2], counts[3]);
+    return (counts[3] == 100) ? 0 : 1;
+}
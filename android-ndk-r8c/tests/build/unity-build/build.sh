@@ -0,0 +1,142 @@
+# Check that LOCAL_UNITY_BUILD batches sources by language and by
+# target-specific flags, honors LOCAL_UNITY_EXCLUDE, and that modifying
+# a source only recompiles its batch.
+#
+# Then compare the build times of a generated module with many C++
+# sources using STLport headers, with and without LOCAL_UNITY_BUILD.
+#
+
+PROGDIR=$(dirname $0)
+PROGDIR=$(cd "$PROGDIR" && pwd)
+
+# Number of generated sources for the timing comparison.
+TIMING_COUNT=64
+
+UNITY_DIR=$PROGDIR/obj/local/armeabi/objs/unity_test.unity
+
+cleanup ()
+{
+    rm -rf "$PROGDIR/obj" "$PROGDIR/libs" "$PROGDIR/jni/timing" "$PROGDIR/build.log"
+}
+
+fail ()
+{
+    echo "ERROR: $@"
+    cleanup
+    exit 1
+}
+
+# $1+: ndk-build arguments
+run_build ()
+{
+    $NDK/ndk-build -C "$PROGDIR" "$@" > "$PROGDIR/build.log" 2>&1
+    if [ $? != 0 ]; then
+        cat "$PROGDIR/build.log"
+        fail "Could not build: $@"
+    fi
+}
+
+# $1+: list of words
+sort_words ()
+{
+    echo $@ | tr ' ' '\n' | sort | tr '\n' ' '
+}
+
+# $1: expected list of compiled files, in any order
+check_compiled ()
+{
+    local COMPILED EXPECTED
+    COMPILED=$(sort_words $(grep -e "^Compile" "$PROGDIR/build.log" | sed -e 's/.* <= //'))
+    EXPECTED=$(sort_words $1)
+    if [ "$COMPILED" != "$EXPECTED" ]; then
+        fail "Compiled '$COMPILED' instead of '$EXPECTED'"
+    fi
+}
+
+# $1: unity source
+# $2+: sources it must include, in this order
+check_unity_source ()
+{
+    local NAME=$1 INCLUDES
+    local UNITY=$UNITY_DIR/$NAME
+    shift
+    if [ ! -f "$UNITY" ]; then
+        fail "Missing unity source: $UNITY"
+    fi
+    INCLUDES=$(sed -e 's|.*/jni/\([^"]*\)"|\1|' "$UNITY" | tr '\n' ' ')
+    if [ "$INCLUDES" != "$* " ]; then
+        fail "$NAME includes '$INCLUDES' instead of '$*'"
+    fi
+}
+
+cleanup
+
+run_build APP_MODULES=unity_test "$@" APP_ABI=armeabi
+check_compiled "unity-1.c unity-2.c unity-3.c unity-4.cpp excluded.c"
+check_unity_source unity-1.c a1.c a2.c a3.c
+check_unity_source unity-2.c a4.c a5.c
+check_unity_source unity-3.c b1.c b2.c
+check_unity_source unity-4.cpp c1.cpp c2.cpp c3.cpp
+if ! grep -q -e "^Compile arm .*unity-3.c" "$PROGDIR/build.log"; then
+    fail "unity-3.c should be compiled in ARM mode"
+fi
+
+# Nothing to do.
+run_build APP_MODULES=unity_test "$@" APP_ABI=armeabi
+check_compiled ""
+
+# Only the batch of the modified source must be rebuilt.
+sleep 1
+touch "$PROGDIR/jni/a5.c"
+run_build APP_MODULES=unity_test "$@" APP_ABI=armeabi
+check_compiled "unity-2.c"
+
+touch "$PROGDIR/jni/excluded.c"
+run_build APP_MODULES=unity_test "$@" APP_ABI=armeabi
+check_compiled "excluded.c"
+
+# Timing comparison.
+mkdir -p "$PROGDIR/jni/timing" || fail "Could not create $PROGDIR/jni/timing"
+NUM=0
+while [ $NUM -lt $TIMING_COUNT ]; do
+    cat > "$PROGDIR/jni/timing/timing$NUM.cpp" <<EOF
+#include <map>
+#include <string>
+#include <vector>
+
+int timing$NUM(const std::vector<std::string>& names)
+{
+    std::map<std::string, int> counts;
+    for (size_t n = 0; n < names.size(); ++n)
+        counts[names[n]] += $NUM;
+    return (int)counts.size();
+}
+EOF
+    NUM=$(( $NUM + 1 ))
+done
+
+# $1: value of LOCAL_UNITY_BUILD
+# $2+: ndk-build arguments
+# Out: BUILD_TIME, in seconds
+time_build ()
+{
+    local UNITY=$1 START END
+    shift
+    rm -rf "$PROGDIR/obj"
+    START=$(date +%s)
+    run_build APP_MODULES=unity_timing UNITY_TIMING=$UNITY "$@" APP_ABI=armeabi
+    END=$(date +%s)
+    BUILD_TIME=$(( $END - $START ))
+}
+
+time_build false "$@"
+TIME_NORMAL=$BUILD_TIME
+time_build true "$@"
+TIME_UNITY=$BUILD_TIME
+echo "Building $TIMING_COUNT C++ sources: ${TIME_NORMAL}s normally, ${TIME_UNITY}s with LOCAL_UNITY_BUILD"
+if [ "$TIME_UNITY" -gt "$TIME_NORMAL" ]; then
+    echo "WARNING: The unity build was slower!"
+fi
+
+cleanup
+echo "Unity builds work."
@@ -0,0 +1,24 @@
+# Check LOCAL_UNITY_BUILD. See build.sh which checks the generated unity
+# sources and generates the sources of the unity_timing module.
+#
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := unity_test
+LOCAL_SRC_FILES := a1.c a2.c a3.c a4.c a5.c \
+                   b1.c.arm b2.c.arm \
+                   c1.cpp c2.cpp c3.cpp \
+                   excluded.c
+LOCAL_UNITY_BUILD := true
+LOCAL_UNITY_BATCH_SIZE := 3
+LOCAL_UNITY_EXCLUDE := excluded.c
+include $(BUILD_SHARED_LIBRARY)
+
+timing_sources := $(wildcard $(LOCAL_PATH)/timing/*.cpp)
+ifdef timing_sources
+include $(CLEAR_VARS)
+LOCAL_MODULE := unity_timing
+LOCAL_SRC_FILES := $(timing_sources:$(LOCAL_PATH)/%=%)
+LOCAL_UNITY_BUILD := $(UNITY_TIMING)
+include $(BUILD_STATIC_LIBRARY)
+endif
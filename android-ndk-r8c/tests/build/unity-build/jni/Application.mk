@@ -0,0 +1,2 @@
+APP_ABI := armeabi
+APP_STL := stlport_static
@@ -0,0 +1,11 @@
+#include "unity_test.h"
+
+static int sum(int a, int b)
+{
+    return a + b;
+}
+
+int unity_a1(void)
+{
+    return sum(0, 1);
+}
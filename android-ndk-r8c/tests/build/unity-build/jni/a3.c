@@ -0,0 +1,6 @@
+#include "unity_test.h"
+
+int unity_a3(void)
+{
+    return 3;
+}
@@ -0,0 +1,7 @@
+#include "unity_test.h"
+
+/* Built in ARM mode, see LOCAL_SRC_FILES */
+int unity_b2(void)
+{
+    return 10 + 2;
+}
@@ -0,0 +1,8 @@
+#include <string>
+#include "unity_test.h"
+
+int unity_c1(void)
+{
+    std::string s("c1");
+    return (int)s.size() + 1;
+}
@@ -0,0 +1,8 @@
+#include <string>
+#include "unity_test.h"
+
+int unity_c2(void)
+{
+    std::string s("c2");
+    return (int)s.size() + 2;
+}
@@ -0,0 +1,8 @@
+#include <string>
+#include "unity_test.h"
+
+int unity_c3(void)
+{
+    std::string s("c3");
+    return (int)s.size() + 3;
+}
@@ -0,0 +1,14 @@
+#include "unity_test.h"
+
+/* Listed in LOCAL_UNITY_EXCLUDE: this static function would conflict
+ * with the one of a1.c if they were in the same batch. */
+static int sum(void)
+{
+    return unity_a1() + unity_a2() + unity_a3() + unity_a4() + unity_a5() +
+           unity_b1() + unity_b2() + unity_c1() + unity_c2() + unity_c3();
+}
+
+int unity_total(void)
+{
+    return sum();
+}
@@ -0,0 +1,25 @@
+#ifndef UNITY_TEST_H
+#define UNITY_TEST_H
+
+/* Each source includes this header, which must be guarded since the
+ * sources of a batch are compiled as a single translation unit. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int unity_a1(void);
+int unity_a2(void);
+int unity_a3(void);
+int unity_a4(void);
+int unity_a5(void);
+int unity_b1(void);
+int unity_b2(void);
+int unity_c1(void);
+int unity_c2(void);
+int unity_c3(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UNITY_TEST_H */
@@ -0,0 +1,12 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := test_audio_engine
+LOCAL_SRC_FILES := test_audio_engine.c
+LOCAL_STATIC_LIBRARIES := audio_engine
+ifeq ($(TARGET_ARCH),host)
+    LOCAL_LDLIBS := -lpthread
+endif
+include $(BUILD_EXECUTABLE)
+
+$(call import-module,android/audio_engine)
@@ -0,0 +1,528 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Headless driver for audio_engine, without OpenSL ES.
+ *
+ * The ring buffer is checked alone, then with a producer thread and a
+ * consumer thread. The mixer is checked with clips played at the rate of
+ * the mixer and at half of it, loops, saturated mixes and gains. Streams
+ * are checked with a simulated clock, where the producer misses some
+ * periods on purpose, and the underrun statistics are checked. Last, a
+ * clock thread stands for the buffer queue of OpenSL ES and calls the
+ * mixer every period while a producer thread feeds it in real time, and
+ * the statistics of the mixer are printed.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "audio_engine.h"
+
+#define RATE           48000
+#define PERIOD_FRAMES  240                      /* 5 ms at 48 kHz */
+#define PERIOD_NS      (PERIOD_FRAMES * 1000000000LL / RATE)
+#define PERIODS        100
+
+static int failures = 0;
+
+#define CHECK(cond, ...) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "KO: " __VA_ARGS__); \
+            fprintf(stderr, "\n"); \
+            failures++; \
+        } \
+    } while (0)
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void sleep_ns(int64_t ns)
+{
+    struct timespec ts;
+    ts.tv_sec = ns / 1000000000LL;
+    ts.tv_nsec = ns % 1000000000LL;
+    while (nanosleep(&ts, &ts) != 0)
+        ;
+}
+
+static unsigned int seed = 12345;
+
+static int16_t random_s16(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return (int16_t)(seed >> 16);
+}
+
+/* A ramp that never goes through 0, so that the silence of the underruns
+ * can be told apart from the stream.
+ */
+static int16_t ramp(uint32_t n)
+{
+    return (int16_t)(1 + n % 30000);
+}
+
+/* Round (a + b) / 2 to the nearest integer, ties to even. */
+static int16_t average(int a, int b)
+{
+    int  sum = a + b;
+    int  half = sum >> 1;
+
+    if ((sum & 1) != 0 && (half & 1) != 0)
+        half++;
+    return (int16_t)half;
+}
+
+static void test_ring(void)
+{
+    AudioRing*  ring = audio_ring_create(1000, 2);
+    int16_t     input[2 * 1500], output[2 * 1500];
+    int         nn, count;
+
+    CHECK(ring != NULL, "could not create a ring");
+    if (ring == NULL)
+        return;
+    CHECK(audio_ring_create(0, 2) == NULL, "ring of 0 frames created");
+    CHECK(audio_ring_capacity(ring) == 1024, "capacity %d instead of 1024",
+          audio_ring_capacity(ring));
+    CHECK(audio_ring_channels(ring) == 2, "%d channels instead of 2",
+          audio_ring_channels(ring));
+
+    for (nn = 0; nn < 2 * 1500; nn++)
+        input[nn] = random_s16();
+
+    /* Fill the ring past its end, in several parts. */
+    CHECK(audio_ring_write(ring, input, 700) == 700, "could not write 700 frames");
+    CHECK(audio_ring_read(ring, output, 500) == 500, "could not read 500 frames");
+    CHECK(memcmp(output, input, 500 * 2 * sizeof(int16_t)) == 0,
+          "wrong frames read from the ring");
+    CHECK(audio_ring_readable(ring) == 200, "%d readable frames instead of 200",
+          audio_ring_readable(ring));
+    CHECK(audio_ring_writable(ring) == 824, "%d writable frames instead of 824",
+          audio_ring_writable(ring));
+
+    count = audio_ring_write(ring, input + 700 * 2, 800);
+    CHECK(count == 800, "%d frames written instead of 800", count);
+    count = audio_ring_write(ring, input + 1500 * 2 - 2, 1);
+    CHECK(count == 1, "%d frames written instead of 1", count);
+    count = audio_ring_write(ring, input, 100);
+    CHECK(count == 23, "%d frames written to a full ring instead of 23", count);
+    CHECK(audio_ring_writable(ring) == 0, "full ring has %d writable frames",
+          audio_ring_writable(ring));
+
+    count = audio_ring_read(ring, output, 1500);
+    CHECK(count == 1024, "%d frames read instead of 1024", count);
+    CHECK(memcmp(output, input + 500 * 2, 1000 * 2 * sizeof(int16_t)) == 0,
+          "wrong frames read across the end of the ring");
+    CHECK(memcmp(output + 1000 * 2, input + 1500 * 2 - 2, 2 * sizeof(int16_t)) == 0 &&
+          memcmp(output + 1001 * 2, input, 23 * 2 * sizeof(int16_t)) == 0,
+          "wrong frames read after a partial write");
+    CHECK(audio_ring_read(ring, output, 1) == 0, "frame read from an empty ring");
+
+    audio_ring_destroy(ring);
+    audio_ring_destroy(NULL);
+}
+
+#define THREAD_FRAMES  (1 << 20)
+
+static void* ring_producer(void* arg)
+{
+    AudioRing*    ring = arg;
+    unsigned int  state = 1;
+    uint32_t      written = 0;
+    int16_t       frames[2 * 100];
+
+    while (written < THREAD_FRAMES) {
+        int  count, nn;
+
+        state = state * 1103515245 + 12345;
+        count = 1 + (state >> 16) % 100;
+        if (count > (int)(THREAD_FRAMES - written))
+            count = THREAD_FRAMES - written;
+        for (nn = 0; nn < count; nn++) {
+            frames[2*nn]     = (int16_t)(written + nn);
+            frames[2*nn + 1] = (int16_t)~(written + nn);
+        }
+        for (nn = 0; nn < count; ) {
+            int  done = audio_ring_write(ring, frames + 2*nn, count - nn);
+            if (done == 0)
+                sched_yield();
+            nn += done;
+        }
+        written += count;
+    }
+    return NULL;
+}
+
+static void test_ring_threads(void)
+{
+    AudioRing*    ring = audio_ring_create(256, 2);
+    pthread_t     thread;
+    unsigned int  state = 2;
+    uint32_t      read = 0;
+    int           errors = 0;
+    int16_t       frames[2 * 100];
+
+    if (ring == NULL || pthread_create(&thread, NULL, ring_producer, ring) != 0) {
+        CHECK(0, "could not start the ring producer");
+        audio_ring_destroy(ring);
+        return;
+    }
+    while (read < THREAD_FRAMES) {
+        int  count, nn;
+
+        state = state * 1103515245 + 12345;
+        count = audio_ring_read(ring, frames, 1 + (state >> 16) % 100);
+        if (count == 0)
+            sched_yield();
+        for (nn = 0; nn < count; nn++, read++) {
+            if (frames[2*nn] != (int16_t)read || frames[2*nn + 1] != (int16_t)~read)
+                errors++;
+        }
+    }
+    pthread_join(thread, NULL);
+    CHECK(errors == 0, "%d wrong frames read from another thread", errors);
+    CHECK(audio_ring_readable(ring) == 0, "%d frames left in the ring",
+          audio_ring_readable(ring));
+    audio_ring_destroy(ring);
+}
+
+#define CLIP_FRAMES  1000
+
+static void test_mixer_clip(void)
+{
+    AudioMixer*  mixer = audio_mixer_create(2, 1, 16000);
+    int16_t      clip[CLIP_FRAMES];
+    int16_t      output[2 * CLIP_FRAMES + 100];
+    int          nn, done, errors;
+
+    CHECK(mixer != NULL, "could not create a mixer");
+    if (mixer == NULL)
+        return;
+    for (nn = 0; nn < CLIP_FRAMES; nn++)
+        clip[nn] = random_s16();
+
+    /* Twice at the rate of the mixer. */
+    CHECK(audio_mixer_play_clip(mixer, 0, clip, CLIP_FRAMES, 16000, 2) == 0,
+          "could not play a clip");
+    CHECK(audio_mixer_is_playing(mixer, 0), "clip not playing before the render");
+    for (done = 0; done < 2 * CLIP_FRAMES + 100; done += 300) {
+        int  count = 2 * CLIP_FRAMES + 100 - done;
+        audio_mixer_render(mixer, output + done, count < 300 ? count : 300);
+    }
+    CHECK(memcmp(output, clip, sizeof(clip)) == 0 &&
+          memcmp(output + CLIP_FRAMES, clip, sizeof(clip)) == 0,
+          "clip not played twice unchanged");
+    for (errors = 0, nn = 2 * CLIP_FRAMES; nn < 2 * CLIP_FRAMES + 100; nn++)
+        errors += (output[nn] != 0);
+    CHECK(errors == 0, "%d frames not silent after the clip", errors);
+    CHECK(!audio_mixer_is_playing(mixer, 0), "clip still playing after its end");
+
+    /* At half the rate of the mixer, in one call. */
+    CHECK(audio_mixer_play_clip(mixer, 1, clip, CLIP_FRAMES, 8000, 1) == 0,
+          "could not play a clip at 8 kHz");
+    audio_mixer_render(mixer, output, 2 * CLIP_FRAMES + 100);
+    for (errors = 0, nn = 0; nn < 2 * CLIP_FRAMES + 100; nn++) {
+        int  a = (nn / 2 < CLIP_FRAMES) ? clip[nn / 2] : 0;
+        int  b = (nn / 2 + 1 < CLIP_FRAMES) ? clip[nn / 2 + 1] : 0;
+        int16_t  expected = (nn & 1) ? average(a, b) : a;
+        errors += (output[nn] != expected);
+    }
+    CHECK(errors == 0, "%d wrong frames for a clip at 8 kHz", errors);
+    CHECK(!audio_mixer_is_playing(mixer, 1), "clip at 8 kHz still playing");
+
+    audio_mixer_destroy(mixer);
+}
+
+static void test_mixer_mix(void)
+{
+    AudioMixer*  mixer = audio_mixer_create(3, 2, RATE);
+    AudioRing*   ring = audio_ring_create(256, 1);
+    int16_t      loud[2 * 10], quiet[2 * 10], output[2 * 1000];
+    int          nn;
+
+    CHECK(mixer != NULL && ring != NULL, "could not create a mixer");
+    if (mixer == NULL || ring == NULL)
+        return;
+    for (nn = 0; nn < 2 * 10; nn++) {
+        loud[nn]  = 20000;
+        quiet[nn] = -5000;
+    }
+
+    CHECK(audio_mixer_play_clip(mixer, 3, loud, 10, RATE, 0) < 0,
+          "clip played on a voice out of range");
+    CHECK(audio_mixer_play_clip(mixer, 0, loud, 10, 9 * RATE, 0) < 0,
+          "clip played 9 times faster");
+    CHECK(audio_mixer_play_stream(mixer, 0, ring, RATE) < 0,
+          "mono stream played by a stereo mixer");
+    CHECK(audio_mixer_create(0, 2, RATE) == NULL, "mixer of 0 voices created");
+
+    /* Loops forever, so that the mix can be checked after any render. */
+    audio_mixer_play_clip(mixer, 0, loud, 10, RATE, 0);
+    audio_mixer_play_clip(mixer, 1, loud, 10, RATE, 0);
+    audio_mixer_play_clip(mixer, 2, quiet, 10, RATE, 0);
+    audio_mixer_set_gain(mixer, 2, 0.5f);
+
+    audio_mixer_render(mixer, output, 1000);
+    CHECK(output[0] == 32767 && output[1999] == 32767,
+          "saturated mix gives %d, %d instead of 32767", output[0], output[1999]);
+
+    audio_mixer_set_gain(mixer, 0, 0.f);
+    audio_mixer_render(mixer, output, 1000);
+    CHECK(output[0] == 17500 && output[1999] == 17500,
+          "mix gives %d, %d instead of 17500", output[0], output[1999]);
+
+    audio_mixer_stop(mixer, 1);
+    CHECK(audio_mixer_is_playing(mixer, 1), "stop applied before the render");
+    audio_mixer_render(mixer, output, 1000);
+    CHECK(output[0] == -2500 && output[1999] == -2500,
+          "mix gives %d, %d instead of -2500", output[0], output[1999]);
+    CHECK(!audio_mixer_is_playing(mixer, 1), "stopped voice still playing");
+    CHECK(audio_mixer_is_playing(mixer, 0), "looping voice not playing");
+
+    audio_mixer_stop(mixer, 0);
+    audio_mixer_stop(mixer, 2);
+    audio_mixer_render(mixer, output, 1000);
+    CHECK(output[0] == 0 && output[1999] == 0, "mix not silent after stop");
+
+    audio_ring_destroy(ring);
+    audio_mixer_destroy(mixer);
+}
+
+/* Check that the non-silent frames of 'output' continue the ramp from
+ * '*next', and return the number of silent frames.
+ */
+static int check_ramp(const int16_t* output, int frames, uint32_t* next, int* errors)
+{
+    int  silent = 0;
+    int  nn;
+
+    for (nn = 0; nn < frames; nn++) {
+        if (output[nn] == 0) {
+            silent++;
+        } else {
+            if (output[nn] != ramp(*next))
+                (*errors)++;
+            (*next)++;
+        }
+    }
+    return silent;
+}
+
+/* Stream through a ring with a simulated clock: the producer writes a
+ * period of frames before each render, except that it misses periods
+ * 40 to 44 and writes only 100 frames for period 60.  Two periods are
+ * written in advance, so the renders 42 to 44 and 60 underrun.
+ */
+static void test_underruns(void)
+{
+    AudioMixer*      mixer = audio_mixer_create(1, 1, RATE);
+    AudioRing*       ring = audio_ring_create(4096, 1);
+    AudioMixerStats  stats;
+    int16_t          frames[3 * PERIOD_FRAMES], output[PERIOD_FRAMES];
+    uint32_t         written = 0, next = 0;
+    int              period, nn, silent = 0, errors = 0;
+
+    CHECK(mixer != NULL && ring != NULL, "could not create a mixer");
+    if (mixer == NULL || ring == NULL)
+        return;
+
+    for (nn = 0; nn < 2 * PERIOD_FRAMES; nn++)
+        frames[nn] = ramp(written++);
+    audio_ring_write(ring, frames, 2 * PERIOD_FRAMES);
+    audio_mixer_play_stream(mixer, 0, ring, RATE);
+
+    for (period = 0; period < PERIODS; period++) {
+        int  count = PERIOD_FRAMES;
+
+        if (period >= 40 && period <= 44)
+            count = 0;
+        else if (period == 60)
+            count = 100;
+        for (nn = 0; nn < count; nn++)
+            frames[nn] = ramp(written++);
+        audio_ring_write(ring, frames, count);
+
+        audio_mixer_render(mixer, output, PERIOD_FRAMES);
+        silent += check_ramp(output, PERIOD_FRAMES, &next, &errors);
+    }
+
+    audio_mixer_get_stats(mixer, &stats);
+    CHECK(errors == 0, "%d frames of the stream lost or repeated", errors);
+    CHECK(next == written - audio_ring_readable(ring),
+          "%u frames played instead of %u", next, written - audio_ring_readable(ring));
+    CHECK(stats.renders == PERIODS && stats.frames == PERIODS * PERIOD_FRAMES,
+          "%u renders of %u frames", stats.renders, stats.frames);
+    CHECK(stats.underruns == 4, "%u underruns instead of 4", stats.underruns);
+    CHECK(stats.underrunFrames == 3 * PERIOD_FRAMES + 140 &&
+          stats.underrunFrames == (uint32_t)silent,
+          "%u underrun frames, %d silent frames, instead of %d",
+          stats.underrunFrames, silent, 3 * PERIOD_FRAMES + 140);
+    CHECK(stats.maxQueuedFrames == 3 * PERIOD_FRAMES,
+          "at most %u queued frames instead of %d", stats.maxQueuedFrames,
+          3 * PERIOD_FRAMES);
+
+    audio_mixer_reset_stats(mixer);
+    audio_mixer_render(mixer, output, PERIOD_FRAMES);
+    audio_mixer_get_stats(mixer, &stats);
+    CHECK(stats.renders == 1 && stats.underruns == 1,
+          "%u renders and %u underruns after a reset", stats.renders, stats.underruns);
+
+    audio_mixer_destroy(mixer);
+    audio_ring_destroy(ring);
+}
+
+/* A stand-in for an OpenSL ES buffer queue: a thread calls 'callback'
+ * every period, which must fill the next buffer, like the Enqueue() of
+ * the buffer queue callback would.
+ */
+typedef struct {
+    void           (*callback)(void* context, int16_t* buffer, int frames);
+    void*          context;
+    int16_t        buffers[2][PERIOD_FRAMES];
+    int            periods;
+} FakeBufferQueue;
+
+static void* fake_buffer_queue_thread(void* arg)
+{
+    FakeBufferQueue*  queue = arg;
+    int64_t           next = now_ns();
+    int               nn;
+
+    for (nn = 0; nn < queue->periods; nn++) {
+        int64_t  delay = next - now_ns();
+
+        if (delay > 0)
+            sleep_ns(delay);
+        queue->callback(queue->context, queue->buffers[nn & 1], PERIOD_FRAMES);
+        next += PERIOD_NS;
+    }
+    return NULL;
+}
+
+typedef struct {
+    AudioMixer*        mixer;
+    AudioRing*         ring;
+    volatile int       stop;
+    uint32_t           written;
+    uint32_t           next;
+    int                errors;
+} Player;
+
+static void player_callback(void* context, int16_t* buffer, int frames)
+{
+    Player*  player = context;
+
+    audio_mixer_render(player->mixer, buffer, frames);
+    /* What the audio device would play. */
+    check_ramp(buffer, frames, &player->next, &player->errors);
+}
+
+/* A decoder, which refills the ring by blocks of two periods. */
+static void* player_producer(void* arg)
+{
+    Player*  player = arg;
+    int16_t  frames[2 * PERIOD_FRAMES];
+    int      nn;
+
+    while (!player->stop) {
+        if (audio_ring_writable(player->ring) < 2 * PERIOD_FRAMES) {
+            sleep_ns(1000000);
+            continue;
+        }
+        for (nn = 0; nn < 2 * PERIOD_FRAMES; nn++)
+            frames[nn] = ramp(player->written + nn);
+        player->written += audio_ring_write(player->ring, frames, 2 * PERIOD_FRAMES);
+    }
+    return NULL;
+}
+
+static void test_callback_clock(void)
+{
+    static FakeBufferQueue  queue;
+    Player                  player;
+    AudioMixerStats         stats;
+    pthread_t               producer, clock;
+
+    memset(&player, 0, sizeof(player));
+    player.mixer = audio_mixer_create(1, 1, RATE);
+    player.ring  = audio_ring_create(8 * PERIOD_FRAMES, 1);
+    CHECK(player.mixer != NULL && player.ring != NULL, "could not create a mixer");
+    if (player.mixer == NULL || player.ring == NULL)
+        return;
+    audio_mixer_play_stream(player.mixer, 0, player.ring, RATE);
+
+    queue.callback = player_callback;
+    queue.context  = &player;
+    queue.periods  = PERIODS;
+    if (pthread_create(&producer, NULL, player_producer, &player) != 0) {
+        CHECK(0, "could not start the producer");
+        return;
+    }
+    /* Let the producer fill the ring, like an application would before
+     * starting the player.
+     */
+    sleep_ns(PERIOD_NS);
+    if (pthread_create(&clock, NULL, fake_buffer_queue_thread, &queue) != 0) {
+        CHECK(0, "could not start the buffer queue");
+        player.stop = 1;
+        pthread_join(producer, NULL);
+        return;
+    }
+    pthread_join(clock, NULL);
+    player.stop = 1;
+    pthread_join(producer, NULL);
+
+    audio_mixer_get_stats(player.mixer, &stats);
+    CHECK(player.errors == 0, "%d frames of the stream lost or repeated", player.errors);
+    CHECK(stats.renders == PERIODS, "%u renders instead of %d", stats.renders, PERIODS);
+    CHECK(player.next == stats.frames - stats.underrunFrames,
+          "%u frames played instead of %u", player.next,
+          stats.frames - stats.underrunFrames);
+    printf("Stream of %d periods of %d frames: %u underruns (%u frames), "
+           "latency %.2f ms at most, render %.1f us at most, "
+           "%.2f ms between renders at most\n", PERIODS, PERIOD_FRAMES,
+           stats.underruns, stats.underrunFrames,
+           stats.maxQueuedFrames * 1000.0 / RATE, stats.maxRenderNs / 1000.0,
+           stats.maxIntervalNs / 1000000.0);
+
+    audio_mixer_destroy(player.mixer);
+    audio_ring_destroy(player.ring);
+}
+
+int main(void)
+{
+    test_ring();
+    test_ring_threads();
+    test_mixer_clip();
+    test_mixer_mix();
+    test_underruns();
+    test_callback_clock();
+
+    if (failures != 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
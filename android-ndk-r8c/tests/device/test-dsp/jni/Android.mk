@@ -0,0 +1,13 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := test_dsp
+LOCAL_SRC_FILES := test_dsp.c
+LOCAL_CFLAGS := -ffp-contract=off
+ifneq (,$(filter x86 host,$(TARGET_ARCH)))
+    LOCAL_CFLAGS += -msse2 -mfpmath=sse
+endif
+LOCAL_STATIC_LIBRARIES := dsp
+include $(BUILD_EXECUTABLE)
+
+$(call import-module,android/dsp)
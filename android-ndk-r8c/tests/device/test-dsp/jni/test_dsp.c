@@ -0,0 +1,527 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Bit-exactness tests and benchmark of the dsp library.
+ *
+ * Every implementation supported by the CPU is selected in turn with
+ * dsp_set_impl(), and the output of each kernel is compared bit for bit
+ * with the straightforward C code below, for odd sizes, odd kernels,
+ * overflowing 16-bit sums, rounding ties and saturation, resampling
+ * steps, various channel counts and block sizes. The float inputs never
+ * involve denormals. Then the throughput of each kernel is printed for
+ * each implementation.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dsp.h"
+
+#define BENCH_MS  200
+
+static int failures = 0;
+
+#define CHECK(cond, ...) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "KO: " __VA_ARGS__); \
+            fprintf(stderr, "\n"); \
+            failures++; \
+        } \
+    } while (0)
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static unsigned int seed = 12345;
+
+static int16_t random_s16(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return (int16_t)(seed >> 16);
+}
+
+/* A float in [-1, 1). */
+static float random_f32(void)
+{
+    return random_s16() / 32768.f;
+}
+
+/* The reference implementations. */
+
+static void ref_fir_s16(int16_t* output, const int16_t* input, const int16_t* kernel,
+                        int width, int kernelSize)
+{
+    int  nn, mm, offset = -kernelSize/2;
+    for (nn = 0; nn < width; nn++) {
+        uint32_t  sum = 0;
+        for (mm = 0; mm < kernelSize; mm++)
+            sum += (uint32_t)(kernel[mm] * input[nn + offset + mm]);
+        output[nn] = (int16_t)((int32_t)(sum + 0x8000) >> 16);
+    }
+}
+
+static void ref_fir_f32(float* output, const float* input, const float* kernel,
+                        int width, int kernelSize)
+{
+    int  nn, mm, offset = -kernelSize/2;
+    for (nn = 0; nn < width; nn++) {
+        float  sum = 0.f;
+        for (mm = 0; mm < kernelSize; mm++)
+            sum += kernel[mm] * input[nn + offset + mm];
+        output[nn] = sum;
+    }
+}
+
+static void ref_biquad_f32(const DspBiquad* q, DspBiquadState* states,
+                           float* output, const float* input, int frames, int channels)
+{
+    int  ff, cc;
+    for (ff = 0; ff < frames; ff++) {
+        for (cc = 0; cc < channels; cc++) {
+            DspBiquadState*  s = &states[cc];
+            float  x = input[ff*channels + cc];
+            float  y = q->b0*x + q->b1*s->x1 + q->b2*s->x2 - q->a1*s->y1 - q->a2*s->y2;
+            s->x2 = s->x1;
+            s->x1 = x;
+            s->y2 = s->y1;
+            s->y1 = y;
+            output[ff*channels + cc] = y;
+        }
+    }
+}
+
+/* Direct convolution of a whole signal, summing from the oldest input
+ * sample, like the convolver does.
+ */
+static void ref_conv_f32(float* output, const float* input, int count,
+                         const float* impulse, int length)
+{
+    int  nn, mm;
+    for (nn = 0; nn < count; nn++) {
+        float  sum = 0.f;
+        for (mm = length - 1; mm >= 0; mm--)
+            sum += impulse[mm] * (nn - mm >= 0 ? input[nn - mm] : 0.f);
+        output[nn] = sum;
+    }
+}
+
+static void ref_s16_to_f32(float* output, const int16_t* input, int count)
+{
+    int  nn;
+    for (nn = 0; nn < count; nn++)
+        output[nn] = input[nn] / 32768.f;
+}
+
+/* Round to nearest, ties to even, without relying on the FPU. */
+static void ref_f32_to_s16(int16_t* output, const float* input, int count)
+{
+    int  nn;
+    for (nn = 0; nn < count; nn++) {
+        float  v = input[nn] * 32768.f, diff;
+        int    r;
+        if (v < -32768.f)
+            v = -32768.f;
+        if (v > 32767.f)
+            v = 32767.f;
+        r = (int)v;
+        diff = v - r;
+        if (diff > 0.5f || (diff == 0.5f && (r & 1)))
+            r++;
+        else if (diff < -0.5f || (diff == -0.5f && (r & 1)))
+            r--;
+        output[nn] = (int16_t)r;
+    }
+}
+
+static void ref_mix_f32(float* output, const float* input, int count, float gain)
+{
+    int  nn;
+    for (nn = 0; nn < count; nn++)
+        output[nn] += input[nn] * gain;
+}
+
+static void ref_resample_s16_f32(float* output, const int16_t* input, int channels,
+                                 int frames, uint32_t position, uint32_t step)
+{
+    int  nn, cc;
+    for (nn = 0; nn < frames; nn++) {
+        uint32_t  p = position + nn * step;
+        uint32_t  i = p >> 16;
+        float     f = (p & 0xffff) / 65536.f;
+        for (cc = 0; cc < channels; cc++) {
+            float  a = input[i*channels + cc];
+            float  b = input[(i + 1)*channels + cc];
+            output[nn*channels + cc] = (a + (b - a) * f) / 32768.f;
+        }
+    }
+}
+
+/* The tests. */
+
+#define MAX_WIDTH   3000
+#define MAX_KERNEL  64
+
+static void test_fir_s16(const char* impl)
+{
+    static const int  kernels[] = { 1, 2, 7, 32, 33, MAX_KERNEL };
+    static const int  widths[] = { 1, 7, 8, 13, 2560 };
+    static int16_t    input[MAX_KERNEL + MAX_WIDTH + MAX_KERNEL];
+    static int16_t    kernel[MAX_KERNEL];
+    static int16_t    expected[MAX_WIDTH], actual[MAX_WIDTH];
+    size_t  kk, ww;
+    int     nn, pass;
+
+    for (pass = 0; pass < 2; pass++) {
+        for (nn = 0; nn < (int)(sizeof(input)/sizeof(input[0])); nn++)
+            input[nn] = pass == 0 ? random_s16() : -32768;
+        for (kk = 0; kk < sizeof(kernels)/sizeof(kernels[0]); kk++) {
+            /* The second pass overflows the 32-bit sums. */
+            for (nn = 0; nn < kernels[kk]; nn++)
+                kernel[nn] = pass == 0 ? random_s16() : -32768;
+            for (ww = 0; ww < sizeof(widths)/sizeof(widths[0]); ww++) {
+                const int16_t*  in = input + MAX_KERNEL;
+                ref_fir_s16(expected, in, kernel, widths[ww], kernels[kk]);
+                dsp_fir_s16(actual, in, kernel, widths[ww], kernels[kk]);
+                CHECK(memcmp(expected, actual, widths[ww] * sizeof(int16_t)) == 0,
+                      "%s: dsp_fir_s16 differs, width %d, kernel %d%s", impl, widths[ww],
+                      kernels[kk], pass ? ", overflowing" : "");
+            }
+        }
+    }
+}
+
+static void test_fir_f32(const char* impl)
+{
+    static const int  kernels[] = { 1, 2, 7, 32, 33, MAX_KERNEL };
+    static const int  widths[] = { 1, 7, 8, 13, 2560 };
+    static float      input[MAX_KERNEL + MAX_WIDTH + MAX_KERNEL];
+    static float      kernel[MAX_KERNEL];
+    static float      expected[MAX_WIDTH], actual[MAX_WIDTH];
+    size_t  kk, ww;
+    int     nn;
+
+    for (nn = 0; nn < (int)(sizeof(input)/sizeof(input[0])); nn++)
+        input[nn] = random_f32();
+    for (kk = 0; kk < sizeof(kernels)/sizeof(kernels[0]); kk++) {
+        for (nn = 0; nn < kernels[kk]; nn++)
+            kernel[nn] = random_f32() / kernels[kk];
+        for (ww = 0; ww < sizeof(widths)/sizeof(widths[0]); ww++) {
+            const float*  in = input + MAX_KERNEL;
+            ref_fir_f32(expected, in, kernel, widths[ww], kernels[kk]);
+            dsp_fir_f32(actual, in, kernel, widths[ww], kernels[kk]);
+            CHECK(memcmp(expected, actual, widths[ww] * sizeof(float)) == 0,
+                  "%s: dsp_fir_f32 differs, width %d, kernel %d", impl, widths[ww],
+                  kernels[kk]);
+        }
+    }
+}
+
+/* A resonant low-pass filter at fs/8. */
+static const DspBiquad  lowpass = {
+    0.0639643f, 0.1279286f, 0.0639643f, -1.1682228f, 0.4240801f
+};
+
+static void test_biquad_f32(const char* impl)
+{
+    enum { FRAMES = 1000, MAX_CHANNELS = 9 };
+    static const int  channels[] = { 1, 2, 4, 6, 8, 9 };
+    static float      input[FRAMES * MAX_CHANNELS];
+    static float      expected[FRAMES * MAX_CHANNELS], actual[FRAMES * MAX_CHANNELS];
+    DspBiquadState    ref_states[MAX_CHANNELS], states[MAX_CHANNELS];
+    size_t  cc;
+    int     nn;
+
+    for (nn = 0; nn < FRAMES * MAX_CHANNELS; nn++)
+        input[nn] = random_f32();
+
+    for (cc = 0; cc < sizeof(channels)/sizeof(channels[0]); cc++) {
+        int  count = FRAMES * channels[cc];
+
+        memset(ref_states, 0, sizeof(ref_states));
+        memset(states, 0, sizeof(states));
+        /* In two calls, to check the states, the second one in place. */
+        ref_biquad_f32(&lowpass, ref_states, expected, input, FRAMES, channels[cc]);
+        dsp_biquad_f32(&lowpass, states, actual, input, FRAMES / 2, channels[cc]);
+        memcpy(actual + count / 2, input + count / 2, (count - count / 2) * sizeof(float));
+        dsp_biquad_f32(&lowpass, states, actual + count / 2, actual + count / 2,
+                       FRAMES - FRAMES / 2, channels[cc]);
+
+        CHECK(memcmp(expected, actual, count * sizeof(float)) == 0,
+              "%s: dsp_biquad_f32 differs, %d channels", impl, channels[cc]);
+        CHECK(memcmp(ref_states, states, channels[cc] * sizeof(DspBiquadState)) == 0,
+              "%s: dsp_biquad_f32 states differ, %d channels", impl, channels[cc]);
+    }
+}
+
+static void test_conv_f32(const char* impl)
+{
+    enum { COUNT = 2000 };
+    static const int  lengths[] = { 1, 5, 64, 300 };
+    static const int  blocks[] = { 1, 64, 100, 256 };
+    static float      input[COUNT], impulse[300];
+    static float      expected[COUNT], actual[COUNT];
+    size_t  ll, bb;
+    int     nn;
+
+    for (nn = 0; nn < COUNT; nn++)
+        input[nn] = random_f32();
+
+    for (ll = 0; ll < sizeof(lengths)/sizeof(lengths[0]); ll++) {
+        for (nn = 0; nn < lengths[ll]; nn++)
+            impulse[nn] = random_f32() / lengths[ll];
+        ref_conv_f32(expected, input, COUNT, impulse, lengths[ll]);
+
+        for (bb = 0; bb < sizeof(blocks)/sizeof(blocks[0]); bb++) {
+            DspConvolver*  conv = dsp_conv_create(impulse, lengths[ll], blocks[bb]);
+            int            pass;
+
+            CHECK(conv != NULL, "dsp_conv_create failed");
+            if (conv == NULL)
+                continue;
+            /* The second pass is in place, after a reset. */
+            for (pass = 0; pass < 2; pass++) {
+                if (pass == 1) {
+                    dsp_conv_reset(conv);
+                    memcpy(actual, input, sizeof(input));
+                }
+                for (nn = 0; nn < COUNT; nn += blocks[bb]) {
+                    int  frames = COUNT - nn < blocks[bb] ? COUNT - nn : blocks[bb];
+                    dsp_conv_process(conv, actual + nn, pass ? actual + nn : input + nn,
+                                     frames);
+                }
+                CHECK(memcmp(expected, actual, sizeof(expected)) == 0,
+                      "%s: dsp_conv_process differs, length %d, block %d%s", impl,
+                      lengths[ll], blocks[bb], pass ? ", in place" : "");
+            }
+            dsp_conv_destroy(conv);
+        }
+    }
+    CHECK(dsp_conv_create(impulse, 0, 16) == NULL, "convolver without impulse created");
+}
+
+static void test_mix(const char* impl)
+{
+    enum { MAX_COUNT = 1000 };
+    static const int  counts[] = { 1, 7, 8, 13, MAX_COUNT };
+    /* Rounding ties and saturation, in 1/32768 units. */
+    static const float  edges[] = {
+        0.5f, 1.5f, 2.5f, -0.5f, -1.5f, -2.5f, 32766.5f, 32767.f, 32767.5f,
+        32768.f, 40000.f, -32767.5f, -32768.f, -32768.5f, -40000.f, 0.f, -0.f
+    };
+    static int16_t  s16[MAX_COUNT], s16_expected[MAX_COUNT], s16_actual[MAX_COUNT];
+    static float    f32[MAX_COUNT], expected[MAX_COUNT], actual[MAX_COUNT];
+    size_t  cc;
+    int     nn;
+
+    for (nn = 0; nn < MAX_COUNT; nn++) {
+        s16[nn] = random_s16();
+        f32[nn] = random_f32() * 1.5f;
+    }
+    for (nn = 0; nn < (int)(sizeof(edges)/sizeof(edges[0])); nn++)
+        f32[nn * 3] = edges[nn] / 32768.f;
+
+    for (cc = 0; cc < sizeof(counts)/sizeof(counts[0]); cc++) {
+        int  count = counts[cc];
+
+        ref_s16_to_f32(expected, s16, count);
+        dsp_s16_to_f32(actual, s16, count);
+        CHECK(memcmp(expected, actual, count * sizeof(float)) == 0,
+              "%s: dsp_s16_to_f32 differs, count %d", impl, count);
+
+        ref_f32_to_s16(s16_expected, f32, count);
+        dsp_f32_to_s16(s16_actual, f32, count);
+        CHECK(memcmp(s16_expected, s16_actual, count * sizeof(int16_t)) == 0,
+              "%s: dsp_f32_to_s16 differs, count %d", impl, count);
+
+        for (nn = 0; nn < count; nn++)
+            expected[nn] = actual[nn] = random_f32();
+        ref_mix_f32(expected, f32, count, 0.3f);
+        dsp_mix_f32(actual, f32, count, 0.3f);
+        CHECK(memcmp(expected, actual, count * sizeof(float)) == 0,
+              "%s: dsp_mix_f32 differs, count %d", impl, count);
+    }
+}
+
+static void test_resample(const char* impl)
+{
+    enum { FRAMES = 300, MAX_CHANNELS = 3, MAX_INPUT = FRAMES * 4 + 2 };
+    /* Q16 steps: same rate, 8 to 16 kHz, 44.1 to 48 kHz, down-sampling. */
+    static const uint32_t  steps[] = { 0x10000, 0x8000, 60211, 0x1aaaa, 0x40000 };
+    static const int       frames[] = { 1, 3, 4, 5, FRAMES };
+    static int16_t  input[MAX_INPUT * MAX_CHANNELS];
+    static float    expected[FRAMES * MAX_CHANNELS], actual[FRAMES * MAX_CHANNELS];
+    size_t  ss, ff;
+    int     nn, channels;
+
+    for (nn = 0; nn < MAX_INPUT * MAX_CHANNELS; nn++)
+        input[nn] = random_s16();
+
+    for (channels = 1; channels <= MAX_CHANNELS; channels++) {
+        for (ss = 0; ss < sizeof(steps)/sizeof(steps[0]); ss++) {
+            for (ff = 0; ff < sizeof(frames)/sizeof(frames[0]); ff++) {
+                uint32_t  position = (random_s16() & 0xffff) + 0x20000;
+                int       count = frames[ff] * channels;
+                ref_resample_s16_f32(expected, input, channels, frames[ff],
+                                     position, steps[ss]);
+                dsp_resample_s16_f32(actual, input, channels, frames[ff],
+                                     position, steps[ss]);
+                CHECK(memcmp(expected, actual, count * sizeof(float)) == 0,
+                      "%s: dsp_resample_s16_f32 differs, %d channels, step 0x%x, "
+                      "%d frames", impl, channels, steps[ss], frames[ff]);
+            }
+        }
+    }
+}
+
+/* The benchmark, with the sizes of the hello-neon sample. */
+
+#define  BENCH_KERNEL   32
+#define  BENCH_WIDTH    2560
+#define  BENCH_FRAMES   1024
+#define  BENCH_CHANNELS 8
+#define  BENCH_IMPULSE  256
+
+typedef struct {
+    int16_t        s16_input[BENCH_WIDTH + BENCH_KERNEL];
+    int16_t        s16_kernel[BENCH_KERNEL];
+    int16_t        s16_output[BENCH_WIDTH];
+    float          f32_input[BENCH_WIDTH + BENCH_KERNEL];
+    float          f32_kernel[BENCH_KERNEL];
+    float          f32_output[BENCH_WIDTH];
+    float          audio[BENCH_FRAMES * BENCH_CHANNELS];
+    DspBiquadState states[BENCH_CHANNELS];
+    DspConvolver*  conv;
+} Bench;
+
+static void bench_fir_s16(Bench* b)
+{
+    dsp_fir_s16(b->s16_output, b->s16_input + BENCH_KERNEL/2, b->s16_kernel,
+                BENCH_WIDTH, BENCH_KERNEL);
+}
+
+static void bench_fir_f32(Bench* b)
+{
+    dsp_fir_f32(b->f32_output, b->f32_input + BENCH_KERNEL/2, b->f32_kernel,
+                BENCH_WIDTH, BENCH_KERNEL);
+}
+
+static void bench_biquad_f32(Bench* b)
+{
+    dsp_biquad_f32(&lowpass, b->states, b->audio, b->audio, BENCH_FRAMES, BENCH_CHANNELS);
+}
+
+static void bench_conv_f32(Bench* b)
+{
+    dsp_conv_process(b->conv, b->f32_output, b->f32_input, BENCH_FRAMES);
+}
+
+static void bench_mix_f32(Bench* b)
+{
+    dsp_mix_f32(b->f32_output, b->f32_input, BENCH_WIDTH, 0.5f);
+}
+
+/* 44.1 to 48 kHz, mono. */
+static void bench_resample(Bench* b)
+{
+    dsp_resample_s16_f32(b->f32_output, b->s16_input, 1, BENCH_WIDTH, 0, 60211);
+}
+
+/* Return the Msamples/s of a kernel processing 'samples' per call. */
+static double bench(void (*func)(Bench*), Bench* b, int samples)
+{
+    double  start = now_ms(), elapsed;
+    int     calls = 0;
+
+    do {
+        func(b);
+        calls++;
+        elapsed = now_ms() - start;
+    } while (elapsed < BENCH_MS);
+
+    return (double)samples * calls / elapsed / 1e3;
+}
+
+int main(void)
+{
+    static Bench  b;
+    float         impulse[BENCH_IMPULSE];
+    int           impl, nn;
+
+    CHECK(dsp_impl_is_supported(DSP_IMPL_SCALAR), "scalar implementation not supported");
+    CHECK(dsp_set_impl(DSP_IMPL_COUNT) < 0, "invalid implementation selected");
+    CHECK(dsp_impl_name(DSP_IMPL_COUNT) == NULL, "invalid implementation has a name");
+    printf("Default implementation: %s\n", dsp_impl_name(dsp_get_impl()));
+
+    for (impl = DSP_IMPL_SCALAR; impl < DSP_IMPL_COUNT; impl++) {
+        const char*  name = dsp_impl_name(impl);
+        if (!dsp_impl_is_supported(impl)) {
+            CHECK(dsp_set_impl(impl) < 0, "unsupported %s implementation selected", name);
+            continue;
+        }
+        CHECK(dsp_set_impl(impl) == 0 && dsp_get_impl() == impl,
+              "could not select the %s implementation", name);
+        test_fir_s16(name);
+        test_fir_f32(name);
+        test_biquad_f32(name);
+        test_conv_f32(name);
+        test_mix(name);
+        test_resample(name);
+    }
+
+    for (nn = 0; nn < BENCH_WIDTH + BENCH_KERNEL; nn++) {
+        b.s16_input[nn] = (5*nn) & 255;
+        b.f32_input[nn] = random_f32();
+    }
+    for (nn = 0; nn < BENCH_KERNEL; nn++) {
+        b.s16_kernel[nn] = random_s16() >> 6;
+        b.f32_kernel[nn] = random_f32() / BENCH_KERNEL;
+    }
+    for (nn = 0; nn < BENCH_IMPULSE; nn++)
+        impulse[nn] = random_f32() / BENCH_IMPULSE;
+    b.conv = dsp_conv_create(impulse, BENCH_IMPULSE, BENCH_FRAMES);
+
+    printf("Throughput in Msamples/s:\n");
+    printf("  %-8s %12s %12s %12s %12s %12s %12s\n", "", "fir_s16/32", "fir_f32/32",
+           "biquad/8ch", "conv/256", "mix_f32", "resample");
+    for (impl = DSP_IMPL_SCALAR; impl < DSP_IMPL_COUNT; impl++) {
+        if (dsp_set_impl(impl) < 0)
+            continue;
+        /* Keep the filtered audio in a sane range between runs. */
+        for (nn = 0; nn < BENCH_FRAMES * BENCH_CHANNELS; nn++)
+            b.audio[nn] = random_f32();
+        printf("  %-8s %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f\n", dsp_impl_name(impl),
+               bench(bench_fir_s16, &b, BENCH_WIDTH),
+               bench(bench_fir_f32, &b, BENCH_WIDTH),
+               bench(bench_biquad_f32, &b, BENCH_FRAMES * BENCH_CHANNELS),
+               bench(bench_conv_f32, &b, BENCH_FRAMES),
+               bench(bench_mix_f32, &b, BENCH_WIDTH),
+               bench(bench_resample, &b, BENCH_WIDTH));
+    }
+    dsp_conv_destroy(b.conv);
+
+    if (failures != 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2012
+ * The Android Open Source Project
+ *
+ * This material is provided "as is", with absolutely no warranty expressed
+ * or implied. Any use is at your own risk.
+ *
+ * Permission to use or copy this software for any purpose is hereby granted
+ * without fee, provided the above notices are retained on all copies.
+ * Permission to modify the code and to distribute modified code is granted,
+ * provided the above notices are retained, and a notice that the code was
+ * modified is included with the above copyright notice.
+ *
+ */
+
+#ifndef CPPUNIT_BENCH_H
+#define CPPUNIT_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cppunit_timer.h"
+
+//
+// CppUnit mini benchmark support
+//
+// In benchmark mode, each test is run repeatedly:
+//  - warm-up: the test is run until 'warmupMs' have elapsed (at least once),
+//    which gives an estimate of its duration;
+//  - sampling: the test is run 'samples' times in batches of 'iterations'
+//    calls, where 'iterations' is computed so that each batch lasts about
+//    'sampleMs'. Sampling stops early if it takes longer than 'budgetMs',
+//    after at least kMinSamples batches.
+//
+// The median and the 99th percentile of the time per call are reported,
+// and can be written to a JSON file that can later be used as a baseline.
+//
+// Note that the STL isn't used here, since it is the code under test.
+//
+struct BenchmarkResult {
+  char name[128];         // <class>::<test>
+  int iterations;         // number of calls per sample
+  int samples;            // number of samples
+  double firstNs;         // duration of the first (cold) call
+  double warmupNs;        // mean duration of a call during warm-up
+  double medianNs;        // median duration of a call
+  double p99Ns;           // 99th percentile of the duration of a call
+  double medianCycles;    // median number of cycles per call, or -1
+};
+
+class Benchmark {
+private:
+  Benchmark(const Benchmark&);
+  Benchmark& operator=(const Benchmark&);
+
+  enum { kMinSamples = 5, kMaxSamples = 1000, kMaxIterations = 1 << 20 };
+  enum State { IDLE, WARMUP, SAMPLING };
+
+public:
+  explicit Benchmark(int samples = 25, double warmupMs = 10, double sampleMs = 5,
+                     double budgetMs = 2000):
+      m_samples(samples < kMinSamples ? kMinSamples : samples > kMaxSamples ? kMaxSamples : samples),
+      m_warmupNs(warmupMs * 1e6), m_sampleNs(sampleMs * 1e6), m_budgetNs(budgetMs * 1e6),
+      m_threshold(10), m_state(IDLE), m_calls(0), m_iterations(0), m_numSampled(0),
+      m_results(0), m_numResults(0), m_maxResults(0),
+      m_baseline(0), m_numBaseline(0)
+  {}
+
+  ~Benchmark() {
+    free(m_results);
+    free(m_baseline);
+  }
+
+  // Regression threshold, in percent of the baseline median.
+  void setThreshold(double percent) { m_threshold = percent; }
+  double threshold() const { return m_threshold; }
+
+  // Called before the first call of a test.
+  void start() {
+    m_state = WARMUP;
+    m_calls = 0;
+    m_numSampled = 0;
+    m_start = Timer::nanoseconds();
+  }
+
+  // Called after each call of a test. Returns true if it must be called
+  // again. The clock is only read at the end of each sample, so that it
+  // doesn't add to the measured time.
+  bool next() {
+    ++m_calls;
+    if (m_state == SAMPLING) {
+      return (m_calls < m_iterations) || endSample();
+    }
+    if (m_state != WARMUP) {
+      return false;
+    }
+    double elapsed = (double)(Timer::nanoseconds() - m_start);
+    if (m_calls == 1) {
+      m_firstNs = elapsed;
+    }
+    if (elapsed < m_warmupNs) {
+      return true;
+    }
+    m_warmupCallNs = elapsed / m_calls;
+    if (m_warmupCallNs > 0 && m_sampleNs / m_warmupCallNs > 1) {
+      m_iterations = m_sampleNs / m_warmupCallNs < kMaxIterations ?
+                     (int)(m_sampleNs / m_warmupCallNs) : (int)kMaxIterations;
+    }
+    else {
+      m_iterations = 1;
+    }
+    m_state = SAMPLING;
+    startSample();
+    return true;
+  }
+
+  // Called instead of end() when a test failed or wasn't benchmarked, so
+  // that the next test doesn't resume its sampling.
+  void reset() {
+    m_state = IDLE;
+    m_numSampled = 0;
+  }
+
+  // Called after the last call of a test. Returns false if the test
+  // didn't complete its warm-up and at least one sample.
+  bool end(const char *in_className, const char *in_testName, BenchmarkResult &out_result) {
+    bool complete = (m_numSampled > 0);
+    int numSampled = m_numSampled;
+    reset();
+    if (!complete) {
+      return false;
+    }
+    memset(&out_result, 0, sizeof(out_result));
+    snprintf(out_result.name, sizeof(out_result.name), "%s::%s", in_className, in_testName);
+    out_result.iterations = m_iterations;
+    out_result.samples = numSampled;
+    out_result.firstNs = m_firstNs;
+    out_result.warmupNs = m_warmupCallNs;
+    out_result.medianNs = percentile(m_sampleTimes, numSampled, 50);
+    out_result.p99Ns = percentile(m_sampleTimes, numSampled, 99);
+    out_result.medianCycles = Timer::cyclesSupported() ?
+                              percentile(m_sampleCycles, numSampled, 50) : -1;
+    addResult(out_result);
+    return true;
+  }
+
+  // Returns the median of the given test in the baseline, or -1.
+  double baseline(const char *in_name) const {
+    for (int i = 0; i < m_numBaseline; ++i) {
+      if (strcmp(m_baseline[i].name, in_name) == 0) {
+        return m_baseline[i].medianNs;
+      }
+    }
+    return -1;
+  }
+
+  // Returns true if the given result is slower than its baseline by more
+  // than the threshold, and its baseline median in out_baselineNs.
+  bool isRegression(const BenchmarkResult &in_result, double &out_baselineNs) const {
+    out_baselineNs = baseline(in_result.name);
+    return out_baselineNs > 0 &&
+           in_result.medianNs > out_baselineNs * (1 + m_threshold / 100);
+  }
+
+  // Loads a baseline, i.e. a file written by writeJson(). Only the name and
+  // the median of each result are used.
+  bool loadBaseline(const char *in_file) {
+    FILE *file = fopen(in_file, "r");
+    if (file == 0) {
+      return false;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), file) != 0) {
+      const char *name = strstr(line, "\"name\": \"");
+      const char *median = strstr(line, "\"median_ns\": ");
+      if (name == 0 || median == 0) {
+        continue;
+      }
+      name += 9;
+      const char *nameEnd = strchr(name, '"');
+      if (nameEnd == 0 || nameEnd - name >= (int)sizeof(m_baseline[0].name)) {
+        continue;
+      }
+      BenchmarkResult *result = (BenchmarkResult*)realloc(m_baseline, (m_numBaseline + 1) * sizeof(BenchmarkResult));
+      if (result == 0) {
+        break;
+      }
+      m_baseline = result;
+      result += m_numBaseline++;
+      memset(result, 0, sizeof(*result));
+      memcpy(result->name, name, nameEnd - name);
+      result->medianNs = strtod(median + 13, 0);
+    }
+    fclose(file);
+    return true;
+  }
+
+  // Writes all results as JSON, one result per line.
+  bool writeJson(const char *in_file) const {
+    FILE *file = fopen(in_file, "w");
+    if (file == 0) {
+      return false;
+    }
+    fprintf(file, "{\n  \"timer\": \"%s\",\n  \"results\": [\n",
+            Timer::cyclesSupported() ? "monotonic+cycles" : "monotonic");
+    for (int i = 0; i < m_numResults; ++i) {
+      const BenchmarkResult &r = m_results[i];
+      fprintf(file, "    {\"name\": \"%s\", \"iterations\": %d, \"samples\": %d, "
+                    "\"first_ns\": %.1f, \"warmup_ns\": %.1f, \"median_ns\": %.3f, "
+                    "\"p99_ns\": %.3f, \"median_cycles\": %.1f}%s\n",
+              r.name, r.iterations, r.samples, r.firstNs, r.warmupNs,
+              r.medianNs, r.p99Ns, r.medianCycles, (i + 1 < m_numResults) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+  }
+
+private:
+  void startSample() {
+    m_calls = 0;
+    m_sampleStart = Timer::nanoseconds();
+    m_sampleStartCycles = Timer::cycles();
+    if (m_numSampled == 0) {
+      m_samplingStart = m_sampleStart;
+    }
+  }
+
+  // Records the current sample, and returns true if another one is needed.
+  bool endSample() {
+    unsigned long long now = Timer::nanoseconds();
+    unsigned long long cycles = Timer::cycles();
+    m_sampleTimes[m_numSampled] = (double)(now - m_sampleStart) / m_iterations;
+    m_sampleCycles[m_numSampled] = (double)(cycles - m_sampleStartCycles) / m_iterations;
+    ++m_numSampled;
+    if (m_numSampled == m_samples ||
+        (m_numSampled >= kMinSamples && (double)(now - m_samplingStart) >= m_budgetNs)) {
+      m_state = IDLE;
+      return false;
+    }
+    startSample();
+    return true;
+  }
+
+  void addResult(const BenchmarkResult &in_result) {
+    if (m_numResults == m_maxResults) {
+      int maxResults = m_maxResults ? 2 * m_maxResults : 64;
+      BenchmarkResult *results = (BenchmarkResult*)realloc(m_results, maxResults * sizeof(BenchmarkResult));
+      if (results == 0) {
+        return;
+      }
+      m_results = results;
+      m_maxResults = maxResults;
+    }
+    m_results[m_numResults++] = in_result;
+  }
+
+  // Nearest-rank percentile of 'count' values, which are sorted in place.
+  static double percentile(double *values, int count, int percent) {
+    for (int i = 1; i < count; ++i) {
+      double value = values[i];
+      int j = i;
+      for (; j > 0 && values[j - 1] > value; --j) {
+        values[j] = values[j - 1];
+      }
+      values[j] = value;
+    }
+    if (percent == 50 && (count % 2) == 0) {
+      return (values[count / 2 - 1] + values[count / 2]) / 2;
+    }
+    int rank = (count * percent + 99) / 100;
+    return values[rank > 0 ? rank - 1 : 0];
+  }
+
+  int m_samples;
+  double m_warmupNs, m_sampleNs, m_budgetNs;
+  double m_threshold;
+
+  // State of the current test
+  State m_state;
+  int m_calls;
+  int m_iterations;
+  int m_numSampled;
+  unsigned long long m_start, m_samplingStart, m_sampleStart, m_sampleStartCycles;
+  double m_firstNs, m_warmupCallNs;
+  double m_sampleTimes[kMaxSamples];
+  double m_sampleCycles[kMaxSamples];
+
+  BenchmarkResult *m_results;
+  int m_numResults, m_maxResults;
+  BenchmarkResult *m_baseline;
+  int m_numBaseline;
+};
+
+#endif /* CPPUNIT_BENCH_H */
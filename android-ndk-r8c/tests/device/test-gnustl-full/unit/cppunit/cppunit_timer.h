@@ -13,12 +13,28 @@
  *
  */
 
+/*
+ * Modified for the Android NDK: added a clock_gettime(CLOCK_MONOTONIC)
+ * based timer for other platforms than Win32, and a cycle counter.
+ */
+
 #ifndef CPPUNIT_TIMER_H
 #define CPPUNIT_TIMER_H
 
 #if defined (_WIN32)
 #  define CPPUNIT_WIN32_TIMER
 #  include <windows.h>
+#elif defined (__linux__)
+/* Linux and Android */
+#  define CPPUNIT_POSIX_TIMER
+#  include <time.h>
+#endif
+
+/* The time stamp counter is the only cycle counter that is always
+ * readable from user mode.
+ */
+#if defined (__GNUC__) && (defined (__i386__) || defined (__x86_64__))
+#  define CPPUNIT_X86_CYCLES
 #endif
 
 class Timer {
@@ -28,12 +44,16 @@ public:
     m_start.LowPart = m_restart.LowPart = m_stop.LowPart = 0;
     m_start.HighPart = m_restart.HighPart = m_stop.HighPart = 0;
     QueryPerformanceFrequency(&m_frequency);
+#elif defined (CPPUNIT_POSIX_TIMER)
+    m_start = m_restart = m_stop = 0;
 #endif
   }
 
   void start() {
 #if defined (CPPUNIT_WIN32_TIMER)
     QueryPerformanceCounter(&m_start);
+#elif defined (CPPUNIT_POSIX_TIMER)
+    m_start = nanoseconds();
 #endif
   }
 
@@ -43,6 +63,11 @@ public:
     if (m_start.HighPart == 0 && m_start.LowPart == 0) {
       m_start = m_restart;
     }
+#elif defined (CPPUNIT_POSIX_TIMER)
+    m_restart = nanoseconds();
+    if (m_start == 0) {
+      m_start = m_restart;
+    }
 #endif
   }
 
@@ -69,6 +94,16 @@ public:
     else {
       m_stop = stop;
     }
+#elif defined (CPPUNIT_POSIX_TIMER)
+    // Same as above: after a restart, only the time since the restart is
+    // added to the elapsed time.
+    unsigned long long stop = nanoseconds();
+    if (m_stop != 0 && m_restart != 0) {
+      m_stop += stop - m_restart;
+    }
+    else {
+      m_stop = stop;
+    }
 #endif
   }
 
@@ -78,13 +113,51 @@ public:
     elapsed.HighPart = m_stop.HighPart - m_start.HighPart;
     elapsed.LowPart = m_stop.LowPart - m_start.LowPart;
     return (double)elapsed.QuadPart / (double)m_frequency.QuadPart * 1000;
+#elif defined (CPPUNIT_POSIX_TIMER)
+    return (double)(m_stop - m_start) / 1000000.0;
 #else
     return 0;
 #endif
   }
 
   static bool supported() {
+#if defined (CPPUNIT_WIN32_TIMER) || defined (CPPUNIT_POSIX_TIMER)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  // Current time of a monotonic clock, in nanoseconds, or 0 if the
+  // timer is not supported.
+  static unsigned long long nanoseconds() {
 #if defined (CPPUNIT_WIN32_TIMER)
+    LARGE_INTEGER frequency, now;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+    return (unsigned long long)((double)now.QuadPart / (double)frequency.QuadPart * 1e9);
+#elif defined (CPPUNIT_POSIX_TIMER)
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+#else
+    return 0;
+#endif
+  }
+
+  // Current value of the CPU cycle counter, or 0 if there is none.
+  static unsigned long long cycles() {
+#if defined (CPPUNIT_X86_CYCLES)
+    unsigned int lo, hi;
+    __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+    return ((unsigned long long)hi << 32) | lo;
+#else
+    return 0;
+#endif
+  }
+
+  static bool cyclesSupported() {
+#if defined (CPPUNIT_X86_CYCLES)
     return true;
 #else
     return false;
@@ -95,6 +168,8 @@ private:
 #if defined (CPPUNIT_WIN32_TIMER)
   LARGE_INTEGER m_frequency;
   LARGE_INTEGER m_start, m_stop, m_restart;
+#elif defined (CPPUNIT_POSIX_TIMER)
+  unsigned long long m_start, m_stop, m_restart;
 #endif
 };
 
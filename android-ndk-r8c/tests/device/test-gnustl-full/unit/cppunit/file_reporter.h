@@ -13,6 +13,10 @@
  *
  */
 
+/*
+ * Modified for the Android NDK: added a benchmark mode, see cppunit_bench.h.
+ */
+
 /* $Id$ */
 
 #ifndef _CPPUNITMINIFILEREPORTERINTERFACE_H_
@@ -21,6 +25,7 @@
 #include <stdio.h>
 
 #include "cppunit_timer.h"
+#include "cppunit_bench.h"
 
 //
 // CppUnit mini file(stream) reporter
@@ -95,6 +100,15 @@ public:
     }
   }
 
+  virtual void benchmark(const char * /*in_className*/, const char * /*in_testName*/, const BenchmarkResult &result) {
+    fprintf(_file, " median %.1f ns, p99 %.1f ns, warm-up %.1f ns, first %.1f ns (%d x %d)",
+            result.medianNs, result.p99Ns, result.warmupNs, result.firstNs,
+            result.samples, result.iterations);
+    if (result.medianCycles >= 0) {
+      fprintf(_file, ", %.0f cycles", result.medianCycles);
+    }
+  }
+
   virtual void end() {
     if (m_doMonitor) {
       m_globalTimer.stop();
@@ -11,7 +11,7 @@ class MoveConstructorTest : public CPPUNIT_NS::TestCase
   CPPUNIT_TEST(move_construct_test);
   CPPUNIT_TEST(deque_test);
   CPPUNIT_TEST(vector_test);
-  CPPUNIT_TEST(move_traits);
+  CPPUNIT_TEST_NO_BENCHMARK(move_traits);
 #if !defined (STLPORT) || defined (_STLP_NO_MOVE_SEMANTIC) || \
     defined (_STLP_DONT_SIMULATE_PARTIAL_SPEC_FOR_TYPE_TRAITS) || \
     (defined (__BORLANDC__) && (__BORLANDC__ < 0x564))
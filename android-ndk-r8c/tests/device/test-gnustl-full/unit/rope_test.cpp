@@ -37,7 +37,7 @@ class RopeTest : public CPPUNIT_NS::TestCase
 #if !defined (_STLP_MEMBER_TEMPLATES)
   CPPUNIT_IGNORE;
 #endif
-  CPPUNIT_TEST(test_saved_rope_iterators);
+  CPPUNIT_TEST_NO_BENCHMARK(test_saved_rope_iterators);
   CPPUNIT_TEST_SUITE_END();
 
 protected:
@@ -14,7 +14,7 @@ using namespace std;
 class UninitializedTest : public CPPUNIT_NS::TestCase
 {
   CPPUNIT_TEST_SUITE(UninitializedTest);
-  CPPUNIT_TEST(copy_test);
+  CPPUNIT_TEST_NO_BENCHMARK(copy_test);
   //CPPUNIT_TEST(fill_test);
   //CPPUNIT_TEST(fill_n_test);
   CPPUNIT_TEST_SUITE_END();
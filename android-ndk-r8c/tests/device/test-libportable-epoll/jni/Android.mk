@@ -0,0 +1,25 @@
+LOCAL_PATH := $(call my-dir)
+
+# libportable is not an NDK module: build its epoll wrappers for the
+# current ABI directly from the NDK sources. The host ABIs use the x86
+# ones, since glibc's struct epoll_event is packed too.
+libportable_path := $(NDK_ROOT)/sources/android/libportable
+libportable_arch := $(TARGET_ARCH)
+ifeq ($(TARGET_ARCH),host)
+    libportable_arch := x86
+endif
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := test_libportable_epoll
+LOCAL_SRC_FILES := test_libportable_epoll.c
+LOCAL_C_INCLUDES := $(libportable_path)/common/include
+LOCAL_STATIC_LIBRARIES := portable_epoll
+include $(BUILD_EXECUTABLE)
+
+LOCAL_PATH := $(libportable_path)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := portable_epoll
+LOCAL_SRC_FILES := arch-$(libportable_arch)/epoll.c
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/common/include
+include $(BUILD_STATIC_LIBRARY)
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Checks libportable's epoll_wait_portable() with many ready fds, and
+ * measures its cost per event with a socketpair fan-in: each of up to
+ * 10000 sockets has one byte pending, and all of them are collected with
+ * one call (max = count) or one call per event (max = 1).
+ */
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <epoll_portable.h>
+
+#define MAX_PAIRS  10000
+#define ROUNDS     20
+
+extern int epoll_ctl_portable(int epfd, int op, int fd, struct epoll_event_portable *event);
+extern int epoll_wait_portable(int epfd, struct epoll_event_portable *events, int max, int timeout);
+
+/* The high bits check that the 64-bit data is converted correctly. */
+#define MAKE_DATA(i)  (((uint64_t)0xa5a5a5a5 << 32) | (uint64_t)(i))
+
+static int failures = 0;
+
+#define CHECK(cond, ...) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "KO: " __VA_ARGS__); \
+            fprintf(stderr, "\n"); \
+            failures++; \
+        } \
+    } while (0)
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Each socketpair uses two fds, so raise the soft limit if needed. */
+static int get_pair_count(void)
+{
+    struct rlimit rl;
+    int count = MAX_PAIRS;
+
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+        if (rl.rlim_cur != RLIM_INFINITY && rl.rlim_cur < 2 * MAX_PAIRS + 16) {
+            rl.rlim_cur = rl.rlim_max;
+            if (rl.rlim_cur != RLIM_INFINITY && rl.rlim_cur > 2 * MAX_PAIRS + 16)
+                rl.rlim_cur = 2 * MAX_PAIRS + 16;
+            setrlimit(RLIMIT_NOFILE, &rl);
+            getrlimit(RLIMIT_NOFILE, &rl);
+        }
+        if (rl.rlim_cur != RLIM_INFINITY && rl.rlim_cur < 2 * MAX_PAIRS + 16)
+            count = ((int)rl.rlim_cur - 16) / 2;
+    }
+    return count;
+}
+
+int main(void)
+{
+    int count = get_pair_count();
+    int (*pairs)[2] = calloc(count, sizeof(*pairs));
+    struct epoll_event_portable *events = calloc(count + 1, sizeof(*events));
+    char *seen = calloc(count, 1);
+    struct epoll_event_portable ev;
+    double start, batched, single;
+    int epfd, i, n, round, ret;
+
+    if (pairs == NULL || events == NULL || seen == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    if (count < MAX_PAIRS)
+        printf("Using %d socket pairs (limited by RLIMIT_NOFILE)\n", count);
+
+    epfd = epoll_create(count);
+    if (epfd < 0) {
+        fprintf(stderr, "epoll_create: %s\n", strerror(errno));
+        return 1;
+    }
+    for (i = 0; i < count; i++) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, pairs[i]) < 0) {
+            fprintf(stderr, "socketpair #%d: %s\n", i, strerror(errno));
+            return 1;
+        }
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.u64 = MAKE_DATA(i);
+        if (epoll_ctl_portable(epfd, EPOLL_CTL_ADD, pairs[i][0], &ev) < 0) {
+            fprintf(stderr, "epoll_ctl_portable #%d: %s\n", i, strerror(errno));
+            return 1;
+        }
+        if (write(pairs[i][1], "x", 1) != 1) {
+            fprintf(stderr, "write #%d: %s\n", i, strerror(errno));
+            return 1;
+        }
+    }
+
+    /* All fds are ready: they must all be returned, and converted, at once.
+     * The extra entry must not be touched. */
+    memset(events, 0xff, (count + 1) * sizeof(*events));
+    ret = epoll_wait_portable(epfd, events, count, 0);
+    CHECK(ret == count, "epoll_wait_portable returned %d instead of %d", ret, count);
+    for (i = 0; i < ret; i++) {
+        uint64_t data = events[i].data.u64;
+        int index = (int)(uint32_t)data;
+        CHECK(events[i].events == EPOLLIN, "event #%d: events is 0x%x", i, events[i].events);
+        CHECK((data >> 32) == 0xa5a5a5a5 && index >= 0 && index < count && !seen[index],
+              "event #%d: bad data 0x%llx", i, (unsigned long long)data);
+        if (index >= 0 && index < count)
+            seen[index] = 1;
+    }
+    CHECK(events[count].events == 0xffffffff && events[count].data.u64 == ~(uint64_t)0,
+          "epoll_wait_portable wrote past the returned events");
+
+    /* A smaller array must not be overflowed either. */
+    memset(events, 0xff, 8 * sizeof(*events));
+    ret = epoll_wait_portable(epfd, events, 7, 0);
+    CHECK(ret == 7, "epoll_wait_portable(max=7) returned %d", ret);
+    CHECK(events[7].events == 0xffffffff && events[7].data.u64 == ~(uint64_t)0,
+          "epoll_wait_portable(max=7) wrote past the returned events");
+    for (i = 0; i < ret; i++)
+        CHECK((events[i].data.u64 >> 32) == 0xa5a5a5a5, "event #%d: bad data", i);
+
+    /* Fan-in benchmark: the fds stay ready (level-triggered), so each round
+     * collects 'count' events. */
+    start = now_ns();
+    for (round = 0; round < ROUNDS; round++)
+        epoll_wait_portable(epfd, events, count, 0);
+    batched = (now_ns() - start) / ((double)ROUNDS * count);
+
+    start = now_ns();
+    for (round = 0; round < ROUNDS; round++)
+        for (n = 0; n < count; n++)
+            epoll_wait_portable(epfd, events, 1, 0);
+    single = (now_ns() - start) / ((double)ROUNDS * count);
+
+    printf("%d fds, batched: %.1f ns/event, one per call: %.1f ns/event\n",
+           count, batched, single);
+
+    /* EPOLL_CTL_DEL accepts a NULL event. */
+    ret = epoll_ctl_portable(epfd, EPOLL_CTL_DEL, pairs[0][0], NULL);
+    CHECK(ret == 0, "epoll_ctl_portable(EPOLL_CTL_DEL, NULL): %s", strerror(errno));
+    ret = epoll_wait_portable(epfd, events, count, 0);
+    CHECK(ret == count - 1, "epoll_wait_portable returned %d after EPOLL_CTL_DEL", ret);
+
+    for (i = 0; i < count; i++) {
+        close(pairs[i][0]);
+        close(pairs[i][1]);
+    }
+    close(epfd);
+    free(seen);
+    free(events);
+    free(pairs);
+
+    if (failures != 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
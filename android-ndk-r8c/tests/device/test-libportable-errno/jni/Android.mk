@@ -0,0 +1,22 @@
+LOCAL_PATH := $(call my-dir)
+
+# libportable is not an NDK module: build its errno translation directly
+# from the NDK sources. include/cutils/log.h replaces the platform header
+# it needs.
+libportable_path := $(NDK_ROOT)/sources/android/libportable
+libportable_test_path := $(LOCAL_PATH)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := test_libportable_errno
+LOCAL_SRC_FILES := test_libportable_errno.c
+LOCAL_C_INCLUDES := $(libportable_path)/common/include
+LOCAL_STATIC_LIBRARIES := portable_errno
+include $(BUILD_EXECUTABLE)
+
+LOCAL_PATH := $(libportable_path)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := portable_errno
+LOCAL_SRC_FILES := arch-mips/errno.c
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/common/include $(libportable_test_path)/include
+include $(BUILD_STATIC_LIBRARY)
@@ -0,0 +1,2 @@
+# libportable only translates errno values on MIPS.
+APP_ABI := mips
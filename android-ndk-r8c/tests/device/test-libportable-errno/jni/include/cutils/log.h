@@ -0,0 +1,15 @@
+/* Minimal replacement for the platform's <cutils/log.h>, which is not part
+ * of the NDK, to build libportable sources in this test. Logging is
+ * disabled.
+ */
+#ifndef _CUTILS_LOG_H
+#define _CUTILS_LOG_H
+
+#define ALOGV(...)  ((void)0)
+#define ALOGD(...)  ((void)0)
+#define ALOGI(...)  ((void)0)
+#define ALOGW(...)  ((void)0)
+#define ALOGE(...)  ((void)0)
+#define ALOG_ASSERT(...)  ((void)0)
+
+#endif /* _CUTILS_LOG_H */
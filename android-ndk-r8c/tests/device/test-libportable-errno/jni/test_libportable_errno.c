@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Checks libportable's errno translation, and measures its cost in a
+ * non-blocking read loop, where every read() fails with EAGAIN and the
+ * caller checks the portable errno, as networking code compiled against
+ * libportable does.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <errno_portable.h>
+
+#define ITERATIONS  200000
+
+extern volatile int* __errno_portable(void);
+extern void __set_errno_portable(int portable_errno);
+
+static int failures = 0;
+
+#define CHECK(cond, ...) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "KO: " __VA_ARGS__); \
+            fprintf(stderr, "\n"); \
+            failures++; \
+        } \
+    } while (0)
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void check_translation(void)
+{
+    static const struct {
+        int native;
+        int portable;
+    } values[] = {
+        { ENOENT, ENOENT },             /* same value on all ABIs */
+        { EAGAIN, EWOULDBLOCK_PORTABLE },
+        { ENAMETOOLONG, ENAMETOOLONG_PORTABLE },
+        { ENOSYS, ENOSYS_PORTABLE },
+        { ETIMEDOUT, ETIMEDOUT_PORTABLE },
+        { ENOTRECOVERABLE, ENOTRECOVERABLE_PORTABLE },
+        { EDQUOT, EDQUOT_PORTABLE },
+    };
+    unsigned i;
+
+    for (i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        int portable;
+
+        errno = values[i].native;
+        portable = *__errno_portable();
+        CHECK(portable == values[i].portable,
+              "native errno %d read as %d instead of %d",
+              values[i].native, portable, values[i].portable);
+
+        __set_errno_portable(values[i].portable);
+        CHECK(errno == values[i].native,
+              "portable errno %d set as %d instead of %d",
+              values[i].portable, errno, values[i].native);
+    }
+
+    /* An assignment to the portable errno is seen as the native errno. */
+    errno = 0;
+    *__errno_portable() = ENAMETOOLONG_PORTABLE;
+    CHECK(*__errno_portable() == ENAMETOOLONG_PORTABLE && errno == ENAMETOOLONG,
+          "assigned portable errno not propagated (errno=%d)", errno);
+}
+
+static void* thread_check(void* arg)
+{
+    /* Each thread has its own portable errno. */
+    CHECK(*__errno_portable() == 0, "new thread has portable errno %d",
+          *__errno_portable());
+    errno = ETIMEDOUT;
+    return (void*)(long)*__errno_portable();
+}
+
+int main(void)
+{
+    pthread_t thread;
+    void* result;
+    char buf[16];
+    int fds[2], i, portable = 0;
+    double start, native_time, portable_time;
+
+    check_translation();
+
+    if (pthread_create(&thread, NULL, thread_check, NULL) == 0) {
+        pthread_join(thread, &result);
+        CHECK((long)result == ETIMEDOUT_PORTABLE, "thread read %ld", (long)result);
+    }
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0 ||
+        fcntl(fds[0], F_SETFL, O_NONBLOCK) < 0) {
+        perror("socketpair");
+        return 1;
+    }
+
+    /* Reference: the same loop with the native errno. */
+    start = now_ns();
+    for (i = 0; i < ITERATIONS; i++) {
+        if (read(fds[0], buf, sizeof(buf)) >= 0 || errno != EAGAIN)
+            break;
+    }
+    native_time = (now_ns() - start) / ITERATIONS;
+    CHECK(i == ITERATIONS, "read() did not fail with EAGAIN (errno=%d)", errno);
+
+    start = now_ns();
+    for (i = 0; i < ITERATIONS; i++) {
+        if (read(fds[0], buf, sizeof(buf)) >= 0)
+            break;
+        portable = *__errno_portable();
+        if (portable != EWOULDBLOCK_PORTABLE)
+            break;
+    }
+    portable_time = (now_ns() - start) / ITERATIONS;
+    CHECK(i == ITERATIONS, "portable errno is %d instead of EWOULDBLOCK_PORTABLE", portable);
+
+    printf("non-blocking read: %.1f ns with native errno, %.1f ns with portable errno\n",
+           native_time, portable_time);
+
+    close(fds[0]);
+    close(fds[1]);
+
+    if (failures != 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
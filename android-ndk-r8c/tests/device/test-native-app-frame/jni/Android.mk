@@ -0,0 +1,12 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := test_native_app_frame
+LOCAL_SRC_FILES := test_native_app_frame.c
+LOCAL_STATIC_LIBRARIES := android_native_app_frame
+ifeq ($(TARGET_ARCH),host)
+    LOCAL_LDLIBS := -lpthread
+endif
+include $(BUILD_EXECUTABLE)
+
+$(call import-module,android/native_app_frame)
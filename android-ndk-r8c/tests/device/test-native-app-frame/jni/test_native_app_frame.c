@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Headless driver for native_app_frame, without any window or looper.
+ *
+ * The frame scheduler is run with simulated frames, some of which are
+ * made late on purpose, and its statistics are checked. The job system
+ * is checked with a parallel sum, nested jobs and many small jobs, then
+ * a particle update is timed with no worker and with one worker per
+ * additional CPU core.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "android_native_app_frame.h"
+
+#define FRAME_NS        (10 * 1000000LL)
+#define FRAMES          60
+#define PARTICLES       (256 * 1024)
+#define PARTICLE_GRAIN  4096
+
+static int failures = 0;
+
+#define CHECK(cond, ...) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "KO: " __VA_ARGS__); \
+            fprintf(stderr, "\n"); \
+            failures++; \
+        } \
+    } while (0)
+
+static void sleep_ns(int64_t ns)
+{
+    struct timespec ts;
+    ts.tv_sec = ns / 1000000000LL;
+    ts.tv_nsec = ns % 1000000000LL;
+    while (nanosleep(&ts, &ts) != 0)
+        ;
+}
+
+/* Busy work, like rendering would be. */
+static void work_ns(int64_t ns)
+{
+    int64_t end = android_frame_now_ns() + ns;
+    while (android_frame_now_ns() < end)
+        ;
+}
+
+static void test_frame_scheduler(void)
+{
+    struct android_frame_scheduler frames;
+    int64_t start, slot;
+    int late = 0, early = 0;
+    int i;
+
+    android_frame_init(&frames, FRAME_NS);
+    start = android_frame_now_ns();
+    for (i = 0; i < FRAMES; i++) {
+        /* What ALooper_pollAll() would do with this timeout. */
+        sleep_ns(android_frame_poll_timeout(&frames) * 1000000LL);
+
+        android_frame_begin(&frames);
+        slot = frames.nextFrameNs - frames.targetFrameNs;
+        if (frames.frameStartNs < slot)
+            early++;
+        if (i == 20)
+            work_ns(FRAME_NS * 3 + FRAME_NS / 2);   /* misses 2 slots */
+        else if (i % 10 == 5)
+            work_ns(FRAME_NS * 3 / 2);              /* late */
+        else
+            work_ns(FRAME_NS / 5);
+        late += android_frame_end(&frames);
+    }
+
+    CHECK(frames.stats.frames == FRAMES, "%u frames instead of %d",
+          frames.stats.frames, FRAMES);
+    CHECK(early == 0, "%d frames started before their slot", early);
+    CHECK(late == (int)frames.stats.lateFrames, "late frames: %d returned, %u counted",
+          late, frames.stats.lateFrames);
+    /* Frames 5, 15, 20, 25, ..., 55. Scheduling delays can only add more. */
+    CHECK(frames.stats.lateFrames >= 6, "only %u late frames", frames.stats.lateFrames);
+    CHECK(frames.stats.skippedFrames >= 2, "only %u skipped frames",
+          frames.stats.skippedFrames);
+    CHECK(frames.stats.minFrameNs >= FRAME_NS / 5, "min frame time %lld ns",
+          (long long)frames.stats.minFrameNs);
+    CHECK(frames.stats.maxFrameNs >= FRAME_NS * 3, "max frame time %lld ns",
+          (long long)frames.stats.maxFrameNs);
+
+    printf("Frame scheduler: %u frames in %.1f ms, %u late, %u skipped, "
+           "frame time min %.2f avg %.2f max %.2f ms\n",
+           frames.stats.frames, (android_frame_now_ns() - start) / 1e6,
+           frames.stats.lateFrames, frames.stats.skippedFrames,
+           frames.stats.minFrameNs / 1e6,
+           frames.stats.totalFrameNs / 1e6 / frames.stats.frames,
+           frames.stats.maxFrameNs / 1e6);
+
+    android_frame_reset_stats(&frames);
+    CHECK(frames.stats.frames == 0 && frames.stats.maxFrameNs == 0, "stats not reset");
+}
+
+/* Parallel sum, with one slot per range to avoid any atomic. */
+struct sum_args {
+    const int* values;
+    long long* sums;
+    int grain;
+};
+
+static void sum_range(void* arg, int begin, int end)
+{
+    struct sum_args* args = arg;
+    long long sum = 0;
+    int i;
+    for (i = begin; i < end; i++)
+        sum += args->values[i];
+    args->sums[begin / args->grain] = sum;
+}
+
+static void test_parallel_sum(struct android_jobs* jobs)
+{
+    enum { COUNT = 1000003, GRAIN = 1000 };
+    struct sum_args args;
+    long long expected = 0, sum = 0;
+    int ranges = (COUNT + GRAIN - 1) / GRAIN;
+    int i;
+
+    args.values = malloc(COUNT * sizeof(int));
+    args.sums = calloc(ranges, sizeof(long long));
+    args.grain = GRAIN;
+    for (i = 0; i < COUNT; i++) {
+        ((int*)args.values)[i] = i % 1000 - 300;
+        expected += args.values[i];
+    }
+    android_jobs_parallel_for(jobs, COUNT, GRAIN, sum_range, &args);
+    for (i = 0; i < ranges; i++)
+        sum += args.sums[i];
+    CHECK(sum == expected, "parallel sum is %lld instead of %lld", sum, expected);
+    free((int*)args.values);
+    free(args.sums);
+}
+
+/* A binary tree of jobs, each waiting for its children from a job. */
+struct tree_node {
+    struct android_jobs* jobs;
+    int depth;
+    int leaves;
+};
+
+static void tree_job(void* arg)
+{
+    struct tree_node* node = arg;
+    struct android_job_group group = ANDROID_JOB_GROUP_INIT;
+    struct tree_node children[2];
+    int i;
+
+    if (node->depth == 0) {
+        node->leaves = 1;
+        return;
+    }
+    for (i = 0; i < 2; i++) {
+        children[i].jobs = node->jobs;
+        children[i].depth = node->depth - 1;
+        children[i].leaves = 0;
+        android_jobs_submit(node->jobs, &group, tree_job, &children[i]);
+    }
+    android_jobs_wait(node->jobs, &group);
+    node->leaves = children[0].leaves + children[1].leaves;
+}
+
+static void test_nested_jobs(struct android_jobs* jobs)
+{
+    struct android_job_group group = ANDROID_JOB_GROUP_INIT;
+    struct tree_node root = { jobs, 12, 0 };
+
+    android_jobs_submit(jobs, &group, tree_job, &root);
+    android_jobs_wait(jobs, &group);
+    CHECK(root.leaves == 1 << 12, "%d leaves instead of %d", root.leaves, 1 << 12);
+}
+
+static volatile int small_job_count;
+
+static void small_job(void* arg)
+{
+    (void)arg;
+    __sync_fetch_and_add(&small_job_count, 1);
+}
+
+static void test_small_jobs(struct android_jobs* jobs)
+{
+    enum { COUNT = 100000 };
+    struct android_job_group group = ANDROID_JOB_GROUP_INIT;
+    int i;
+
+    small_job_count = 0;
+    for (i = 0; i < COUNT; i++)
+        android_jobs_submit(jobs, &group, small_job, NULL);
+    android_jobs_wait(jobs, &group);
+    CHECK(small_job_count == COUNT, "%d small jobs run instead of %d",
+          small_job_count, COUNT);
+    CHECK(group.pending == 0, "%d jobs still pending", group.pending);
+}
+
+/* A typical per-frame workload: integrate and bounce particles. */
+struct particle {
+    float x, y, vx, vy;
+};
+
+static void update_particles(void* arg, int begin, int end)
+{
+    struct particle* p = arg;
+    int i;
+    for (i = begin; i < end; i++) {
+        p[i].vy -= 9.81f * 0.016f;
+        p[i].x += p[i].vx * 0.016f;
+        p[i].y += p[i].vy * 0.016f;
+        if (p[i].y < 0) {
+            p[i].y = -p[i].y;
+            p[i].vy = -p[i].vy * 0.9f;
+        }
+        p[i].vx *= 0.999f + 0.001f * sinf(p[i].x);
+    }
+}
+
+static double time_particles(struct android_jobs* jobs, struct particle* particles)
+{
+    int64_t start;
+    int i;
+
+    for (i = 0; i < PARTICLES; i++) {
+        particles[i].x = (float)(i % 640);
+        particles[i].y = (float)(i % 480);
+        particles[i].vx = (float)(i % 7) - 3;
+        particles[i].vy = (float)(i % 5);
+    }
+    start = android_frame_now_ns();
+    for (i = 0; i < FRAMES; i++)
+        android_jobs_parallel_for(jobs, PARTICLES, PARTICLE_GRAIN,
+                                  update_particles, particles);
+    return (android_frame_now_ns() - start) / 1e6 / FRAMES;
+}
+
+int main(void)
+{
+    struct particle* serial = malloc(PARTICLES * sizeof(struct particle));
+    struct particle* parallel = malloc(PARTICLES * sizeof(struct particle));
+    struct android_jobs* none;
+    struct android_jobs* jobs;
+    double serial_ms, parallel_ms;
+
+    test_frame_scheduler();
+
+    none = android_jobs_create(0);
+    jobs = android_jobs_create(-1);
+    CHECK(none != NULL && jobs != NULL, "could not create the job systems");
+    if (none == NULL || jobs == NULL)
+        return 1;
+    CHECK(android_jobs_worker_count(none) == 0, "%d workers instead of 0",
+          android_jobs_worker_count(none));
+
+    test_parallel_sum(none);
+    test_parallel_sum(jobs);
+    test_nested_jobs(none);
+    test_nested_jobs(jobs);
+    test_small_jobs(none);
+    test_small_jobs(jobs);
+
+    serial_ms = time_particles(none, serial);
+    parallel_ms = time_particles(jobs, parallel);
+    CHECK(memcmp(serial, parallel, PARTICLES * sizeof(struct particle)) == 0,
+          "parallel particle update differs");
+    printf("Particle update (%d particles): %.2f ms with no worker, "
+           "%.2f ms with %d workers\n", PARTICLES, serial_ms, parallel_ms,
+           android_jobs_worker_count(jobs));
+
+    android_jobs_destroy(none);
+    android_jobs_destroy(jobs);
+    free(serial);
+    free(parallel);
+
+    if (failures != 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,42 @@
+LOCAL_PATH := $(call my-dir)
+
+# These tests build native_app_glue against mock_android.c, a stand-in for
+# the AInputQueue, ALooper, AConfiguration and log functions of the
+# platform, instead of linking to libandroid.so. This lets it run on the
+# host ABIs too, where the Android headers are taken from the x86 platform
+# files, after the host's system headers.
+native_app_glue_path := $(NDK_ROOT)/sources/android/native_app_glue
+native_app_glue_cflags :=
+ifeq ($(TARGET_ARCH),host)
+    native_app_glue_cflags += -idirafter $(NDK_PLATFORMS_ROOT)/android-9/arch-x86/usr/include
+endif
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := test_native_app_glue_input
+LOCAL_SRC_FILES := test_native_app_glue_input.c mock_android.c
+LOCAL_CFLAGS := $(native_app_glue_cflags)
+LOCAL_C_INCLUDES := $(native_app_glue_path)
+LOCAL_STATIC_LIBRARIES := native_app_glue_mocked
+ifeq ($(TARGET_ARCH),host)
+    LOCAL_LDLIBS := -lpthread
+endif
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := test_native_app_glue_cmd
+LOCAL_SRC_FILES := test_native_app_glue_cmd.c mock_android.c
+LOCAL_CFLAGS := $(native_app_glue_cflags)
+LOCAL_C_INCLUDES := $(native_app_glue_path)
+LOCAL_STATIC_LIBRARIES := native_app_glue_mocked
+ifeq ($(TARGET_ARCH),host)
+    LOCAL_LDLIBS := -lpthread
+endif
+include $(BUILD_EXECUTABLE)
+
+LOCAL_PATH := $(native_app_glue_path)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := native_app_glue_mocked
+LOCAL_SRC_FILES := android_native_app_glue.c
+LOCAL_CFLAGS := $(native_app_glue_cflags)
+include $(BUILD_STATIC_LIBRARY)
@@ -0,0 +1,358 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Minimal implementations of the platform functions used by
+ * native_app_glue, see mock_android.h. */
+#include <poll.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <android/configuration.h>
+#include <android/log.h>
+#include <android/looper.h>
+
+#include "android_native_app_glue.h"
+#include "mock_android.h"
+
+#define MAX_QUEUED_EVENTS  4096
+#define MAX_LOOPER_FDS     8
+
+/* ALooper */
+
+struct ALooper {
+    int count;
+    struct {
+        int fd;
+        int ident;
+        void* data;
+    } fds[MAX_LOOPER_FDS];
+};
+
+/* Like the real ones, loopers are per-thread. */
+static pthread_key_t looper_key;
+static pthread_once_t looper_key_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t looper_lock = PTHREAD_MUTEX_INITIALIZER;
+static int input_wakeups;
+
+static void looper_key_create(void)
+{
+    pthread_key_create(&looper_key, free);
+}
+
+static ALooper* looper_for_thread(void)
+{
+    pthread_once(&looper_key_once, looper_key_create);
+    return (ALooper*)pthread_getspecific(looper_key);
+}
+
+ALooper* ALooper_prepare(int opts)
+{
+    ALooper* looper = looper_for_thread();
+    if (looper == NULL) {
+        looper = calloc(1, sizeof(*looper));
+        pthread_setspecific(looper_key, looper);
+    }
+    return looper;
+}
+
+int ALooper_addFd(ALooper* looper, int fd, int ident, int events,
+        ALooper_callbackFunc callback, void* data)
+{
+    pthread_mutex_lock(&looper_lock);
+    if (looper->count == MAX_LOOPER_FDS) {
+        pthread_mutex_unlock(&looper_lock);
+        return -1;
+    }
+    looper->fds[looper->count].fd = fd;
+    looper->fds[looper->count].ident = ident;
+    looper->fds[looper->count].data = data;
+    looper->count++;
+    pthread_mutex_unlock(&looper_lock);
+    return 1;
+}
+
+static void looper_remove_fd(ALooper* looper, int fd)
+{
+    int i;
+    pthread_mutex_lock(&looper_lock);
+    for (i = 0; i < looper->count; i++) {
+        if (looper->fds[i].fd == fd) {
+            looper->fds[i] = looper->fds[--looper->count];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&looper_lock);
+}
+
+int ALooper_pollAll(int timeoutMillis, int* outFd, int* outEvents, void** outData)
+{
+    ALooper* looper = looper_for_thread();
+    struct pollfd pfds[MAX_LOOPER_FDS];
+    int idents[MAX_LOOPER_FDS];
+    void* datas[MAX_LOOPER_FDS];
+    int count, i;
+
+    if (looper == NULL)
+        return ALOOPER_POLL_ERROR;
+    pthread_mutex_lock(&looper_lock);
+    count = looper->count;
+    for (i = 0; i < count; i++) {
+        pfds[i].fd = looper->fds[i].fd;
+        pfds[i].events = POLLIN;
+        pfds[i].revents = 0;
+        idents[i] = looper->fds[i].ident;
+        datas[i] = looper->fds[i].data;
+    }
+    pthread_mutex_unlock(&looper_lock);
+
+    if (poll(pfds, count, timeoutMillis) <= 0)
+        return ALOOPER_POLL_TIMEOUT;
+    for (i = 0; i < count; i++) {
+        if (pfds[i].revents != 0) {
+            if (outFd != NULL) *outFd = pfds[i].fd;
+            if (outEvents != NULL) *outEvents = ALOOPER_EVENT_INPUT;
+            if (outData != NULL) *outData = datas[i];
+            if (idents[i] == LOOPER_ID_INPUT)
+                __sync_fetch_and_add(&input_wakeups, 1);
+            return idents[i];
+        }
+    }
+    return ALOOPER_POLL_TIMEOUT;
+}
+
+int mock_looper_input_wakeups(void)
+{
+    return __sync_fetch_and_add(&input_wakeups, 0);
+}
+
+/* AInputQueue */
+
+struct AInputQueue {
+    int fds[2];
+    pthread_mutex_t lock;
+    pthread_cond_t finished_cond;
+    AInputEvent* events[MAX_QUEUED_EVENTS];
+    int head;
+    int count;
+    int finished;
+    ALooper* looper;
+};
+
+AInputQueue* mock_input_queue_new(void)
+{
+    AInputQueue* queue = calloc(1, sizeof(*queue));
+    if (queue == NULL || pipe(queue->fds) != 0) {
+        perror("mock_input_queue_new");
+        exit(1);
+    }
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->finished_cond, NULL);
+    return queue;
+}
+
+void mock_input_queue_delete(AInputQueue* queue)
+{
+    close(queue->fds[0]);
+    close(queue->fds[1]);
+    pthread_cond_destroy(&queue->finished_cond);
+    pthread_mutex_destroy(&queue->lock);
+    free(queue);
+}
+
+void mock_input_queue_push(AInputQueue* queue, AInputEvent* events, int count)
+{
+    char bytes[MAX_QUEUED_EVENTS];
+    int i;
+
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count + count > MAX_QUEUED_EVENTS) {
+        fprintf(stderr, "mock_input_queue_push: queue full\n");
+        exit(1);
+    }
+    for (i = 0; i < count; i++) {
+        events[i].handled = -1;
+        queue->events[(queue->head + queue->count++) % MAX_QUEUED_EVENTS] = &events[i];
+    }
+    /* One byte per event, like one message per event on the real channel. */
+    memset(bytes, 0, count);
+    if (write(queue->fds[1], bytes, count) != count) {
+        perror("mock_input_queue_push");
+        exit(1);
+    }
+    pthread_mutex_unlock(&queue->lock);
+}
+
+void mock_input_queue_wait_finished(AInputQueue* queue, int count)
+{
+    pthread_mutex_lock(&queue->lock);
+    while (queue->finished < count)
+        pthread_cond_wait(&queue->finished_cond, &queue->lock);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+void AInputQueue_attachLooper(AInputQueue* queue, ALooper* looper,
+        int ident, ALooper_callbackFunc callback, void* data)
+{
+    queue->looper = looper;
+    ALooper_addFd(looper, queue->fds[0], ident, ALOOPER_EVENT_INPUT, callback, data);
+}
+
+void AInputQueue_detachLooper(AInputQueue* queue)
+{
+    if (queue->looper != NULL) {
+        looper_remove_fd(queue->looper, queue->fds[0]);
+        queue->looper = NULL;
+    }
+}
+
+int32_t AInputQueue_hasEvents(AInputQueue* queue)
+{
+    int32_t result;
+    pthread_mutex_lock(&queue->lock);
+    result = queue->count > 0;
+    pthread_mutex_unlock(&queue->lock);
+    return result;
+}
+
+int32_t AInputQueue_getEvent(AInputQueue* queue, AInputEvent** outEvent)
+{
+    char byte;
+
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count == 0) {
+        pthread_mutex_unlock(&queue->lock);
+        return -1;
+    }
+    if (read(queue->fds[0], &byte, 1) != 1) {
+        pthread_mutex_unlock(&queue->lock);
+        return -1;
+    }
+    *outEvent = queue->events[queue->head];
+    queue->head = (queue->head + 1) % MAX_QUEUED_EVENTS;
+    queue->count--;
+    pthread_mutex_unlock(&queue->lock);
+    return 0;
+}
+
+int32_t AInputQueue_preDispatchEvent(AInputQueue* queue, AInputEvent* event)
+{
+    return 0;
+}
+
+void AInputQueue_finishEvent(AInputQueue* queue, AInputEvent* event, int handled)
+{
+    pthread_mutex_lock(&queue->lock);
+    event->handled = handled;
+    queue->finished++;
+    pthread_cond_broadcast(&queue->finished_cond);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+/* AInputEvent */
+
+int32_t AInputEvent_getType(const AInputEvent* event)
+{
+    return event->type;
+}
+
+int32_t AInputEvent_getDeviceId(const AInputEvent* event)
+{
+    return event->deviceId;
+}
+
+int32_t AInputEvent_getSource(const AInputEvent* event)
+{
+    return event->source;
+}
+
+int32_t AMotionEvent_getAction(const AInputEvent* motion_event)
+{
+    return motion_event->action;
+}
+
+size_t AMotionEvent_getHistorySize(const AInputEvent* motion_event)
+{
+    return motion_event->historySize;
+}
+
+/* AConfiguration: only what native_app_glue prints. */
+
+struct AConfiguration {
+    int unused;
+};
+
+AConfiguration* AConfiguration_new()
+{
+    return calloc(1, sizeof(AConfiguration));
+}
+
+void AConfiguration_delete(AConfiguration* config)
+{
+    free(config);
+}
+
+void AConfiguration_fromAssetManager(AConfiguration* out, AAssetManager* am)
+{
+}
+
+void AConfiguration_getLanguage(AConfiguration* config, char* outLanguage)
+{
+    outLanguage[0] = 'e';
+    outLanguage[1] = 'n';
+}
+
+void AConfiguration_getCountry(AConfiguration* config, char* outCountry)
+{
+    outCountry[0] = 'U';
+    outCountry[1] = 'S';
+}
+
+#define MOCK_CONFIGURATION_GETTER(name) \
+    int32_t AConfiguration_get##name(AConfiguration* config) { return 0; }
+
+MOCK_CONFIGURATION_GETTER(Mcc)
+MOCK_CONFIGURATION_GETTER(Mnc)
+MOCK_CONFIGURATION_GETTER(Orientation)
+MOCK_CONFIGURATION_GETTER(Touchscreen)
+MOCK_CONFIGURATION_GETTER(Density)
+MOCK_CONFIGURATION_GETTER(Keyboard)
+MOCK_CONFIGURATION_GETTER(Navigation)
+MOCK_CONFIGURATION_GETTER(KeysHidden)
+MOCK_CONFIGURATION_GETTER(NavHidden)
+MOCK_CONFIGURATION_GETTER(SdkVersion)
+MOCK_CONFIGURATION_GETTER(ScreenSize)
+MOCK_CONFIGURATION_GETTER(ScreenLong)
+MOCK_CONFIGURATION_GETTER(UiModeType)
+MOCK_CONFIGURATION_GETTER(UiModeNight)
+
+/* Log: only errors are printed. */
+
+int __android_log_print(int prio, const char *tag, const char *fmt, ...)
+{
+    va_list args;
+    if (prio < ANDROID_LOG_ERROR)
+        return 0;
+    va_start(args, fmt);
+    fprintf(stderr, "%s: ", tag);
+    vfprintf(stderr, fmt, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+    return 0;
+}
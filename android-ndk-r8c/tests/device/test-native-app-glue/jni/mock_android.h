@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MOCK_ANDROID_H
+#define MOCK_ANDROID_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <android/input.h>
+
+/* The mock AInputEvent. 'seq' is the order in which the events were
+ * queued, 'handled' is set to the value given to AInputQueue_finishEvent(),
+ * or -1 while the event is not finished. */
+struct AInputEvent {
+    int32_t type;
+    int32_t action;
+    int32_t deviceId;
+    int32_t source;
+    size_t  historySize;
+    int     seq;
+    int     handled;
+};
+
+/* Create an AInputQueue. Like the real one, it is backed by a file
+ * descriptor that is readable while events are pending, and each
+ * AInputQueue_getEvent() call reads from it. */
+AInputQueue* mock_input_queue_new(void);
+void mock_input_queue_delete(AInputQueue* queue);
+
+/* Queue 'count' events at once, as if they had been received during a
+ * frame. */
+void mock_input_queue_push(AInputQueue* queue, AInputEvent* events, int count);
+
+/* Wait until 'count' events have been finished since the queue creation. */
+void mock_input_queue_wait_finished(AInputQueue* queue, int count);
+
+/* Number of times ALooper_pollAll() returned the ident of an input queue. */
+int mock_looper_input_wakeups(void);
+
+#endif /* MOCK_ANDROID_H */
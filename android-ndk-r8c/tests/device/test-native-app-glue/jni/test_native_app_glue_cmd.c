@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Checks the lifecycle commands of native_app_glue, and measures how long
+ * each ANativeActivity callback blocks the main (UI) thread.
+ *
+ * The real glue code runs android_main() in its own thread, against the
+ * mock ALooper of mock_android.c. Like a game, android_main() draws
+ * frames of FRAME_MS milliseconds continuously while it has a window, and
+ * only processes commands between frames. A callback that waits for the
+ * app thread can thus block the main thread for up to a frame.
+ *
+ * The main thread repeatedly simulates a resize (the soft keyboard being
+ * shown) and a rotation (the activity being destroyed and re-created).
+ * Before each resize, it also sends more onLowMemory commands than the
+ * command ring holds, so that it has to wait for free slots.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "android_native_app_glue.h"
+#include "mock_android.h"
+
+#define ROUNDS    20
+#define FRAME_MS  4
+#define FLOOD     (4 * ANDROID_APP_CMD_RING_SIZE)
+
+static int failures = 0;
+
+#define CHECK(cond, ...) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "KO: " __VA_ARGS__); \
+            fprintf(stderr, "\n"); \
+            failures++; \
+        } \
+    } while (0)
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* The windows are never dereferenced by the glue code. */
+#define WINDOW(n)  ((ANativeWindow*)(long)(0x1000 * (n)))
+
+/* State of the app thread, checked by the main thread. */
+static pthread_mutex_t app_lock = PTHREAD_MUTEX_INITIALIZER;
+static ANativeWindow* app_window;
+static ARect app_content_rect;
+static int app_restored;
+static int app_redraws;
+static int app_low_memory;
+static int app_bad_order;
+static int app_frames_without_window;
+
+static void on_app_cmd(struct android_app* app, int32_t cmd)
+{
+    pthread_mutex_lock(&app_lock);
+    switch (cmd) {
+    case APP_CMD_INIT_WINDOW:
+        if (app_window != NULL)
+            app_bad_order++;
+        app_window = app->window;
+        break;
+    case APP_CMD_TERM_WINDOW:
+        if (app_window != app->window)
+            app_bad_order++;
+        app_window = NULL;
+        break;
+    case APP_CMD_WINDOW_REDRAW_NEEDED:
+        app_redraws++;
+        break;
+    case APP_CMD_LOW_MEMORY:
+        app_low_memory++;
+        break;
+    case APP_CMD_CONTENT_RECT_CHANGED:
+        app_content_rect = app->contentRect;
+        break;
+    case APP_CMD_SAVE_STATE:
+        app->savedState = malloc(sizeof(int));
+        *(int*)app->savedState = 42;
+        app->savedStateSize = sizeof(int);
+        break;
+    }
+    pthread_mutex_unlock(&app_lock);
+}
+
+static void draw_frame(struct android_app* app)
+{
+    struct timespec ts = { 0, FRAME_MS * 1000000 };
+    if (app->window == NULL)
+        app_frames_without_window++;
+    nanosleep(&ts, NULL);
+}
+
+void android_main(struct android_app* app)
+{
+    app_dummy();
+
+    app->onAppCmd = on_app_cmd;
+    if (app->savedState != NULL && app->savedStateSize == sizeof(int) &&
+        *(int*)app->savedState == 42) {
+        pthread_mutex_lock(&app_lock);
+        app_restored++;
+        pthread_mutex_unlock(&app_lock);
+    }
+
+    for (;;) {
+        struct android_poll_source* source;
+        int events;
+        int animating = app->window != NULL && app->activityState == APP_CMD_RESUME;
+
+        while (ALooper_pollAll(animating ? 0 : -1, NULL, &events, (void**)&source) >= 0) {
+            if (source != NULL)
+                source->process(app, source);
+            if (app->destroyRequested)
+                return;
+            animating = app->window != NULL && app->activityState == APP_CMD_RESUME;
+        }
+        if (animating)
+            draw_frame(app);
+    }
+}
+
+/* Time spent in each callback by the main thread. */
+enum {
+    T_CREATE, T_START, T_RESUME, T_WINDOW_CREATED, T_INPUT_CREATED,
+    T_FOCUS, T_CONTENT_RECT, T_RESIZED, T_REDRAW, T_PAUSE, T_SAVE,
+    T_STOP, T_WINDOW_DESTROYED, T_INPUT_DESTROYED, T_DESTROY, T_COUNT
+};
+
+static const char* const timer_names[T_COUNT] = {
+    "onCreate", "onStart", "onResume", "onNativeWindowCreated",
+    "onInputQueueCreated", "onWindowFocusChanged", "onContentRectChanged",
+    "onNativeWindowResized", "onNativeWindowRedrawNeeded", "onPause",
+    "onSaveInstanceState", "onStop", "onNativeWindowDestroyed",
+    "onInputQueueDestroyed", "onDestroy",
+};
+
+static double timers[T_COUNT];
+static int timer_counts[T_COUNT];
+
+#define TIMED(id, call) \
+    do { \
+        double _start = now_ns(); \
+        call; \
+        timers[id] += now_ns() - _start; \
+        timer_counts[id]++; \
+    } while (0)
+
+static ANativeActivity activity;
+static ANativeActivityCallbacks callbacks;
+
+static void create_activity(void* savedState, size_t savedStateSize,
+                            int window, AInputQueue* queue)
+{
+    memset(&activity, 0, sizeof(activity));
+    memset(&callbacks, 0, sizeof(callbacks));
+    activity.callbacks = &callbacks;
+    TIMED(T_CREATE, ANativeActivity_onCreate(&activity, savedState, savedStateSize));
+    TIMED(T_START, callbacks.onStart(&activity));
+    TIMED(T_RESUME, callbacks.onResume(&activity));
+    TIMED(T_WINDOW_CREATED, callbacks.onNativeWindowCreated(&activity, WINDOW(window)));
+    TIMED(T_INPUT_CREATED, callbacks.onInputQueueCreated(&activity, queue));
+    TIMED(T_FOCUS, callbacks.onWindowFocusChanged(&activity, 1));
+}
+
+static void resize(int window, int height)
+{
+    ARect rect = { 0, 0, 480, height };
+    TIMED(T_CONTENT_RECT, callbacks.onContentRectChanged(&activity, &rect));
+    TIMED(T_RESIZED, callbacks.onNativeWindowResized(&activity, WINDOW(window)));
+    TIMED(T_REDRAW, callbacks.onNativeWindowRedrawNeeded(&activity, WINDOW(window)));
+}
+
+static void* destroy_activity(size_t* savedStateSize)
+{
+    void* savedState = NULL;
+    TIMED(T_FOCUS, callbacks.onWindowFocusChanged(&activity, 0));
+    TIMED(T_PAUSE, callbacks.onPause(&activity));
+    TIMED(T_SAVE, savedState = callbacks.onSaveInstanceState(&activity, savedStateSize));
+    TIMED(T_STOP, callbacks.onStop(&activity));
+    TIMED(T_WINDOW_DESTROYED, callbacks.onNativeWindowDestroyed(&activity, NULL));
+    /* The app thread must have stopped using the window now. */
+    pthread_mutex_lock(&app_lock);
+    CHECK(app_window == NULL, "window still in use after onNativeWindowDestroyed");
+    pthread_mutex_unlock(&app_lock);
+    TIMED(T_INPUT_DESTROYED, callbacks.onInputQueueDestroyed(&activity, NULL));
+    TIMED(T_DESTROY, callbacks.onDestroy(&activity));
+    return savedState;
+}
+
+int main(void)
+{
+    AInputQueue* queue = mock_input_queue_new();
+    void* savedState = NULL;
+    size_t savedStateSize = 0;
+    double total;
+    int round, i;
+
+    create_activity(NULL, 0, 1, queue);
+    for (round = 0; round < ROUNDS; round++) {
+        int redraws, low_memory;
+
+        /* These are not acknowledged, and fill the command ring. */
+        for (i = 0; i < FLOOD; i++)
+            callbacks.onLowMemory(&activity);
+
+        /* Resize: the soft keyboard is shown, then hidden. */
+        resize(1, 400);
+        resize(1, 800);
+        pthread_mutex_lock(&app_lock);
+        redraws = app_redraws;
+        low_memory = app_low_memory;
+        pthread_mutex_unlock(&app_lock);
+        CHECK(redraws == 2 * (round + 1),
+              "%d redraws after onNativeWindowRedrawNeeded instead of %d",
+              redraws, 2 * (round + 1));
+        CHECK(low_memory == FLOOD * (round + 1),
+              "%d onLowMemory commands before onNativeWindowRedrawNeeded instead of %d",
+              low_memory, FLOOD * (round + 1));
+
+        /* Rotation: the activity is destroyed and re-created. */
+        free(savedState);
+        savedStateSize = 0;
+        savedState = destroy_activity(&savedStateSize);
+        CHECK(savedState != NULL && savedStateSize == sizeof(int) && *(int*)savedState == 42,
+              "bad saved state");
+        /* The content rect of the last resize was seen before that. */
+        pthread_mutex_lock(&app_lock);
+        CHECK(app_content_rect.bottom == 800, "content rect bottom is %d",
+              app_content_rect.bottom);
+        app_content_rect.bottom = 0;
+        pthread_mutex_unlock(&app_lock);
+        create_activity(savedState, savedStateSize, 2 + round, queue);
+    }
+    free(savedState);
+    savedState = destroy_activity(&savedStateSize);
+    free(savedState);
+    mock_input_queue_delete(queue);
+
+    CHECK(app_restored == ROUNDS, "state restored %d times instead of %d",
+          app_restored, ROUNDS);
+    CHECK(app_bad_order == 0, "%d window commands out of order", app_bad_order);
+    CHECK(app_frames_without_window == 0, "%d frames drawn without a window",
+          app_frames_without_window);
+
+    printf("Main thread time per callback (%d rounds, %d ms frames):\n", ROUNDS, FRAME_MS);
+    total = 0;
+    for (i = 0; i < T_COUNT; i++) {
+        printf("  %-28s %9.1f us\n", timer_names[i], timers[i] / timer_counts[i] / 1000);
+        total += timers[i];
+    }
+    printf("  %-28s %9.1f us\n", "total per round", total / (ROUNDS + 1) / 1000);
+
+    if (failures != 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
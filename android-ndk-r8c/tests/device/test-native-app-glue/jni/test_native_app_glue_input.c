@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Checks and measures the input event processing of native_app_glue.
+ *
+ * The real glue code runs android_main() in its own thread, but against
+ * the mock AInputQueue and ALooper of mock_android.c. Bursts of touch
+ * events (one DOWN, many MOVE with historical samples, one UP, and a key
+ * event) are queued at once, as if received during a frame, and processed:
+ *
+ *   - one event per looper wakeup (inputEventBudget = 1, the former
+ *     behaviour),
+ *   - with the default budget,
+ *   - with the default budget and an onInputBatch callback.
+ *
+ * All events must be finished, in order, with the right 'handled' value.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "android_native_app_glue.h"
+#include "mock_android.h"
+
+#define ROUNDS       200
+#define BURST_MOVES  118
+#define BURST_SIZE   (BURST_MOVES + 3)
+#define HISTORY_SIZE 2
+
+static int failures = 0;
+
+#define CHECK(cond, ...) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "KO: " __VA_ARGS__); \
+            fprintf(stderr, "\n"); \
+            failures++; \
+        } \
+    } while (0)
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Settings of the current run, and what android_main() saw. */
+static int32_t run_budget;
+static int run_batch;
+static int last_seq;
+static int out_of_order;
+static int event_calls;
+static int batch_calls;
+static int batch_samples;
+static int bad_batches;
+
+static void check_order(AInputEvent* event)
+{
+    if (event->seq != last_seq + 1)
+        out_of_order++;
+    last_seq = event->seq;
+}
+
+static int32_t on_input_event(struct android_app* app, AInputEvent* event)
+{
+    event_calls++;
+    check_order(event);
+    /* Motion events are handled, key events are not. */
+    return AInputEvent_getType(event) == AINPUT_EVENT_TYPE_MOTION;
+}
+
+static int32_t on_input_batch(struct android_app* app, AInputEvent** events, int32_t count)
+{
+    int32_t i;
+    batch_calls++;
+    for (i = 0; i < count; i++) {
+        check_order(events[i]);
+        if (AInputEvent_getType(events[i]) != AINPUT_EVENT_TYPE_MOTION ||
+            AMotionEvent_getAction(events[i]) != AMOTION_EVENT_ACTION_MOVE)
+            bad_batches++;
+        batch_samples += AMotionEvent_getHistorySize(events[i]) + 1;
+    }
+    return 1;
+}
+
+void android_main(struct android_app* app)
+{
+    app_dummy();
+
+    app->inputEventBudget = run_budget;
+    app->onInputEvent = on_input_event;
+    if (run_batch)
+        app->onInputBatch = on_input_batch;
+
+    while (!app->destroyRequested) {
+        struct android_poll_source* source = NULL;
+        int events;
+        if (ALooper_pollAll(-1, NULL, &events, (void**)&source) >= 0 && source != NULL)
+            source->process(app, source);
+    }
+}
+
+static void make_burst(AInputEvent* events, int* seq)
+{
+    int i;
+    memset(events, 0, BURST_SIZE * sizeof(*events));
+    for (i = 0; i < BURST_SIZE; i++) {
+        events[i].type = AINPUT_EVENT_TYPE_MOTION;
+        events[i].deviceId = 1;
+        events[i].source = AINPUT_SOURCE_TOUCHSCREEN;
+        events[i].action = AMOTION_EVENT_ACTION_MOVE;
+        events[i].historySize = HISTORY_SIZE;
+        events[i].seq = ++*seq;
+    }
+    events[0].action = AMOTION_EVENT_ACTION_DOWN;
+    events[0].historySize = 0;
+    events[BURST_MOVES + 1].action = AMOTION_EVENT_ACTION_UP;
+    events[BURST_MOVES + 1].historySize = 0;
+    events[BURST_MOVES + 2].type = AINPUT_EVENT_TYPE_KEY;
+    events[BURST_MOVES + 2].deviceId = 2;
+    events[BURST_MOVES + 2].source = AINPUT_SOURCE_KEYBOARD;
+    events[BURST_MOVES + 2].action = AKEY_EVENT_ACTION_DOWN;
+    events[BURST_MOVES + 2].historySize = 0;
+}
+
+static void run(const char* name, int32_t budget, int batch)
+{
+    static AInputEvent events[ROUNDS][BURST_SIZE];
+    ANativeActivity activity;
+    ANativeActivityCallbacks callbacks;
+    AInputQueue* queue;
+    int round, i, seq = 0, wakeups, max_wakeups;
+    double start, elapsed;
+
+    run_budget = budget;
+    run_batch = batch;
+    last_seq = 0;
+    out_of_order = event_calls = batch_calls = batch_samples = bad_batches = 0;
+    for (round = 0; round < ROUNDS; round++)
+        make_burst(events[round], &seq);
+
+    memset(&activity, 0, sizeof(activity));
+    memset(&callbacks, 0, sizeof(callbacks));
+    activity.callbacks = &callbacks;
+    ANativeActivity_onCreate(&activity, NULL, 0);
+
+    queue = mock_input_queue_new();
+    callbacks.onInputQueueCreated(&activity, queue);
+    wakeups = mock_looper_input_wakeups();
+
+    start = now_ns();
+    for (round = 0; round < ROUNDS; round++) {
+        mock_input_queue_push(queue, events[round], BURST_SIZE);
+        mock_input_queue_wait_finished(queue, (round + 1) * BURST_SIZE);
+    }
+    elapsed = now_ns() - start;
+    wakeups = mock_looper_input_wakeups() - wakeups;
+
+    callbacks.onInputQueueDestroyed(&activity, queue);
+    callbacks.onDestroy(&activity);
+    mock_input_queue_delete(queue);
+
+    printf("%-22s %6d events, %6d wakeups, %5d onInputEvent, %4d onInputBatch, %7.1f ns/event\n",
+           name, ROUNDS * BURST_SIZE, wakeups, event_calls, batch_calls,
+           elapsed / (ROUNDS * BURST_SIZE));
+
+    CHECK(out_of_order == 0, "%s: %d events out of order", name, out_of_order);
+    for (round = 0; round < ROUNDS; round++) {
+        for (i = 0; i < BURST_SIZE; i++) {
+            int expected = events[round][i].type == AINPUT_EVENT_TYPE_MOTION;
+            CHECK(events[round][i].handled == expected,
+                  "%s: event %d finished with handled=%d", name,
+                  events[round][i].seq, events[round][i].handled);
+        }
+    }
+    max_wakeups = ROUNDS * ((BURST_SIZE + budget - 1) / budget);
+    CHECK(wakeups <= max_wakeups, "%s: %d wakeups, expected at most %d",
+          name, wakeups, max_wakeups);
+    if (batch) {
+        CHECK(bad_batches == 0, "%s: %d non-MOVE events batched", name, bad_batches);
+        CHECK(event_calls == ROUNDS * 3, "%s: %d onInputEvent calls", name, event_calls);
+        CHECK(batch_samples == ROUNDS * BURST_MOVES * (HISTORY_SIZE + 1),
+              "%s: %d samples batched", name, batch_samples);
+    } else {
+        CHECK(event_calls == ROUNDS * BURST_SIZE, "%s: %d onInputEvent calls", name, event_calls);
+        CHECK(batch_calls == 0, "%s: %d onInputBatch calls", name, batch_calls);
+    }
+}
+
+int main(void)
+{
+    run("one event per wakeup", 1, 0);
+    run("default budget", ANDROID_APP_DEFAULT_INPUT_BUDGET, 0);
+    run("default budget, batch", ANDROID_APP_DEFAULT_INPUT_BUDGET, 1);
+
+    if (failures != 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
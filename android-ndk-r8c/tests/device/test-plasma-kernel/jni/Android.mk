@@ -0,0 +1,9 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := test_plasma_kernel
+LOCAL_SRC_FILES := test_plasma_kernel.c
+LOCAL_STATIC_LIBRARIES := plasma_kernel
+include $(BUILD_EXECUTABLE)
+
+$(call import-module,android/plasma_kernel)
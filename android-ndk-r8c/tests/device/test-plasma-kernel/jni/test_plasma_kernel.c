@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Headless harness for the plasma_kernel library: renders into memory,
+ * so it doesn't need a display.
+ *
+ * It first checks that all the kernels supported by the CPU render the
+ * same pixels as the original per-pixel loop of the plasma samples, for
+ * several buffer sizes, strides and alignments. Then it reports the
+ * throughput of each kernel in Mpixels/s, on one thread and tiled across
+ * the threads of a job system.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "android_native_app_frame.h"
+#include "plasma_kernel.h"
+
+#define BENCH_WIDTH   1280
+#define BENCH_HEIGHT  720
+#define BENCH_MS      300
+
+static int failures = 0;
+
+#define CHECK(cond, ...) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "KO: " __VA_ARGS__); \
+            fprintf(stderr, "\n"); \
+            failures++; \
+        } \
+    } while (0)
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/* The original rendering code of the samples, one pixel at a time. */
+
+typedef int32_t  Fixed;
+
+#define  FIXED_BITS           16
+#define  FIXED_ONE            (1 << FIXED_BITS)
+#define  FIXED_FROM_FLOAT(x)  ((Fixed)((x)*FIXED_ONE))
+#define  FIXED_FRAC(x)        ((x) & ((1 << FIXED_BITS)-1))
+
+#define  ANGLE_BITS           9
+#define  ANGLE_2PI            (1 << ANGLE_BITS)
+#define  ANGLE_PI             (1 << (ANGLE_BITS-1))
+#define  ANGLE_FROM_FIXED(x)  ((x) >> (FIXED_BITS - ANGLE_BITS))
+
+#define  PALETTE_BITS         8
+#define  PALETTE_SIZE         (1 << PALETTE_BITS)
+
+static Fixed     angle_sin_tab[ANGLE_2PI+1];
+static uint16_t  palette[PALETTE_SIZE];
+
+static uint16_t make565(int red, int green, int blue)
+{
+    return (uint16_t)( ((red   << 8) & 0xf800) |
+                       ((green << 2) & 0x03e0) |
+                       ((blue  >> 3) & 0x001f) );
+}
+
+static void init_tables(void)
+{
+    int  nn, mm = 0;
+    for (nn = 0; nn < ANGLE_2PI+1; nn++)
+        angle_sin_tab[nn] = FIXED_FROM_FLOAT(sin(nn*M_PI/ANGLE_PI));
+
+    for (nn = 0; nn < PALETTE_SIZE/4; nn++) {
+        int  jj = (nn-mm)*4*255/PALETTE_SIZE;
+        palette[nn] = make565(255, jj, 255-jj);
+    }
+    for ( mm = nn; nn < PALETTE_SIZE/2; nn++ ) {
+        int  jj = (nn-mm)*4*255/PALETTE_SIZE;
+        palette[nn] = make565(255-jj, 255, jj);
+    }
+    for ( mm = nn; nn < PALETTE_SIZE*3/4; nn++ ) {
+        int  jj = (nn-mm)*4*255/PALETTE_SIZE;
+        palette[nn] = make565(0, 255-jj, 255);
+    }
+    for ( mm = nn; nn < PALETTE_SIZE; nn++ ) {
+        int  jj = (nn-mm)*4*255/PALETTE_SIZE;
+        palette[nn] = make565(jj, 0, 255);
+    }
+}
+
+static Fixed fixed_sin(Fixed f)
+{
+    return angle_sin_tab[(uint32_t)ANGLE_FROM_FIXED(f) & (ANGLE_2PI-1)];
+}
+
+static uint16_t palette_from_fixed(Fixed x)
+{
+    if (x < 0) x = -x;
+    if (x >= FIXED_ONE) x = FIXED_ONE-1;
+    return palette[(FIXED_FRAC(x) >> (FIXED_BITS - PALETTE_BITS)) & (PALETTE_SIZE-1)];
+}
+
+static void reference_fill_plasma(const PlasmaBuffer* buffer, double t)
+{
+    uint8_t* pixels = buffer->pixels;
+    Fixed yt1 = FIXED_FROM_FLOAT(t/1230.);
+    Fixed yt2 = yt1;
+    Fixed xt10 = FIXED_FROM_FLOAT(t/3000.);
+    Fixed xt20 = xt10;
+    int  yy, xx;
+
+    for (yy = 0; yy < buffer->height; yy++) {
+        uint16_t*  line = (uint16_t*)pixels;
+        Fixed      base = fixed_sin(yt1) + fixed_sin(yt2);
+        Fixed      xt1 = xt10;
+        Fixed      xt2 = xt20;
+
+        yt1 += FIXED_FROM_FLOAT(1/100.);
+        yt2 += FIXED_FROM_FLOAT(1/163.);
+
+        for (xx = 0; xx < buffer->width; xx++) {
+            Fixed ii = base + fixed_sin(xt1) + fixed_sin(xt2);
+            xt1 += FIXED_FROM_FLOAT(1/173.);
+            xt2 += FIXED_FROM_FLOAT(1/242.);
+            line[xx] = palette_from_fixed(ii >> 2);
+        }
+        pixels += buffer->stride;
+    }
+}
+
+/* Allocate a buffer whose rows are surrounded by guard bytes, and whose
+ * pixels start at 'offset' bytes from an aligned address.
+ */
+static PlasmaBuffer make_buffer(int width, int height, int padding, int offset)
+{
+    PlasmaBuffer  buffer;
+    size_t        size;
+
+    buffer.width  = width;
+    buffer.height = height;
+    buffer.stride = width * 2 + padding;
+    size = (size_t)buffer.stride * height + offset;
+    buffer.pixels = (uint8_t*)malloc(size) + offset;
+    memset((uint8_t*)buffer.pixels - offset, 0xa5, size);
+    return buffer;
+}
+
+static void free_buffer(PlasmaBuffer* buffer, int offset)
+{
+    free((uint8_t*)buffer->pixels - offset);
+}
+
+static void test_kernel(int kernel, struct android_jobs* jobs)
+{
+    static const struct {
+        int  width, height, padding, offset;
+    } sizes[] = {
+        { 320, 240, 0, 0 },
+        { 333, 77, 6, 2 },      /* odd width, padded and misaligned rows */
+        { 7, 19, 2, 0 },        /* narrower than a SIMD vector */
+        { 1, 1, 0, 0 },
+    };
+    static const double  times[] = { 0., 1234.5, 987654. };
+    size_t  ss, tt;
+
+    for (ss = 0; ss < sizeof(sizes)/sizeof(sizes[0]); ss++) {
+        PlasmaBuffer  expected = make_buffer(sizes[ss].width, sizes[ss].height,
+                                             sizes[ss].padding, sizes[ss].offset);
+        PlasmaBuffer  actual = make_buffer(sizes[ss].width, sizes[ss].height,
+                                           sizes[ss].padding, sizes[ss].offset);
+        size_t        size = (size_t)expected.stride * expected.height;
+
+        for (tt = 0; tt < sizeof(times)/sizeof(times[0]); tt++) {
+            reference_fill_plasma(&expected, times[tt]);
+            CHECK(plasma_render(&actual, times[tt], kernel, jobs) == 0,
+                  "%s: plasma_render failed", plasma_kernel_name(kernel));
+            CHECK(memcmp(expected.pixels, actual.pixels, size) == 0,
+                  "%s%s: wrong pixels for %dx%d at t=%g", plasma_kernel_name(kernel),
+                  jobs ? " (tiled)" : "", expected.width, expected.height, times[tt]);
+        }
+        free_buffer(&expected, sizes[ss].offset);
+        free_buffer(&actual, sizes[ss].offset);
+    }
+}
+
+/* Render frames for at least BENCH_MS and return the Mpixels/s. */
+static double bench(int kernel, struct android_jobs* jobs, const PlasmaBuffer* buffer)
+{
+    double  start = now_ms(), elapsed;
+    int     frames = 0;
+
+    do {
+        if (kernel < 0)
+            reference_fill_plasma(buffer, frames * 16.);
+        else
+            plasma_render(buffer, frames * 16., kernel, jobs);
+        frames++;
+        elapsed = now_ms() - start;
+    } while (elapsed < BENCH_MS);
+
+    return (double)buffer->width * buffer->height * frames / elapsed / 1e3;
+}
+
+int main(void)
+{
+    struct android_jobs*  jobs;
+    PlasmaBuffer          buffer;
+    int                   kernel;
+
+    init_tables();
+    jobs = android_jobs_create(-1);
+    CHECK(jobs != NULL, "could not create the job system");
+    if (jobs == NULL)
+        return 1;
+
+    CHECK(plasma_kernel_is_supported(PLASMA_KERNEL_SCALAR), "scalar kernel not supported");
+    CHECK(!plasma_kernel_is_supported(PLASMA_KERNEL_COUNT), "invalid kernel supported");
+    CHECK(plasma_kernel_name(PLASMA_KERNEL_COUNT) == NULL, "invalid kernel has a name");
+
+    for (kernel = PLASMA_KERNEL_AUTO; kernel < PLASMA_KERNEL_COUNT; kernel++) {
+        if (!plasma_kernel_is_supported(kernel)) {
+            PlasmaBuffer  small = make_buffer(8, 8, 0, 0);
+            CHECK(plasma_render(&small, 0., kernel, NULL) < 0,
+                  "unsupported kernel %s did render", plasma_kernel_name(kernel));
+            free_buffer(&small, 0);
+            continue;
+        }
+        test_kernel(kernel, NULL);
+        test_kernel(kernel, jobs);
+    }
+
+    buffer = make_buffer(BENCH_WIDTH, BENCH_HEIGHT, 0, 0);
+    printf("Plasma %dx%d, best kernel: %s, %d worker(s)\n", BENCH_WIDTH, BENCH_HEIGHT,
+           plasma_kernel_name(plasma_kernel_best()), android_jobs_worker_count(jobs));
+    printf("  %-10s %10.1f Mpixels/s\n", "original", bench(-1, NULL, &buffer));
+    for (kernel = PLASMA_KERNEL_SCALAR; kernel < PLASMA_KERNEL_COUNT; kernel++) {
+        if (!plasma_kernel_is_supported(kernel))
+            continue;
+        printf("  %-10s %10.1f Mpixels/s, tiled: %.1f Mpixels/s\n", plasma_kernel_name(kernel),
+               bench(kernel, NULL, &buffer), bench(kernel, jobs, &buffer));
+    }
+    free_buffer(&buffer, 0);
+    android_jobs_destroy(jobs);
+
+    if (failures != 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
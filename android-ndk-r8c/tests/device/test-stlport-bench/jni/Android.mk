@@ -0,0 +1,6 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := test_stlport_bench
+LOCAL_SRC_FILES := test_stlport_bench.cpp
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,168 @@
+// Benchmark of string and algorithm-heavy STL workloads, to compare
+// STLport builds, e.g. with different compiler flags.
+//
+// Each workload is run with an increasing number of iterations until it
+// takes at least 50ms, and its time per iteration is printed. The checksum
+// must be the same with all builds.
+
+#include <stdio.h>
+#include <time.h>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static double now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static unsigned long checksum = 0;
+
+// A pseudo-random text made of lowercase words, with a marker at the end.
+static std::string make_text(size_t size)
+{
+    std::string text;
+    unsigned int seed = 12345;
+    text.reserve(size + 16);
+    while (text.size() < size) {
+        seed = seed * 1103515245 + 12345;
+        size_t len = 2 + (seed >> 16) % 8;
+        for (size_t n = 0; n < len; ++n) {
+            seed = seed * 1103515245 + 12345;
+            text += (char)('a' + (seed >> 16) % 26);
+        }
+        text += ' ';
+    }
+    text += "#marker#";
+    return text;
+}
+
+static const std::string& text()
+{
+    static std::string s = make_text(4096);
+    return s;
+}
+
+static void find_char(int count)
+{
+    for (int n = 0; n < count; ++n)
+        checksum += text().find('#');
+}
+
+static void find_string(int count)
+{
+    for (int n = 0; n < count; ++n)
+        checksum += text().find("#marker");
+}
+
+static void rfind_string(int count)
+{
+    for (int n = 0; n < count; ++n)
+        checksum += text().rfind("zzz", text().size() / 2);
+}
+
+static void find_first_of(int count)
+{
+    for (int n = 0; n < count; ++n)
+        checksum += text().find_first_of("#0123456789");
+}
+
+static void compare(int count)
+{
+    std::string a = text();
+    std::string b = text();
+    b[b.size() - 1] = '!';
+    for (int n = 0; n < count; ++n)
+        checksum += (a.compare(b) < 0) + (a == text());
+}
+
+static void append(int count)
+{
+    for (int n = 0; n < count; ++n) {
+        std::string s;
+        for (int i = 0; i < 64; ++i)
+            s.append(text(), i * 16, 16);
+        checksum += s.size();
+    }
+}
+
+static void sort_strings(int count)
+{
+    std::vector<std::string> words;
+    std::istringstream in(text());
+    std::string word;
+    while (in >> word)
+        words.push_back(word);
+    for (int n = 0; n < count; ++n) {
+        std::vector<std::string> sorted(words);
+        std::sort(sorted.begin(), sorted.end());
+        checksum += sorted[sorted.size() / 2].size();
+    }
+}
+
+static void format_numbers(int count)
+{
+    for (int n = 0; n < count; ++n) {
+        std::ostringstream out;
+        for (int i = 0; i < 32; ++i)
+            out << i * 7919 << ' ' << i * 0.25 << ' ';
+        checksum += out.str().size();
+    }
+}
+
+static void parse_numbers(int count)
+{
+    std::ostringstream out;
+    for (int i = 0; i < 32; ++i)
+        out << i * 7919 << ' ';
+    const std::string numbers = out.str();
+    for (int n = 0; n < count; ++n) {
+        std::istringstream in(numbers);
+        int value;
+        while (in >> value)
+            checksum += value;
+    }
+}
+
+static void run(const char* name, void (*workload)(int))
+{
+    int count = 1;
+    double elapsed;
+    workload(1);
+    for (;;) {
+        double start = now_ns();
+        workload(count);
+        elapsed = now_ns() - start;
+        if (elapsed >= 50e6 || count >= (1 << 24))
+            break;
+        count *= 2;
+    }
+    printf("%-16s %12.1f ns\n", name, elapsed / count);
+}
+
+int main()
+{
+    run("find_char", find_char);
+    run("find_string", find_string);
+    run("rfind_string", rfind_string);
+    run("find_first_of", find_first_of);
+    run("compare", compare);
+    run("append", append);
+    run("sort_strings", sort_strings);
+    run("format_numbers", format_numbers);
+    run("parse_numbers", parse_numbers);
+    // The checksum depends on the iteration counts, only print it when
+    // they are not timing-dependent.
+    checksum = 0;
+    find_string(1);
+    compare(1);
+    sort_strings(1);
+    format_numbers(1);
+    parse_numbers(1);
+    printf("checksum: %lu\n", checksum);
+    return 0;
+}
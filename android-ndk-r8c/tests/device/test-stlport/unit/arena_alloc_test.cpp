@@ -0,0 +1,476 @@
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+#include <functional>
+#include <cstring>
+
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
+#  include <slist>
+#  include <hash_map>
+#  include <hash_set>
+#  include <arena_alloc>
+#endif
+
+#include "cppunit/cppunit_proxy.h"
+
+#if !defined (STLPORT) || defined (_STLP_USE_NAMESPACES)
+using namespace std;
+#endif
+
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
+// Upstream resource counting what the arenas ask for.
+class CountingArena : public arena_resource
+{
+public:
+  CountingArena() : nbAlloc(0), nbDealloc(0), bytesInUse(0) {}
+
+  size_t nbAlloc, nbDealloc, bytesInUse;
+
+protected:
+  virtual void* do_allocate(size_t bytes, size_t align)
+  {
+    ++nbAlloc;
+    bytesInUse += bytes;
+    return new_delete_arena()->allocate(bytes, align);
+  }
+  virtual void do_deallocate(void* p, size_t bytes, size_t align)
+  {
+    ++nbDealloc;
+    bytesInUse -= bytes;
+    new_delete_arena()->deallocate(p, bytes, align);
+  }
+};
+
+#  if defined (_STLP_USE_EXCEPTIONS)
+// Upstream resource remembering the biggest request and refusing it.
+class FailingArena : public arena_resource
+{
+public:
+  FailingArena() : maxBytes(0) {}
+
+  size_t maxBytes;
+
+protected:
+  virtual void* do_allocate(size_t bytes, size_t)
+  {
+    if (bytes > maxBytes)
+      maxBytes = bytes;
+    throw bad_alloc();
+    return 0;
+  }
+  virtual void do_deallocate(void*, size_t, size_t) {}
+};
+#  endif
+
+#  define BENCH_ARENA_REQUESTS 20000
+#  define BENCH_ARENA_NODES 64
+#endif
+
+//
+// TestCase class
+//
+class ArenaAllocTest : public CPPUNIT_NS::TestCase
+{
+  CPPUNIT_TEST_SUITE(ArenaAllocTest);
+#if !defined (STLPORT) || defined (_STLP_NO_EXTENSIONS)
+  CPPUNIT_IGNORE;
+#endif
+  CPPUNIT_TEST(monotonic);
+  CPPUNIT_TEST(monotonic_buffer);
+  CPPUNIT_TEST(pool);
+  CPPUNIT_TEST(pool_recycled_align);
+#if !defined (STLPORT) || defined (_STLP_USE_EXCEPTIONS)
+  CPPUNIT_TEST(bad_size);
+#endif
+  CPPUNIT_TEST(list_in_arena);
+  CPPUNIT_TEST(map_in_arena);
+  CPPUNIT_TEST(hash_in_arena);
+  CPPUNIT_TEST(swap_arenas);
+  CPPUNIT_EXPLICIT_TEST(benchmark1);
+  CPPUNIT_EXPLICIT_TEST(benchmark2);
+  CPPUNIT_EXPLICIT_TEST(benchmark3);
+  CPPUNIT_TEST_SUITE_END();
+
+protected:
+  void monotonic();
+  void monotonic_buffer();
+  void pool();
+  void pool_recycled_align();
+  void bad_size();
+  void list_in_arena();
+  void map_in_arena();
+  void hash_in_arena();
+  void swap_arenas();
+  void benchmark1();
+  void benchmark2();
+  void benchmark3();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ArenaAllocTest);
+
+//
+// tests implementation
+//
+void ArenaAllocTest::monotonic()
+{
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
+  CountingArena upstream;
+  {
+    monotonic_buffer_arena arena(&upstream);
+    char* p1 = static_cast<char*>(arena.allocate(3, 1));
+    double* p2 = static_cast<double*>(arena.allocate(sizeof(double), sizeof(double)));
+    CPPUNIT_ASSERT( p1 != 0 && p2 != 0 );
+    CPPUNIT_ASSERT( (reinterpret_cast<size_t>(p2) % sizeof(double)) == 0 );
+    CPPUNIT_ASSERT( upstream.nbAlloc == 1 );
+
+    // Bigger than the next block: still a single upstream call.
+    void* big = arena.allocate(10000);
+    CPPUNIT_ASSERT( big != 0 );
+    CPPUNIT_ASSERT( upstream.nbAlloc == 2 );
+
+    arena.deallocate(big, 10000);
+    CPPUNIT_ASSERT( upstream.nbDealloc == 0 );
+
+    arena.release();
+    CPPUNIT_ASSERT( upstream.nbDealloc == 2 );
+    CPPUNIT_ASSERT( upstream.bytesInUse == 0 );
+
+    // Usable again after a release.
+    CPPUNIT_ASSERT( arena.allocate(16) != 0 );
+  }
+  CPPUNIT_ASSERT( upstream.nbAlloc == upstream.nbDealloc );
+  CPPUNIT_ASSERT( upstream.bytesInUse == 0 );
+#endif
+}
+
+void ArenaAllocTest::monotonic_buffer()
+{
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
+  CountingArena upstream;
+  double buf[128];
+  {
+    monotonic_buffer_arena arena(buf, sizeof(buf), &upstream);
+    list<int, arena_allocator<int> > l(&arena);
+    for (int i = 0; i < 16; ++i) {
+      l.push_back(i);
+    }
+    // Everything fits in the initial buffer.
+    CPPUNIT_ASSERT( upstream.nbAlloc == 0 );
+    CPPUNIT_ASSERT( reinterpret_cast<char*>(&l.front()) >= reinterpret_cast<char*>(buf) );
+    CPPUNIT_ASSERT( reinterpret_cast<char*>(&l.back()) < reinterpret_cast<char*>(buf + 128) );
+
+    for (int i = 0; i < 1000; ++i) {
+      l.push_back(i);
+    }
+    CPPUNIT_ASSERT( l.size() == 1016 );
+    CPPUNIT_ASSERT( upstream.nbAlloc != 0 );
+    CPPUNIT_ASSERT( upstream.nbAlloc < 10 );
+  }
+  CPPUNIT_ASSERT( upstream.nbAlloc == upstream.nbDealloc );
+#endif
+}
+
+void ArenaAllocTest::pool()
+{
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
+  CountingArena upstream;
+  {
+    unsynchronized_pool_arena arena(&upstream);
+    void* p1 = arena.allocate(24, 8);
+    arena.deallocate(p1, 24, 8);
+    // Same size class is recycled.
+    CPPUNIT_ASSERT( arena.allocate(20, 8) == p1 );
+
+    // Large blocks are given back right away.
+    size_t nbDealloc = upstream.nbDealloc;
+    void* big = arena.allocate(4096);
+    CPPUNIT_ASSERT( big != 0 );
+    arena.deallocate(big, 4096);
+    CPPUNIT_ASSERT( upstream.nbDealloc == nbDealloc + 1 );
+
+    // Over aligned requests, small or large, honour their alignment.
+    for (size_t align = 64; align <= 128; align *= 2) {
+      for (size_t bytes = 8; bytes <= 1024; bytes *= 4) {
+        char* p = static_cast<char*>(arena.allocate(bytes, align));
+        CPPUNIT_ASSERT( p != 0 );
+        CPPUNIT_ASSERT( (reinterpret_cast<size_t>(p) % align) == 0 );
+        memset(p, 0xa5, bytes);
+        arena.deallocate(p, bytes, align);
+      }
+    }
+    CPPUNIT_ASSERT( upstream.nbDealloc == nbDealloc + 9 );
+
+    // Steady insert/erase does not grow the arena.
+    set<int, less<int>, arena_allocator<int> > s(less<int>(), &arena);
+    for (int i = 0; i < 1000; ++i) {
+      s.insert(i);
+    }
+    size_t nbAlloc = upstream.nbAlloc;
+    for (int n = 0; n < 10; ++n) {
+      for (int i = 0; i < 1000; i += 2) {
+        s.erase(i);
+      }
+      for (int i = 0; i < 1000; i += 2) {
+        s.insert(i);
+      }
+    }
+    CPPUNIT_ASSERT( s.size() == 1000 );
+    CPPUNIT_ASSERT( upstream.nbAlloc == nbAlloc );
+
+    // Still allocated large blocks are freed by release().
+    arena.allocate(1000);
+    s.clear();
+  }
+  CPPUNIT_ASSERT( upstream.nbAlloc == upstream.nbDealloc );
+  CPPUNIT_ASSERT( upstream.bytesInUse == 0 );
+#endif
+}
+
+void ArenaAllocTest::pool_recycled_align()
+{
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
+  // A block freed by a less aligned request of the same size class must
+  // still satisfy the next request.
+  for (size_t align = 1; align <= (size_t)arena_resource::_S_max_align; align *= 2) {
+    for (size_t bytes = 1; bytes <= 64; ++bytes) {
+      unsynchronized_pool_arena arena;
+      arena.allocate(sizeof(void*), 1);
+      void* p = arena.allocate(bytes, 1);
+      arena.deallocate(p, bytes, 1);
+      char* q = static_cast<char*>(arena.allocate(bytes, align));
+      CPPUNIT_ASSERT( (reinterpret_cast<size_t>(q) % align) == 0 );
+    }
+  }
+#endif
+}
+
+void ArenaAllocTest::bad_size()
+{
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS) && defined (_STLP_USE_EXCEPTIONS)
+  // Requests close to the address space size are refused without asking
+  // the upstream resource for a wrapped around size.
+  const size_t huge = static_cast<size_t>(-1);
+  size_t sizes[] = { huge, huge - 8, huge - 64, huge / 2 + 1024 };
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+    FailingArena upstream;
+    monotonic_buffer_arena arena(&upstream);
+    unsynchronized_pool_arena pool(&upstream);
+
+    bool thrown = false;
+    try {
+      arena.allocate(sizes[i], 16);
+    }
+    catch (bad_alloc const&) {
+      thrown = true;
+    }
+    CPPUNIT_ASSERT( thrown );
+    CPPUNIT_ASSERT( upstream.maxBytes == 0 || upstream.maxBytes > sizes[i] );
+
+    upstream.maxBytes = 0;
+    thrown = false;
+    try {
+      pool.allocate(sizes[i], 16);
+    }
+    catch (bad_alloc const&) {
+      thrown = true;
+    }
+    CPPUNIT_ASSERT( thrown );
+    CPPUNIT_ASSERT( upstream.maxBytes == 0 || upstream.maxBytes > sizes[i] );
+  }
+#endif
+}
+
+void ArenaAllocTest::list_in_arena()
+{
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
+  CountingArena upstream;
+  {
+    monotonic_buffer_arena arena(&upstream);
+    typedef list<int, arena_allocator<int> > IntList;
+    IntList l(&arena);
+    for (int i = 0; i < 1000; ++i) {
+      l.push_back(i);
+    }
+    CPPUNIT_ASSERT( l.get_allocator().resource() == &arena );
+
+    // Copies share the arena.
+    IntList lcopy(l);
+    CPPUNIT_ASSERT( lcopy.get_allocator() == l.get_allocator() );
+    CPPUNIT_ASSERT( lcopy == l );
+
+    // Pointer containers go through the void* specialization.
+    list<int*, arena_allocator<int*> > lp(&arena);
+    lp.push_back(&l.front());
+    CPPUNIT_ASSERT( *lp.front() == 0 );
+
+    slist<int, arena_allocator<int> > sl(&arena);
+    sl.insert(sl.end(), l.begin(), l.end());
+    CPPUNIT_ASSERT( sl.size() == 1000 );
+    CPPUNIT_ASSERT( sl.front() == 0 );
+
+    vector<int, arena_allocator<int> > v(l.begin(), l.end(), &arena);
+    CPPUNIT_ASSERT( v.size() == 1000 );
+    CPPUNIT_ASSERT( v[999] == 999 );
+  }
+  CPPUNIT_ASSERT( upstream.nbAlloc == upstream.nbDealloc );
+  CPPUNIT_ASSERT( upstream.nbAlloc < 20 );
+#endif
+}
+
+void ArenaAllocTest::map_in_arena()
+{
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
+  CountingArena upstream;
+  {
+    monotonic_buffer_arena arena(&upstream);
+    typedef map<int, int, less<int>, arena_allocator<pair<const int, int> > > IntMap;
+    IntMap m(less<int>(), &arena);
+    for (int i = 0; i < 1000; ++i) {
+      m[i] = i * 2;
+    }
+    CPPUNIT_ASSERT( m.size() == 1000 );
+    CPPUNIT_ASSERT( m[500] == 1000 );
+    CPPUNIT_ASSERT( m.get_allocator().resource() == &arena );
+
+    m.erase(m.find(500));
+    CPPUNIT_ASSERT( m.find(500) == m.end() );
+
+    IntMap mcopy(m);
+    CPPUNIT_ASSERT( mcopy.get_allocator() == m.get_allocator() );
+    CPPUNIT_ASSERT( mcopy == m );
+
+    multiset<int, less<int>, arena_allocator<int> > ms(less<int>(), &arena);
+    ms.insert(1);
+    ms.insert(1);
+    CPPUNIT_ASSERT( ms.count(1) == 2 );
+  }
+  CPPUNIT_ASSERT( upstream.nbAlloc == upstream.nbDealloc );
+  CPPUNIT_ASSERT( upstream.nbAlloc < 20 );
+#endif
+}
+
+void ArenaAllocTest::hash_in_arena()
+{
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
+  CountingArena upstream;
+  {
+    unsynchronized_pool_arena arena(&upstream);
+    typedef hash_map<int, int, hash<int>, equal_to<int>, arena_allocator<pair<const int, int> > > IntHMap;
+    IntHMap hm(100, hash<int>(), equal_to<int>(), &arena);
+    for (int i = 0; i < 1000; ++i) {
+      hm[i] = i;
+    }
+    CPPUNIT_ASSERT( hm.size() == 1000 );
+    CPPUNIT_ASSERT( hm[999] == 999 );
+    CPPUNIT_ASSERT( hm.get_allocator().resource() == &arena );
+
+    hm.erase(999);
+    CPPUNIT_ASSERT( hm.find(999) == hm.end() );
+
+    IntHMap hmcopy(hm);
+    CPPUNIT_ASSERT( hmcopy.size() == 999 );
+    CPPUNIT_ASSERT( hmcopy[998] == 998 );
+
+    hash_set<int, hash<int>, equal_to<int>, arena_allocator<int> > hs(100, hash<int>(), equal_to<int>(), &arena);
+    hs.insert(hm.begin()->first);
+    CPPUNIT_ASSERT( hs.size() == 1 );
+  }
+  CPPUNIT_ASSERT( upstream.nbAlloc == upstream.nbDealloc );
+  CPPUNIT_ASSERT( upstream.bytesInUse == 0 );
+#endif
+}
+
+void ArenaAllocTest::swap_arenas()
+{
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
+  CountingArena upstream1, upstream2;
+  {
+    monotonic_buffer_arena arena1(&upstream1), arena2(&upstream2);
+    typedef map<int, int, less<int>, arena_allocator<pair<const int, int> > > IntMap;
+    IntMap m1(less<int>(), &arena1), m2(less<int>(), &arena2);
+    m1[1] = 1;
+    m2[2] = 2;
+
+    // Nodes travel with their allocator.
+    m1.swap(m2);
+    CPPUNIT_ASSERT( m1.get_allocator().resource() == &arena2 );
+    CPPUNIT_ASSERT( m2.get_allocator().resource() == &arena1 );
+    CPPUNIT_ASSERT( m1[2] == 2 );
+    CPPUNIT_ASSERT( m2[1] == 1 );
+
+    list<int, arena_allocator<int> > l1(&arena1), l2(&arena2);
+    l1.push_back(1);
+    l2.push_back(2);
+    l1.swap(l2);
+    CPPUNIT_ASSERT( l1.get_allocator().resource() == &arena2 );
+    CPPUNIT_ASSERT( l1.front() == 2 );
+  }
+  CPPUNIT_ASSERT( upstream1.bytesInUse == 0 );
+  CPPUNIT_ASSERT( upstream2.bytesInUse == 0 );
+#endif
+}
+
+/*
+ * Allocation count benchmarks: every request builds a few transient node
+ * containers. Run them with -t=ArenaAllocTest::benchmarkN.
+ */
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
+template <class _Alloc>
+static size_t serve_request(int request, const _Alloc& alloc)
+{
+  typedef typename _Alloc::template rebind<pair<const int, int> >::other PairAlloc;
+  map<int, int, less<int>, PairAlloc> m(less<int>(), alloc);
+  list<int, _Alloc> l(alloc);
+  for (int i = 0; i < BENCH_ARENA_NODES; ++i) {
+    m[(request * 31 + i * 17) % 1024] = i;
+    l.push_back(i);
+  }
+  return m.size() + l.size();
+}
+#endif
+
+void ArenaAllocTest::benchmark1()
+{
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
+  // Reference: one upstream allocation per node.
+  CountingArena upstream;
+  size_t total = 0;
+  for (int r = 0; r < BENCH_ARENA_REQUESTS; ++r) {
+    total += serve_request(r, arena_allocator<int>(&upstream));
+  }
+  CPPUNIT_ASSERT( total != 0 );
+  CPPUNIT_ASSERT( upstream.nbAlloc >= (size_t)BENCH_ARENA_REQUESTS * BENCH_ARENA_NODES * 2 );
+#endif
+}
+
+void ArenaAllocTest::benchmark2()
+{
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
+  // A per request monotonic arena on a stack buffer: no upstream allocation.
+  CountingArena upstream;
+  size_t total = 0;
+  for (int r = 0; r < BENCH_ARENA_REQUESTS; ++r) {
+    double buf[1024];
+    monotonic_buffer_arena arena(buf, sizeof(buf), &upstream);
+    total += serve_request(r, arena_allocator<int>(&arena));
+  }
+  CPPUNIT_ASSERT( total != 0 );
+  CPPUNIT_ASSERT( upstream.nbAlloc == 0 );
+#endif
+}
+
+void ArenaAllocTest::benchmark3()
+{
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
+  // A long lived pool: nodes are recycled from one request to the next.
+  CountingArena upstream;
+  unsynchronized_pool_arena arena(&upstream);
+  size_t total = 0;
+  for (int r = 0; r < BENCH_ARENA_REQUESTS; ++r) {
+    total += serve_request(r, arena_allocator<int>(&arena));
+  }
+  CPPUNIT_ASSERT( total != 0 );
+  CPPUNIT_ASSERT( upstream.nbAlloc < 10 );
+#endif
+}
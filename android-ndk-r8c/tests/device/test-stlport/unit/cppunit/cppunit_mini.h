@@ -13,6 +13,10 @@
  *
  */
 
+/*
+ * Modified for the Android NDK: added a benchmark mode, see cppunit_bench.h.
+ */
+
 /* $Id$ */
 
 #ifndef _CPPUNITMPFR_H_
@@ -30,12 +34,17 @@
 namespace CPPUNIT_NS
 {
 #endif
+  // See cppunit_bench.h
+  struct BenchmarkResult;
+  class Benchmark;
+
   class Reporter {
   public:
     virtual ~Reporter() {}
     virtual void error(const char * /*macroName*/, const char * /*in_macro*/, const char * /*in_file*/, int /*in_line*/) {}
     virtual void message( const char * /*msg*/ ) {}
     virtual void progress( const char * /*in_className*/, const char * /*in_testName*/, bool /*ignored*/, bool /* explicit */) {}
+    virtual void benchmark(const char * /*in_className*/, const char * /*in_testName*/, const BenchmarkResult & /*result*/) {}
     virtual void end() {}
     virtual void printSummary() {}
   };
@@ -56,7 +65,8 @@ namespace CPPUNIT_NS
     TestCase() { registerTestCase(this); }
 
     void setUp() { m_failed = false; }
-    static int run(Reporter *in_reporter = 0, const char *in_testName = "", bool invert = false);
+    static int run(Reporter *in_reporter = 0, const char *in_testName = "", bool invert = false,
+                   Benchmark *in_benchmark = 0);
     int numErrors() { return m_numErrors; }
     static void registerTestCase(TestCase *in_testCase);
 
@@ -116,6 +126,14 @@ namespace CPPUNIT_NS
       m_reporter->end();
     }
 
+    // In benchmark mode, a test is called until benchmarkNext() returns
+    // false. Otherwise it is only called once. benchmarkAbort() is called
+    // instead of benchmarkEnd() when the test threw an exception.
+    void benchmarkStart(bool in_repeatable);
+    bool benchmarkNext();
+    void benchmarkEnd(const char *in_className, const char *in_testName, const char *in_file, int in_line);
+    void benchmarkAbort();
+
   protected:
     static int m_numErrors;
     static int m_numTests;
@@ -126,6 +144,7 @@ namespace CPPUNIT_NS
     bool m_failed;
 
     static Reporter *m_reporter;
+    static Benchmark *m_benchmark;
   };
 #if 0
 }
@@ -146,7 +165,7 @@ namespace CPPUNIT_NS
     bool ignoring = false; CPPUNIT_MINI_HIDE_UNUSED_VARIABLE(ignoring)
 
 #if defined CPPUNIT_MINI_USE_EXCEPTIONS
-#  define CPPUNIT_TEST_BASE(X, Y) \
+#  define CPPUNIT_TEST_BASE(X, Y, R) \
   { \
     bool do_progress; \
     bool shouldRun = shouldRunThis(in_name, className, #X, invert, Y, do_progress); \
@@ -155,9 +174,14 @@ namespace CPPUNIT_NS
       progress(className, #X, ignoring || !shouldRun, !ignoring && Y); \
       if (shouldRun && !ignoring) { \
         try { \
-          X(); \
+          benchmarkStart(R); \
+          do { \
+            X(); \
+          } while (benchmarkNext()); \
+          benchmarkEnd(className, #X, __FILE__, __LINE__); \
         } \
         catch(...) { \
+          benchmarkAbort(); \
           Base::error("Test Failed: An Exception was thrown.", #X, __FILE__, __LINE__); \
         } \
       } \
@@ -165,22 +189,30 @@ namespace CPPUNIT_NS
     } \
   }
 #else
-#  define CPPUNIT_TEST_BASE(X, Y) \
+#  define CPPUNIT_TEST_BASE(X, Y, R) \
   { \
     bool do_progress; \
     bool shouldRun = shouldRunThis(in_name, className, #X, invert, Y, do_progress); \
     if (shouldRun || do_progress) { \
       setUp(); \
       progress(className, #X, ignoring || !shouldRun, !ignoring && Y); \
-      if (shouldRun && !ignoring) \
-        X(); \
+      if (shouldRun && !ignoring) { \
+        benchmarkStart(R); \
+        do { \
+          X(); \
+        } while (benchmarkNext()); \
+        benchmarkEnd(className, #X, __FILE__, __LINE__); \
+      } \
       tearDown(); \
     } \
   }
 #endif
 
-#define CPPUNIT_TEST(X) CPPUNIT_TEST_BASE(X, false)
-#define CPPUNIT_EXPLICIT_TEST(X) CPPUNIT_TEST_BASE(X, true)
+#define CPPUNIT_TEST(X) CPPUNIT_TEST_BASE(X, false, true)
+#define CPPUNIT_EXPLICIT_TEST(X) CPPUNIT_TEST_BASE(X, true, true)
+// For tests that can't be run repeatedly, e.g. because they check global
+// counters, and thus are only run once in benchmark mode.
+#define CPPUNIT_TEST_NO_BENCHMARK(X) CPPUNIT_TEST_BASE(X, false, false)
 
 #define CPPUNIT_IGNORE \
   ignoring = true
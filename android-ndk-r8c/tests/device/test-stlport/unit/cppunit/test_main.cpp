@@ -13,9 +13,14 @@
  *
  */
 
+/*
+ * Modified for the Android NDK: added a benchmark mode, see cppunit_bench.h.
+ */
+
 #include "cppunit_proxy.h"
 #include "file_reporter.h"
 #include "cppunit_timer.h"
+#include "cppunit_bench.h"
 
 #include "stdio.h"
 
@@ -28,14 +33,16 @@ namespace CPPUNIT_NS
 
   TestCase *TestCase::m_root = 0;
   Reporter *TestCase::m_reporter = 0;
+  Benchmark *TestCase::m_benchmark = 0;
 
   void TestCase::registerTestCase(TestCase *in_testCase) {
     in_testCase->m_next = m_root;
     m_root = in_testCase;
   }
 
-  int TestCase::run(Reporter *in_reporter, const char *in_testName, bool invert) {
+  int TestCase::run(Reporter *in_reporter, const char *in_testName, bool invert, Benchmark *in_benchmark) {
     TestCase::m_reporter = in_reporter;
+    TestCase::m_benchmark = in_benchmark;
 
     m_numErrors = 0;
     m_numTests = 0;
@@ -47,6 +54,46 @@ namespace CPPUNIT_NS
     }
     return m_numErrors;
   }
+
+  void TestCase::benchmarkStart(bool in_repeatable) {
+    if (m_benchmark) {
+      if (in_repeatable)
+        m_benchmark->start();
+      else
+        m_benchmark->reset();
+    }
+  }
+
+  bool TestCase::benchmarkNext() {
+    return m_benchmark && !m_failed && m_benchmark->next();
+  }
+
+  void TestCase::benchmarkEnd(const char *in_className, const char *in_testName, const char *in_file, int in_line) {
+    BenchmarkResult result;
+    if (!m_benchmark)
+      return;
+    if (m_failed) {
+      m_benchmark->reset();
+      return;
+    }
+    if (!m_benchmark->end(in_className, in_testName, result))
+      return;
+    if (m_reporter)
+      m_reporter->benchmark(in_className, in_testName, result);
+    double baselineNs;
+    if (m_benchmark->isRegression(result, baselineNs)) {
+      char msg[256];
+      snprintf(msg, sizeof(msg), "%s: %.1f ns instead of %.1f ns (%+.0f%%, threshold %.0f%%)",
+               result.name, result.medianNs, baselineNs,
+               (result.medianNs / baselineNs - 1) * 100, m_benchmark->threshold());
+      error("CPPUNIT_BENCHMARK_REGRESSION", msg, in_file, in_line);
+    }
+  }
+
+  void TestCase::benchmarkAbort() {
+    if (m_benchmark)
+      m_benchmark->reset();
+  }
 #if 0
 }
 #endif
@@ -54,12 +101,19 @@ namespace CPPUNIT_NS
 static void usage(const char* name)
 {
   printf("Usage : %s [-t=<class>[::<test>]] [-x=<class>[::<test>]] [-f=<file>]%s\n",
-         name, Timer::supported() ? " [-m]": "");
+         name, Timer::supported() ? " [-m] [-b[=<samples>]] [-j=<file>] [-c=<file>] [-r=<percent>]": "");
   printf("\t[-t=<class>[::<test>]] : test class or class::test to execute;\n");
   printf("\t[-x=<class>[::<test>]] : test class or class::test to exclude from execution;\n");
   printf("\t[-f=<file>] : output file");
-  if (Timer::supported())
-    printf(";\n\t[-m] : monitor test execution, display time duration for each test\n");
+  if (Timer::supported()) {
+    printf(";\n\t[-m] : monitor test execution, display time duration for each test;\n");
+    printf("\t[-b[=<samples>]] : benchmark mode, run each test repeatedly and display its\n"
+           "\t\tmedian and 99th percentile durations (default: 25 samples);\n");
+    printf("\t[-j=<file>] : benchmark mode, also write the results to a JSON file;\n");
+    printf("\t[-c=<file>] : benchmark mode, compare the results to a JSON file written\n"
+           "\t\twith -j, and report slower tests as errors;\n");
+    printf("\t[-r=<percent>] : regression threshold for -c (default: 10)\n");
+  }
   else
     printf("\n");
 }
@@ -74,10 +128,19 @@ int main(int argc, char** argv) {
   //  -x=CLASS[::TEST]    run all except the test class CLASS or member test CLASS::TEST
   //  -f=FILE             save output in file FILE instead of stdout
   //  -m                  monitor test(s) execution
+  //  -b[=SAMPLES]        benchmark test(s), see cppunit_bench.h
+  //  -j=FILE             save benchmark results in JSON file FILE
+  //  -c=FILE             compare benchmark results with JSON file FILE
+  //  -r=PERCENT          regression threshold for -c
   const char *fileName = 0;
   const char *testName = "";
   const char *xtestName = "";
   bool doMonitoring = false;
+  bool doBenchmark = false;
+  int benchSamples = 25;
+  const char *jsonName = 0;
+  const char *baselineName = 0;
+  double threshold = 10;
 
   for (int i = 1; i < argc; ++i) {
     if (argv[i][0] == '-') {
@@ -97,6 +160,29 @@ int main(int argc, char** argv) {
         doMonitoring = true;
         continue;
       }
+      else if (Timer::supported() && !strcmp(argv[i], "-b")) {
+        doBenchmark = true;
+        continue;
+      }
+      else if (Timer::supported() && !strncmp(argv[i], "-b=", 3) && atoi(argv[i]+3) > 0) {
+        doBenchmark = true;
+        benchSamples = atoi(argv[i]+3);
+        continue;
+      }
+      else if (Timer::supported() && !strncmp(argv[i], "-j=", 3)) {
+        doBenchmark = true;
+        jsonName = argv[i]+3;
+        continue;
+      }
+      else if (Timer::supported() && !strncmp(argv[i], "-c=", 3)) {
+        doBenchmark = true;
+        baselineName = argv[i]+3;
+        continue;
+      }
+      else if (Timer::supported() && !strncmp(argv[i], "-r=", 3)) {
+        threshold = atof(argv[i]+3);
+        continue;
+      }
     }
 
 		// invalid option, we display normal usage.
@@ -110,16 +196,34 @@ int main(int argc, char** argv) {
   else
     reporter = new FileReporter(stdout, doMonitoring);
 
+  Benchmark* benchmark = 0;
+  if (doBenchmark) {
+    benchmark = new Benchmark(benchSamples);
+    benchmark->setThreshold(threshold);
+    if (baselineName != 0 && !benchmark->loadBaseline(baselineName)) {
+      printf("Could not read benchmark baseline: %s\n", baselineName);
+      delete benchmark;
+      delete reporter;
+      return 1;
+    }
+  }
+
   int num_errors;
   if (xtestName[0] != 0) {
-    num_errors = CPPUNIT_NS::TestCase::run(reporter, xtestName, true);
+    num_errors = CPPUNIT_NS::TestCase::run(reporter, xtestName, true, benchmark);
   } else {
-    num_errors = CPPUNIT_NS::TestCase::run(reporter, testName);
+    num_errors = CPPUNIT_NS::TestCase::run(reporter, testName, false, benchmark);
   }
 
   reporter->printSummary();
   delete reporter;
 
+  if (jsonName != 0 && !benchmark->writeJson(jsonName)) {
+    printf("Could not write benchmark results: %s\n", jsonName);
+    ++num_errors;
+  }
+  delete benchmark;
+
   return num_errors;
 }
 
@@ -3,6 +3,10 @@
 
 #if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
 #  include <rope>
+#  include <string>
+#  include <algorithm>
+#  include <cstdio>
+#  include <cstring>
 
 #  if !defined (_STLP_USE_NO_IOSTREAMS)
 #    include <sstream>
@@ -32,18 +36,28 @@ class RopeTest : public CPPUNIT_NS::TestCase
 #endif
   CPPUNIT_TEST(find1);
   CPPUNIT_TEST(find2);
+  CPPUNIT_TEST(find_across_leaves);
+  CPPUNIT_TEST(c_str_after_append);
+  CPPUNIT_TEST(substr_of_leaf);
+  CPPUNIT_EXPLICIT_TEST(append_c_str_bench);
+  CPPUNIT_EXPLICIT_TEST(find_bench);
   CPPUNIT_TEST(construct_from_char);
   CPPUNIT_TEST(bug_report);
 #if !defined (_STLP_MEMBER_TEMPLATES)
   CPPUNIT_IGNORE;
 #endif
-  CPPUNIT_TEST(test_saved_rope_iterators);
+  CPPUNIT_TEST_NO_BENCHMARK(test_saved_rope_iterators);
   CPPUNIT_TEST_SUITE_END();
 
 protected:
   void io();
   void find1();
   void find2();
+  void find_across_leaves();
+  void c_str_after_append();
+  void substr_of_leaf();
+  void append_c_str_bench();
+  void find_bench();
   void construct_from_char();
   void bug_report();
   void test_saved_rope_iterators();
@@ -92,6 +106,139 @@ void RopeTest::find2()
 #endif
 }
 
+void RopeTest::find_across_leaves()
+{
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS) 
+  // Chunks are longer than crope::_S_copy_max so each one ends up
+  // in a leaf of its own.
+  const char* chunks[] = { "the quick brown fox jumps over ",
+                           "the lazy dog, then the quick br",
+                           "own fox sleeps and the lazy dog" };
+  crope r;
+  string s;
+  for (int i = 0; i < 30; ++i) {
+    r.append(chunks[i % 3]);
+    s.append(chunks[i % 3]);
+  }
+  CPPUNIT_ASSERT( r.size() == s.size() );
+
+  CPPUNIT_ASSERT( r.find('z') == s.find('z') );
+  CPPUNIT_ASSERT( r.find('z', 100) == s.find('z', 100) );
+  CPPUNIT_ASSERT( r.find('#') == crope::npos );
+  CPPUNIT_ASSERT( r.find('g', r.size() - 1) == r.size() - 1 );
+
+  // "quick brown" is split over two leaves at every second occurrence.
+  const char* pats[] = { "quick brown", "dog, then", "lazy dogthe", "sleeps", "x", "cat" };
+  for (size_t i = 0; i < sizeof(pats) / sizeof(pats[0]); ++i) {
+    size_t pos = 0;
+    for (;;) {
+      size_t rpos = r.find(pats[i], pos);
+      size_t spos = s.find(pats[i], pos);
+      CPPUNIT_ASSERT( (rpos == crope::npos) == (spos == string::npos) );
+      if (spos == string::npos) break;
+      CPPUNIT_ASSERT( rpos == spos );
+      CPPUNIT_ASSERT( r.find(crope(pats[i]), pos) == spos );
+      pos = spos + 1;
+    }
+  }
+
+  CPPUNIT_ASSERT( r.find("") == 0 );
+  CPPUNIT_ASSERT( r.find("dog", r.size() - 2) == crope::npos );
+#endif
+}
+
+void RopeTest::c_str_after_append()
+{
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS) 
+  crope r;
+  string s;
+  for (int i = 0; i < 200; ++i) {
+    char line[64];
+    sprintf(line, "line %d: a log message long enough for its own leaf\n", i);
+    r.append(line);
+    s.append(line);
+    if (i % 7 == 0) {
+      // Flattening reuses the string cached by the previous c_str().
+      CPPUNIT_ASSERT( s == r.c_str() );
+    }
+  }
+  CPPUNIT_ASSERT( s == r.c_str() );
+
+  crope copy(r);
+  copy.append("tail");
+  CPPUNIT_ASSERT( s == r.c_str() );
+  CPPUNIT_ASSERT( s + "tail" == copy.c_str() );
+  CPPUNIT_ASSERT( copy[copy.size() - 1] == 'l' );
+  CPPUNIT_ASSERT( copy[10] == s[10] );
+#endif
+}
+
+void RopeTest::substr_of_leaf()
+{
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS) 
+  // Long enough for substrings to be represented by reference
+  // instead of by copy.
+  string s;
+  for (int i = 0; i < 40; ++i) {
+    s.append("0123456789abcdefghijklmnopqrstuvwxyz");
+  }
+  crope r(s.c_str());
+
+  crope sub = r.substr(5, 1000);
+  string ssub = s.substr(5, 1000);
+  CPPUNIT_ASSERT( sub.size() == ssub.size() );
+  CPPUNIT_ASSERT( equal(sub.begin(), sub.end(), ssub.begin()) );
+  CPPUNIT_ASSERT( sub.find('z') == ssub.find('z') );
+  CPPUNIT_ASSERT( sub.find("xyz0123") == ssub.find("xyz0123") );
+  CPPUNIT_ASSERT( sub[999] == ssub[999] );
+
+  crope subsub = sub.substr(300, 400);
+  CPPUNIT_ASSERT( ssub.substr(300, 400) == subsub.c_str() );
+
+  crope joined = sub + subsub;
+  CPPUNIT_ASSERT( ssub + ssub.substr(300, 400) == joined.c_str() );
+  CPPUNIT_ASSERT( joined.find("56789a", 1000) == ssub.size() + ssub.substr(300, 400).find("56789a") );
+#endif
+}
+
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
+static const size_t BENCH_ROPE_SIZE = 4 * 1024 * 1024;
+#endif
+
+void RopeTest::append_c_str_bench()
+{
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
+  // Log assembly: append lines and look at the whole buffer often.
+  const char line[] = "I/engine ( 1234): frame 000000 took 16.6ms, 42 draw calls\n";
+  crope r;
+  size_t total = 0;
+  for (int i = 0; r.size() < BENCH_ROPE_SIZE; ++i) {
+    r.append(line);
+    if (i % 64 == 0) {
+      total += strlen(r.c_str());
+    }
+  }
+  CPPUNIT_ASSERT( total != 0 );
+#endif
+}
+
+void RopeTest::find_bench()
+{
+#if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS)
+  const char line[] = "I/engine ( 1234): frame 000000 took 16.6ms, 42 draw calls\n";
+  crope r;
+  while (r.size() < BENCH_ROPE_SIZE) {
+    r.append(line);
+  }
+  r.append("E/engine: out of memory\n");
+
+  for (int i = 0; i < 16; ++i) {
+    CPPUNIT_ASSERT( r.find('E') == r.size() - 24 );
+    CPPUNIT_ASSERT( r.find("out of memory") == r.size() - 14 );
+  }
+#endif
+}
+
 void RopeTest::construct_from_char()
 {
 #if defined (STLPORT) && !defined (_STLP_NO_EXTENSIONS) 
@@ -10,7 +10,12 @@ int main(void)
 {
     void*  lib;
 
+#ifdef __ANDROID__
     lib = dlopen("/data/local/tmp/ndk-tests/libbar.so", RTLD_NOW);
+#else
+    /* Host ABIs: found through LD_LIBRARY_PATH */
+    lib = dlopen("libbar.so", RTLD_NOW);
+#endif
     if (lib == NULL) {
         fprintf(stderr, "Could not dlopen(\"libbar.so\"): %s\n", dlerror());
         return 1;
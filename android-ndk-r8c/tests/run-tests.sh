@@ -51,6 +51,10 @@ RUN_TESTS=
 NDK_PACKAGE=
 WINE=
 CONTINUE_ON_BUILD_FAIL=
+PARALLEL=1
+SHARD=
+JUNIT_FILE=
+JSON_FILE=
 
 while [ -n "$1" ]; do
     opt="$1"
@@ -112,6 +116,18 @@ while [ -n "$1" ]; do
         --continue-on-build-fail)
             CONTINUE_ON_BUILD_FAIL=yes
             ;;
+        --parallel=*)
+            PARALLEL="$optarg"
+            ;;
+        --shard=*)
+            SHARD="$optarg"
+            ;;
+        --junit=*)
+            JUNIT_FILE="$optarg"
+            ;;
+        --json=*)
+            JSON_FILE="$optarg"
+            ;;
         -*) # unknown options
             echo "ERROR: Unknown option '$opt', use --help for list of valid ones."
             exit 1
@@ -139,6 +155,7 @@ if [ "$OPTION_HELP" = "yes" ] ; then
     echo "    --package=<path>  Path to NDK package to test"
     echo "    -j<N> --jobs=<N>  Launch parallel builds [$JOBS]"
     echo "    --abi=<name>      Only run tests for the specific ABI [$ABI]"
+    echo "                      Use 'host' to run the device tests on this machine"
     echo "    --platform=<name> Force API level for testing; platform=<android-x>"
     echo "    --adb=<file>      Specify adb executable for device tests"
     echo "    --only-samples    Only rebuild samples"
@@ -147,12 +164,45 @@ if [ "$OPTION_HELP" = "yes" ] ; then
     echo "    --only-awk        Only run awk tests."
     echo "    --full            Run all device tests, even very long ones."
     echo "    --wine            Build all tests with wine on Linux"
+    echo "    --continue-on-build-fail  Continue after a build failure"
+    echo "    --parallel=<N>    Build up to N tests at the same time [$PARALLEL]"
+    echo "                      The -j value is split between them"
+    echo "    --shard=<i>/<n>   Only run the i-th of n shards of the tests"
+    echo "    --junit=<file>    Write the test results to <file> in JUnit XML format"
+    echo "    --json=<file>     Write the test results to <file> in JSON format"
     echo ""
     echo "NOTE: You cannot use --ndk and --package at the same time."
     echo ""
     exit 0
 fi
 
+if ! echo "$PARALLEL" | grep -q -e '^[1-9][0-9]*$'; then
+    echo "ERROR: Invalid --parallel value, must be a positive number: $PARALLEL"
+    exit 1
+fi
+
+# The tests are distributed round-robin between the shards, in the order
+# in which they are found, see in_shard.
+SHARD_NUM=1
+SHARD_COUNT=1
+if [ -n "$SHARD" ]; then
+    SHARD_NUM=`expr "x$SHARD" : 'x\([0-9]*\)/[0-9]*$'`
+    SHARD_COUNT=`expr "x$SHARD" : 'x[0-9]*/\([0-9]*\)$'`
+    if [ -z "$SHARD_NUM" -o -z "$SHARD_COUNT" ] ||
+       [ "$SHARD_NUM" -lt 1 -o "$SHARD_NUM" -gt "$SHARD_COUNT" ]; then
+        echo "ERROR: Invalid --shard value, must be <i>/<n> with 1 <= i <= n: $SHARD"
+        exit 1
+    fi
+fi
+
+# The make jobs are split between the tests that are built in parallel.
+if [ "$PARALLEL" -gt 1 ]; then
+    JOBS=$(( $JOBS / $PARALLEL ))
+    if [ "$JOBS" -lt 1 ]; then
+        JOBS=1
+    fi
+fi
+
 # Run a command in ADB.
 #
 # This is needed because "adb shell" does not return the proper status
@@ -255,6 +305,16 @@ else # !FULL_TESTS
     }
 fi # !FULL_TESTS
 
+# in_shard returns 0 if the next test belongs to the shard selected
+# with --shard. It must be called once for each buildable test, always
+# in the same order, and not in a sub-shell.
+SHARD_INDEX=0
+in_shard ()
+{
+    SHARD_INDEX=$(( $SHARD_INDEX + 1 ))
+    [ $(( ($SHARD_INDEX - 1) % $SHARD_COUNT + 1 )) = $SHARD_NUM ]
+}
+
 
 TEST_DIR="/tmp/ndk-$USER/tests"
 mkdir -p $TEST_DIR
@@ -364,7 +424,8 @@ run_awk_test_dir ()
     done
 }
 
-if is_testable awk; then
+# The awk tests are quick, they are only run by the first shard.
+if is_testable awk && [ $SHARD_NUM = 1 ]; then
     AWKDIR="$ROOTDIR/build/awk"
     for DIR in `ls -d "$PROGDIR"/awk/*`; do
         run_awk_test_dir "$DIR"
@@ -375,6 +436,17 @@ fi
 ###  REBUILD ALL SAMPLES FIRST
 ###
 
+# The 'host' ABI is the host-x86 or host-x86_64 one that matches
+# this machine.
+if [ "$ABI" = "host" ]; then
+    case $HOST_ARCH in
+        x86_64) ABI=host-x86_64
+            ;;
+        *) ABI=host-x86
+            ;;
+    esac
+fi
+
 NDK_BUILD_FLAGS="-B"
 case $ABI in
     default)  # Let the APP_ABI in jni/Application.mk decide what to build
@@ -382,6 +454,13 @@ case $ABI in
     armeabi|armeabi-v7a|x86|mips)
         NDK_BUILD_FLAGS="$NDK_BUILD_FLAGS APP_ABI=$ABI"
         ;;
+    host-x86|host-x86_64)
+        if [ "$HOST_OS" != "linux" ]; then
+            echo "ERROR: The $ABI ABI is only supported on Linux"
+            exit 1
+        fi
+        NDK_BUILD_FLAGS="$NDK_BUILD_FLAGS APP_ABI=$ABI"
+        ;;
     *)
         echo "ERROR: Unsupported abi value: $ABI"
         exit 1
@@ -415,16 +494,231 @@ get_build_var ()
     $GNUMAKE --no-print-dir -f $NDK/build/core/build-local.mk -C $DIR DUMP_$1 | tail -1
 }
 
+###
+###  TEST SCHEDULER
+###
+
+# Each sample build, build test, device test build or device test run
+# is a job, started with run_test. Job number <seq> writes its log to
+# $RESULTS_DIR/<seq>.log, which is appended to the main log when it
+# completes, and its result to $RESULTS_DIR/<seq>.result, as:
+#
+#   <set> <name> <passed|failed|skipped> <seconds>
+#
+# With --parallel=<N>, up to N jobs run in the background, and the output
+# of each job is printed when it completes. Device test runs use the
+# devices, so they are only started once all builds are done.
+#
+RESULTS_DIR=$TEST_DIR/results
+rm -rf "$RESULTS_DIR" && mkdir -p "$RESULTS_DIR"
+JOB_COUNT=0
+JOB_RUNNING=
+JOB_FAILED=
+
+# Mark the current test as skipped. Must be called from a job.
+skip_test ()
+{
+    touch "$JOB_FILE.skipped"
+}
+
+# $1: job number
+# $2: test set
+# $3: test name
+# $4+: command
+run_job ()
+{
+    local JOB_FILE="$RESULTS_DIR/$1"
+    local TEST_SET=$2
+    local NAME=$3
+    shift; shift; shift
+    (
+        local START END RESULT
+        TMPLOG="$JOB_FILE.log"
+        NDK_LOGFILE="$TMPLOG"
+        touch "$TMPLOG"
+        START=`date +%s`
+        ( "$@" )
+        if [ $? != 0 ]; then
+            RESULT=failed
+        elif [ -f "$JOB_FILE.skipped" ]; then
+            RESULT=skipped
+        else
+            RESULT=passed
+        fi
+        END=`date +%s`
+        echo "$TEST_SET $NAME $RESULT $(( $END - $START ))" > "$JOB_FILE.result"
+    )
+}
+
+# Print the output of a completed job, and check its result.
+# $1: job number
+finish_job ()
+{
+    local JOB_FILE="$RESULTS_DIR/$1"
+    if [ -f "$JOB_FILE.out" ]; then
+        cat "$JOB_FILE.out"
+    fi
+    cat "$JOB_FILE.log" >> "$TMPLOG"
+    set -- `cat "$JOB_FILE.result" 2>/dev/null`
+    if [ "$3" != "passed" -a "$3" != "skipped" ]; then
+        # Only build failures stop the tests.
+        case $1 in
+            run-*) ;;
+            *) if [ "$CONTINUE_ON_BUILD_FAIL" != yes ] ; then
+                   JOB_FAILED=yes
+               fi
+               ;;
+        esac
+    fi
+}
+
+# Wait until at most $1 jobs are running.
+wait_for_jobs ()
+{
+    local JOB RUNNING
+    while [ `echo $JOB_RUNNING | wc -w` -gt $1 ]; do
+        sleep 1
+        RUNNING=
+        for JOB in $JOB_RUNNING; do
+            if [ -f "$RESULTS_DIR/$JOB.result" ]; then
+                finish_job $JOB
+            else
+                RUNNING="$RUNNING $JOB"
+            fi
+        done
+        JOB_RUNNING=$RUNNING
+    done
+    if [ "$1" = 0 ]; then
+        wait
+    fi
+}
+
+# Run a test, in the background with --parallel, except for device test
+# runs. Stop all tests after a build failure, unless
+# --continue-on-build-fail is used.
+# $1: test set (samples, build, device or run-<abi>)
+# $2: test name
+# $3+: command
+run_test ()
+{
+    local JOB BACKGROUND=no
+    JOB_COUNT=$(( $JOB_COUNT + 1 ))
+    JOB=$JOB_COUNT
+    if [ "$PARALLEL" -gt 1 ]; then
+        case $1 in
+            run-*) ;;
+            *) BACKGROUND=yes
+               ;;
+        esac
+    fi
+    if [ "$BACKGROUND" = "yes" ]; then
+        wait_for_jobs $(( $PARALLEL - 1 ))
+        if [ -z "$JOB_FAILED" ]; then
+            run_job $JOB "$@" > "$RESULTS_DIR/$JOB.out" 2>&1 &
+            JOB_RUNNING="$JOB_RUNNING $JOB"
+        fi
+    else
+        run_job $JOB "$@"
+        finish_job $JOB
+    fi
+    if [ -n "$JOB_FAILED" ]; then
+        wait_for_jobs 0
+        write_results
+        exit 1
+    fi
+}
+
+# $1: string
+# Out: the string, escaped for a JSON string
+escape_json ()
+{
+    echo "$1" | sed -e 's/\\/\\\\/g' -e 's/"/\\"/g'
+}
+
+# Print a summary of the results of all completed jobs, and write them
+# to the files given with --junit and --json.
+write_results ()
+{
+    local JOB=1 JOB_FILE TOTAL=0 FAILED=0 SKIPPED=0 TIME=0 FIRST=yes
+    local TESTCASES="$RESULTS_DIR/testcases.xml"
+    local JSON_TESTS="$RESULTS_DIR/tests.json"
+    rm -f "$TESTCASES" "$JSON_TESTS"
+    touch "$TESTCASES" "$JSON_TESTS"
+    while [ $JOB -le $JOB_COUNT ]; do
+        JOB_FILE="$RESULTS_DIR/$JOB"
+        JOB=$(( $JOB + 1 ))
+        if [ ! -f "$JOB_FILE.result" ]; then
+            continue
+        fi
+        set -- `cat "$JOB_FILE.result"`
+        TOTAL=$(( $TOTAL + 1 ))
+        TIME=$(( $TIME + $4 ))
+        echo "  <testcase classname=\"$1\" name=\"$2\" time=\"$4\">" >> "$TESTCASES"
+        case $3 in
+            failed)
+                FAILED=$(( $FAILED + 1 ))
+                dump "FAILED: $1/$2, see $JOB_FILE.log"
+                echo "    <failure message=\"Test failed\"><![CDATA[" >> "$TESTCASES"
+                tail -n 100 "$JOB_FILE.log" | sed -e 's/]]>/]]]]><![CDATA[>/g' >> "$TESTCASES"
+                echo "]]></failure>" >> "$TESTCASES"
+                ;;
+            skipped)
+                SKIPPED=$(( $SKIPPED + 1 ))
+                echo "    <skipped/>" >> "$TESTCASES"
+                ;;
+        esac
+        echo "  </testcase>" >> "$TESTCASES"
+        if [ "$FIRST" != "yes" ]; then
+            echo "," >> "$JSON_TESTS"
+        fi
+        FIRST=no
+        printf '    {"set": "%s", "name": "%s", "result": "%s", "seconds": %s, "log": "%s"}' \
+            "$1" "$2" "$3" "$4" "`escape_json "$JOB_FILE.log"`" >> "$JSON_TESTS"
+    done
+    dump "Results: $TOTAL tests, $FAILED failed, $SKIPPED skipped, ${TIME}s (shard $SHARD_NUM/$SHARD_COUNT)"
+    if [ -n "$JUNIT_FILE" ]; then
+        (
+            echo '<?xml version="1.0" encoding="UTF-8"?>'
+            echo "<testsuite name=\"ndk-tests.shard$SHARD_NUM\" tests=\"$TOTAL\" failures=\"$FAILED\" errors=\"0\" skipped=\"$SKIPPED\" time=\"$TIME\">"
+            cat "$TESTCASES"
+            echo "</testsuite>"
+        ) > "$JUNIT_FILE"
+        fail_panic "Could not write JUnit results: $JUNIT_FILE"
+        dump "JUnit results: $JUNIT_FILE"
+    fi
+    if [ -n "$JSON_FILE" ]; then
+        (
+            echo "{"
+            echo "  \"abi\": \"$ABI\","
+            echo "  \"shard\": $SHARD_NUM,"
+            echo "  \"shards\": $SHARD_COUNT,"
+            echo "  \"tests\": ["
+            cat "$JSON_TESTS"
+            echo ""
+            echo "  ]"
+            echo "}"
+        ) > "$JSON_FILE"
+        fail_panic "Could not write JSON results: $JSON_FILE"
+        dump "JSON results: $JSON_FILE"
+    fi
+    rm -f "$TESTCASES" "$JSON_TESTS"
+}
+
+# Build a project in its own copy under $BUILD_DIR/<set>, so that each
+# test has its own NDK_OUT. Must be called from a job.
+# $1: project path
+# $2: 'yes' to check that the project supports the selected ABI
 build_project ()
 {
     local NAME=`basename $1`
     local CHECK_ABI=$2
-    local DIR="$BUILD_DIR/$NAME"
+    local DIR="$BUILD_DIR/$TEST_SET/$NAME"
     if [ -f "$1/BROKEN_BUILD" -a -z "$RUN_TESTS" ] ; then
         echo "Skipping `basename $1`: (build)"
+        skip_test
         return 0
     fi
-    rm -rf "$DIR" && cp -r "$1" "$DIR"
+    rm -rf "$DIR" && mkdir -p "$BUILD_DIR/$TEST_SET" && cp -r "$1" "$DIR"
     if [ "$ABI" != "default" -a "$CHECK_ABI" = "yes" ] ; then
         # check APP_ABI
         local APP_ABIS=`get_build_var APP_ABI`
@@ -432,12 +726,19 @@ build_project ()
         if [ "$APP_ABIS" != "${APP_ABIS%%all*}" ] ; then
         # replace the first "all" with all available ABIs
           ALL_ABIS=`get_build_var NDK_ALL_ABIS`
+          # Host ABIs are never part of 'all', but the device tests use
+          # it to mean any ABI.
+          case $ABI in
+              host-*) ALL_ABIS="$ALL_ABIS $ABI"
+                  ;;
+          esac
           APP_ABIS_FRONT="${APP_ABIS%%all*}"
           APP_ABIS_BACK="${APP_ABIS#*all}"
           APP_ABIS="${APP_ABIS_FRONT}${ALL_ABIS}${APP_ABIS_BACK}"
         fi
         if [ "$APP_ABIS" = "${APP_ABIS%$ABI *}" ] ; then
             echo "Skipping `basename $1`: incompatible ABI, needs $APP_ABIS"
+            skip_test
             return 0
         fi
     fi
@@ -447,21 +748,27 @@ build_project ()
     if [ -f "$1/BUILD_SHOULD_FAIL" ]; then
         if [ $RET = 0 ]; then
             echo "!!! FAILURE: BUILD SHOULD HAVE FAILED [$1]"
-            if [ "$CONTINUE_ON_BUILD_FAIL" != yes ] ; then
-                exit 1
-            fi
+            return 1
         fi
         log "!!! SUCCESS: BUILD FAILED AS EXPECTED [$(basename $1)]"
         RET=0
     fi
     if [ $RET != 0 ] ; then
         echo "!!! BUILD FAILURE [$1]!!! See $NDK_LOGFILE for details or use --verbose option!"
-        if [ "$CONTINUE_ON_BUILD_FAIL" != yes ] ; then
-            exit 1
-        fi
+        return 1
     fi
 }
 
+# Samples and build tests only target Android devices.
+case $ABI in
+    host-*)
+        if is_testable samples || is_testable build; then
+            dump "Skipping samples and build tests for the $ABI ABI"
+        fi
+        TESTABLES=$(echo $TESTABLES | tr ' ' '\n' | grep -v -x -e samples -e build)
+        ;;
+esac
+
 #
 # Determine list of samples directories.
 #
@@ -505,8 +812,8 @@ if is_testable samples; then
 
     for DIR in $SAMPLES_DIRS; do
         for SUBDIR in `ls -d $DIR/*`; do
-            if is_buildable $SUBDIR; then
-                build_sample $SUBDIR
+            if is_buildable $SUBDIR && in_shard; then
+                run_test samples `basename $SUBDIR` build_sample $SUBDIR
             fi
         done
     done
@@ -525,9 +832,7 @@ if is_testable build; then
             run $1/build.sh $NDK_BUILD_FLAGS
             if [ $? != 0 ]; then
                 echo "!!! BUILD FAILURE [$1]!!! See $NDK_LOGFILE for details or use --verbose option!"
-                if [ "$CONTINUE_ON_BUILD_FAIL" != yes ] ; then
-                    exit 1
-                fi
+                return 1
             fi
         else
             build_project $1 "yes"
@@ -535,8 +840,8 @@ if is_testable build; then
     }
 
     for DIR in `ls -d $ROOTDIR/tests/build/*`; do
-        if is_buildable $DIR; then
-            build_build_test $DIR
+        if is_buildable $DIR && in_shard; then
+            run_test build `basename $DIR` build_build_test $DIR
         fi
     done
 fi
@@ -553,6 +858,7 @@ if is_testable device; then
         # Have listed the test explicitely.
         if [ -f "$1/BROKEN_BUILD" -a -z "$RUN_TESTS" ] ; then
             echo "Skipping broken device test build: `basename $1`"
+            skip_test
             return 0
         fi
         echo "Building NDK device test: `basename $1` in $1"
@@ -574,16 +880,19 @@ if is_testable device; then
         local DSTFILE
         local PROGRAMS=
         local PROGRAM
+        local RET=0
         # Do not run the test if BROKEN_RUN is defined
         if [ -f "$TEST/BROKEN_RUN" -o -f "$TEST/BROKEN_BUILD" ] ; then
 	    if [ -z "$RUN_TESTS" ]; then
 		dump "Skipping NDK device test run: `basename $TEST`"
+		skip_test
 		return 0
 	    fi
         fi
-        SRCDIR="$BUILD_DIR/`basename $TEST`/libs/$CPU_ABI"
+        SRCDIR="$BUILD_DIR/device/`basename $TEST`/libs/$CPU_ABI"
         if [ ! -d "$SRCDIR" ]; then
             dump "Skipping NDK device test run (no $CPU_ABI binaries): `basename $TEST`"
+            skip_test
             return 0
         fi
         # First, copy all files to the device, except for gdbserver or gdb.setup.
@@ -615,77 +924,144 @@ if is_testable device; then
             adb_var_shell_cmd "$DEVICE" "" LD_LIBRARY_PATH="$DSTDIR" $PROGRAM
             if [ $? != 0 ] ; then
                 dump "   ---> TEST FAILED!!"
+                RET=1
             fi
         done
         # Cleanup
         adb_var_shell_cmd "$DEVICE" "" rm -r $DSTDIR
+        return $RET
     }
 
+    # Run a device test on this machine, for host ABIs.
+    # $1: test
+    run_host_test ()
+    {
+        local TEST=$1
+        local SRCDIR
+        local PROGRAM
+        local RET=0
+        # Do not run the test if BROKEN_RUN is defined
+        if [ -f "$TEST/BROKEN_RUN" -o -f "$TEST/BROKEN_BUILD" ] ; then
+            if [ -z "$RUN_TESTS" ]; then
+                dump "Skipping NDK device test run: `basename $TEST`"
+                skip_test
+                return 0
+            fi
+        fi
+        SRCDIR="$BUILD_DIR/device/`basename $TEST`/libs/$ABI"
+        if [ ! -d "$SRCDIR" ]; then
+            dump "Skipping NDK device test run (no $ABI binaries): `basename $TEST`"
+            skip_test
+            return 0
+        fi
+        for PROGRAM in `ls $SRCDIR`; do
+            # Skip shared libraries, they are found with LD_LIBRARY_PATH
+            echo "$PROGRAM" | grep -q -e '\.so$' && continue
+            dump "Running device test [$ABI]: $PROGRAM"
+            run env LD_LIBRARY_PATH="$SRCDIR" "$SRCDIR/$PROGRAM"
+            if [ $? != 0 ] ; then
+                dump "   ---> TEST FAILED!!"
+                RET=1
+            fi
+        done
+        return $RET
+    }
+
+    DEVICE_TESTS=
     for DIR in `ls -d $ROOTDIR/tests/device/*`; do
-        if is_buildable $DIR; then
-            build_device_test $DIR
+        if is_buildable $DIR && in_shard; then
+            DEVICE_TESTS="$DEVICE_TESTS $DIR"
+            run_test device `basename $DIR` build_device_test $DIR
         fi
     done
 
-    # Do we have adb and any device connected here?
-    # If not, we can't run our tests.
-    #
-    SKIP_TESTS=no
-    if [ -z "$ADB_CMD" ] ; then
-        dump "WARNING: No 'adb' in your path!"
-        SKIP_TESTS=yes
+    # The tests can only run once all of them are built.
+    wait_for_jobs 0
+    if [ -n "$JOB_FAILED" ]; then
+        write_results
+        exit 1
+    fi
+
+    case $ABI in
+        host-*)
+            HOST_TESTS=yes
+            ;;
+        *)
+            HOST_TESTS=no
+            ;;
+    esac
+
+    # Host ABIs run the tests on this machine, without adb.
+    if [ "$HOST_TESTS" = "yes" ] ; then
+        for DIR in $DEVICE_TESTS; do
+            log "Running device test on this machine [$ABI]: $DIR"
+            run_test run-$ABI `basename $DIR` run_host_test "$DIR"
+        done
     else
-        # Get list of online devices, turn ' ' in device into '.'
-        ADB_DEVICES=`$ADB_CMD devices | grep -v offline | awk 'NR>1 {gsub(/[ \t]+device$/,""); print;}' | sed '/^$/d' | sort | tr ' ' '.'`
-        ADB_DEVICES=$(echo $ADB_DEVICES | tr '\n' ' ')
-        log2 "ADB online devices (sorted): $ADB_DEVICES"
-        ADB_DEVCOUNT=`echo "$ADB_DEVICES" | wc -w`
-        if [ "$ADB_DEVCOUNT" = "0" ]; then
-            dump "WARNING: No device connected to adb!"
+        # Do we have adb and any device connected here?
+        # If not, we can't run our tests.
+        #
+        SKIP_TESTS=no
+        if [ -z "$ADB_CMD" ] ; then
+            dump "WARNING: No 'adb' in your path!"
             SKIP_TESTS=yes
         else
-            ADB_DEVICES="$ADB_DEVICES "
-            if [ -n "$ANDROID_SERIAL" ] ; then
-                ADB_SERIAL=$(echo "$ANDROID_SERIAL" | tr ' ' '.')  # turn ' ' into '.'
-                if [ "$ADB_DEVICES" = "${ADB_DEVICES%$ADB_SERIAL *}" ] ; then
-                    dump "WARNING: Device $ANDROID_SERIAL cannot be found or offline!"
-                    SKIP_TESTS=yes
-                else
-                    ADB_DEVICES="$ANDROID_SERIAL"
+            # Get list of online devices, turn ' ' in device into '.'
+            ADB_DEVICES=`$ADB_CMD devices | grep -v offline | awk 'NR>1 {gsub(/[ \t]+device$/,""); print;}' | sed '/^$/d' | sort | tr ' ' '.'`
+            ADB_DEVICES=$(echo $ADB_DEVICES | tr '\n' ' ')
+            log2 "ADB online devices (sorted): $ADB_DEVICES"
+            ADB_DEVCOUNT=`echo "$ADB_DEVICES" | wc -w`
+            if [ "$ADB_DEVCOUNT" = "0" ]; then
+                dump "WARNING: No device connected to adb!"
+                SKIP_TESTS=yes
+            else
+                ADB_DEVICES="$ADB_DEVICES "
+                if [ -n "$ANDROID_SERIAL" ] ; then
+                    ADB_SERIAL=$(echo "$ANDROID_SERIAL" | tr ' ' '.')  # turn ' ' into '.'
+                    if [ "$ADB_DEVICES" = "${ADB_DEVICES%$ADB_SERIAL *}" ] ; then
+                        dump "WARNING: Device $ANDROID_SERIAL cannot be found or offline!"
+                        SKIP_TESTS=yes
+                    else
+                        ADB_DEVICES="$ANDROID_SERIAL"
+                    fi
                 fi
             fi
         fi
-    fi
-    if [ "$SKIP_TESTS" = "yes" ] ; then
-        dump "SKIPPING RUNNING TESTS ON DEVICE!"
-    else
-        AT_LEAST_CPU_ABI_MATCH=
-        for DEVICE in $ADB_DEVICES; do
-            # undo earlier ' '-to-'.' translation
-            DEVICE=$(echo $DEVICE | tr '.' ' ')
-            # get device CPU_ABI and CPU_ABI2, each may contain list of abi, comma-delimited.
-            adb_var_shell_cmd "$DEVICE" CPU_ABI1 getprop ro.product.cpu.abi
-            adb_var_shell_cmd "$DEVICE" CPU_ABI2 getprop ro.product.cpu.abi2
-            CPU_ABIS="$CPU_ABI1,$CPU_ABI2"
-            CPU_ABIS=$(commas_to_spaces $CPU_ABIS)
-            for CPU_ABI in $CPU_ABIS; do
-                if [ "$ABI" = "default" -o "$ABI" = "$CPU_ABI" ] ; then
-                    AT_LEAST_CPU_ABI_MATCH="yes"
-                    for DIR in `ls -d $ROOTDIR/tests/device/*`; do
-                        log "Running device test on $DEVICE [$CPU_ABI]: $DIR"
-                        if is_buildable $DIR; then
-                            run_device_test "$DEVICE" "$CPU_ABI" "$DIR" /data/local/tmp
-                        fi
-                    done
-                fi
+        if [ "$SKIP_TESTS" = "yes" ] ; then
+            dump "SKIPPING RUNNING TESTS ON DEVICE!"
+        else
+            AT_LEAST_CPU_ABI_MATCH=
+            for DEVICE in $ADB_DEVICES; do
+                # undo earlier ' '-to-'.' translation
+                DEVICE=$(echo $DEVICE | tr '.' ' ')
+                # get device CPU_ABI and CPU_ABI2, each may contain list of abi, comma-delimited.
+                adb_var_shell_cmd "$DEVICE" CPU_ABI1 getprop ro.product.cpu.abi
+                adb_var_shell_cmd "$DEVICE" CPU_ABI2 getprop ro.product.cpu.abi2
+                CPU_ABIS="$CPU_ABI1,$CPU_ABI2"
+                CPU_ABIS=$(commas_to_spaces $CPU_ABIS)
+                for CPU_ABI in $CPU_ABIS; do
+                    if [ "$ABI" = "default" -o "$ABI" = "$CPU_ABI" ] ; then
+                        AT_LEAST_CPU_ABI_MATCH="yes"
+                        for DIR in $DEVICE_TESTS; do
+                            log "Running device test on $DEVICE [$CPU_ABI]: $DIR"
+                            run_test run-$CPU_ABI `basename $DIR` run_device_test "$DEVICE" "$CPU_ABI" "$DIR" /data/local/tmp
+                        done
+                    fi
+                done
             done
-        done
-        if [ "$AT_LEAST_CPU_ABI_MATCH" != "yes" ] ; then
-            dump "WARNING: No device matches ABI $ABI! SKIPPING RUNNING TESTS ON DEVICE!"
+            if [ "$AT_LEAST_CPU_ABI_MATCH" != "yes" ] ; then
+                dump "WARNING: No device matches ABI $ABI! SKIPPING RUNNING TESTS ON DEVICE!"
+            fi
         fi
     fi
 fi
 
+wait_for_jobs 0
+write_results
+
 dump "Cleaning up..."
 rm -rf $BUILD_DIR
 dump "Done."
+if [ -n "$JOB_FAILED" ]; then
+    exit 1
+fi
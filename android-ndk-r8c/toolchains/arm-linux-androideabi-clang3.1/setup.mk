@@ -42,6 +42,14 @@ TOOLCHAIN_PREFIX := $(TOOLCHAIN_PREBUILT_ROOT)/bin/arm-linux-androideabi-
 TARGET_CC := $(LLVM_TOOLCHAIN_PREFIX)clang
 TARGET_CXX := $(LLVM_TOOLCHAIN_PREFIX)clang++
 
+# Link-time optimization with Clang requires the LLVMgold linker plugin,
+# which isn't provided. Don't pick the GCC one from TOOLCHAIN_PREBUILT_ROOT.
+TARGET_LTO_PLUGIN :=
+
+# The profile-guided optimization flags used with GCC aren't supported.
+TARGET_PGO_instrument_CFLAGS :=
+TARGET_PGO_use_CFLAGS :=
+
 #
 # CFLAGS and LDFLAGS
 #
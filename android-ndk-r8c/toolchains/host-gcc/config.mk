@@ -0,0 +1,24 @@
+# Copyright (C) 2012 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# config file for the host gcc toolchain for the Android NDK
+# the real meat is in the setup.mk file adjacent to this one
+#
+# It builds the host-x86 and host-x86_64 pseudo-ABIs with the compiler of
+# the host system, in order to run and profile NDK code (e.g. the device
+# tests) without a device. These are not part of APP_ABI=all.
+#
+TOOLCHAIN_ARCH := host
+TOOLCHAIN_ABIS := host-x86 host-x86_64
@@ -0,0 +1,105 @@
+# Copyright (C) 2012 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# this file is used to prepare the NDK to build with the host gcc
+# toolchain any number of source files, for the host-x86 and host-x86_64
+# pseudo-ABIs.
+#
+# its purpose is to define (or re-define) templates used to build
+# various sources into target object files, libraries or executables.
+#
+# The host compiler and binutils are used from the PATH, since they are
+# not part of the NDK. They can be changed on the command-line, e.g. with
+# TARGET_CC=gcc-4.6 TARGET_CXX=g++-4.6. The host-x86 ABI requires a
+# compiler that supports -m32, and the corresponding libraries.
+#
+
+TOOLCHAIN_NAME   := host-gcc
+TOOLCHAIN_PREFIX :=
+
+ifeq ($(TARGET_ARCH_ABI),host-x86)
+    TARGET_HOST_CFLAGS := -m32
+else
+    TARGET_HOST_CFLAGS := -m64
+endif
+
+TARGET_CFLAGS := \
+    $(TARGET_HOST_CFLAGS) \
+    -fPIC \
+    -ffunction-sections \
+    -funwind-tables \
+    -fstack-protector
+
+# C++ sources only see the headers of the selected NDK C++ runtime, and use
+# the same dialect as the NDK's GCC, like on the device.
+TARGET_CXXFLAGS = $(TARGET_CFLAGS) -fno-exceptions -fno-rtti -std=gnu++98 -nostdinc++
+
+# Use the host's system headers and libraries instead of the platform's.
+# Unlike Bionic, the GNU C library provides the pthread, dl and rt
+# functions in separate libraries.
+SYSROOT           :=
+TARGET_C_INCLUDES :=
+TARGET_LDFLAGS    := $(TARGET_HOST_CFLAGS)
+TARGET_LDLIBS     := -lc -lm -lpthread -ldl -lrt
+
+# The host compiler driver links libgcc itself.
+TARGET_LIBGCC :=
+
+# The location of the host's LTO plugin is not known.
+TARGET_LTO_PLUGIN :=
+
+TARGET_host_release_CFLAGS := -O2 \
+                              -fomit-frame-pointer \
+                              -fstrict-aliasing
+
+TARGET_host_debug_CFLAGS := $(TARGET_host_release_CFLAGS) \
+                            -fno-omit-frame-pointer \
+                            -fno-strict-aliasing
+
+# This function will be called to determine the target CFLAGS used to build
+# a C or Assembler source file, based on its tags.
+#
+TARGET-process-src-files-tags = \
+$(eval __debug_sources := $(call get-src-files-with-tag,debug)) \
+$(eval __release_sources := $(call get-src-files-without-tag,debug)) \
+$(call set-src-files-target-cflags, $(__debug_sources), $(TARGET_host_debug_CFLAGS)) \
+$(call set-src-files-target-cflags, $(__release_sources),$(TARGET_host_release_CFLAGS)) \
+$(call set-src-files-text,$(LOCAL_SRC_FILES),host$(space)) \
+
+# There is no sysroot to link against, and executables can use copy
+# relocations.
+#
+define cmd-build-shared-library
+$(PRIVATE_CXX) \
+    -Wl,-soname,$(notdir $(LOCAL_BUILT_MODULE)) \
+    -shared \
+    $(PRIVATE_LINKER_OBJECTS_AND_LIBRARIES) \
+    $(PRIVATE_LDFLAGS) \
+    $(PRIVATE_LDLIBS) \
+    -o $(call host-path,$(LOCAL_BUILT_MODULE))
+endef
+
+define cmd-build-executable
+$(PRIVATE_CXX) \
+    -Wl,--gc-sections \
+    $(PRIVATE_LINKER_OBJECTS_AND_LIBRARIES) \
+    $(PRIVATE_LDFLAGS) \
+    $(PRIVATE_LDLIBS) \
+    -o $(call host-path,$(LOCAL_BUILT_MODULE))
+endef
+
+# The ABI-specific sub-directory that the SDK tools recognize for
+# this toolchain's generated binaries
+TARGET_ABI_SUBDIR := $(TARGET_ARCH_ABI)
@@ -37,6 +37,9 @@ TARGET_CFLAGS := \
 
 TARGET_LDFLAGS :=
 
+# The MIPS linker doesn't support the GNU hash table.
+TARGET_LINK_OPTIMIZE_LDFLAGS := -Wl,--gc-sections -Wl,-O1
+
 TARGET_C_INCLUDES := \
     $(SYSROOT)/usr/include
 